@@ -40,6 +40,7 @@
 #include "stream_manager.hh"
 #include "system.hh"
 #include "api/config.hh"
+#include "redis.hh"
 
 namespace api {
 
@@ -122,6 +123,11 @@ future<> set_server_cache(http_context& ctx) {
             "The cache service API", set_cache_service);
 }
 
+future<> set_server_redis(http_context& ctx) {
+    return register_api(ctx, "redis",
+            "The redis frontend API", set_redis);
+}
+
 future<> set_server_gossip_settle(http_context& ctx) {
     auto rb = std::make_shared < api_registry_builder > (ctx.api_doc);
 
@@ -48,5 +48,6 @@ future<> set_server_stream_manager(http_context& ctx);
 future<> set_server_gossip_settle(http_context& ctx);
 future<> set_server_cache(http_context& ctx);
 future<> set_server_done(http_context& ctx);
+future<> set_server_redis(http_context& ctx);
 
 }
@@ -0,0 +1,85 @@
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "api/redis.hh"
+#include "api/api-doc/redis.json.hh"
+#include "redis/hot_keys.hh"
+#include "redis/query_processor.hh"
+#include "redis/rdb.hh"
+
+namespace api {
+
+using namespace json;
+namespace rs = httpd::redis_json;
+
+static constexpr size_t default_hot_keys_count = 10;
+
+static sstring rdb_path(const request& req) {
+    auto path = req.get_query_param("path");
+    if (path.empty()) {
+        throw bad_param_exception("path is required");
+    }
+    return path;
+}
+
+void set_redis(http_context& ctx, routes& r) {
+    rs::get_hot_keys.set(r, [] (std::unique_ptr<request> req) {
+        auto count = default_hot_keys_count;
+        auto param = req->get_query_param("count");
+        if (!param.empty()) {
+            try {
+                count = boost::lexical_cast<size_t>(param);
+            } catch (boost::bad_lexical_cast&) {
+                throw bad_param_exception(sprint("count should be a positive number, got '%s'", param));
+            }
+        }
+        return redis::get_hot_keys(count).then([] (std::vector<redis::hot_keys::entry> entries) {
+            std::vector<rs::hot_key> res;
+            res.reserve(entries.size());
+            for (auto& e : entries) {
+                rs::hot_key k;
+                k.key = sstring(reinterpret_cast<const char*>(e._key.data()), e._key.size());
+                k.count = e._count;
+                res.push_back(std::move(k));
+            }
+            return make_ready_future<json::json_return_type>(std::move(res));
+        });
+    });
+
+    rs::reset_hot_keys.set(r, [] (std::unique_ptr<request> req) {
+        return redis::get_query_processor().invoke_on_all([] (auto& qp) {
+            qp.get_hot_keys().reset();
+        }).then([] {
+            return make_ready_future<json::json_return_type>(json_void());
+        });
+    });
+
+    rs::import_rdb.set(r, [] (std::unique_ptr<request> req) {
+        return redis::import_rdb(rdb_path(*req)).then([] (uint64_t keys) {
+            return make_ready_future<json::json_return_type>(keys);
+        });
+    });
+
+    rs::export_rdb.set(r, [] (std::unique_ptr<request> req) {
+        return redis::export_rdb(rdb_path(*req)).then([] (uint64_t keys) {
+            return make_ready_future<json::json_return_type>(keys);
+        });
+    });
+}
+
+}
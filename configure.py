@@ -265,6 +265,7 @@ scylla_tests = [
     'tests/perf/perf_hash',
     'tests/perf/perf_cql_parser',
     'tests/perf/perf_simple_query',
+    'tests/perf/perf_redis',
     'tests/perf/perf_fast_forward',
     'tests/perf/perf_cache_eviction',
     'tests/cache_flat_mutation_reader_test',
@@ -274,6 +275,28 @@ scylla_tests = [
     'tests/cql_query_test',
     'tests/secondary_index_test',
     'tests/json_cql_query_test',
+    'tests/redis/list_test',
+    'tests/redis/stream_test',
+    'tests/redis/hyperloglog_test',
+    'tests/redis/geo_test',
+    'tests/redis/hash_test',
+    'tests/redis/bitmap_test',
+    'tests/redis/transport_test',
+    'tests/redis/stats_test',
+    'tests/redis/slowlog_test',
+    'tests/redis/info_test',
+    'tests/redis/protocol_parser_test',
+    'tests/redis/hotkeys_test',
+    'tests/redis/near_cache_test',
+    'tests/redis/resp3_test',
+    'tests/redis/cluster_test',
+    'tests/redis/schemas_test',
+    'tests/redis/flushdb_test',
+    'tests/redis/rdb_test',
+    'tests/redis/replication_test',
+    'tests/redis/dump_test',
+    'tests/redis/rename_test',
+    'tests/redis/object_test',
     'tests/filtering_test',
     'tests/storage_proxy_test',
     'tests/schema_change_test',
@@ -579,6 +602,22 @@ scylla_core = (['database.cc',
                 'redis/prefetcher.cc',
                 'redis/redis_mutation.cc',
                 'redis/native_protocol_parser.cc',
+                'redis/blocked_clients.cc',
+                'redis/key_locks.cc',
+                'redis/streams.cc',
+                'redis/hyperloglog.cc',
+                'redis/bitmaps.cc',
+                'redis/geo.cc',
+                'redis/slowlog.cc',
+                'redis/hot_keys.cc',
+                'redis/near_cache.cc',
+                'redis/client_tracking.cc',
+                'redis/command_keys.cc',
+                'redis/cluster.cc',
+                'redis/rdb.cc',
+                'redis/replication.cc',
+                'redis/key_copy.cc',
+                'redis/key_footprint.cc',
                 'redis/commands/set.cc',
                 'redis/commands/get.cc',
                 'redis/commands/append.cc',
@@ -593,6 +632,7 @@ scylla_core = (['database.cc',
                 'redis/commands/lrange.cc',
                 'redis/commands/lrem.cc',
                 'redis/commands/lpop.cc',
+                'redis/commands/blpop.cc',
                 'redis/commands/llen.cc',
                 'redis/commands/ltrim.cc',
                 'redis/commands/hset.cc',
@@ -615,7 +655,36 @@ scylla_core = (['database.cc',
                 'redis/commands/zrangebyscore.cc',
                 'redis/commands/zrank.cc',
                 'redis/commands/zrem.cc',
+                'redis/commands/xadd.cc',
+                'redis/commands/xtrim.cc',
+                'redis/commands/xdel.cc',
+                'redis/commands/xlen.cc',
+                'redis/commands/xrange.cc',
+                'redis/commands/xread.cc',
+                'redis/commands/xgroup.cc',
+                'redis/commands/pfadd.cc',
+                'redis/commands/setbit.cc',
+                'redis/commands/bitcount.cc',
+                'redis/commands/bitop.cc',
+                'redis/commands/bitfield.cc',
+                'redis/commands/geoadd.cc',
+                'redis/commands/geopos.cc',
+                'redis/commands/georadius.cc',
                 'redis/commands/cluster_slots.cc',
+                'redis/commands/slowlog.cc',
+                'redis/commands/info.cc',
+                'redis/commands/hotkeys.cc',
+                'redis/commands/flushdb.cc',
+                'redis/commands/replicaof.cc',
+                'redis/commands/dump.cc',
+                'redis/commands/restore.cc',
+                'redis/commands/migrate.cc',
+                'redis/commands/rename.cc',
+                'redis/commands/copy.cc',
+                'redis/commands/move.cc',
+                'redis/commands/object.cc',
+                'redis/commands/memory.cc',
+                'redis/commands/bigkeys.cc',
                 'db/consistency_level.cc',
                 'db/system_keyspace.cc',
                 'db/system_distributed_keyspace.cc',
@@ -663,6 +732,7 @@ scylla_core = (['database.cc',
                 'dht/murmur3_partitioner.cc',
                 'dht/byte_ordered_partitioner.cc',
                 'dht/random_partitioner.cc',
+                'dht/redis_hash_slot_partitioner.cc',
                 'dht/boot_strapper.cc',
                 'dht/range_streamer.cc',
                 'unimplemented.cc',
@@ -777,6 +847,8 @@ api = ['api/api.cc',
        'api/system.cc',
        'api/config.cc',
        'api/api-doc/config.json',
+       'api/redis.cc',
+       'api/api-doc/redis.json',
        ]
 
 idls = ['idl/gossip_digest.idl.hh',
@@ -866,6 +938,7 @@ tests_not_using_seastar_test_framework = set([
     'tests/perf/perf_cql_parser',
     'tests/message',
     'tests/perf/perf_simple_query',
+    'tests/perf/perf_redis',
     'tests/perf/perf_fast_forward',
     'tests/perf/perf_cache_eviction',
     'tests/row_cache_stress_test',
@@ -307,6 +307,14 @@ logalloc::occupancy_stats table::occupancy() const {
     return res;
 }
 
+size_t table::partition_memtable_memory_usage(const dht::decorated_key& key) const {
+    size_t size = 0;
+    for (auto&& mt : *_memtables) {
+        size += mt->partition_memory_usage(key);
+    }
+    return size;
+}
+
 static
 bool belongs_to_current_shard(const dht::decorated_key& dk) {
     return dht::shard_of(dk.token()) == engine().cpu_id();
@@ -3862,10 +3870,10 @@ future<> database::flush_all_memtables() {
     });
 }
 
-future<> database::truncate(sstring ksname, sstring cfname, timestamp_func tsf) {
+future<> database::truncate(sstring ksname, sstring cfname, timestamp_func tsf, bool with_snapshot) {
     auto& ks = find_keyspace(ksname);
     auto& cf = find_column_family(ksname, cfname);
-    return truncate(ks, cf, std::move(tsf));
+    return truncate(ks, cf, std::move(tsf), with_snapshot);
 }
 
 future<>
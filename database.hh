@@ -689,6 +689,8 @@ public:
     future<std::vector<locked_cell>> lock_counter_cells(const mutation& m, db::timeout_clock::time_point timeout);
 
     logalloc::occupancy_stats occupancy() const;
+    // The memory used by the partition of the key in the memtables.
+    size_t partition_memtable_memory_usage(const dht::decorated_key& key) const;
 private:
     table(schema_ptr schema, config cfg, db::commitlog* cl, compaction_manager&, cell_locker_stats& cl_stats, cache_tracker& row_cache_tracker);
 public:
@@ -1423,7 +1425,7 @@ public:
     typedef std::function<future<db_clock::time_point>()> timestamp_func;
 
     /** Truncates the given column family */
-    future<> truncate(sstring ksname, sstring cfname, timestamp_func);
+    future<> truncate(sstring ksname, sstring cfname, timestamp_func, bool with_snapshot = true);
     future<> truncate(const keyspace& ks, column_family& cf, timestamp_func, bool with_snapshot = true);
     future<> truncate_views(const column_family& base, db_clock::time_point truncated_at, bool should_flush);
 
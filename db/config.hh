@@ -382,7 +382,8 @@ public:
     val(num_tokens, uint32_t, 1, Used,                \
             "Defines the number of tokens randomly assigned to this node on the ring when using virtual nodes (vnodes). The more tokens, relative to other nodes, the larger the proportion of data that the node stores. Generally all nodes should have the same number of tokens assuming equal hardware capability. The recommended value is 256. If unspecified (#num_tokens), Scylla uses 1 (equivalent to #num_tokens : 1) for legacy compatibility and uses the initial_token setting.\n"    \
             "If not using vnodes, comment #num_tokens : 256 or set num_tokens : 1 and use initial_token. If you already have an existing cluster with one token per node and wish to migrate to vnodes, see Enabling virtual nodes on an existing production cluster.\n"    \
-            "Note: If using DataStax Enterprise, the default setting of this property depends on the type of node and type of install."  \
+            "Note: If using DataStax Enterprise, the default setting of this property depends on the type of node and type of install.\n"  \
+            "With the RedisHashSlotPartitioner, the random tokens are the first tokens of the hash slots: the ring holds at most 16383 tokens, so num_tokens times the number of nodes must not exceed 16383 (a node whose tokens cannot fit fails to bootstrap), and the nodes must bootstrap one at a time."  \
     )   \
     val(partitioner, sstring, "org.apache.cassandra.dht.Murmur3Partitioner", Used,                \
             "Distributes rows (by partition key) across all nodes in the cluster. Any IPartitioner may be used, including your own as long as it is in the class path. For new clusters use the default partitioner.\n" \
@@ -392,11 +393,14 @@ public:
             "\tByteOrderedPartitioner\n"    \
             "\tOrderPreservingPartitioner (deprecated)\n"    \
             "\n"    \
+            "Pedis provides RedisHashSlotPartitioner, which places the keys by their Redis Cluster hash slot, the CRC16 of their {hashtag}.\n" \
+            "\n"    \
             "Related information: Partitioners"  \
             , "org.apache.cassandra.dht.Murmur3Partitioner" \
             , "org.apache.cassandra.dht.RandomPartitioner" \
             , "org.apache.cassandra.dht.ByteOrderedPartitioner" \
             , "org.apache.cassandra.dht.OrderPreservingPartitioner" \
+            , "org.pedis.dht.RedisHashSlotPartitioner" \
     )                                                   \
     val(storage_port, uint16_t, 7000, Used,                \
             "The port for inter-node communication."  \
@@ -763,6 +767,50 @@ public:
             "\n"    \
             "The properties of replication for redis keyspace."    \
     )   \
+    val(redis_client_output_buffer_limit_in_mb, uint32_t, 64, Used,     \
+            "The maximum size of the replies a redis connection may have pending, waiting to be written to the client. " \
+            "A connection over this limit (e.g. a client pipelining requests without reading the replies) is closed. Set to 0 to disable the limit." \
+    )   \
+    val(redis_slowlog_log_slower_than, int64_t, 10000, Used,     \
+            "The redis commands taking longer than this many microseconds are kept in the slowlog of their shard (SLOWLOG GET). " \
+            "Set to 0 to log every command, or to a negative value to disable the slowlog." \
+    )   \
+    val(redis_slowlog_max_len, uint32_t, 128, Used,     \
+            "The maximum number of slow redis commands kept per shard." \
+    )   \
+    val(redis_latency_monitor_threshold_in_ms, uint32_t, 100, Used,     \
+            "The redis commands taking at least this many milliseconds are recorded as latency spikes of the command (LATENCY LATEST). " \
+            "Set to 0 to disable the latency monitor." \
+    )   \
+    val(redis_hotkeys_capacity, uint32_t, 32, Used,     \
+            "The number of hottest redis keys tracked per shard (HOTKEYS). Set to 0 to disable the tracking." \
+    )   \
+    val(redis_hotkeys_sample_every, uint32_t, 1, Used,     \
+            "Count one redis key access out of this many in the hot keys tracking." \
+    )   \
+    val(redis_bigkeys_per_type, uint32_t, 10, Used,     \
+            "The number of largest redis keys of each type kept per shard by the scan of BIGKEYS." \
+    )   \
+    val(redis_near_cache_size_in_kb, uint32_t, 0, Used,     \
+            "The memory per shard of the cache of the values read by the redis GET and HGET, served again without reading them. " \
+            "Set to 0 to disable the cache." \
+    )   \
+    val(redis_near_cache_staleness_in_ms, uint32_t, 1000, Used,     \
+            "The time a value is served by the redis near cache after it was read. The writes processed by this node invalidate the cached values, " \
+            "this bounds how long the writes processed by the other nodes are not seen." \
+    )   \
+    val(redis_tracking_table_max_keys, uint32_t, 1000000, Used,     \
+            "The maximum number of keys per shard recorded for the redis clients with CLIENT TRACKING. The keys over it are invalidated to their clients." \
+    )   \
+    val(redis_reply_page_rows, uint32_t, 1000, Used,     \
+            "The number of rows read at once for the redis HKEYS, HVALS, HGETALL and SMEMBERS. A larger collection is read and written to the client page by page." \
+    )   \
+    val(redis_flush_auto_snapshot, bool, true, Used,     \
+            "Whether the tables of the redis keyspaces truncated by FLUSHDB and FLUSHALL are snapshotted first, when auto_snapshot is enabled. Disable it for the flushes to drop the data without keeping a snapshot of it. The node running the flush decides for all the nodes." \
+    )   \
+    val(redis_masterauth, sstring, "", Used,     \
+            "The password sent with AUTH to the Redis master replicated with REPLICAOF, when the master requires one." \
+    )   \
     /* done! */
 
 #define _make_value_member(name, type, deflt, status, desc, ...)    \
@@ -95,6 +95,12 @@ std::unordered_set<token> boot_strapper::get_bootstrap_tokens(token_metadata met
         blogger.warn("Picking random token for a single vnode.  You should probably add more vnodes; failing that, you should probably specify the token manually");
     }
 
+    auto random_token_count = global_partitioner().random_token_count();
+    if (random_token_count && metadata.sorted_tokens().size() + num_tokens > random_token_count) {
+        throw std::runtime_error(sprint("Cannot pick %d tokens, the %s has %d tokens of which %d are already in the ring. Lower num_tokens.",
+                num_tokens, global_partitioner().name(), random_token_count, metadata.sorted_tokens().size()));
+    }
+
     auto tokens = get_random_tokens(metadata, num_tokens);
     blogger.debug("Get random bootstrap_tokens={}", tokens);
     return tokens;
@@ -298,6 +298,14 @@ public:
      */
     virtual token get_random_token() = 0;
 
+    /**
+     * @return the number of distinct tokens get_random_token() can return,
+     * or 0 when it is practically unbounded
+     */
+    virtual size_t random_token_count() const {
+        return 0;
+    }
+
     // FIXME: token.tokenFactory
     //virtual token.tokenFactory gettokenFactory() = 0;
 
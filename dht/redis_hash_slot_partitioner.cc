@@ -0,0 +1,68 @@
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "redis_hash_slot_partitioner.hh"
+#include "redis/cluster.hh"
+#include "utils/murmur_hash.hh"
+#include "sstables/key.hh"
+#include "utils/class_registrator.hh"
+
+namespace dht {
+
+token
+redis_hash_slot_partitioner::get_token(bytes_view key) {
+    if (key.empty()) {
+        return minimum_token();
+    }
+    std::array<uint64_t, 2> hash;
+    utils::murmur_hash::hash3_x64_128(key, 0, hash);
+    return redis::slot_token(redis::hash_slot(key), hash[0]);
+}
+
+token
+redis_hash_slot_partitioner::get_token(const sstables::key_view& key) {
+    return get_token(bytes_view(key));
+}
+
+token
+redis_hash_slot_partitioner::get_token(const schema& s, partition_key_view key) {
+    // The keys of the redis tables have a single component, which is their
+    // legacy form.
+    if (s.partition_key_size() == 1) {
+        return get_token(*key.begin(s));
+    }
+    auto&& legacy = key.legacy_form(s);
+    bytes b(bytes::initialized_later(), legacy.size());
+    std::copy(legacy.begin(), legacy.end(), b.begin());
+    return get_token(bytes_view(b));
+}
+
+token redis_hash_slot_partitioner::get_random_token() {
+    // Not the first slot, the minimum token is not a token of the ring.
+    auto slot = 1 + dht::get_random_number<uint16_t>() % (redis::cluster_slots_count - 1);
+    return redis::slot_first_token(slot);
+}
+
+size_t redis_hash_slot_partitioner::random_token_count() const {
+    return redis::cluster_slots_count - 1;
+}
+
+using registry = class_registrator<i_partitioner, redis_hash_slot_partitioner, const unsigned&, const unsigned&>;
+static registry registrator("org.pedis.dht.RedisHashSlotPartitioner");
+static registry registrator_short_name("RedisHashSlotPartitioner");
+
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "i_partitioner.hh"
+#include "murmur3_partitioner.hh"
+#include "bytes.hh"
+
+namespace dht {
+
+// Places the keys by their Redis Cluster hash slot: the 14 most significant
+// bits of a token are the CRC16 slot of the key's {hashtag}, the others are
+// the murmur3 hash of the whole key. The keys sharing a hashtag are owned by
+// the same replicas and, since the shards are taken from the most significant
+// bits, by the same shard.
+//
+// The tokens have the format of murmur3, which does the rest.
+class redis_hash_slot_partitioner final : public i_partitioner {
+    murmur3_partitioner _murmur3;
+public:
+    // The most significant bits are never ignored by the sharding, they are the slot.
+    redis_hash_slot_partitioner(unsigned shard_count = smp::count, unsigned sharding_ignore_msb_bits = 0)
+            : i_partitioner(shard_count)
+            , _murmur3(shard_count, 0) {
+    }
+    virtual const sstring name() const { return "org.pedis.dht.RedisHashSlotPartitioner"; }
+    virtual token get_token(const schema& s, partition_key_view key) override;
+    virtual token get_token(const sstables::key_view& key) override;
+    // The first token of a random slot, so that the slots are not split
+    // between the token ranges of the nodes.
+    //
+    // There are only cluster_slots_count - 1 such tokens (the first token of
+    // slot 0 is the minimum token), so the ring holds at most 16383 tokens:
+    // about 16383 / num_tokens nodes. The bootstrap rejects a node whose
+    // tokens cannot fit. Two nodes bootstrapping at the same time may pick
+    // the same slot, one of them then takes the token over from the other:
+    // keep consistent_rangemovement on so that they bootstrap one at a time.
+    virtual token get_random_token() override;
+    virtual size_t random_token_count() const override;
+    virtual bool preserves_order() override { return false; }
+    virtual std::map<token, float> describe_ownership(const std::vector<token>& sorted_tokens) override {
+        return _murmur3.describe_ownership(sorted_tokens);
+    }
+    virtual data_type get_token_validator() override {
+        return _murmur3.get_token_validator();
+    }
+    virtual int tri_compare(token_view t1, token_view t2) const override {
+        return _murmur3.tri_compare(t1, t2);
+    }
+    virtual token midpoint(const token& t1, const token& t2) const override {
+        return _murmur3.midpoint(t1, t2);
+    }
+    virtual sstring to_sstring(const dht::token& t) const override {
+        return _murmur3.to_sstring(t);
+    }
+    virtual dht::token from_sstring(const sstring& t) const override {
+        return _murmur3.from_sstring(t);
+    }
+    virtual dht::token from_bytes(bytes_view bytes) const override {
+        return _murmur3.from_bytes(bytes);
+    }
+
+    virtual unsigned shard_of(const token& t) const override {
+        return _murmur3.shard_of(t);
+    }
+    virtual token token_for_next_shard(const token& t, shard_id shard, unsigned spans) const override {
+        return _murmur3.token_for_next_shard(t, shard, spans);
+    }
+    virtual unsigned sharding_ignore_msb() const override {
+        return 0;
+    }
+private:
+    token get_token(bytes_view key);
+};
+
+}
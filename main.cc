@@ -371,7 +371,10 @@ int main(int ac, char** av) {
 
             verify_rlimit(cfg->developer_mode());
             verify_adequate_memory_per_shard(cfg->developer_mode());
-            if (cfg->partitioner() != "org.apache.cassandra.dht.Murmur3Partitioner") {
+            // The hash slot partitioner places the redis keys like Redis Cluster.
+            if (cfg->partitioner() != "org.apache.cassandra.dht.Murmur3Partitioner"
+                    && cfg->partitioner() != "org.pedis.dht.RedisHashSlotPartitioner"
+                    && cfg->partitioner() != "RedisHashSlotPartitioner") {
                 if (cfg->enable_deprecated_partitioners()) {
                     startlog.warn("The partitioner {} is deprecated and will be removed in a future version."
                             "  Contact scylladb-users@googlegroups.com if you are using it in production", cfg->partitioner());
@@ -634,6 +637,7 @@ int main(int ac, char** av) {
                 supervisor::notify("starting redis query processor");
                 auto& redis_qp = redis::get_query_processor();
                 redis_qp.start(std::ref(proxy), std::ref(db)).get();
+                api::set_server_redis(ctx).get();
             }
             // #293 - do not stop anything
             // engine().at_exit([&qp] { return qp.stop(); });
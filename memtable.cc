@@ -678,6 +678,13 @@ size_t memtable::partition_count() const {
     return partitions.size();
 }
 
+size_t memtable::partition_memory_usage(const dht::decorated_key& key) {
+    return with_linearized_managed_bytes([&] {
+        auto i = partitions.find(key, memtable_entry::compare(_schema));
+        return i != partitions.end() ? i->size_in_allocator(allocator()) : size_t(0);
+    });
+}
+
 memtable_entry::memtable_entry(memtable_entry&& o) noexcept
     : _link()
     , _schema(std::move(o._schema))
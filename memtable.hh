@@ -305,6 +305,9 @@ public:
 
     size_t partition_count() const;
     logalloc::occupancy_stats occupancy() const;
+    // The memory used by the partition of the key in the region, its entry and
+    // all of its versions, 0 if the memtable doesn't hold it.
+    size_t partition_memory_usage(const dht::decorated_key& key);
 
     // Creates a reader of data in this memtable for given partition range.
     //
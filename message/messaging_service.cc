@@ -965,7 +965,7 @@ future<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<c
 }
 
 // Wrapper for TRUNCATE
-void messaging_service::register_truncate(std::function<future<> (sstring, sstring)>&& func) {
+void messaging_service::register_truncate(std::function<future<> (sstring, sstring, rpc::optional<bool>)>&& func) {
     register_handler(this, netw::messaging_verb::TRUNCATE, std::move(func));
 }
 
@@ -973,8 +973,8 @@ void messaging_service::unregister_truncate() {
     _rpc->unregister_handler(netw::messaging_verb::TRUNCATE);
 }
 
-future<> messaging_service::send_truncate(msg_addr id, std::chrono::milliseconds timeout, sstring ks, sstring cf) {
-    return send_message_timeout<void>(this, netw::messaging_verb::TRUNCATE, std::move(id), std::move(timeout), std::move(ks), std::move(cf));
+future<> messaging_service::send_truncate(msg_addr id, std::chrono::milliseconds timeout, sstring ks, sstring cf, bool with_snapshot) {
+    return send_message_timeout<void>(this, netw::messaging_verb::TRUNCATE, std::move(id), std::move(timeout), std::move(ks), std::move(cf), with_snapshot);
 }
 
 // Wrapper for REPLICATION_FINISHED
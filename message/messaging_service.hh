@@ -357,9 +357,9 @@ public:
     future<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>> send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da);
 
     // Wrapper for TRUNCATE
-    void register_truncate(std::function<future<>(sstring, sstring)>&& func);
+    void register_truncate(std::function<future<>(sstring, sstring, rpc::optional<bool>)>&& func);
     void unregister_truncate();
-    future<> send_truncate(msg_addr, std::chrono::milliseconds, sstring, sstring);
+    future<> send_truncate(msg_addr, std::chrono::milliseconds, sstring, sstring, bool with_snapshot);
 
     // Wrapper for REPLICATION_FINISHED verb
     void register_replication_finished(std::function<future<> (inet_address from)>&& func);
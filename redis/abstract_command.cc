@@ -1,4 +1,41 @@
 #include "abstract_command.hh"
+#include "redis/query_processor.hh"
 namespace redis {
 
+schema_ptr simple_objects_schema(service::storage_proxy& proxy, const sstring& keyspace) {
+    return get_local_query_processor().schemas_of(keyspace)._strings;
+}
+
+schema_ptr lists_schema(service::storage_proxy& proxy, const sstring& keyspace) {
+    return get_local_query_processor().schemas_of(keyspace)._lists;
+}
+
+schema_ptr sets_schema(service::storage_proxy& proxy, const sstring& keyspace) {
+    return get_local_query_processor().schemas_of(keyspace)._sets;
+}
+
+schema_ptr maps_schema(service::storage_proxy& proxy, const sstring& keyspace) {
+    return get_local_query_processor().schemas_of(keyspace)._maps;
+}
+
+schema_ptr zsets_schema(service::storage_proxy& proxy, const sstring& keyspace) {
+    return get_local_query_processor().schemas_of(keyspace)._zsets;
+}
+
+schema_ptr streams_schema(service::storage_proxy& proxy, const sstring& keyspace) {
+    return get_local_query_processor().schemas_of(keyspace)._streams;
+}
+
+schema_ptr stream_groups_schema(service::storage_proxy& proxy, const sstring& keyspace) {
+    return get_local_query_processor().schemas_of(keyspace)._stream_groups;
+}
+
+schema_ptr bitmaps_schema(service::storage_proxy& proxy, const sstring& keyspace) {
+    return get_local_query_processor().schemas_of(keyspace)._bitmaps;
+}
+
+schema_ptr zset_scores_schema(service::storage_proxy& proxy, const sstring& keyspace) {
+    return get_local_query_processor().schemas_of(keyspace)._zset_scores;
+}
+
 } // end of redis namespace
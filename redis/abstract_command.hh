@@ -13,6 +13,9 @@
 #include "timestamp.hh"
 #include "redis/redis_keyspace.hh"
 #include <unordered_map>
+#include <cstring>
+#include <cerrno>
+#include <optional>
 using namespace seastar;
 
 class timeout_config;
@@ -40,31 +43,20 @@ static inline decltype(auto) lists() { return redis::LISTS; }
 static inline decltype(auto) sets() { return redis::SETS; }
 static inline decltype(auto) maps() { return redis::MAPS; }
 static inline decltype(auto) zsets() { return redis::ZSETS; }
-static inline const schema_ptr simple_objects_schema(service::storage_proxy& proxy, const sstring& keyspace) {
-    auto& db = proxy.get_db().local();
-    auto schema = db.find_schema(keyspace, simple_objects());
-    return schema;
-}
-static inline const schema_ptr lists_schema(service::storage_proxy& proxy, const sstring& keyspace) {
-    auto& db = proxy.get_db().local();
-    auto schema = db.find_schema(keyspace, lists());
-    return schema;
-}
-static inline const schema_ptr sets_schema(service::storage_proxy& proxy, const sstring& keyspace) {
-    auto& db = proxy.get_db().local();
-    auto schema = db.find_schema(keyspace, sets());
-    return schema;
-}
-static inline const schema_ptr maps_schema(service::storage_proxy& proxy, const sstring& keyspace) {
-    auto& db = proxy.get_db().local();
-    auto schema = db.find_schema(keyspace, maps());
-    return schema;
-}
-static inline const schema_ptr zsets_schema(service::storage_proxy& proxy, const sstring& keyspace) {
-    auto& db = proxy.get_db().local();
-    auto schema = db.find_schema(keyspace, zsets());
-    return schema;
-}
+static inline decltype(auto) streams() { return redis::STREAMS; }
+static inline decltype(auto) stream_groups() { return redis::STREAM_GROUPS; }
+static inline decltype(auto) bitmaps() { return redis::BITMAPS; }
+static inline decltype(auto) zset_scores() { return redis::ZSET_SCORES; }
+// The schemas of the tables of the keyspace, resolved once per shard.
+schema_ptr simple_objects_schema(service::storage_proxy& proxy, const sstring& keyspace);
+schema_ptr lists_schema(service::storage_proxy& proxy, const sstring& keyspace);
+schema_ptr sets_schema(service::storage_proxy& proxy, const sstring& keyspace);
+schema_ptr maps_schema(service::storage_proxy& proxy, const sstring& keyspace);
+schema_ptr zsets_schema(service::storage_proxy& proxy, const sstring& keyspace);
+schema_ptr streams_schema(service::storage_proxy& proxy, const sstring& keyspace);
+schema_ptr stream_groups_schema(service::storage_proxy& proxy, const sstring& keyspace);
+schema_ptr bitmaps_schema(service::storage_proxy& proxy, const sstring& keyspace);
+schema_ptr zset_scores_schema(service::storage_proxy& proxy, const sstring& keyspace);
 
 inline long bytes2long(const bytes& b) {
     try {
@@ -73,6 +65,22 @@ inline long bytes2long(const bytes& b) {
         throw e;
     }
 }
+// Returns nothing if `b` is not an integer within the range of long.
+inline std::optional<long> try_bytes2long(const bytes& b) {
+    if (b.empty() || b.size() > 20) {
+        return std::nullopt;
+    }
+    char buf[21];
+    std::copy(b.begin(), b.end(), buf);
+    buf[b.size()] = '\0';
+    char* end = nullptr;
+    errno = 0;
+    auto v = std::strtol(buf, &end, 10);
+    if (errno != 0 || end != buf + b.size()) {
+        return std::nullopt;
+    }
+    return v;
+}
 inline bytes long2bytes(long l) {
     auto s = sprint("%lld", l);
     return to_bytes(s);
@@ -94,6 +102,14 @@ inline bool is_number(const bytes& b)
         return !(std::isdigit((char)c) || c == '.' || c == '+' || c == '-');
     }) == b.end();
 }
+// Compares an argument with an option name (in lower case), ignoring the case of the argument.
+inline bool option_equals(const bytes& b, const char* option)
+{
+    auto len = std::strlen(option);
+    return b.size() == len && std::equal(b.begin(), b.end(), option, [] (auto c, char o) {
+        return std::tolower(static_cast<unsigned char>(c)) == o;
+    });
+}
 class abstract_command : public enable_shared_from_this<abstract_command> {
 protected:
     bytes _name;
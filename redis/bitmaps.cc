@@ -0,0 +1,237 @@
+#include "redis/bitmaps.hh"
+#include "seastar/core/byteorder.hh"
+#include <algorithm>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+namespace redis {
+namespace bitmaps {
+
+size_t popcount(const uint8_t* p, size_t n)
+{
+    size_t count = 0;
+    size_t i = 0;
+#ifdef __SSSE3__
+    // The nibble lookup of Mula et al., the byte counters are summed up before they can overflow.
+    const __m128i lookup = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i low_mask = _mm_set1_epi8(0x0f);
+    __m128i total = _mm_setzero_si128();
+    while (i + 16 <= n) {
+        __m128i local = _mm_setzero_si128();
+        for (int k = 0; k < 31 && i + 16 <= n; ++k, i += 16) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            auto lo = _mm_and_si128(v, low_mask);
+            auto hi = _mm_and_si128(_mm_srli_epi16(v, 4), low_mask);
+            local = _mm_add_epi8(local, _mm_add_epi8(_mm_shuffle_epi8(lookup, lo), _mm_shuffle_epi8(lookup, hi)));
+        }
+        total = _mm_add_epi64(total, _mm_sad_epu8(local, _mm_setzero_si128()));
+    }
+    count += _mm_cvtsi128_si64(total) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(total, total));
+#endif
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        count += __builtin_popcountll(w);
+    }
+    for (; i < n; ++i) {
+        count += __builtin_popcount(p[i]);
+    }
+    return count;
+}
+
+void apply(bitop op, uint8_t* dst, const uint8_t* src, size_t n)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 16 <= n; i += 16) {
+        auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i r;
+        switch (op) {
+        case bitop::band: r = _mm_and_si128(a, b); break;
+        case bitop::bor: r = _mm_or_si128(a, b); break;
+        case bitop::bxor: r = _mm_xor_si128(a, b); break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), r);
+    }
+#endif
+    for (; i < n; ++i) {
+        switch (op) {
+        case bitop::band: dst[i] &= src[i]; break;
+        case bitop::bor: dst[i] |= src[i]; break;
+        case bitop::bxor: dst[i] ^= src[i]; break;
+        }
+    }
+}
+
+void invert(uint8_t* p, size_t n)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i ones = _mm_set1_epi8(-1);
+    for (; i + 16 <= n; i += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), _mm_xor_si128(v, ones));
+    }
+#endif
+    for (; i < n; ++i) {
+        p[i] = ~p[i];
+    }
+}
+
+long find_first(const uint8_t* p, size_t n, bool bit)
+{
+    // The bytes to skip: all zeros when looking for a set bit, all ones otherwise.
+    const uint8_t skip = bit ? 0 : 0xff;
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i skipped = _mm_set1_epi8(static_cast<char>(skip));
+    for (; i + 16 <= n; i += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, skipped)) != 0xffff) {
+            break;
+        }
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        auto w = read_be<uint64_t>(reinterpret_cast<const char*>(p + i));
+        if (!bit) {
+            w = ~w;
+        }
+        if (w) {
+            return static_cast<long>(i * 8 + __builtin_clzll(w));
+        }
+    }
+    for (; i < n; ++i) {
+        uint8_t b = bit ? p[i] : static_cast<uint8_t>(~p[i]);
+        if (b) {
+            return static_cast<long>(i * 8 + __builtin_clz(b) - 24);
+        }
+    }
+    return -1;
+}
+
+const bytes* chunked_bitmap::find_chunk(uint64_t byte) const
+{
+    auto index = chunk_of(byte);
+    auto it = std::lower_bound(_chunks.begin(), _chunks.end(), index, [] (auto& c, int64_t i) { return c.first < i; });
+    if (it == _chunks.end() || it->first != index) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+uint64_t chunked_bitmap::length() const
+{
+    if (_chunks.empty()) {
+        return 0;
+    }
+    auto& last = _chunks.back();
+    return static_cast<uint64_t>(last.first) * chunk_size + last.second.size();
+}
+
+uint8_t chunked_bitmap::byte_at(uint64_t byte) const
+{
+    auto c = find_chunk(byte);
+    auto offset = byte % chunk_size;
+    if (!c || offset >= c->size()) {
+        return 0;
+    }
+    return static_cast<uint8_t>((*c)[offset]);
+}
+
+bool chunked_bitmap::bit_at(uint64_t bit) const
+{
+    return (byte_at(bit >> 3) >> (7 - (bit & 7))) & 1;
+}
+
+uint64_t chunked_bitmap::popcount(uint64_t first, uint64_t last) const
+{
+    if (first > last) {
+        return 0;
+    }
+    auto first_byte = first >> 3;
+    auto last_byte = last >> 3;
+    auto head_mask = static_cast<uint8_t>(0xff >> (first & 7));
+    auto tail_mask = static_cast<uint8_t>(0xff << (7 - (last & 7)));
+    if (first_byte == last_byte) {
+        return __builtin_popcount(byte_at(first_byte) & head_mask & tail_mask);
+    }
+    uint64_t count = __builtin_popcount(byte_at(first_byte) & head_mask) + __builtin_popcount(byte_at(last_byte) & tail_mask);
+    // The whole bytes in between, chunk by chunk.
+    auto begin = first_byte + 1;
+    auto end = last_byte;
+    for (auto& c : _chunks) {
+        auto chunk_begin = static_cast<uint64_t>(c.first) * chunk_size;
+        auto from = std::max(begin, chunk_begin);
+        auto to = std::min(end, chunk_begin + c.second.size());
+        if (from < to) {
+            count += bitmaps::popcount(reinterpret_cast<const uint8_t*>(c.second.data()) + (from - chunk_begin), to - from);
+        }
+    }
+    return count;
+}
+
+long chunked_bitmap::find_first(bool bit, uint64_t first, uint64_t last) const
+{
+    auto b = first;
+    // The unaligned head.
+    for (; b <= last && (b & 7); ++b) {
+        if (bit_at(b) == bit) {
+            return static_cast<long>(b);
+        }
+    }
+    // The whole bytes, chunk by chunk. The bytes which were never written are zeros.
+    auto byte = b >> 3;
+    auto end = (last + 1) >> 3;
+    auto it = std::lower_bound(_chunks.begin(), _chunks.end(), chunk_of(byte), [] (auto& c, int64_t i) { return c.first < i; });
+    while (byte < end) {
+        auto chunk_begin = static_cast<uint64_t>(chunk_of(byte)) * chunk_size;
+        const bytes* data = (it != _chunks.end() && it->first == chunk_of(byte)) ? &it->second : nullptr;
+        auto stored_end = data ? chunk_begin + data->size() : chunk_begin;
+        if (byte >= stored_end) {
+            // zeros up to the next written chunk.
+            if (!bit) {
+                return static_cast<long>(byte * 8);
+            }
+            if (data) {
+                ++it;
+            }
+            if (it == _chunks.end()) {
+                byte = end;
+                break;
+            }
+            byte = std::max(byte, static_cast<uint64_t>(it->first) * chunk_size);
+            continue;
+        }
+        auto to = std::min(end, stored_end);
+        auto found = bitmaps::find_first(reinterpret_cast<const uint8_t*>(data->data()) + (byte - chunk_begin), to - byte, bit);
+        if (found >= 0) {
+            return static_cast<long>(byte * 8 + found);
+        }
+        byte = to;
+        if (to == stored_end) {
+            ++it;
+            byte = std::min(end, chunk_begin + chunk_size);
+            if (!bit && byte > to) {
+                // the unwritten end of a short chunk.
+                return static_cast<long>(to * 8);
+            }
+        }
+    }
+    // The unaligned tail.
+    for (b = std::max(b, end * 8); b <= last; ++b) {
+        if (bit_at(b) == bit) {
+            return static_cast<long>(b);
+        }
+    }
+    return -1;
+}
+
+}
+}
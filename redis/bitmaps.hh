@@ -0,0 +1,51 @@
+#pragma once
+#include "bytes.hh"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace redis {
+namespace bitmaps {
+
+// A bitmap is stored in chunks of `chunk_size` bytes, one clustering row per chunk, so
+// that SETBIT writes a single chunk. The missing chunks are zeros, and the length of
+// the bitmap (in bytes) is given by the last chunk.
+//
+// The bitmaps are not in the table of the strings, so a key holds either a string or a
+// bitmap. The bit commands fail with WRONGTYPE on a key holding a string, and GET,
+// STRLEN and APPEND on a key holding a bitmap. SET does not remove a bitmap.
+static constexpr size_t chunk_size = 4096;
+// The greatest bit offset, as in Redis (512MB).
+static constexpr uint64_t max_offset = (uint64_t(1) << 32) - 1;
+
+static inline int64_t chunk_of(uint64_t byte) { return static_cast<int64_t>(byte / chunk_size); }
+
+// Kernels over raw bytes, vectorized when SSE2 (SSSE3 for popcount) is available.
+size_t popcount(const uint8_t* p, size_t n);
+enum class bitop { band, bor, bxor };
+// dst = dst <op> src
+void apply(bitop op, uint8_t* dst, const uint8_t* src, size_t n);
+void invert(uint8_t* p, size_t n);
+// Returns the position of the first bit equal to `bit` (the most significant bit of a
+// byte comes first), or -1 if there is none.
+long find_first(const uint8_t* p, size_t n, bool bit);
+
+// The chunks read from the bitmaps table, sorted by index.
+class chunked_bitmap {
+    const std::vector<std::pair<int64_t, bytes>>& _chunks;
+    // Returns the chunk holding `byte`, or nullptr if it was not written.
+    const bytes* find_chunk(uint64_t byte) const;
+public:
+    explicit chunked_bitmap(const std::vector<std::pair<int64_t, bytes>>& chunks) : _chunks(chunks) {}
+    // The length of the bitmap in bytes, only valid if the last chunk was read.
+    uint64_t length() const;
+    uint8_t byte_at(uint64_t byte) const;
+    bool bit_at(uint64_t bit) const;
+    // Counts the set bits within [first, last] (bits, inclusive).
+    uint64_t popcount(uint64_t first, uint64_t last) const;
+    // Returns the first bit equal to `bit` within [first, last] (bits, inclusive), or -1.
+    long find_first(bool bit, uint64_t first, uint64_t last) const;
+};
+
+}
+}
@@ -0,0 +1,315 @@
+#include "redis/blocked_clients.hh"
+#include "redis/query_processor.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/commands/lpop.hh"
+#include "dht/i_partitioner.hh"
+#include "keys.hh"
+#include "log.hh"
+#include "schema_registry.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include <algorithm>
+#include "seastar/core/smp.hh"
+#include "seastar/core/future-util.hh"
+namespace redis {
+
+static logging::logger blog("blocked_clients");
+
+blocked_clients::waiter_id blocked_clients::make_waiter()
+{
+    auto id = _next_id++;
+    auto w = make_lw_shared<wakeup>();
+    w->_timer.set_callback([this, id] { wake(id); });
+    _wakeups.emplace(id, std::move(w));
+    return id;
+}
+
+future<> blocked_clients::wait(waiter_id id, std::optional<clock_type::time_point> deadline)
+{
+    auto it = _wakeups.find(id);
+    if (it == _wakeups.end() || _stopped) {
+        return make_ready_future<>();
+    }
+    auto w = it->second;
+    if (w->_woken) {
+        // woken up between the registration and the wait.
+        w->_woken = false;
+        w->_pr = promise<>();
+        return make_ready_future<>();
+    }
+    if (deadline) {
+        w->_timer.arm(*deadline);
+    }
+    return w->_pr.get_future().finally([w] {
+        w->_timer.cancel();
+        w->_woken = false;
+        w->_pr = promise<>();
+    });
+}
+
+void blocked_clients::wake(waiter_id id)
+{
+    auto it = _wakeups.find(id);
+    if (it == _wakeups.end() || it->second->_woken || it->second->_claimed) {
+        return;
+    }
+    it->second->_woken = true;
+    it->second->_pr.set_value();
+}
+
+void blocked_clients::drop(waiter_id id)
+{
+    auto it = _wakeups.find(id);
+    if (it != _wakeups.end()) {
+        it->second->_timer.cancel();
+        _wakeups.erase(it);
+    }
+}
+
+bool blocked_clients::claim(waiter_id id)
+{
+    auto it = _wakeups.find(id);
+    if (it == _wakeups.end() || _stopped || it->second->_claimed || it->second->_served) {
+        return false;
+    }
+    it->second->_claimed = true;
+    return true;
+}
+
+void blocked_clients::unclaim(waiter_id id)
+{
+    auto it = _wakeups.find(id);
+    if (it != _wakeups.end()) {
+        it->second->_claimed = false;
+    }
+}
+
+bool blocked_clients::claimed(waiter_id id) const
+{
+    auto it = _wakeups.find(id);
+    return it != _wakeups.end() && it->second->_claimed;
+}
+
+bool blocked_clients::deliver(waiter_id id, popped_type popped)
+{
+    auto it = _wakeups.find(id);
+    if (it == _wakeups.end()) {
+        return false;
+    }
+    auto& w = *it->second;
+    w._claimed = false;
+    w._served = std::move(popped);
+    if (!w._woken) {
+        w._woken = true;
+        w._pr.set_value();
+    }
+    return true;
+}
+
+blocked_clients::popped_type blocked_clients::take_served(waiter_id id)
+{
+    auto it = _wakeups.find(id);
+    if (it == _wakeups.end()) {
+        return std::nullopt;
+    }
+    return std::exchange(it->second->_served, std::nullopt);
+}
+
+void blocked_clients::add(const bytes& key, unsigned shard, waiter_id id, std::optional<list_pop> pop)
+{
+    auto& waiters = _waiters[key];
+    // Still waiting since the last round, keeps its place in the queue.
+    auto registered = std::any_of(waiters.begin(), waiters.end(), [shard, id] (auto& w) {
+        return w._shard == shard && w._id == id;
+    });
+    if (!registered) {
+        waiters.emplace_back(remote_waiter { shard, id, std::move(pop) });
+    }
+}
+
+void blocked_clients::remove(const bytes& key, unsigned shard, waiter_id id)
+{
+    auto it = _waiters.find(key);
+    if (it == _waiters.end()) {
+        return;
+    }
+    auto& waiters = it->second;
+    waiters.erase(std::remove_if(waiters.begin(), waiters.end(), [shard, id] (auto& w) {
+        return w._shard == shard && w._id == id;
+    }), waiters.end());
+    if (waiters.empty()) {
+        _waiters.erase(it);
+    }
+}
+
+future<> blocked_clients::notify(const bytes& key)
+{
+    auto it = _waiters.find(key);
+    if (it == _waiters.end()) {
+        return make_ready_future<>();
+    }
+    // Wake up all the waiters, the readers of a stream don't consume its entries,
+    // and the readers of a group register themselves again if they lose the race
+    // for the new entries.
+    auto waiters = std::move(it->second);
+    _waiters.erase(it);
+    return parallel_for_each(std::move(waiters), [] (auto w) {
+        if (w._shard == engine().cpu_id()) {
+            get_local_query_processor().get_blocked_clients().wake(w._id);
+            return make_ready_future<>();
+        }
+        return smp::submit_to(w._shard, [id = w._id] {
+            get_local_query_processor().get_blocked_clients().wake(id);
+        });
+    });
+}
+
+future<> blocked_clients::serve(schema_ptr schema, bytes key, size_t pushed)
+{
+    auto k = make_key(*schema, key);
+    return do_with(std::move(key), std::move(k), pushed, std::vector<bytes> {}, [this, schema] (auto& key, auto& k, auto& pushed, auto& destinations) {
+        return get_local_query_processor().get_key_locks().with_lock(k, [this, schema, &key, &k, &pushed, &destinations] {
+            return repeat([this, schema, &key, &k, &pushed, &destinations] {
+                auto it = _waiters.find(k);
+                if (pushed == 0 || it == _waiters.end()) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
+                auto w = std::move(it->second.front());
+                it->second.pop_front();
+                if (it->second.empty()) {
+                    _waiters.erase(it);
+                }
+                if (!w._pop) {
+                    return smp::submit_to(w._shard, [id = w._id] {
+                        get_local_query_processor().get_blocked_clients().wake(id);
+                    }).then([] {
+                        return stop_iteration::no;
+                    });
+                }
+                // The waiter may have been served by another of its keys, or be popping by itself.
+                return smp::submit_to(w._shard, [id = w._id] {
+                    return get_local_query_processor().get_blocked_clients().claim(id);
+                }).then([schema, &key, &pushed, &destinations, w = std::move(w)] (bool claimed) mutable {
+                    if (!claimed) {
+                        return make_ready_future<stop_iteration>(stop_iteration::no);
+                    }
+                    auto pop = *w._pop;
+                    auto timeout = db::timeout_clock::now() + pop._timeout;
+                    return do_with(service::client_state(service::client_state::internal_tag {}), [schema, &key, pop = std::move(pop), timeout] (auto& cs) {
+                        return commands::pop_element(service::get_local_storage_proxy(), schema, key, pop._left, pop._cl, timeout, cs, pop._destination);
+                    }).then_wrapped([schema, &key, &pushed, &destinations, w = std::move(w)] (auto f) mutable {
+                        std::optional<bytes> popped;
+                        try {
+                            popped = f.get0();
+                        } catch (...) {
+                            blog.warn("Failed to pop for a blocked client: {}", std::current_exception());
+                        }
+                        if (!popped) {
+                            // The elements are gone, the client tries by itself.
+                            return smp::submit_to(w._shard, [id = w._id] {
+                                get_local_query_processor().get_blocked_clients().deliver(id, std::nullopt);
+                            }).then([] {
+                                return stop_iteration::yes;
+                            });
+                        }
+                        --pushed;
+                        if (w._pop->_destination) {
+                            destinations.emplace_back(*w._pop->_destination);
+                        }
+                        auto value = *popped;
+                        return smp::submit_to(w._shard, [id = w._id, p = std::make_pair(key, std::move(*popped))] () mutable {
+                            return get_local_query_processor().get_blocked_clients().deliver(id, std::move(p));
+                        }).then([schema, &key, w = std::move(w), value = std::move(value)] (bool delivered) mutable {
+                            if (delivered || w._pop->_destination) {
+                                return make_ready_future<stop_iteration>(stop_iteration::no);
+                            }
+                            // The client left meanwhile, puts the element back where it was.
+                            auto timeout = db::timeout_clock::now() + w._pop->_timeout;
+                            auto cl = w._pop->_cl;
+                            auto left = w._pop->_left;
+                            return do_with(service::client_state(service::client_state::internal_tag {}), [schema, &key, value = std::move(value), cl, left, timeout] (auto& cs) mutable {
+                                return redis::write_mutation(service::get_local_storage_proxy(), make_list_cells(schema, key, std::vector<bytes> { std::move(value) }, left), cl, timeout, cs);
+                            }).then([] {
+                                return stop_iteration::no;
+                            });
+                        });
+                    });
+                });
+            });
+        }).then([schema, &destinations] {
+            // After the lock is released, the destination may be the key itself.
+            return parallel_for_each(destinations, [schema] (auto& d) {
+                return serve_blocked_clients(schema, d, 1);
+            });
+        });
+    });
+}
+
+future<> blocked_clients::stop()
+{
+    _stopped = true;
+    _waiters.clear();
+    for (auto& w : _wakeups) {
+        w.second->_timer.cancel();
+        if (!w.second->_woken) {
+            w.second->_woken = true;
+            w.second->_pr.set_value();
+        }
+    }
+    return make_ready_future<>();
+}
+
+bytes blocked_clients::make_key(const schema& s, const bytes& key)
+{
+    bytes k(bytes::initialized_later(), s.ks_name().size() + s.cf_name().size() + key.size() + 2);
+    auto out = k.begin();
+    out = std::copy(s.ks_name().begin(), s.ks_name().end(), out);
+    *out++ = '.';
+    out = std::copy(s.cf_name().begin(), s.cf_name().end(), out);
+    *out++ = ':';
+    std::copy(key.begin(), key.end(), out);
+    return k;
+}
+
+unsigned blocked_clients::shard_of(const schema& s, const bytes& key)
+{
+    auto pkey = partition_key::from_single_value(s, key);
+    return dht::shard_of(dht::global_partitioner().decorate_key(s, std::move(pkey)).token());
+}
+
+future<> register_blocked_client(const schema_ptr schema, const std::vector<bytes>& keys, blocked_clients::waiter_id id,
+    std::optional<blocked_clients::list_pop> pop)
+{
+    auto origin = engine().cpu_id();
+    return parallel_for_each(keys.begin(), keys.end(), [schema, origin, id, &pop] (auto& key) {
+        return get_query_processor().invoke_on(blocked_clients::shard_of(*schema, key), [k = blocked_clients::make_key(*schema, key), origin, id, pop] (auto& qp) mutable {
+            qp.get_blocked_clients().add(k, origin, id, std::move(pop));
+        });
+    });
+}
+
+future<> unregister_blocked_client(const schema_ptr schema, const std::vector<bytes>& keys, blocked_clients::waiter_id id)
+{
+    auto origin = engine().cpu_id();
+    return parallel_for_each(keys.begin(), keys.end(), [schema, origin, id] (auto& key) {
+        return get_query_processor().invoke_on(blocked_clients::shard_of(*schema, key), [k = blocked_clients::make_key(*schema, key), origin, id] (auto& qp) {
+            qp.get_blocked_clients().remove(k, origin, id);
+        });
+    });
+}
+
+future<> notify_blocked_clients(const schema_ptr schema, const bytes& key)
+{
+    return get_query_processor().invoke_on(blocked_clients::shard_of(*schema, key), [k = blocked_clients::make_key(*schema, key)] (auto& qp) {
+        return qp.get_blocked_clients().notify(k);
+    });
+}
+
+future<> serve_blocked_clients(const schema_ptr schema, const bytes& key, size_t pushed)
+{
+    return get_query_processor().invoke_on(blocked_clients::shard_of(*schema, key), [s = global_schema_ptr(schema), key, pushed] (auto& qp) {
+        return qp.get_blocked_clients().serve(s, key, pushed);
+    });
+}
+
+} // end of redis namespace
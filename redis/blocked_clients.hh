@@ -0,0 +1,153 @@
+#pragma once
+#include "bytes.hh"
+#include "schema.hh"
+#include "db/consistency_level_type.hh"
+#include "db/timeout_clock.hh"
+#include "seastar/core/future.hh"
+#include "seastar/core/future-util.hh"
+#include "seastar/core/shared_ptr.hh"
+#include "seastar/core/timer.hh"
+#include "seastar/core/lowres_clock.hh"
+#include <deque>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+using namespace seastar;
+
+namespace redis {
+
+// Clients blocked by BLPOP, BRPOP, BRPOPLPUSH, XREAD and XREADGROUP.
+//
+// Every shard keeps two tables:
+//   1) the waiters of the keys owned by this shard (keyed by the table and the partition key),
+//      which are woken up by the push commands;
+//   2) the wakeups of the blocking commands executed on this shard.
+// A blocking command registers itself on the shards owning its keys, so a push only has to
+// hop to the single shard owning the key to wake up the blocked clients, wherever they are.
+//
+// The clients blocked on lists are served like redis does: the push pops one element per
+// client, in the order they blocked, on the shard owning the list and under the lock of
+// the key (see key_locks), and hands it to the client. The pops of the clients themselves
+// take the same lock, so two clients never pop the same element.
+class blocked_clients {
+public:
+    using waiter_id = uint64_t;
+    using clock_type = lowres_clock;
+    using popped_type = std::optional<std::pair<bytes, bytes>>;
+    // How the element handed to a client blocked on lists is popped.
+    struct list_pop {
+        bool _left;
+        // BRPOPLPUSH, the element is pushed to the head of this list in the same batch.
+        std::optional<bytes> _destination;
+        db::consistency_level _cl;
+        db::timeout_clock::duration _timeout;
+    };
+private:
+    struct remote_waiter {
+        unsigned _shard;
+        waiter_id _id;
+        std::optional<list_pop> _pop;
+    };
+    struct wakeup {
+        promise<> _pr;
+        timer<clock_type> _timer;
+        bool _woken = false;
+        // Popping for the client, by a push or by the client itself. The deadline
+        // is ignored until the claim ends.
+        bool _claimed = false;
+        popped_type _served;
+    };
+    std::unordered_map<bytes, std::deque<remote_waiter>> _waiters;
+    std::unordered_map<waiter_id, lw_shared_ptr<wakeup>> _wakeups;
+    waiter_id _next_id = 0;
+    bool _stopped = false;
+public:
+    blocked_clients() {}
+    blocked_clients(const blocked_clients&) = delete;
+    blocked_clients& operator=(const blocked_clients&) = delete;
+
+    // origin side.
+    waiter_id make_waiter();
+    // Resolved when the waiter is woken up or the deadline is reached.
+    future<> wait(waiter_id id, std::optional<clock_type::time_point> deadline);
+    void wake(waiter_id id);
+    void drop(waiter_id id);
+    // False if the waiter is gone, already claimed or already served.
+    bool claim(waiter_id id);
+    void unclaim(waiter_id id);
+    bool claimed(waiter_id id) const;
+    // Ends the claim of a push and wakes up the waiter, with the popped element, or with
+    // nothing if the push lost it. False if the waiter is gone.
+    bool deliver(waiter_id id, popped_type popped);
+    popped_type take_served(waiter_id id);
+
+    // owner side.
+    void add(const bytes& key, unsigned shard, waiter_id id, std::optional<list_pop> pop);
+    void remove(const bytes& key, unsigned shard, waiter_id id);
+    // Wakes up all the waiters of the key.
+    future<> notify(const bytes& key);
+    // Hands up to `pushed` elements of the list to its waiters, one each.
+    future<> serve(schema_ptr schema, bytes key, size_t pushed);
+
+
+    bool stopped() const { return _stopped; }
+    size_t waiting_keys() const { return _waiters.size(); }
+    size_t blocked() const { return _wakeups.size(); }
+    future<> stop();
+
+    static bytes make_key(const schema& s, const bytes& key);
+    static unsigned shard_of(const schema& s, const bytes& key);
+};
+
+// Helpers to register the current shard's waiter on the shards owning the keys.
+future<> register_blocked_client(const schema_ptr schema, const std::vector<bytes>& keys, blocked_clients::waiter_id id,
+    std::optional<blocked_clients::list_pop> pop = std::nullopt);
+future<> unregister_blocked_client(const schema_ptr schema, const std::vector<bytes>& keys, blocked_clients::waiter_id id);
+// Called by the writers of the key, wakes up all clients blocked on it.
+future<> notify_blocked_clients(const schema_ptr schema, const bytes& key);
+// Called by the pushes of a list, hands the pushed elements to the clients blocked on it.
+future<> serve_blocked_clients(const schema_ptr schema, const bytes& key, size_t pushed);
+
+// Runs `attempt` until it yields a result, the deadline is reached or the shard is stopped.
+// The waiter is registered on the keys before every attempt, so the writes made after an
+// unsuccessful attempt always wake us up. The waiters are dropped by the wakeup, that's
+// why we register again in every round. `keys` must outlive the returned future.
+template<typename Result, typename Attempt>
+future<std::optional<Result>> block_on_keys(blocked_clients& blocked,
+    const schema_ptr schema,
+    const std::vector<bytes>& keys,
+    std::optional<blocked_clients::clock_type::time_point> deadline,
+    Attempt&& attempt)
+{
+    using result_type = std::optional<Result>;
+    using clock_type = blocked_clients::clock_type;
+    if (blocked.stopped()) {
+        return make_ready_future<result_type>();
+    }
+    auto id = blocked.make_waiter();
+    return do_with(result_type {}, std::move(attempt), [schema, &keys, deadline, id, &blocked] (auto& result, auto& attempt) {
+        return repeat([schema, &keys, deadline, id, &blocked, &result, &attempt] {
+            return register_blocked_client(schema, keys, id).then([&attempt] {
+                return attempt();
+            }).then([deadline, id, &blocked, &result] (result_type r) {
+                if (r) {
+                    result = std::move(r);
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
+                if (blocked.stopped() || (deadline && clock_type::now() >= *deadline)) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
+                return blocked.wait(id, deadline).then([] {
+                    return stop_iteration::no;
+                });
+            });
+        }).finally([schema, &keys, id, &blocked] {
+            blocked.drop(id);
+            return unregister_blocked_client(schema, keys, id);
+        }).then([&result] {
+            return std::move(result);
+        });
+    });
+}
+
+} // end of redis namespace
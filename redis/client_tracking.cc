@@ -0,0 +1,196 @@
+#include "redis/client_tracking.hh"
+#include "redis/query_processor.hh"
+#include "seastar/core/future-util.hh"
+#include <algorithm>
+#include <map>
+
+namespace redis {
+
+void client_tracking::push(uint64_t id, std::vector<bytes> keys)
+{
+    auto it = _connections.find(id);
+    if (it != _connections.end()) {
+        it->second(std::move(keys));
+    }
+}
+
+void client_tracking::invalidate_all()
+{
+    _keys.clear();
+    for (auto& c : _connections) {
+        c.second(std::vector<bytes>());
+    }
+}
+
+void client_tracking::add_client(const client& c, bool bcast, const std::vector<bytes>& prefixes)
+{
+    if (!bcast) {
+        ++_tracking_clients;
+    } else if (prefixes.empty()) {
+        _prefixes.emplace_back(bytes(), c);
+    } else {
+        for (auto& p : prefixes) {
+            _prefixes.emplace_back(p, c);
+        }
+    }
+}
+
+void client_tracking::remove_client(const client& c, bool bcast)
+{
+    if (!bcast) {
+        --_tracking_clients;
+        return;
+    }
+    _prefixes.erase(std::remove_if(_prefixes.begin(), _prefixes.end(), [&c] (auto& p) {
+        return p.second == c;
+    }), _prefixes.end());
+}
+
+std::vector<std::pair<client_tracking::client, bytes>> client_tracking::add_keys(const client& c, const std::vector<bytes>& keys)
+{
+    for (auto& key : keys) {
+        auto& clients = _keys[key];
+        if (std::find(clients.begin(), clients.end(), c) == clients.end()) {
+            clients.push_back(c);
+        }
+    }
+    std::vector<std::pair<client, bytes>> evicted;
+    while (_keys.size() > _max_keys) {
+        auto it = _keys.begin();
+        for (auto& e : it->second) {
+            evicted.emplace_back(e, it->first);
+        }
+        _keys.erase(it);
+        ++_stats._evictions;
+    }
+    return evicted;
+}
+
+std::vector<std::pair<client_tracking::client, bytes>> client_tracking::take_keys(const std::vector<bytes>& keys)
+{
+    std::vector<std::pair<client, bytes>> taken;
+    for (auto& key : keys) {
+        auto it = _keys.find(key);
+        if (it == _keys.end()) {
+            continue;
+        }
+        for (auto& c : it->second) {
+            taken.emplace_back(c, key);
+        }
+        _keys.erase(it);
+    }
+    return taken;
+}
+
+std::vector<std::pair<client_tracking::client, bytes>> client_tracking::match_prefixes(const std::vector<bytes>& keys) const
+{
+    std::vector<std::pair<client, bytes>> matched;
+    for (auto& key : keys) {
+        for (auto& p : _prefixes) {
+            if (key.size() >= p.first.size() && std::equal(p.first.begin(), p.first.end(), key.begin())) {
+                matched.emplace_back(p.second, key);
+            }
+        }
+    }
+    return matched;
+}
+
+static unsigned owner_of(const bytes& key)
+{
+    return std::hash<bytes>()(key) % smp::count;
+}
+
+using invalidations = std::vector<std::pair<client_tracking::client, bytes>>;
+
+// Sends the keys to their clients, grouped by connection.
+static future<> push_invalidations(invalidations&& keys, std::optional<uint64_t> writer)
+{
+    std::map<std::pair<unsigned, uint64_t>, std::vector<bytes>> by_client;
+    for (auto& k : keys) {
+        if (k.first._noloop && writer && *writer == k.first._id) {
+            continue;
+        }
+        auto& v = by_client[std::make_pair(k.first._shard, k.first._id)];
+        // A broadcasting client may match a key with several prefixes.
+        if (std::find(v.begin(), v.end(), k.second) == v.end()) {
+            v.emplace_back(std::move(k.second));
+        }
+    }
+    return do_with(std::move(by_client), [] (auto& by_client) {
+        return parallel_for_each(by_client, [] (auto& c) {
+            return get_query_processor().invoke_on(c.first.first, [id = c.first.second, keys = std::move(c.second)] (auto& qp) mutable {
+                auto& tracking = qp.get_client_tracking();
+                tracking.push(id, std::move(keys));
+            });
+        });
+    });
+}
+
+future<> enable_client_tracking(client_tracking::client c, bool bcast, std::vector<bytes> prefixes)
+{
+    return do_with(std::move(prefixes), [c, bcast] (auto& prefixes) {
+        return get_query_processor().invoke_on_all([c, bcast, &prefixes] (auto& qp) {
+            qp.get_client_tracking().add_client(c, bcast, prefixes);
+        });
+    });
+}
+
+future<> disable_client_tracking(client_tracking::client c, bool bcast)
+{
+    return get_query_processor().invoke_on_all([c, bcast] (auto& qp) {
+        qp.get_client_tracking().remove_client(c, bcast);
+    });
+}
+
+future<> track_keys(client_tracking::client c, std::vector<bytes> keys)
+{
+    std::map<unsigned, std::vector<bytes>> by_shard;
+    for (auto& key : keys) {
+        by_shard[owner_of(key)].emplace_back(std::move(key));
+    }
+    return do_with(std::move(by_shard), [c] (auto& by_shard) {
+        return parallel_for_each(by_shard, [c] (auto& s) {
+            return get_query_processor().invoke_on(s.first, [c, keys = std::move(s.second)] (auto& qp) {
+                auto evicted = qp.get_client_tracking().add_keys(c, keys);
+                if (evicted.empty()) {
+                    return make_ready_future<>();
+                }
+                return push_invalidations(std::move(evicted), std::nullopt);
+            });
+        });
+    });
+}
+
+future<> invalidate_tracked_keys(std::vector<bytes> keys, std::optional<uint64_t> writer)
+{
+    auto& tracking = get_local_query_processor().get_client_tracking();
+    if (!tracking.active() || keys.empty()) {
+        return make_ready_future<>();
+    }
+    auto matched = tracking.match_prefixes(keys);
+    auto taken = make_ready_future<invalidations>();
+    if (tracking.tracking_clients()) {
+        std::map<unsigned, std::vector<bytes>> by_shard;
+        for (auto& key : keys) {
+            by_shard[owner_of(key)].push_back(key);
+        }
+        taken = do_with(std::move(by_shard), invalidations(), [] (auto& by_shard, auto& all) {
+            return parallel_for_each(by_shard, [&all] (auto& s) {
+                return get_query_processor().invoke_on(s.first, [keys = std::move(s.second)] (auto& qp) {
+                    return qp.get_client_tracking().take_keys(keys);
+                }).then([&all] (invalidations taken) {
+                    std::move(taken.begin(), taken.end(), std::back_inserter(all));
+                });
+            }).then([&all] {
+                return std::move(all);
+            });
+        });
+    }
+    return taken.then([matched = std::move(matched), writer] (invalidations taken) mutable {
+        std::move(matched.begin(), matched.end(), std::back_inserter(taken));
+        get_local_query_processor().get_client_tracking().count_invalidations(taken.size());
+        return push_invalidations(std::move(taken), writer);
+    });
+}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "bytes.hh"
+#include "seastar/core/future.hh"
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+using namespace seastar;
+
+namespace redis {
+
+// CLIENT TRACKING, the server side of the client side caching: the clients
+// are told which keys they read were written since, so that they can cache
+// the values of the keys.
+//
+// In the default mode, the keys read by a tracking client are recorded in the
+// table of the shard owning the key (by the hash of the key), before the read
+// is processed so that a concurrent write is not missed; a write takes the
+// clients of its keys out of the table and sends them the invalidations. In
+// the broadcasting mode, the prefixes of the client are known by every shard,
+// which sends the invalidations of the keys written there.
+class client_tracking {
+public:
+    struct client {
+        unsigned _shard;
+        uint64_t _id;
+        // The writes of the client itself are not sent to it.
+        bool _noloop;
+        bool operator==(const client& o) const {
+            return _shard == o._shard && _id == o._id;
+        }
+    };
+    // Sends the invalidations to the connection, no key invalidates all of them.
+    using push_function = std::function<void (std::vector<bytes>)>;
+    struct stats {
+        uint64_t _invalidations = 0;
+        // The keys invalidated to make room in the table.
+        uint64_t _evictions = 0;
+    };
+private:
+    // The tracking connections of this shard, by id.
+    std::unordered_map<uint64_t, push_function> _connections;
+    // The keys owned by this shard, with the clients which read them since
+    // they were last written.
+    std::unordered_map<bytes, std::vector<client>> _keys;
+    size_t _max_keys;
+    // The broadcasting clients of all the shards, by prefix.
+    std::vector<std::pair<bytes, client>> _prefixes;
+    // The clients of all the shards tracking the keys they read.
+    uint64_t _tracking_clients = 0;
+    stats _stats;
+public:
+    explicit client_tracking(size_t max_keys) : _max_keys(max_keys) {}
+
+    // Whether a client of this node tracks keys, otherwise the writes skip
+    // the tracking.
+    bool active() const {
+        return _tracking_clients || !_prefixes.empty();
+    }
+    void register_connection(uint64_t id, push_function push) {
+        _connections[id] = std::move(push);
+    }
+    void unregister_connection(uint64_t id) {
+        _connections.erase(id);
+    }
+    void push(uint64_t id, std::vector<bytes> keys);
+    // FLUSHDB and FLUSHALL, the tracking connections of this shard drop all
+    // their keys.
+    void invalidate_all();
+
+    void add_client(const client& c, bool bcast, const std::vector<bytes>& prefixes);
+    void remove_client(const client& c, bool bcast);
+    // Records the keys read by the client, returns the keys evicted from the
+    // table with the clients to invalidate.
+    std::vector<std::pair<client, bytes>> add_keys(const client& c, const std::vector<bytes>& keys);
+    // Takes the clients of the keys written out of the table.
+    std::vector<std::pair<client, bytes>> take_keys(const std::vector<bytes>& keys);
+    // The broadcasting clients of the keys written.
+    std::vector<std::pair<client, bytes>> match_prefixes(const std::vector<bytes>& keys) const;
+
+    void count_invalidations(size_t keys) {
+        _stats._invalidations += keys;
+    }
+    const stats& get_stats() const {
+        return _stats;
+    }
+    size_t size() const {
+        return _keys.size();
+    }
+    uint64_t tracking_clients() const {
+        return _tracking_clients;
+    }
+    size_t broadcasting_clients() const {
+        return _prefixes.size();
+    }
+};
+
+future<> enable_client_tracking(client_tracking::client c, bool bcast, std::vector<bytes> prefixes);
+future<> disable_client_tracking(client_tracking::client c, bool bcast);
+// Records the keys read by the client on the shards owning them.
+future<> track_keys(client_tracking::client c, std::vector<bytes> keys);
+// Sends the invalidations of the keys written to the clients which read them.
+// The writer is given for the clients with NOLOOP.
+future<> invalidate_tracked_keys(std::vector<bytes> keys, std::optional<uint64_t> writer);
+
+}
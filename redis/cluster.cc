@@ -0,0 +1,160 @@
+#include "redis/cluster.hh"
+#include "database.hh"
+#include "net/byteorder.hh"
+#include "service/storage_service.hh"
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace redis {
+
+// CRC16-CCITT (XMODEM), the one of Redis Cluster.
+static const std::array<uint16_t, 256> crc16_table = [] {
+    std::array<uint16_t, 256> table;
+    for (unsigned i = 0; i < 256; ++i) {
+        uint16_t crc = i << 8;
+        for (int j = 0; j < 8; ++j) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+uint16_t crc16(bytes_view b)
+{
+    uint16_t crc = 0;
+    for (auto c : b) {
+        crc = (crc << 8) ^ crc16_table[((crc >> 8) ^ uint8_t(c)) & 0xff];
+    }
+    return crc;
+}
+
+uint16_t hash_slot(bytes_view key)
+{
+    auto open = std::find(key.begin(), key.end(), '{');
+    if (open != key.end()) {
+        auto close = std::find(open + 1, key.end(), '}');
+        if (close != key.end() && close != open + 1) {
+            key = bytes_view(&*(open + 1), close - open - 1);
+        }
+    }
+    return crc16(key) & (cluster_slots_count - 1);
+}
+
+static constexpr unsigned slot_shift = 64 - 14;
+
+static dht::token long_token(int64_t value)
+{
+    auto t = net::hton(value);
+    bytes b(bytes::initialized_later(), 8);
+    std::copy_n(reinterpret_cast<int8_t*>(&t), 8, b.begin());
+    return dht::token{dht::token::kind::key, std::move(b)};
+}
+
+static int64_t first_of(uint16_t slot)
+{
+    return int64_t((uint64_t(slot) << slot_shift) + uint64_t(std::numeric_limits<int64_t>::min()));
+}
+
+static int64_t last_of(uint16_t slot)
+{
+    return int64_t((uint64_t(slot) << slot_shift) + ((uint64_t(1) << slot_shift) - 1) + uint64_t(std::numeric_limits<int64_t>::min()));
+}
+
+dht::token slot_first_token(uint16_t slot)
+{
+    return long_token(first_of(slot));
+}
+
+dht::token slot_last_token(uint16_t slot)
+{
+    return long_token(last_of(slot));
+}
+
+dht::token_range slot_token_range(uint16_t slot)
+{
+    return dht::token_range::make(slot_first_token(slot), slot_last_token(slot));
+}
+
+dht::token slot_token(uint16_t slot, uint64_t hash)
+{
+    auto value = first_of(slot) + int64_t(hash >> 14);
+    // Like murmur3, no key has the minimum token.
+    if (value == std::numeric_limits<int64_t>::min()) {
+        ++value;
+    }
+    return long_token(value);
+}
+
+static cluster_node make_node(const gms::inet_address& endpoint, uint16_t port)
+{
+    auto& ss = service::get_local_storage_service();
+    auto& tm = ss.get_token_metadata();
+    cluster_node node { endpoint, ss.get_rpc_address(endpoint), port, sstring() };
+    auto id = tm.get_host_id(endpoint);
+    // The 128 bits of the host id, then the address, since Redis expects 160 bits.
+    node._id = sprint("%016x%016x%08x", uint64_t(id.get_most_significant_bits()),
+        uint64_t(id.get_least_significant_bits()), endpoint.raw_addr());
+    return node;
+}
+
+static bool same_replicas(const slot_range& r, const std::vector<gms::inet_address>& endpoints)
+{
+    if (r._replicas.size() != endpoints.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        if (r._replicas[i]._endpoint != endpoints[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::vector<slot_range>& slot_map::get(database& db, const sstring& keyspace)
+{
+    auto& tm = service::get_local_storage_service().get_token_metadata();
+    auto& slots = _keyspaces[keyspace];
+    if (slots._ring_version == tm.get_ring_version()) {
+        return slots._ranges;
+    }
+    slots._ranges.clear();
+    auto& strategy = db.find_keyspace(keyspace).get_replication_strategy();
+    std::unordered_map<gms::inet_address, cluster_node> nodes;
+    for (unsigned slot = 0; slot < cluster_slots_count; ++slot) {
+        // A slot split by a token of the ring goes to the owners of its middle.
+        auto middle = first_of(slot) + int64_t((uint64_t(1) << (slot_shift - 1)));
+        auto endpoints = strategy.get_natural_endpoints(long_token(middle));
+        if (endpoints.empty()) {
+            continue;
+        }
+        if (!slots._ranges.empty() && slots._ranges.back()._last + 1 == slot && same_replicas(slots._ranges.back(), endpoints)) {
+            slots._ranges.back()._last = slot;
+            continue;
+        }
+        slot_range r { uint16_t(slot), uint16_t(slot), {} };
+        for (auto& ep : endpoints) {
+            auto it = nodes.find(ep);
+            if (it == nodes.end()) {
+                it = nodes.emplace(ep, make_node(ep, _port)).first;
+            }
+            r._replicas.push_back(it->second);
+        }
+        slots._ranges.emplace_back(std::move(r));
+    }
+    slots._ring_version = tm.get_ring_version();
+    return slots._ranges;
+}
+
+std::vector<cluster_node> slot_map::nodes() const
+{
+    auto& tm = service::get_local_storage_service().get_token_metadata();
+    std::vector<cluster_node> nodes;
+    for (auto& ep : tm.get_all_endpoints()) {
+        nodes.emplace_back(make_node(ep, _port));
+    }
+    return nodes;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "bytes.hh"
+#include "dht/i_partitioner.hh"
+#include "gms/inet_address.hh"
+#include "seastar/core/sstring.hh"
+#include <unordered_map>
+#include <vector>
+using namespace seastar;
+
+class database;
+
+namespace redis {
+
+// The hash slots of Redis Cluster, a key is in the slot of the CRC16 of its
+// {hashtag}, or of the whole key if it has no hashtag or an empty one.
+static constexpr uint16_t cluster_slots_count = 16384;
+
+uint16_t crc16(bytes_view b);
+uint16_t hash_slot(bytes_view key);
+
+// A slot is a range of the token ring, the slots are the 14 most significant
+// bits of the tokens (taken as unsigned), so that the keys of a slot are owned
+// by the same replicas as long as they are placed by their slot.
+dht::token slot_first_token(uint16_t slot);
+dht::token slot_last_token(uint16_t slot);
+dht::token_range slot_token_range(uint16_t slot);
+// The token of a key of the slot, the bits below the slot are taken from the
+// hash of the key.
+dht::token slot_token(uint16_t slot, uint64_t hash);
+
+struct cluster_node {
+    gms::inet_address _endpoint;
+    // The address the clients connect to.
+    sstring _address;
+    uint16_t _port;
+    // 40 hexadecimal digits, derived from the host id.
+    sstring _id;
+};
+
+// The consecutive slots owned by the same replicas.
+struct slot_range {
+    uint16_t _first;
+    uint16_t _last;
+    // The primary replica first.
+    std::vector<cluster_node> _replicas;
+};
+
+// The owners of the slots of the keyspaces, computed from the token ring and
+// the replication strategy of the keyspace. Recomputed once the ring changed,
+// on a topology change.
+class slot_map {
+    struct keyspace_slots {
+        long _ring_version = -1;
+        std::vector<slot_range> _ranges;
+    };
+    std::unordered_map<sstring, keyspace_slots> _keyspaces;
+    uint16_t _port;
+public:
+    explicit slot_map(uint16_t port) : _port(port) {}
+    const std::vector<slot_range>& get(database& db, const sstring& keyspace);
+    // The nodes of the ring, the ones without a slot too.
+    std::vector<cluster_node> nodes() const;
+    uint16_t port() const {
+        return _port;
+    }
+};
+
+}
@@ -11,6 +11,7 @@
 #include "redis/commands/counter.hh"
 #include "redis/commands/lpush.hh"
 #include "redis/commands/lpop.hh"
+#include "redis/commands/blpop.hh"
 #include "redis/commands/lrange.hh"
 #include "redis/commands/llen.hh"
 #include "redis/commands/lindex.hh"
@@ -37,83 +38,321 @@
 #include "redis/commands/expire.hh"
 #include "redis/commands/cluster_slots.hh"
 #include "redis/commands/spop.hh"
+#include "redis/commands/xadd.hh"
+#include "redis/commands/xtrim.hh"
+#include "redis/commands/xdel.hh"
+#include "redis/commands/xlen.hh"
+#include "redis/commands/xrange.hh"
+#include "redis/commands/xread.hh"
+#include "redis/commands/xgroup.hh"
+#include "redis/commands/pfadd.hh"
+#include "redis/commands/setbit.hh"
+#include "redis/commands/bitcount.hh"
+#include "redis/commands/bitop.hh"
+#include "redis/commands/bitfield.hh"
+#include "redis/commands/geoadd.hh"
+#include "redis/commands/geopos.hh"
+#include "redis/commands/georadius.hh"
 #include "redis/commands/srandmember.hh"
 #include "redis/commands/scard.hh"
+#include "redis/commands/slowlog.hh"
+#include "redis/commands/info.hh"
+#include "redis/commands/hotkeys.hh"
+#include "redis/commands/flushdb.hh"
+#include "redis/commands/replicaof.hh"
+#include "redis/commands/dump.hh"
+#include "redis/commands/restore.hh"
+#include "redis/commands/migrate.hh"
+#include "redis/commands/rename.hh"
+#include "redis/commands/copy.hh"
+#include "redis/commands/move.hh"
+#include "redis/commands/object.hh"
+#include "redis/commands/memory.hh"
+#include "redis/commands/bigkeys.hh"
 #include "log.hh"
 namespace redis {
 static logging::logger logging("command_factory");
-shared_ptr<abstract_command> command_factory::create(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+// The supported commands.
+static const std::vector<std::pair<bytes, command_code>> supported_commands {
+    { "set", command_code::set },
+//  { "setnx", command_code::setnx },
+    { "setex", command_code::setex },
+    { "mset", command_code::mset },
+//  { "msetnx", command_code::msetnx },
+    { "get", command_code::get },
+//  { "getset", command_code::getset },
+    { "mget", command_code::mget },
+    { "del", command_code::del },
+    { "exists", command_code::exists },
+    { "expire", command_code::expire },
+    { "persist", command_code::persist },
+    { "strlen", command_code::strlen },
+    { "append", command_code::append },
+    { "incr", command_code::incr },
+    { "decr", command_code::decr },
+    { "incrby", command_code::incrby },
+    { "decrby", command_code::decrby },
+    { "lpush", command_code::lpush },
+    { "lpushx", command_code::lpushx },
+    { "rpush", command_code::rpush },
+    { "rpushx", command_code::rpushx },
+    { "lpop", command_code::lpop },
+    { "rpop", command_code::rpop },
+    { "blpop", command_code::blpop },
+    { "brpop", command_code::brpop },
+    { "brpoplpush", command_code::brpoplpush },
+    { "lrange", command_code::lrange },
+    { "llen", command_code::llen },
+    { "lindex", command_code::lindex },
+    { "lrem", command_code::lrem },
+    { "lset", command_code::lset },
+    { "ltrim", command_code::ltrim },
+    { "hset", command_code::hset },
+    { "hmset", command_code::hmset },
+    { "hget", command_code::hget },
+    { "hmget", command_code::hmget },
+    { "hdel", command_code::hdel },
+    { "hincrby", command_code::hincrby },
+    { "hexists", command_code::hexists },
+    { "hkeys", command_code::hkeys },
+    { "hvals", command_code::hvals },
+    { "hgetall", command_code::hgetall },
+    { "sadd", command_code::sadd },
+    { "smembers", command_code::smembers },
+    { "spop", command_code::spop },
+    { "scard", command_code::scard },
+    { "srandmember", command_code::srandmember },
+    { "srem", command_code::srem },
+    { "zadd", command_code::zadd },
+    { "zscore", command_code::zscore },
+    { "zincrby", command_code::zincrby },
+    { "zcount", command_code::zcount },
+    { "zcard", command_code::zcard },
+    { "zrange", command_code::zrange },
+    { "zrevrange", command_code::zrevrange },
+    { "zrangebyscore", command_code::zrangebyscore },
+    { "zrevrangebyscore", command_code::zrevrangebyscore },
+    { "zrank", command_code::zrank },
+    { "zrevrank", command_code::zrevrank },
+    { "zrem", command_code::zrem },
+    { "zremrangebyrank", command_code::zremrangebyrank },
+    { "zremrangebyscore", command_code::zremrangebyscore },
+    { "xadd", command_code::xadd },
+    { "xtrim", command_code::xtrim },
+    { "xdel", command_code::xdel },
+    { "xlen", command_code::xlen },
+    { "xrange", command_code::xrange },
+    { "xrevrange", command_code::xrevrange },
+    { "xread", command_code::xread },
+    { "xreadgroup", command_code::xreadgroup },
+    { "xgroup", command_code::xgroup },
+    { "xack", command_code::xack },
+    { "xpending", command_code::xpending },
+    { "pfadd", command_code::pfadd },
+    { "pfcount", command_code::pfcount },
+    { "pfmerge", command_code::pfmerge },
+    { "setbit", command_code::setbit },
+    { "getbit", command_code::getbit },
+    { "bitcount", command_code::bitcount },
+    { "bitpos", command_code::bitpos },
+    { "bitop", command_code::bitop },
+    { "bitfield", command_code::bitfield },
+    { "geoadd", command_code::geoadd },
+    { "geopos", command_code::geopos },
+    { "geohash", command_code::geohash },
+    { "geodist", command_code::geodist },
+    { "georadius", command_code::georadius },
+    { "georadiusbymember", command_code::georadiusbymember },
+    { "geosearch", command_code::geosearch },
+    { "cluster", command_code::cluster },
+    { "slowlog", command_code::slowlog },
+    { "latency", command_code::latency },
+    { "info", command_code::info },
+    { "hotkeys", command_code::hotkeys },
+    { "flushdb", command_code::flushdb },
+    { "flushall", command_code::flushall },
+    { "replicaof", command_code::replicaof },
+    { "slaveof", command_code::slaveof },
+    { "dump", command_code::dump },
+    { "restore", command_code::restore },
+    { "migrate", command_code::migrate },
+    { "rename", command_code::rename },
+    { "renamenx", command_code::renamenx },
+    { "copy", command_code::copy },
+    { "move", command_code::move },
+    { "object", command_code::object },
+    { "memory", command_code::memory },
+    { "bigkeys", command_code::bigkeys },
+};
+
+// The supported commands by their length and first letter, a command is
+// found by comparing its name with a few names at most, without hashing it.
+class command_index {
+    static constexpr size_t max_length = 24;
+    static constexpr size_t letters = 26;
+    std::vector<std::vector<std::pair<bytes, command_code>>> _buckets;
+    static size_t bucket_of(bytes_view name) {
+        return (name.size() - 1) * letters + (name[0] - 'a');
+    }
+public:
+    command_index() : _buckets(max_length * letters) {
+        for (auto& c : supported_commands) {
+            _buckets[bucket_of(c.first)].push_back(c);
+        }
+    }
+    command_code find(bytes_view name) const {
+        if (name.empty() || name.size() > max_length || name[0] < 'a' || name[0] > 'z') {
+            return command_code::unknown;
+        }
+        for (auto& c : _buckets[bucket_of(name)]) {
+            if (bytes_view(c.first) == name) {
+                return c.second;
+            }
+        }
+        return command_code::unknown;
+    }
+};
+
+static shared_ptr<abstract_command> prepare(command_code code, service::storage_proxy& proxy, const service::client_state& cs, request&& req)
 {
-    static thread_local std::unordered_map<bytes, std::function<shared_ptr<abstract_command> (service::storage_proxy& proxy, const service::client_state& cs, request&& req)>> _commands = {
-    { "set",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::set::prepare(proxy, cs, std::move(req)); } }, 
-//  { "setnx",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::setnx::prepare(proxy, cs, std::move(req)); } }, 
-    { "setex",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::setex::prepare(proxy, cs, std::move(req)); } }, 
-    { "mset",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::mset::prepare(proxy, cs, std::move(req)); } }, 
-//  { "msetnx",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::msetnx::prepare(proxy, cs, std::move(req)); } }, 
-    { "get",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::get::prepare(proxy, cs, std::move(req)); } }, 
-//  { "getset",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::getset::prepare(proxy, cs, std::move(req)); } }, 
-    { "mget",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::mget::prepare(proxy, cs, std::move(req)); } }, 
-    { "del",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::del::prepare(proxy, cs, std::move(req)); } }, 
-    { "exists",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::exists::prepare(proxy, cs, std::move(req)); } }, 
-    { "expire",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::expire::prepare(proxy, cs, std::move(req)); } }, 
-    { "persist",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::persist::prepare(proxy, cs, std::move(req)); } }, 
-    { "strlen",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::strlen::prepare(proxy, cs, std::move(req)); } }, 
-    { "append",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::append::prepare(proxy, cs, std::move(req)); } }, 
-    { "incr",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::counter::prepare(proxy, cs, commands::counter::incr_tag {}, std::move(req)); } }, 
-    { "decr",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::counter::prepare(proxy, cs, commands::counter::decr_tag {}, std::move(req)); } }, 
-    { "incrby",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::counter::prepare(proxy, cs, commands::counter::incrby_tag {}, std::move(req)); } }, 
-    { "decrby",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::counter::prepare(proxy, cs, commands::counter::decrby_tag {}, std::move(req)); } }, 
-    { "lpush",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::lpush::prepare(proxy, cs, std::move(req)); } }, 
-    { "lpushx",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::lpushx::prepare(proxy, cs, std::move(req)); } }, 
-    { "rpush",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::rpush::prepare(proxy, cs, std::move(req)); } }, 
-    { "rpushx",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::rpushx::prepare(proxy, cs, std::move(req)); } }, 
-    { "lpop",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::lpop::prepare(proxy, cs, std::move(req)); } }, 
-    { "rpop",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::rpop::prepare(proxy, cs, std::move(req)); } }, 
-    { "lrange",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::lrange::prepare(proxy, cs, std::move(req)); } }, 
-    { "llen",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::llen::prepare(proxy, cs, std::move(req)); } }, 
-    { "lindex",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::lindex::prepare(proxy, cs, std::move(req)); } }, 
-    { "lrem",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::lrem::prepare(proxy, cs, std::move(req)); } }, 
-    { "lset",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::lset::prepare(proxy, cs, std::move(req)); } }, 
-    { "ltrim",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::ltrim::prepare(proxy, cs, std::move(req)); } }, 
-    { "hset",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hset::prepare(proxy, cs, std::move(req), false); } }, 
-    { "hmset",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hset::prepare(proxy, cs, std::move(req), true); } }, 
-    { "hget",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hget::prepare(proxy, cs, std::move(req), false); } }, 
-    { "hmget",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hget::prepare(proxy, cs, std::move(req), true); } }, 
-    { "hdel",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hdel::prepare(proxy, cs, std::move(req)); } }, 
-    { "hincrby",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hincrby::prepare(proxy, cs, std::move(req)); } }, 
-    { "hexists",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hexists::prepare(proxy, cs, std::move(req)); } }, 
-    { "hkeys",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hkeys::prepare(proxy, cs, std::move(req)); } }, 
-    { "hvals",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hvals::prepare(proxy, cs, std::move(req)); } }, 
-    { "hgetall",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::hgetall::prepare(proxy, cs, std::move(req)); } }, 
-    { "sadd",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::sset::prepare(proxy, cs, std::move(req)); } }, 
-    { "smembers",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::smembers::prepare(proxy, cs, std::move(req)); } }, 
-    { "spop",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::spop::prepare(proxy, cs, std::move(req)); } }, 
-    { "scard",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::scard::prepare(proxy, cs, std::move(req)); } }, 
-    { "srandmember",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::srandmember::prepare(proxy, cs, std::move(req)); } }, 
-    { "srem",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::srem::prepare(proxy, cs, std::move(req)); } }, 
-    { "zadd",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zadd::prepare(proxy, cs, std::move(req)); } }, 
-    { "zscore",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zscore::prepare(proxy, cs, std::move(req)); } }, 
-    { "zincrby",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zincrby::prepare(proxy, cs, std::move(req)); } }, 
-    { "zcount",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zcount::prepare(proxy, cs, std::move(req)); } }, 
-    { "zcard",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zcard::prepare(proxy, cs, std::move(req)); } }, 
-    { "zrange",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zrange::prepare(proxy, cs, std::move(req)); } }, 
-    { "zrevrange",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zrevrange::prepare(proxy, cs, std::move(req)); } }, 
-    { "zrangebyscore",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zrangebyscore::prepare(proxy, cs, std::move(req)); } }, 
-    { "zrevrangebyscore",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zrevrangebyscore::prepare(proxy, cs, std::move(req)); } }, 
-    { "zrank",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zrank::prepare(proxy, cs, std::move(req)); } }, 
-    { "zrevrank",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zrevrank::prepare(proxy, cs, std::move(req)); } }, 
-    { "zrem",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zrem::prepare(proxy, cs, std::move(req)); } }, 
-    { "zremrangebyrank",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zremrangebyrank::prepare(proxy, cs, std::move(req)); } }, 
-    { "zremrangebyscore",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::zremrangebyscore::prepare(proxy, cs, std::move(req)); } }, 
-    { "cluster",  [] (service::storage_proxy& proxy, const service::client_state& cs, request&& req) { return commands::cluster_slots::prepare(proxy, cs, std::move(req)); } }, 
-    };
-    auto&& command = _commands.find(req._command);
-    if (command != _commands.end()) {
-        return (command->second)(proxy, cs, std::move(req));
+    switch (code) {
+    case command_code::set: return commands::set::prepare(proxy, cs, std::move(req));
+//  case command_code::setnx: return commands::setnx::prepare(proxy, cs, std::move(req));
+    case command_code::setex: return commands::setex::prepare(proxy, cs, std::move(req));
+    case command_code::mset: return commands::mset::prepare(proxy, cs, std::move(req));
+//  case command_code::msetnx: return commands::msetnx::prepare(proxy, cs, std::move(req));
+    case command_code::get: return commands::get::prepare(proxy, cs, std::move(req));
+//  case command_code::getset: return commands::getset::prepare(proxy, cs, std::move(req));
+    case command_code::mget: return commands::mget::prepare(proxy, cs, std::move(req));
+    case command_code::del: return commands::del::prepare(proxy, cs, std::move(req));
+    case command_code::exists: return commands::exists::prepare(proxy, cs, std::move(req));
+    case command_code::expire: return commands::expire::prepare(proxy, cs, std::move(req));
+    case command_code::persist: return commands::persist::prepare(proxy, cs, std::move(req));
+    case command_code::strlen: return commands::strlen::prepare(proxy, cs, std::move(req));
+    case command_code::append: return commands::append::prepare(proxy, cs, std::move(req));
+    case command_code::incr: return commands::counter::prepare(proxy, cs, commands::counter::incr_tag {}, std::move(req));
+    case command_code::decr: return commands::counter::prepare(proxy, cs, commands::counter::decr_tag {}, std::move(req));
+    case command_code::incrby: return commands::counter::prepare(proxy, cs, commands::counter::incrby_tag {}, std::move(req));
+    case command_code::decrby: return commands::counter::prepare(proxy, cs, commands::counter::decrby_tag {}, std::move(req));
+    case command_code::lpush: return commands::lpush::prepare(proxy, cs, std::move(req));
+    case command_code::lpushx: return commands::lpushx::prepare(proxy, cs, std::move(req));
+    case command_code::rpush: return commands::rpush::prepare(proxy, cs, std::move(req));
+    case command_code::rpushx: return commands::rpushx::prepare(proxy, cs, std::move(req));
+    case command_code::lpop: return commands::lpop::prepare(proxy, cs, std::move(req));
+    case command_code::rpop: return commands::rpop::prepare(proxy, cs, std::move(req));
+    case command_code::blpop: return commands::blpop::prepare(proxy, cs, std::move(req));
+    case command_code::brpop: return commands::brpop::prepare(proxy, cs, std::move(req));
+    case command_code::brpoplpush: return commands::brpoplpush::prepare(proxy, cs, std::move(req));
+    case command_code::lrange: return commands::lrange::prepare(proxy, cs, std::move(req));
+    case command_code::llen: return commands::llen::prepare(proxy, cs, std::move(req));
+    case command_code::lindex: return commands::lindex::prepare(proxy, cs, std::move(req));
+    case command_code::lrem: return commands::lrem::prepare(proxy, cs, std::move(req));
+    case command_code::lset: return commands::lset::prepare(proxy, cs, std::move(req));
+    case command_code::ltrim: return commands::ltrim::prepare(proxy, cs, std::move(req));
+    case command_code::hset: return commands::hset::prepare(proxy, cs, std::move(req), false);
+    case command_code::hmset: return commands::hset::prepare(proxy, cs, std::move(req), true);
+    case command_code::hget: return commands::hget::prepare(proxy, cs, std::move(req), false);
+    case command_code::hmget: return commands::hget::prepare(proxy, cs, std::move(req), true);
+    case command_code::hdel: return commands::hdel::prepare(proxy, cs, std::move(req));
+    case command_code::hincrby: return commands::hincrby::prepare(proxy, cs, std::move(req));
+    case command_code::hexists: return commands::hexists::prepare(proxy, cs, std::move(req));
+    case command_code::hkeys: return commands::hkeys::prepare(proxy, cs, std::move(req));
+    case command_code::hvals: return commands::hvals::prepare(proxy, cs, std::move(req));
+    case command_code::hgetall: return commands::hgetall::prepare(proxy, cs, std::move(req));
+    case command_code::sadd: return commands::sset::prepare(proxy, cs, std::move(req));
+    case command_code::smembers: return commands::smembers::prepare(proxy, cs, std::move(req));
+    case command_code::spop: return commands::spop::prepare(proxy, cs, std::move(req));
+    case command_code::scard: return commands::scard::prepare(proxy, cs, std::move(req));
+    case command_code::srandmember: return commands::srandmember::prepare(proxy, cs, std::move(req));
+    case command_code::srem: return commands::srem::prepare(proxy, cs, std::move(req));
+    case command_code::zadd: return commands::zadd::prepare(proxy, cs, std::move(req));
+    case command_code::zscore: return commands::zscore::prepare(proxy, cs, std::move(req));
+    case command_code::zincrby: return commands::zincrby::prepare(proxy, cs, std::move(req));
+    case command_code::zcount: return commands::zcount::prepare(proxy, cs, std::move(req));
+    case command_code::zcard: return commands::zcard::prepare(proxy, cs, std::move(req));
+    case command_code::zrange: return commands::zrange::prepare(proxy, cs, std::move(req));
+    case command_code::zrevrange: return commands::zrevrange::prepare(proxy, cs, std::move(req));
+    case command_code::zrangebyscore: return commands::zrangebyscore::prepare(proxy, cs, std::move(req));
+    case command_code::zrevrangebyscore: return commands::zrevrangebyscore::prepare(proxy, cs, std::move(req));
+    case command_code::zrank: return commands::zrank::prepare(proxy, cs, std::move(req));
+    case command_code::zrevrank: return commands::zrevrank::prepare(proxy, cs, std::move(req));
+    case command_code::zrem: return commands::zrem::prepare(proxy, cs, std::move(req));
+    case command_code::zremrangebyrank: return commands::zremrangebyrank::prepare(proxy, cs, std::move(req));
+    case command_code::zremrangebyscore: return commands::zremrangebyscore::prepare(proxy, cs, std::move(req));
+    case command_code::xadd: return commands::xadd::prepare(proxy, cs, std::move(req));
+    case command_code::xtrim: return commands::xtrim::prepare(proxy, cs, std::move(req));
+    case command_code::xdel: return commands::xdel::prepare(proxy, cs, std::move(req));
+    case command_code::xlen: return commands::xlen::prepare(proxy, cs, std::move(req));
+    case command_code::xrange: return commands::xrange::prepare(proxy, cs, std::move(req));
+    case command_code::xrevrange: return commands::xrevrange::prepare(proxy, cs, std::move(req));
+    case command_code::xread: return commands::xread::prepare(proxy, cs, std::move(req));
+    case command_code::xreadgroup: return commands::xreadgroup::prepare(proxy, cs, std::move(req));
+    case command_code::xgroup: return commands::xgroup::prepare(proxy, cs, std::move(req));
+    case command_code::xack: return commands::xack::prepare(proxy, cs, std::move(req));
+    case command_code::xpending: return commands::xpending::prepare(proxy, cs, std::move(req));
+    case command_code::pfadd: return commands::pfadd::prepare(proxy, cs, std::move(req));
+    case command_code::pfcount: return commands::pfcount::prepare(proxy, cs, std::move(req));
+    case command_code::pfmerge: return commands::pfmerge::prepare(proxy, cs, std::move(req));
+    case command_code::setbit: return commands::setbit::prepare(proxy, cs, std::move(req));
+    case command_code::getbit: return commands::getbit::prepare(proxy, cs, std::move(req));
+    case command_code::bitcount: return commands::bitcount::prepare(proxy, cs, std::move(req));
+    case command_code::bitpos: return commands::bitpos::prepare(proxy, cs, std::move(req));
+    case command_code::bitop: return commands::bitop::prepare(proxy, cs, std::move(req));
+    case command_code::bitfield: return commands::bitfield::prepare(proxy, cs, std::move(req));
+    case command_code::geoadd: return commands::geoadd::prepare(proxy, cs, std::move(req));
+    case command_code::geopos: return commands::geopos::prepare(proxy, cs, std::move(req));
+    case command_code::geohash: return commands::geohash::prepare(proxy, cs, std::move(req));
+    case command_code::geodist: return commands::geodist::prepare(proxy, cs, std::move(req));
+    case command_code::georadius: return commands::georadius::prepare(proxy, cs, std::move(req));
+    case command_code::georadiusbymember: return commands::georadiusbymember::prepare(proxy, cs, std::move(req));
+    case command_code::geosearch: return commands::geosearch::prepare(proxy, cs, std::move(req));
+    case command_code::cluster: return commands::cluster_slots::prepare(proxy, cs, std::move(req));
+    case command_code::slowlog: return commands::slowlog::prepare(proxy, cs, std::move(req));
+    case command_code::latency: return commands::latency::prepare(proxy, cs, std::move(req));
+    case command_code::info: return commands::info::prepare(proxy, cs, std::move(req));
+    case command_code::hotkeys: return commands::hotkeys::prepare(proxy, cs, std::move(req));
+    case command_code::flushdb: return commands::flushdb::prepare(proxy, cs, std::move(req));
+    case command_code::flushall: return commands::flushdb::prepare(proxy, cs, std::move(req));
+    case command_code::replicaof: return commands::replicaof::prepare(proxy, cs, std::move(req));
+    case command_code::slaveof: return commands::replicaof::prepare(proxy, cs, std::move(req));
+    case command_code::dump: return commands::dump::prepare(proxy, cs, std::move(req));
+    case command_code::restore: return commands::restore::prepare(proxy, cs, std::move(req));
+    case command_code::migrate: return commands::migrate::prepare(proxy, cs, std::move(req));
+    case command_code::rename: return commands::rename::prepare(proxy, cs, std::move(req));
+    case command_code::renamenx: return commands::rename::prepare(proxy, cs, std::move(req));
+    case command_code::copy: return commands::copy::prepare(proxy, cs, std::move(req));
+    case command_code::move: return commands::move::prepare(proxy, cs, std::move(req));
+    case command_code::object: return commands::object::prepare(proxy, cs, std::move(req));
+    case command_code::memory: return commands::memory::prepare(proxy, cs, std::move(req));
+    case command_code::bigkeys: return commands::bigkeys::prepare(proxy, cs, std::move(req));
+    default:
+        break;
     }
     auto& b = req._command;
     logging.error("unkown command = {}", sstring(reinterpret_cast<const char*>(b.data()), b.size()));
     return commands::unexpected::prepare(std::move(req._command));
 }
 
+std::vector<bytes> command_factory::names()
+{
+    std::vector<bytes> names;
+    for (auto& c : supported_commands) {
+        names.emplace_back(c.first);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+command_code command_factory::code_of(bytes_view name)
+{
+    static thread_local command_index index;
+    return index.find(name);
+}
+
+shared_ptr<abstract_command> command_factory::create(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    auto code = req._code;
+    return prepare(code, proxy, cs, std::move(req));
+}
+
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include "bytes.hh"
 #include "seastar/core/shared_ptr.hh"
+#include "redis/redis_command_code.hh"
+#include <vector>
 
 namespace service {
 class storage_proxy;
@@ -15,5 +17,9 @@ public:
     command_factory() {}
     ~command_factory() {}
     static shared_ptr<abstract_command> create(service::storage_proxy&, const service::client_state&, request&&);
+    // The names of the supported commands, sorted.
+    static std::vector<bytes> names();
+    // The code of a supported command, unknown otherwise.
+    static command_code code_of(bytes_view name);
 };
 }
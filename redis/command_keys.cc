@@ -0,0 +1,222 @@
+#include "redis/command_keys.hh"
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+#include <algorithm>
+#include <vector>
+
+namespace redis {
+
+namespace {
+
+// Where the keys are in the arguments of a command.
+enum class key_args {
+    none,
+    first,
+    second,
+    first_two,
+    all,
+    // BLPOP, the timeout follows the keys.
+    all_but_last,
+    // MSET, the keys followed by their values.
+    even,
+    // MIGRATE, the key or the keys following KEYS.
+    migrate,
+};
+
+struct command_key_args {
+    bool _read;
+    key_args _args;
+    // The command writes strings or hashes, or deletes keys, which GET and
+    // HGET read from the near cache. The other writes change the other types
+    // of keys.
+    bool _cached = false;
+};
+
+}
+
+// The commands not given are writes of their first argument, not cached.
+static const std::vector<std::pair<command_code, command_key_args>> commands {
+    { command_code::get, { true, key_args::first } },
+    { command_code::mget, { true, key_args::all } },
+    { command_code::strlen, { true, key_args::first } },
+    { command_code::exists, { true, key_args::all } },
+    { command_code::llen, { true, key_args::first } },
+    { command_code::lrange, { true, key_args::first } },
+    { command_code::lindex, { true, key_args::first } },
+    { command_code::hget, { true, key_args::first } },
+    { command_code::hmget, { true, key_args::first } },
+    { command_code::hkeys, { true, key_args::first } },
+    { command_code::hvals, { true, key_args::first } },
+    { command_code::hgetall, { true, key_args::first } },
+    { command_code::hexists, { true, key_args::first } },
+    { command_code::smembers, { true, key_args::first } },
+    { command_code::scard, { true, key_args::first } },
+    { command_code::srandmember, { true, key_args::first } },
+    { command_code::zscore, { true, key_args::first } },
+    { command_code::zcount, { true, key_args::first } },
+    { command_code::zcard, { true, key_args::first } },
+    { command_code::zrange, { true, key_args::first } },
+    { command_code::zrevrange, { true, key_args::first } },
+    { command_code::zrangebyscore, { true, key_args::first } },
+    { command_code::zrevrangebyscore, { true, key_args::first } },
+    { command_code::zrank, { true, key_args::first } },
+    { command_code::zrevrank, { true, key_args::first } },
+    { command_code::xlen, { true, key_args::first } },
+    { command_code::xrange, { true, key_args::first } },
+    { command_code::xrevrange, { true, key_args::first } },
+    { command_code::xpending, { true, key_args::first } },
+    { command_code::pfcount, { true, key_args::all } },
+    { command_code::getbit, { true, key_args::first } },
+    { command_code::bitcount, { true, key_args::first } },
+    { command_code::bitpos, { true, key_args::first } },
+    { command_code::geopos, { true, key_args::first } },
+    { command_code::geohash, { true, key_args::first } },
+    { command_code::geodist, { true, key_args::first } },
+    { command_code::geosearch, { true, key_args::first } },
+    { command_code::georadius, { true, key_args::first } },
+    { command_code::georadiusbymember, { true, key_args::first } },
+    { command_code::dump, { true, key_args::first } },
+    { command_code::object, { true, key_args::second } },
+    { command_code::memory, { true, key_args::second } },
+    { command_code::set, { false, key_args::first, true } },
+    { command_code::setex, { false, key_args::first, true } },
+    { command_code::append, { false, key_args::first, true } },
+    { command_code::incr, { false, key_args::first, true } },
+    { command_code::decr, { false, key_args::first, true } },
+    { command_code::incrby, { false, key_args::first, true } },
+    { command_code::decrby, { false, key_args::first, true } },
+    { command_code::expire, { false, key_args::first, true } },
+    { command_code::persist, { false, key_args::first, true } },
+    { command_code::hset, { false, key_args::first, true } },
+    { command_code::hmset, { false, key_args::first, true } },
+    { command_code::hdel, { false, key_args::first, true } },
+    { command_code::hincrby, { false, key_args::first, true } },
+    { command_code::pfadd, { false, key_args::first, true } },
+    { command_code::restore, { false, key_args::first, true } },
+    { command_code::move, { false, key_args::first, true } },
+    { command_code::del, { false, key_args::all, true } },
+    { command_code::mset, { false, key_args::even, true } },
+    { command_code::pfmerge, { false, key_args::first, true } },
+    { command_code::blpop, { false, key_args::all_but_last } },
+    { command_code::brpop, { false, key_args::all_but_last } },
+    { command_code::brpoplpush, { false, key_args::first_two } },
+    { command_code::bitop, { false, key_args::second } },
+    { command_code::xgroup, { false, key_args::second } },
+    { command_code::migrate, { false, key_args::migrate, true } },
+    { command_code::rename, { false, key_args::first_two, true } },
+    { command_code::renamenx, { false, key_args::first_two, true } },
+    { command_code::copy, { false, key_args::first_two, true } },
+    { command_code::xread, { true, key_args::none } },
+    { command_code::xreadgroup, { false, key_args::none } },
+    { command_code::cluster, { true, key_args::none } },
+    { command_code::slowlog, { true, key_args::none } },
+    { command_code::latency, { true, key_args::none } },
+    { command_code::info, { true, key_args::none } },
+    { command_code::hotkeys, { true, key_args::none } },
+    { command_code::select, { true, key_args::none } },
+    { command_code::flushdb, { false, key_args::none } },
+    { command_code::flushall, { false, key_args::none } },
+    { command_code::replicaof, { true, key_args::none } },
+    { command_code::slaveof, { true, key_args::none } },
+    { command_code::bigkeys, { true, key_args::none } },
+};
+
+static const command_key_args default_command_keys { false, key_args::first };
+
+// Indexed by the command codes.
+static const std::vector<command_key_args> command_keys_table = [] {
+    std::vector<command_key_args> table(size_t(command_code::count), default_command_keys);
+    for (auto& c : commands) {
+        table[size_t(c.first)] = c.second;
+    }
+    return table;
+}();
+
+static const command_key_args& command_keys_of(const request& req)
+{
+    return command_keys_table[size_t(req._code)];
+}
+
+static std::vector<bytes> keys_of(const request& req, key_args args)
+{
+    std::vector<bytes> keys;
+    auto& a = req._args;
+    switch (args) {
+    case key_args::none:
+        break;
+    case key_args::first:
+        if (a.size() >= 1) {
+            keys.emplace_back(a[0]);
+        }
+        break;
+    case key_args::second:
+        if (a.size() >= 2) {
+            keys.emplace_back(a[1]);
+        }
+        break;
+    case key_args::first_two:
+        keys.insert(keys.end(), a.begin(), a.begin() + std::min(a.size(), size_t(2)));
+        break;
+    case key_args::all:
+        keys = a;
+        break;
+    case key_args::all_but_last:
+        if (!a.empty()) {
+            keys.insert(keys.end(), a.begin(), a.end() - 1);
+        }
+        break;
+    case key_args::even:
+        for (size_t i = 0; i < a.size(); i += 2) {
+            keys.emplace_back(a[i]);
+        }
+        break;
+    case key_args::migrate:
+        if (a.size() >= 3 && !a[2].empty()) {
+            keys.emplace_back(a[2]);
+        } else if (a.size() >= 5) {
+            auto it = std::find_if(a.begin() + 5, a.end(), [] (const bytes& b) {
+                return option_equals(b, "keys");
+            });
+            keys.insert(keys.end(), it != a.end() ? it + 1 : a.end(), a.end());
+        }
+        break;
+    }
+    return keys;
+}
+
+std::vector<bytes> command_keys::read_keys(const request& req)
+{
+    auto& c = command_keys_of(req);
+    return c._read ? keys_of(req, c._args) : std::vector<bytes>();
+}
+
+std::vector<bytes> command_keys::written_keys(const request& req)
+{
+    auto& c = command_keys_of(req);
+    return !c._read ? keys_of(req, c._args) : std::vector<bytes>();
+}
+
+std::vector<bytes> command_keys::cached_written_keys(const request& req)
+{
+    auto& c = command_keys_of(req);
+    return c._cached ? keys_of(req, c._args) : std::vector<bytes>();
+}
+
+const bytes* command_keys::first_key(const request& req)
+{
+    if (req._args.empty()) {
+        return nullptr;
+    }
+    switch (command_keys_of(req)._args) {
+    case key_args::first:
+    case key_args::first_two:
+    case key_args::all:
+    case key_args::all_but_last:
+    case key_args::even:
+        return &req._args[0];
+    default:
+        return nullptr;
+    }
+}
+
+}
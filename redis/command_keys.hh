@@ -0,0 +1,26 @@
+#pragma once
+#include "bytes.hh"
+#include <vector>
+
+namespace redis {
+
+struct request;
+
+// Where the keys of the commands are in their arguments, and what the commands
+// do with them. The single table of the keys of the commands, used by the
+// client tracking, the near cache, the hot keys and the replication, to be
+// updated with the supported commands of command_factory.
+class command_keys {
+public:
+    // The keys read by the request, empty if it writes.
+    static std::vector<bytes> read_keys(const request& req);
+    // The keys written by the request, empty if it only reads.
+    static std::vector<bytes> written_keys(const request& req);
+    // The keys whose strings or hashes are written by the request, or which
+    // are deleted, the values of the near cache. Empty if none is.
+    static std::vector<bytes> cached_written_keys(const request& req);
+    // The first argument of the request when it is a key, null otherwise.
+    static const bytes* first_key(const request& req);
+};
+
+}
@@ -7,6 +7,7 @@
 #include "timeout_config.hh"
 #include "service/client_state.hh"
 #include "service/storage_proxy.hh"
+#include "seastar/core/future-util.hh"
 #include "db/system_keyspace.hh"
 #include "partition_slice_builder.hh"
 #include "gc_clock.hh"
@@ -25,10 +26,16 @@ shared_ptr<abstract_command> append::prepare(service::storage_proxy& proxy, cons
 future<redis_message> append::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
     auto timeout = now + tc.read_timeout;
-    return prefetch_simple(proxy, _schema, _key, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+    auto fetched = prefetch_simple(proxy, _schema, _key, cl, timeout, cs);
+    auto is_bitmap = exists(proxy, bitmaps_schema(proxy, cs.get_keyspace()), _key, cl, timeout, cs);
+    return when_all(std::move(fetched), std::move(is_bitmap)).then([this, &proxy, cl, timeout, &cs] (auto results) {
+        auto pd = std::get<0>(results).get0();
         bytes new_data;
         if (pd && pd->has_data()) {
             new_data = std::move(pd->_data + _data);
+        } else if (std::get<1>(results).get0()) {
+            // A bitmap is not a string, see bitmaps.hh.
+            return redis_message::wrong_type();
         } else {
             new_data = std::move(_data);
         }
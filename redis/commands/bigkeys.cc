@@ -0,0 +1,50 @@
+#include "redis/commands/bigkeys.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/key_footprint.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+static constexpr long default_bigkeys_count = 1;
+
+shared_ptr<abstract_command> bigkeys::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count > 1) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    if (req._args_count == 1 && option_equals(req._args[0], "scan")) {
+        return seastar::make_shared<bigkeys>(std::move(req._command), operation::scan, 0);
+    }
+    long count = default_bigkeys_count;
+    if (req._args_count == 1) {
+        auto c = try_bytes2long(req._args[0]);
+        if (!c || *c <= 0) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR count should be greater than 0\r\n"));
+        }
+        count = *c;
+    }
+    return seastar::make_shared<bigkeys>(std::move(req._command), operation::get, count);
+}
+
+future<redis_message> bigkeys::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    if (_op == operation::scan) {
+        return start_big_keys_scan().then([] (bool started) {
+            if (!started) {
+                return redis_message::make_exception(sstring("-ERR a scan of the big keys is already in progress\r\n"));
+            }
+            return redis_message::ok();
+        });
+    }
+    return get_big_keys(static_cast<size_t>(_count)).then([] (auto&& keys) {
+        return redis_message::make_big_keys(make_lw_shared<std::vector<big_key>>(std::move(keys)));
+    });
+}
+
+}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// BIGKEYS [count] | SCAN, the largest keys of each type found by the last
+// scan of the sstables of all shards, or starts a scan in the background.
+class bigkeys : public abstract_command {
+public:
+    enum class operation { get, scan };
+private:
+    operation _op;
+    long _count;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    bigkeys(bytes&& name, operation op, long count)
+        : abstract_command(std::move(name))
+        , _op(op)
+        , _count(count)
+    {
+    }
+    ~bigkeys() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
@@ -0,0 +1,187 @@
+#include "redis/commands/bitcount.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/prefetcher.hh"
+#include "redis/bitmaps.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "seastar/core/future-util.hh"
+namespace redis {
+namespace commands {
+
+// Parses [start [end [BYTE|BIT]]] from args[i].
+static std::optional<bit_range> parse_bit_range(const std::vector<bytes>& args, size_t i)
+{
+    bit_range range;
+    if (i < args.size()) {
+        range._start = try_bytes2long(args[i++]);
+        if (!range._start) {
+            return std::nullopt;
+        }
+    }
+    if (i < args.size()) {
+        range._end = try_bytes2long(args[i++]);
+        if (!range._end) {
+            return std::nullopt;
+        }
+    }
+    if (i < args.size()) {
+        if (option_equals(args[i], "bit")) {
+            range._bits = true;
+        } else if (!option_equals(args[i], "byte")) {
+            return std::nullopt;
+        }
+        ++i;
+    }
+    if (i != args.size()) {
+        return std::nullopt;
+    }
+    return range;
+}
+
+// Resolves the range over a bitmap of `length` bytes to bits, as Redis does
+// (negative indexes count from the end). Returns nothing if the range is empty.
+static std::optional<std::pair<uint64_t, uint64_t>> resolve_bit_range(const bit_range& range, uint64_t length)
+{
+    long total = static_cast<long>(range._bits ? length * 8 : length);
+    long start = range._start ? *range._start : 0;
+    long end = range._end ? *range._end : total - 1;
+    if (start < 0) start += total;
+    if (end < 0) end += total;
+    if (start < 0) start = 0;
+    if (end < 0) end = 0;
+    if (end >= total) end = total - 1;
+    if (total == 0 || start > end) {
+        return std::nullopt;
+    }
+    if (range._bits) {
+        return std::make_pair(static_cast<uint64_t>(start), static_cast<uint64_t>(end));
+    }
+    return std::make_pair(static_cast<uint64_t>(start) * 8, static_cast<uint64_t>(end) * 8 + 7);
+}
+
+static query::clustering_range make_chunk_range(const schema& s, uint64_t first_bit, uint64_t last_bit)
+{
+    auto first = clustering_key_prefix::from_single_value(s, long_type->decompose(bitmaps::chunk_of(first_bit >> 3)));
+    auto last = clustering_key_prefix::from_single_value(s, long_type->decompose(bitmaps::chunk_of(last_bit >> 3)));
+    return query::clustering_range::make({ std::move(first), true }, { std::move(last), true });
+}
+
+// Reads the chunks covered by the range. The length of the bitmap is given by its last
+// chunk, which is read first, unless the whole bitmap is read anyway.
+template<typename Func>
+static future<redis_message> read_bit_range(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    const bit_range& range,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs,
+    Func&& func)
+{
+    auto all = std::vector<query::clustering_range> { query::clustering_range::make_open_ended_both_sides() };
+    if (!range._start) {
+        return prefetch_bitmap(proxy, schema, key, std::move(all), false, std::numeric_limits<uint32_t>::max(), cl, timeout, cs).then([range, func = std::move(func)] (auto pd) {
+            bitmaps::chunked_bitmap bitmap(pd->data());
+            return func(bitmap, bitmap.length(), resolve_bit_range(range, bitmap.length()));
+        });
+    }
+    return prefetch_bitmap(proxy, schema, key, std::move(all), true, 1, cl, timeout, cs).then([&proxy, schema, &key, range, cl, timeout, &cs, func = std::move(func)] (auto last) mutable {
+        auto length = bitmaps::chunked_bitmap(last->data()).length();
+        auto bits = resolve_bit_range(range, length);
+        if (!bits) {
+            bitmaps::chunked_bitmap empty(last->data());
+            return func(empty, length, bits);
+        }
+        auto ranges = std::vector<query::clustering_range> { make_chunk_range(*schema, bits->first, bits->second) };
+        return prefetch_bitmap(proxy, schema, key, std::move(ranges), false, std::numeric_limits<uint32_t>::max(), cl, timeout, cs).then([length, bits, func = std::move(func)] (auto pd) {
+            bitmaps::chunked_bitmap bitmap(pd->data());
+            return func(bitmap, length, bits);
+        });
+    });
+}
+
+// A key holding a string is not a bitmap, see bitmaps.hh.
+template<typename Func>
+static future<redis_message> with_bit_range(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    const bit_range& range,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs,
+    Func&& func)
+{
+    auto is_string = exists(proxy, simple_objects_schema(proxy, cs.get_keyspace()), key, cl, timeout, cs);
+    auto read = read_bit_range(proxy, schema, key, range, cl, timeout, cs, std::forward<Func>(func));
+    return when_all(std::move(is_string), std::move(read)).then([] (auto results) {
+        if (std::get<0>(results).get0()) {
+            return redis_message::wrong_type();
+        }
+        return make_ready_future<redis_message>(std::get<1>(results).get0());
+    });
+}
+
+shared_ptr<abstract_command> bitcount::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 1 || req._args_count == 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    auto range = parse_bit_range(req._args, 1);
+    if (!range) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    return seastar::make_shared<bitcount>(std::move(req._command), bitmaps_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), *range);
+}
+
+future<redis_message> bitcount::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    return with_bit_range(proxy, _schema, _key, _range, cl, timeout, cs, [] (const bitmaps::chunked_bitmap& bitmap, uint64_t length, auto bits) {
+        if (!bits) {
+            return redis_message::zero();
+        }
+        return redis_message::make_long(static_cast<long>(bitmap.popcount(bits->first, bits->second)));
+    });
+}
+
+shared_ptr<abstract_command> bitpos::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 2, req._args_count);
+    }
+    auto& bit = req._args[1];
+    if (bit.size() != 1 || (bit[0] != '0' && bit[0] != '1')) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR The bit argument must be 1 or 0.\r\n"));
+    }
+    auto range = parse_bit_range(req._args, 2);
+    if (!range) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    return seastar::make_shared<bitpos>(std::move(req._command), bitmaps_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), bit[0] == '1', *range);
+}
+
+future<redis_message> bitpos::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    return with_bit_range(proxy, _schema, _key, _range, cl, timeout, cs, [this] (const bitmaps::chunked_bitmap& bitmap, uint64_t length, auto bits) {
+        if (length == 0) {
+            // A missing key is an empty string.
+            return redis_message::make_long(_bit ? -1 : 0);
+        }
+        if (!bits) {
+            return redis_message::make_long(-1);
+        }
+        auto pos = bitmap.find_first(_bit, bits->first, bits->second);
+        if (pos < 0 && !_bit && !_range._end) {
+            // Looking for a clear bit without an end, the string is padded with zeros.
+            pos = static_cast<long>(bits->second + 1);
+        }
+        return redis_message::make_long(pos);
+    });
+}
+
+}
+}
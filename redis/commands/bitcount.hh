@@ -0,0 +1,53 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include <optional>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+// The optional range of BITCOUNT and BITPOS, in bytes or in bits.
+struct bit_range {
+    std::optional<long> _start;
+    std::optional<long> _end;
+    bool _bits = false;
+};
+
+// BITCOUNT key [start end [BYTE|BIT]]
+class bitcount : public command_with_single_schema {
+    bytes _key;
+    bit_range _range;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    bitcount(bytes&& name, const schema_ptr schema, bytes&& key, bit_range range)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _range(range)
+    {
+    }
+    ~bitcount() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+// BITPOS key bit [start [end [BYTE|BIT]]]
+class bitpos : public command_with_single_schema {
+    bytes _key;
+    bool _bit;
+    bit_range _range;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    bitpos(bytes&& name, const schema_ptr schema, bytes&& key, bool bit, bit_range range)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _bit(bit)
+        , _range(range)
+    {
+    }
+    ~bitpos() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
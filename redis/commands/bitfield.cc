@@ -0,0 +1,264 @@
+#include "redis/commands/bitfield.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "redis/bitmaps.hh"
+#include "redis/key_locks.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "seastar/core/future-util.hh"
+#include <map>
+#include <set>
+namespace redis {
+namespace commands {
+
+// Parses i1..i64 and u1..u63.
+static bool parse_type(const bytes& b, bool& is_signed, unsigned& bits)
+{
+    if (b.size() < 2 || (b[0] != 'i' && b[0] != 'I' && b[0] != 'u' && b[0] != 'U')) {
+        return false;
+    }
+    is_signed = b[0] == 'i' || b[0] == 'I';
+    auto n = try_bytes2long(bytes(b.begin() + 1, b.end()));
+    if (!n || *n < 1 || *n > (is_signed ? 64 : 63)) {
+        return false;
+    }
+    bits = static_cast<unsigned>(*n);
+    return true;
+}
+
+// Parses a bit offset, or "#<n>" which is multiplied by the width of the field.
+static bool parse_field_offset(const bytes& b, unsigned bits, uint64_t& offset)
+{
+    bool multiply = !b.empty() && b[0] == '#';
+    auto n = try_bytes2long(multiply ? bytes(b.begin() + 1, b.end()) : b);
+    if (!n || *n < 0) {
+        return false;
+    }
+    offset = static_cast<uint64_t>(*n) * (multiply ? bits : 1);
+    return offset + bits - 1 <= bitmaps::max_offset;
+}
+
+shared_ptr<abstract_command> bitfield::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 1) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    std::vector<field_op> ops;
+    auto current_overflow = overflow::wrap;
+    auto& args = req._args;
+    for (size_t i = 1; i < args.size(); ) {
+        auto& sub = args[i];
+        if (option_equals(sub, "overflow")) {
+            if (i + 1 >= args.size()) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+            }
+            auto& mode = args[i + 1];
+            if (option_equals(mode, "wrap")) {
+                current_overflow = overflow::wrap;
+            } else if (option_equals(mode, "sat")) {
+                current_overflow = overflow::sat;
+            } else if (option_equals(mode, "fail")) {
+                current_overflow = overflow::fail;
+            } else {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid OVERFLOW type specified\r\n"));
+            }
+            i += 2;
+            continue;
+        }
+        field_op op;
+        size_t nargs;
+        if (option_equals(sub, "get")) {
+            op._kind = kind::get;
+            nargs = 3;
+        } else if (option_equals(sub, "set")) {
+            op._kind = kind::set;
+            nargs = 4;
+        } else if (option_equals(sub, "incrby")) {
+            op._kind = kind::incrby;
+            nargs = 4;
+        } else {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+        }
+        if (i + nargs > args.size()) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+        }
+        if (!parse_type(args[i + 1], op._signed, op._bits)) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid bitfield type. Use something like i16 u8. Note that u64 is not supported but i64 is.\r\n"));
+        }
+        if (!parse_field_offset(args[i + 2], op._bits, op._offset)) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR bit offset is not an integer or out of range\r\n"));
+        }
+        op._value = 0;
+        if (nargs == 4) {
+            auto value = try_bytes2long(args[i + 3]);
+            if (!value) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR value is not an integer or out of range\r\n"));
+            }
+            op._value = *value;
+        }
+        op._overflow = current_overflow;
+        ops.emplace_back(op);
+        i += nargs;
+    }
+    return seastar::make_shared<bitfield>(std::move(req._command), bitmaps_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), std::move(ops));
+}
+
+namespace {
+
+// The chunks touched by the operations, modified in place.
+class field_chunks {
+    std::map<int64_t, bytes> _chunks;
+    std::set<int64_t> _dirty;
+    bytes& chunk_for_write(uint64_t byte) {
+        auto index = bitmaps::chunk_of(byte);
+        auto& c = _chunks[index];
+        auto pos = byte % bitmaps::chunk_size;
+        if (pos >= c.size()) {
+            bytes grown(pos + 1, 0);
+            std::copy(c.begin(), c.end(), grown.begin());
+            c = std::move(grown);
+        }
+        _dirty.insert(index);
+        return c;
+    }
+public:
+    explicit field_chunks(std::vector<std::pair<int64_t, bytes>>&& chunks) {
+        for (auto& c : chunks) {
+            _chunks.emplace(c.first, std::move(c.second));
+        }
+    }
+    bool bit_at(uint64_t bit) const {
+        auto byte = bit >> 3;
+        auto it = _chunks.find(bitmaps::chunk_of(byte));
+        if (it == _chunks.end()) {
+            return false;
+        }
+        auto pos = byte % bitmaps::chunk_size;
+        return pos < it->second.size() && (static_cast<uint8_t>(it->second[pos]) & (0x80 >> (bit & 7)));
+    }
+    void set_bit(uint64_t bit, bool value) {
+        auto byte = bit >> 3;
+        auto& c = chunk_for_write(byte);
+        auto pos = byte % bitmaps::chunk_size;
+        auto mask = static_cast<uint8_t>(0x80 >> (bit & 7));
+        c[pos] = value ? (static_cast<uint8_t>(c[pos]) | mask) : (static_cast<uint8_t>(c[pos]) & ~mask);
+    }
+    uint64_t get(uint64_t offset, unsigned bits) const {
+        uint64_t v = 0;
+        for (unsigned i = 0; i < bits; ++i) {
+            v = (v << 1) | (bit_at(offset + i) ? 1 : 0);
+        }
+        return v;
+    }
+    void set(uint64_t offset, unsigned bits, uint64_t v) {
+        for (unsigned i = 0; i < bits; ++i) {
+            set_bit(offset + i, (v >> (bits - 1 - i)) & 1);
+        }
+    }
+    std::vector<std::pair<int64_t, bytes>> dirty_chunks() {
+        std::vector<std::pair<int64_t, bytes>> chunks;
+        for (auto index : _dirty) {
+            chunks.emplace_back(std::make_pair(index, std::move(_chunks[index])));
+        }
+        return chunks;
+    }
+};
+
+int64_t to_signed(uint64_t v, unsigned bits)
+{
+    if (bits < 64 && (v & (uint64_t(1) << (bits - 1)))) {
+        v |= ~uint64_t(0) << bits;
+    }
+    return static_cast<int64_t>(v);
+}
+
+// Fits `v` into the field, returns nothing if it overflows with OVERFLOW FAIL.
+std::optional<int64_t> fit(__int128 v, const bitfield::field_op& op)
+{
+    __int128 min = op._signed ? -(__int128(1) << (op._bits - 1)) : 0;
+    __int128 max = op._signed ? (__int128(1) << (op._bits - 1)) - 1 : (__int128(1) << op._bits) - 1;
+    if (v >= min && v <= max) {
+        return static_cast<int64_t>(v);
+    }
+    switch (op._overflow) {
+    case bitfield::overflow::fail:
+        return std::nullopt;
+    case bitfield::overflow::sat:
+        return static_cast<int64_t>(v < min ? min : max);
+    case bitfield::overflow::wrap:
+        break;
+    }
+    auto wrapped = static_cast<uint64_t>(v) & (op._bits == 64 ? ~uint64_t(0) : (uint64_t(1) << op._bits) - 1);
+    return op._signed ? to_signed(wrapped, op._bits) : static_cast<int64_t>(wrapped);
+}
+
+}
+
+future<redis_message> bitfield::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + (_read_only ? tc.read_timeout : tc.write_timeout);
+    auto run = [this, &proxy, cl, timeout, &cs] {
+        std::set<int64_t> indexes;
+        for (auto& op : _ops) {
+            indexes.insert(bitmaps::chunk_of(op._offset >> 3));
+            indexes.insert(bitmaps::chunk_of((op._offset + op._bits - 1) >> 3));
+        }
+        std::vector<query::clustering_range> ranges;
+        for (auto index : indexes) {
+            ranges.emplace_back(query::clustering_range::make_singular(clustering_key_prefix::from_single_value(*_schema, long_type->decompose(index))));
+        }
+        auto count = static_cast<uint32_t>(indexes.size());
+        auto is_string = exists(proxy, simple_objects_schema(proxy, cs.get_keyspace()), _key, cl, timeout, cs);
+        auto fetched = prefetch_bitmap(proxy, _schema, _key, std::move(ranges), false, count, cl, timeout, cs);
+        return when_all(std::move(is_string), std::move(fetched)).then([this, &proxy, cl, timeout, &cs] (auto results) {
+            // A key holding a string is not a bitmap, see bitmaps.hh.
+            if (std::get<0>(results).get0()) {
+                return redis_message::wrong_type();
+            }
+            auto pd = std::get<1>(results).get0();
+            field_chunks chunks(std::move(pd->data()));
+            std::vector<std::optional<long>> results;
+            results.reserve(_ops.size());
+            for (auto& op : _ops) {
+                auto raw = chunks.get(op._offset, op._bits);
+                int64_t old = op._signed ? to_signed(raw, op._bits) : static_cast<int64_t>(raw);
+                if (op._kind == kind::get) {
+                    results.emplace_back(old);
+                    continue;
+                }
+                auto updated = fit(op._kind == kind::set ? __int128(op._value) : __int128(old) + op._value, op);
+                if (!updated) {
+                    results.emplace_back(std::nullopt);
+                    continue;
+                }
+                chunks.set(op._offset, op._bits, static_cast<uint64_t>(*updated));
+                results.emplace_back(op._kind == kind::set ? old : *updated);
+            }
+            auto dirty = chunks.dirty_chunks();
+            if (dirty.empty()) {
+                return redis_message::make_long_array(results);
+            }
+            return redis::write_mutation(proxy, redis::make_bitmap_chunks(_schema, _key, std::move(dirty)), cl, timeout, cs).then_wrapped([results = std::move(results)] (auto f) {
+                try {
+                    f.get();
+                } catch (...) {
+                    return redis_message::err();
+                }
+                return redis_message::make_long_array(results);
+            });
+        });
+    };
+    if (_read_only) {
+        return run();
+    }
+    // SET and INCRBY write back the chunks they read, like SETBIT they are
+    // serialized per key.
+    return with_lock_on_owner(_schema, _key, std::move(run));
+}
+
+}
+}
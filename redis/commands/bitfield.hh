@@ -0,0 +1,43 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include <vector>
+#include <algorithm>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+// BITFIELD key [GET type offset] [SET type offset value] [INCRBY type offset increment] [OVERFLOW WRAP|SAT|FAIL]
+class bitfield : public command_with_single_schema {
+public:
+    enum class overflow { wrap, sat, fail };
+    enum class kind { get, set, incrby };
+    struct field_op {
+        kind _kind;
+        bool _signed;
+        unsigned _bits;
+        uint64_t _offset;
+        int64_t _value;
+        overflow _overflow;
+    };
+private:
+    bytes _key;
+    std::vector<field_op> _ops;
+    bool _read_only;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    bitfield(bytes&& name, const schema_ptr schema, bytes&& key, std::vector<field_op>&& ops)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _ops(std::move(ops))
+        , _read_only(std::all_of(_ops.begin(), _ops.end(), [] (auto& op) { return op._kind == kind::get; }))
+    {
+    }
+    ~bitfield() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
@@ -0,0 +1,169 @@
+#include "redis/commands/bitop.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "redis/bitmaps.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "seastar/core/future-util.hh"
+#include <boost/range/irange.hpp>
+#include <array>
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> bitop::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 3) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    operation op;
+    auto& name = req._args[0];
+    if (option_equals(name, "and")) {
+        op = operation::band;
+    } else if (option_equals(name, "or")) {
+        op = operation::bor;
+    } else if (option_equals(name, "xor")) {
+        op = operation::bxor;
+    } else if (option_equals(name, "not")) {
+        op = operation::bnot;
+    } else {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    if (op == operation::bnot && req._args_count != 3) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR BITOP NOT must be called with a single source key.\r\n"));
+    }
+    std::vector<bytes> keys;
+    keys.insert(keys.end(), std::make_move_iterator(req._args.begin() + 2), std::make_move_iterator(req._args.end()));
+    return seastar::make_shared<bitop>(std::move(req._command), bitmaps_schema(proxy, cs.get_keyspace()), op, std::move(req._args[1]), std::move(keys));
+}
+
+// The chunks combined and written per batch, so that the memory of BITOP is bounded
+// by the batch and the number of keys, whatever the length of the bitmaps.
+static constexpr int64_t batch_chunks = 64;
+
+static query::clustering_range make_chunks_range(const schema& s, int64_t first, int64_t last)
+{
+    auto from = clustering_key_prefix::from_single_value(s, long_type->decompose(first));
+    auto to = clustering_key_prefix::from_single_value(s, long_type->decompose(last));
+    return query::clustering_range::make({ std::move(from), true }, { std::move(to), true });
+}
+
+// Copies the chunk of a source into `out` (`n` bytes), the missing chunks and the
+// missing end of a short chunk are zeros.
+static void copy_chunk(const std::vector<std::pair<int64_t, bytes>>& chunks, int64_t index, uint8_t* out, size_t n)
+{
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), index, [] (auto& c, int64_t i) { return c.first < i; });
+    std::fill_n(out, n, 0);
+    if (it != chunks.end() && it->first == index) {
+        std::copy_n(reinterpret_cast<const uint8_t*>(it->second.data()), std::min(it->second.size(), n), out);
+    }
+}
+
+// Combines the chunks [first, last] of the sources, and replaces them in the destination.
+// The last batch also removes the chunks of the destination beyond the result.
+future<> bitop::combine(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs,
+    size_t length, int64_t first, int64_t last)
+{
+    using sources_type = std::vector<std::vector<std::pair<int64_t, bytes>>>;
+    return do_with(sources_type(_keys.size()), [this, &proxy, cl, timeout, &cs, length, first, last] (auto& sources) {
+        return parallel_for_each(boost::irange<size_t>(0, _keys.size()), [this, &proxy, cl, timeout, &cs, &sources, first, last] (size_t i) {
+            auto ranges = std::vector<query::clustering_range> { make_chunks_range(*_schema, first, last) };
+            return prefetch_bitmap(proxy, _schema, _keys[i], std::move(ranges), false, std::numeric_limits<uint32_t>::max(), cl, timeout, cs).then([&sources, i] (auto pd) {
+                sources[i] = std::move(pd->data());
+            });
+        }).then([this, &proxy, cl, timeout, &cs, &sources, length, first, last] {
+            auto op = _op == operation::band ? bitmaps::bitop::band : _op == operation::bor ? bitmaps::bitop::bor : bitmaps::bitop::bxor;
+            std::vector<std::pair<int64_t, bytes>> chunks;
+            std::array<uint8_t, bitmaps::chunk_size> src;
+            for (auto index = first; index <= last; ++index) {
+                auto offset = static_cast<size_t>(index) * bitmaps::chunk_size;
+                auto n = std::min(bitmaps::chunk_size, length - offset);
+                bytes chunk(bytes::initialized_later(), n);
+                auto out = reinterpret_cast<uint8_t*>(chunk.begin());
+                copy_chunk(sources.front(), index, out, n);
+                if (_op == operation::bnot) {
+                    bitmaps::invert(out, n);
+                } else {
+                    for (auto it = sources.begin() + 1; it != sources.end(); ++it) {
+                        copy_chunk(*it, index, src.data(), n);
+                        bitmaps::apply(op, out, src.data(), n);
+                    }
+                }
+                // Chunks of zeros are not written, except the last one which gives the length.
+                bool is_last = offset + n == length;
+                if (is_last || bitmaps::popcount(out, n) != 0) {
+                    chunks.emplace_back(std::make_pair(index, std::move(chunk)));
+                }
+            }
+            // The destination may be one of the sources, only the chunks read are replaced.
+            auto end = bitmaps::chunk_of(length - 1);
+            auto replaced = bitmap_chunks::replaced_range { first, last == end ? std::nullopt : std::optional<int64_t>(last) };
+            return redis::write_mutation(proxy, redis::make_bitmap_chunks(_schema, _destination, std::move(chunks), std::move(replaced)), cl, timeout, cs);
+        });
+    });
+}
+
+future<redis_message> bitop::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    // A source holding a string is not a bitmap, see bitmaps.hh.
+    auto strings = simple_objects_schema(proxy, cs.get_keyspace());
+    auto is_string = map_reduce(_keys.begin(), _keys.end(), [&proxy, strings, cl, timeout, &cs] (auto& key) {
+        return exists(proxy, strings, key, cl, timeout, cs);
+    }, false, std::bit_or<bool>());
+    // The length of a source is given by its last chunk.
+    auto length = map_reduce(_keys.begin(), _keys.end(), [this, &proxy, cl, timeout, &cs] (auto& key) {
+        auto all = std::vector<query::clustering_range> { query::clustering_range::make_open_ended_both_sides() };
+        return prefetch_bitmap(proxy, _schema, key, std::move(all), true, 1, cl, timeout, cs).then([] (auto pd) {
+            return static_cast<size_t>(bitmaps::chunked_bitmap(pd->data()).length());
+        });
+    }, size_t { 0 }, [] (size_t a, size_t b) {
+        return std::max(a, b);
+    });
+    return when_all(std::move(is_string), std::move(length)).then([this, &proxy, cl, timeout, &cs] (auto results) {
+        if (std::get<0>(results).get0()) {
+            return redis_message::wrong_type();
+        }
+        return execute_bitop(proxy, cl, timeout, cs, std::get<1>(results).get0());
+    }).handle_exception([] (auto ep) {
+        return redis_message::err();
+    });
+}
+
+future<redis_message> bitop::execute_bitop(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs, size_t length)
+{
+    return [this, &proxy, cl, timeout, &cs, length] {
+        if (length == 0) {
+            return redis::write_mutation(proxy, redis::make_dead(_schema, _destination), cl, timeout, cs).then([] {
+                return size_t { 0 };
+            });
+        }
+        auto end = bitmaps::chunk_of(length - 1);
+        return do_with(int64_t { 0 }, [this, &proxy, cl, timeout, &cs, length, end] (auto& first) {
+            return repeat([this, &proxy, cl, timeout, &cs, length, end, &first] {
+                if (first > end) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
+                auto last = std::min(first + batch_chunks - 1, end);
+                return combine(proxy, cl, timeout, cs, length, first, last).then([&first, last] {
+                    first = last + 1;
+                    return stop_iteration::no;
+                });
+            });
+        }).then([length] {
+            return length;
+        });
+    }().then_wrapped([] (auto f) {
+        try {
+            return redis_message::make_long(static_cast<long>(f.get0()));
+        } catch (...) {
+            return redis_message::err();
+        }
+    });
+}
+
+}
+}
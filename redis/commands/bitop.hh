@@ -0,0 +1,35 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+// BITOP AND|OR|XOR|NOT destkey key [key ...]
+class bitop : public command_with_single_schema {
+public:
+    enum class operation { band, bor, bxor, bnot };
+private:
+    operation _op;
+    bytes _destination;
+    std::vector<bytes> _keys;
+    future<redis_message> execute_bitop(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs, size_t length);
+    future<> combine(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs, size_t length, int64_t first, int64_t last);
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    bitop(bytes&& name, const schema_ptr schema, operation op, bytes&& destination, std::vector<bytes>&& keys)
+        : command_with_single_schema(std::move(name), schema)
+        , _op(op)
+        , _destination(std::move(destination))
+        , _keys(std::move(keys))
+    {
+    }
+    ~bitop() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
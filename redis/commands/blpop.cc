@@ -0,0 +1,191 @@
+#include "redis/commands/blpop.hh"
+#include "redis/commands/lpop.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "seastar/core/future-util.hh"
+namespace redis {
+namespace commands {
+
+static std::optional<long> parse_timeout(const bytes& b)
+{
+    if (!is_number(b)) {
+        return std::nullopt;
+    }
+    return static_cast<long>(bytes2double(b) * 1000);
+}
+
+template<typename PopType>
+shared_ptr<abstract_command> prepare_impl(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 2, req._args_count);
+    }
+    auto timeout = parse_timeout(req._args.back());
+    if (!timeout) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR timeout is not a float or out of range\r\n"));
+    }
+    if (*timeout < 0) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR timeout is negative\r\n"));
+    }
+    std::vector<bytes> keys;
+    keys.reserve(req._args.size() - 1);
+    keys.insert(keys.end(), std::make_move_iterator(req._args.begin()), std::make_move_iterator(req._args.end() - 1));
+    return seastar::make_shared<PopType>(std::move(req._command), lists_schema(proxy, cs.get_keyspace()), std::move(keys), *timeout);
+}
+
+shared_ptr<abstract_command> blpop::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    return prepare_impl<blpop>(proxy, cs, std::move(req));
+}
+
+shared_ptr<abstract_command> brpop::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    return prepare_impl<brpop>(proxy, cs, std::move(req));
+}
+
+shared_ptr<abstract_command> brpoplpush::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 3) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    auto timeout = parse_timeout(req._args[2]);
+    if (!timeout) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR timeout is not a float or out of range\r\n"));
+    }
+    if (*timeout < 0) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR timeout is negative\r\n"));
+    }
+    return seastar::make_shared<brpoplpush>(std::move(req._command), lists_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), std::move(req._args[1]), *timeout);
+}
+
+future<std::optional<std::pair<bytes, bytes>>> blocking_pop::try_pop(db::consistency_level cl, const timeout_config& tc)
+{
+    using popped_type = std::optional<std::pair<bytes, bytes>>;
+    return do_with(size_t { 0 }, popped_type {}, [this, cl, &tc] (auto& i, auto& popped) {
+        return repeat([this, cl, &tc, &i, &popped] {
+            if (i == _keys.size()) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            auto& key = _keys[i++];
+            return pop_element_on_owner(_schema, key, _left, _destination, cl, tc.write_timeout).then([&key, &popped] (auto removed) {
+                if (removed) {
+                    popped = std::make_pair(key, std::move(*removed));
+                    return stop_iteration::yes;
+                }
+                return stop_iteration::no;
+            });
+        }).then([this, &popped] {
+            if (popped && _destination) {
+                return serve_blocked_clients(_schema, *_destination, 1);
+            }
+            return make_ready_future<>();
+        }).then([&popped] {
+            return std::move(popped);
+        });
+    });
+}
+
+future<std::optional<std::pair<bytes, bytes>>> blocking_pop::do_execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    using popped_type = std::optional<std::pair<bytes, bytes>>;
+    using clock_type = blocked_clients::clock_type;
+    std::optional<clock_type::time_point> deadline;
+    if (_timeout > 0) {
+        deadline = clock_type::now() + std::chrono::milliseconds(_timeout);
+    }
+    // Fast path: one of the lists is not empty.
+    return try_pop(cl, tc).then([this, cl, &tc, deadline] (auto popped) {
+        auto& blocked = get_local_query_processor().get_blocked_clients();
+        if (popped || blocked.stopped()) {
+            return make_ready_future<popped_type>(std::move(popped));
+        }
+        // Blocked: the pushes hand us an element when we are the first waiter of
+        // the list. We are registered before every attempt of ours, and claim
+        // ourselves during it, so an element is never popped for us twice.
+        auto id = blocked.make_waiter();
+        auto pop = blocked_clients::list_pop { _left, _destination, cl, tc.write_timeout };
+        return do_with(popped_type {}, std::move(pop), [this, cl, &tc, deadline, &blocked, id] (auto& result, auto& pop) {
+            return repeat([this, cl, &tc, deadline, &blocked, id, &pop, &result] {
+                return register_blocked_client(_schema, _keys, id, pop).then([this, cl, &tc, &blocked, id] {
+                    if (!blocked.claim(id)) {
+                        return make_ready_future<popped_type>();
+                    }
+                    return try_pop(cl, tc).finally([&blocked, id] {
+                        blocked.unclaim(id);
+                    });
+                }).then([deadline, &blocked, id, &result] (popped_type popped) {
+                    if (!popped) {
+                        popped = blocked.take_served(id);
+                    }
+                    if (popped) {
+                        result = std::move(popped);
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    }
+                    if (blocked.stopped()) {
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    }
+                    // A push is popping for us, the element is ours even past the deadline.
+                    if (blocked.claimed(id)) {
+                        return blocked.wait(id, std::nullopt).then([] {
+                            return stop_iteration::no;
+                        });
+                    }
+                    if (deadline && clock_type::now() >= *deadline) {
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    }
+                    return blocked.wait(id, deadline).then([] {
+                        return stop_iteration::no;
+                    });
+                });
+            }).finally([this, &blocked, id, &result] {
+                if (!result) {
+                    result = blocked.take_served(id);
+                }
+                // Served after this, the push puts the element back.
+                blocked.drop(id);
+                return unregister_blocked_client(_schema, _keys, id);
+            }).then([&result] {
+                return std::move(result);
+            });
+        });
+    });
+}
+
+future<redis_message> blocking_pop::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    return do_execute(proxy, cl, now, tc, cs).then_wrapped([&cs] (auto f) {
+        try {
+            auto popped = f.get0();
+            if (popped) {
+                auto result = make_lw_shared<std::vector<std::optional<bytes>>>();
+                result->emplace_back(std::move(popped->first));
+                result->emplace_back(std::move(popped->second));
+                return redis_message::make_zset_bytes(result);
+            }
+        } catch (...) {
+            return redis_message::err();
+        }
+        return redis_message::null_array(cs.get_redis_protocol_version());
+    });
+}
+
+future<redis_message> brpoplpush::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    // The element was pushed to the destination along with the pop.
+    return do_execute(proxy, cl, now, tc, cs).then([&cs] (auto popped) {
+        if (!popped) {
+            return redis_message::null(cs.get_redis_protocol_version());
+        }
+        return redis_message::make_bytes(popped->second);
+    }).handle_exception([] (auto ep) {
+        return redis_message::err();
+    });
+}
+
+}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include "redis/blocked_clients.hh"
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+// Pops from the first non-empty list of the keys. If all lists are empty, the
+// client is blocked until an element is pushed to one of them, or the timeout
+// (in seconds, zero means forever) is reached.
+class blocking_pop : public command_with_single_schema {
+protected:
+    std::vector<bytes> _keys;
+    long _timeout; // in milliseconds
+    bool _left;
+    // BRPOPLPUSH, the popped element is pushed to this list in the same batch.
+    std::optional<bytes> _destination;
+    future<std::optional<std::pair<bytes, bytes>>> try_pop(db::consistency_level, const timeout_config& tc);
+    future<std::optional<std::pair<bytes, bytes>>> do_execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs);
+public:
+    blocking_pop(bytes&& name, const schema_ptr schema, std::vector<bytes>&& keys, long timeout, bool left, std::optional<bytes> destination = std::nullopt)
+        : command_with_single_schema(std::move(name), schema)
+        , _keys(std::move(keys))
+        , _timeout(timeout)
+        , _left(left)
+        , _destination(std::move(destination))
+    {
+    }
+    ~blocking_pop() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+class blpop : public blocking_pop {
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    blpop(bytes&& name, const schema_ptr schema, std::vector<bytes>&& keys, long timeout) : blocking_pop(std::move(name), schema, std::move(keys), timeout, true) {}
+};
+
+class brpop : public blocking_pop {
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    brpop(bytes&& name, const schema_ptr schema, std::vector<bytes>&& keys, long timeout) : blocking_pop(std::move(name), schema, std::move(keys), timeout, false) {}
+};
+
+class brpoplpush : public blocking_pop {
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    brpoplpush(bytes&& name, const schema_ptr schema, bytes&& source, bytes&& destination, long timeout)
+        : blocking_pop(std::move(name), schema, std::vector<bytes> { std::move(source) }, timeout, false, std::move(destination))
+    {
+    }
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
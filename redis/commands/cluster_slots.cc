@@ -4,11 +4,15 @@
 #include "redis/request.hh"
 #include "redis/redis_mutation.hh"
 #include "redis/reply.hh"
-#include "db/system_keyspace.hh"
+#include "redis/cluster.hh"
+#include "redis/prefetcher.hh"
+#include "redis/query_processor.hh"
 #include "types.hh"
 #include "service/storage_proxy.hh"
 #include "service/client_state.hh"
 #include "timeout_config.hh"
+#include "service/storage_service.hh"
+#include "utils/fb_utilities.hh"
 namespace service {
 class storage_proxy;
 }
@@ -16,40 +20,90 @@ namespace redis {
 
 namespace commands {
 
-static const bytes slots {"slots"};
+static const std::unordered_map<bytes, std::pair<cluster_slots::subcommand, size_t>> subcommands {
+    { "slots", { cluster_slots::subcommand::slots, 1 } },
+    { "nodes", { cluster_slots::subcommand::nodes, 1 } },
+    { "keyslot", { cluster_slots::subcommand::keyslot, 2 } },
+    { "countkeysinslot", { cluster_slots::subcommand::countkeysinslot, 2 } },
+};
+
 shared_ptr<abstract_command> cluster_slots::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
 {
-    if (req._args_count != 1) {
+    if (req._args_count < 1) {
         return unexpected::make_exception(std::move(req._command), sprint("-wrong number of arguments (given %ld, expected 1)\r\n", req._args_count));
     }
-    auto& slots = req._args[0];
-    std::transform(slots.begin(), slots.end(), slots.begin(), ::tolower);
-    if (slots != slots) {
-        return unexpected::make_exception(std::move(req._command), sprint("-unknown cluster command '%s'\r\n", slots));
+    auto name = req._args[0];
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    auto it = subcommands.find(name);
+    if (it == subcommands.end()) {
+        return unexpected::make_exception(std::move(req._command), sprint("-unknown cluster command '%s'\r\n", req._args[0]));
+    }
+    if (req._args_count != it->second.second) {
+        return unexpected::make_exception(std::move(req._command), sprint("-wrong number of arguments (given %ld, expected %ld)\r\n", req._args_count, it->second.second));
+    }
+    bytes key;
+    uint16_t slot = 0;
+    if (it->second.first == subcommand::keyslot) {
+        key = std::move(req._args[1]);
+    } else if (it->second.first == subcommand::countkeysinslot) {
+        auto s = try_bytes2long(req._args[1]);
+        if (!s || *s < 0 || *s >= cluster_slots_count) {
+            return unexpected::make_exception(std::move(req._command), "-ERR Invalid slot\r\n");
+        }
+        slot = uint16_t(*s);
     }
-    return seastar::make_shared<cluster_slots> (std::move(req._command));
+    return seastar::make_shared<cluster_slots> (std::move(req._command), it->second.first, std::move(key), slot);
 }
 
+// A line of CLUSTER NODES, every node is a master of the slots of which it is
+// the primary replica.
+static sstring node_line(const cluster_node& node, const std::vector<slot_range>& ranges, long ring_version)
+{
+    auto myself = node._endpoint == utils::fb_utilities::get_broadcast_address();
+    auto line = sprint("%s %s:%d@%d %s - 0 0 %ld connected", node._id, node._address, node._port, node._port + 10000,
+        myself ? "myself,master" : "master", ring_version);
+    for (auto& r : ranges) {
+        if (r._replicas.front()._endpoint != node._endpoint) {
+            continue;
+        }
+        line += r._first == r._last ? sprint(" %d", r._first) : sprint(" %d-%d", r._first, r._last);
+    }
+    return line + "\n";
+}
+
+// The tables of the keys, the indexes of the sorted sets and the groups of the
+// streams have the keys of their zset and stream.
+static const std::vector<sstring> key_tables { STRINGS, LISTS, SETS, MAPS, ZSETS, STREAMS, BITMAPS };
+
 future<redis_message> cluster_slots::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
-{   
-    static size_t REDIS_CLUSTER_SLOTS = 16384;
-    return db::system_keyspace::load_peers().then([&proxy] (auto&& peers) {
-        return gms::inet_address::lookup(proxy.get_db().local().get_config().listen_address()).then([peers = std::move(peers), &proxy] (auto&& local) mutable {
-            peers.emplace_back(local);
-            auto slots_per_peer = REDIS_CLUSTER_SLOTS / peers.size();
-            using slots_type = std::vector<std::tuple<size_t, size_t, bytes, uint16_t>>;
-            lw_shared_ptr<slots_type> ret = make_lw_shared<slots_type>();
-            auto port = proxy.get_db().local().get_config().redis_transport_port();
-            size_t start = 0;
-            for (auto& peer : peers) {
-                auto end = start + slots_per_peer - 1;
-                if (end >= (REDIS_CLUSTER_SLOTS - slots_per_peer)) {
-                    end = REDIS_CLUSTER_SLOTS - 1;
-                }
-                ret->emplace_back(std::tuple<size_t, size_t, bytes, uint16_t> (start, end, to_bytes(peer.to_sstring()), uint16_t { port }));
-                start = end + 1;
-            }
-            return redis_message::make_slots(ret);
+{
+    auto& db = proxy.get_db().local();
+    auto& slots = get_local_query_processor().get_slot_map();
+    switch (_subcommand) {
+    case subcommand::slots:
+        return redis_message::make_slots(make_lw_shared<std::vector<slot_range>>(slots.get(db, cs.get_keyspace())));
+    case subcommand::nodes: {
+        auto& ranges = slots.get(db, cs.get_keyspace());
+        auto ring_version = service::get_local_storage_service().get_token_metadata().get_ring_version();
+        sstring nodes;
+        for (auto& node : slots.nodes()) {
+            nodes += node_line(node, ranges, ring_version);
+        }
+        return redis_message::make_bytes(to_bytes(nodes));
+    }
+    case subcommand::keyslot:
+        return redis_message::make_long(hash_slot(_key));
+    case subcommand::countkeysinslot:
+        break;
+    }
+    auto timeout = now + tc.read_timeout;
+    return do_with(uint64_t(0), [this, &proxy, &db, cl, timeout, &cs] (auto& count) {
+        return parallel_for_each(key_tables, [this, &proxy, &db, cl, timeout, &cs, &count] (auto& table) {
+            return count_keys_in_slot(proxy, db.find_schema(cs.get_keyspace(), table), _slot, cl, timeout, cs).then([&count] (uint64_t keys) {
+                count += keys;
+            });
+        }).then([&count] {
+            return redis_message::make_long(count);
         });
     });
 }
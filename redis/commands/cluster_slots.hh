@@ -8,10 +8,22 @@ class result;
 class timeout_config;
 namespace redis {
 namespace commands {
+// CLUSTER SLOTS, NODES, KEYSLOT and COUNTKEYSINSLOT, the slots owned by the
+// replicas of their token ranges.
 class cluster_slots : public abstract_command {
+public:
+    enum class subcommand { slots, nodes, keyslot, countkeysinslot };
+private:
+    subcommand _subcommand;
+    bytes _key;
+    uint16_t _slot;
 public:
     static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
-    cluster_slots(bytes&& name) : abstract_command(std::move(name)) 
+    cluster_slots(bytes&& name, subcommand c, bytes&& key, uint16_t slot)
+        : abstract_command(std::move(name))
+        , _subcommand(c)
+        , _key(std::move(key))
+        , _slot(slot)
     {
     }
     ~cluster_slots() {}
@@ -0,0 +1,72 @@
+#include "redis/commands/copy.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/key_copy.hh"
+#include "redis/near_cache.hh"
+#include "redis/query_processor.hh"
+#include "redis/rdb.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "database.hh"
+#include <boost/lexical_cast.hpp>
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> copy::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 2, req._args_count);
+    }
+    auto keyspace = cs.get_keyspace();
+    bool replace = false;
+    for (size_t i = 2; i < req._args.size(); ++i) {
+        if (option_equals(req._args[i], "replace")) {
+            replace = true;
+        } else if (option_equals(req._args[i], "db") && i + 1 < req._args.size()) {
+            auto& db = req._args[++i];
+            try {
+                keyspace = keyspace_of_db(boost::lexical_cast<uint64_t>(sstring(reinterpret_cast<const char*>(db.data()), db.size())));
+            } catch (boost::bad_lexical_cast&) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR value is not an integer or out of range\r\n"));
+            }
+            if (!proxy.get_db().local().has_keyspace(keyspace)) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR DB index is out of range\r\n"));
+            }
+        } else {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+        }
+    }
+    if (keyspace == cs.get_keyspace() && req._args[0] == req._args[1]) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR source and destination objects are the same\r\n"));
+    }
+    return seastar::make_shared<copy>(std::move(req._command), std::move(req._args[0]), std::move(req._args[1]), std::move(keyspace), replace);
+}
+
+future<redis_message> copy::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto& qp = get_local_query_processor();
+    auto from = qp.schemas_of(cs.get_keyspace());
+    auto to = qp.schemas_of(_keyspace);
+    auto read_timeout = now + tc.read_timeout;
+    auto taken = _replace ? make_ready_future<bool>(false) : key_exists(proxy, to, _new_key, cl, read_timeout, cs);
+    return taken.then([this, &proxy, from, to, cl, read_timeout, write_timeout = now + tc.write_timeout, &cs] (bool taken) {
+        if (taken) {
+            return make_ready_future<bool>(false);
+        }
+        return copy_key(proxy, from, _key, to, _new_key, false, cl, read_timeout, write_timeout, cs);
+    }).then([this, &cs] (bool copied) {
+        if (!copied) {
+            return redis_message::zero();
+        }
+        // The key of another database is not invalidated with the command.
+        auto invalidated = _keyspace != cs.get_keyspace() ? invalidate_near_caches(_keyspace, { _new_key }) : make_ready_future<>();
+        return invalidated.then([] {
+            return redis_message::one();
+        });
+    });
+}
+
+}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// COPY source destination [DB destination-db] [REPLACE], the partitions of the
+// key are copied as they are stored.
+class copy : public abstract_command {
+    bytes _key;
+    bytes _new_key;
+    // The keyspace of the destination.
+    sstring _keyspace;
+    bool _replace;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    copy(bytes&& name, bytes&& key, bytes&& new_key, sstring&& keyspace, bool replace)
+        : abstract_command(std::move(name))
+        , _key(std::move(key))
+        , _new_key(std::move(new_key))
+        , _keyspace(std::move(keyspace))
+        , _replace(replace)
+    {
+    }
+    ~copy() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
@@ -28,7 +28,11 @@ shared_ptr<abstract_command> del::prepare(service::storage_proxy& proxy, const s
         lists_schema(proxy, cs.get_keyspace()),
         sets_schema(proxy, cs.get_keyspace()),
         maps_schema(proxy, cs.get_keyspace()),
-        zsets_schema(proxy, cs.get_keyspace())
+        zsets_schema(proxy, cs.get_keyspace()),
+        streams_schema(proxy, cs.get_keyspace()),
+        stream_groups_schema(proxy, cs.get_keyspace()),
+        bitmaps_schema(proxy, cs.get_keyspace()),
+        zset_scores_schema(proxy, cs.get_keyspace())
     };
     return seastar::make_shared<del> (std::move(req._command), std::move(schemas), std::move(req._args[0]));
 }
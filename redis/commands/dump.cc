@@ -0,0 +1,33 @@
+#include "redis/commands/dump.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/rdb.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> dump::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 1) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    return seastar::make_shared<dump>(std::move(req._command), std::move(req._args[0]));
+}
+
+future<redis_message> dump::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto& schemas = get_local_query_processor().schemas_of(cs.get_keyspace());
+    return read_rdb_entry(proxy, schemas, _key, cl, now + tc.read_timeout, cs).then([&cs] (std::optional<rdb_entry> e) {
+        if (!e) {
+            return redis_message::null(cs.get_redis_protocol_version());
+        }
+        return redis_message::make_bytes(rdb_writer().dump(*e));
+    });
+}
+
+}
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// DUMP key, the value of a string, list, set, hash or sorted set serialized
+// as Redis does, for RESTORE on this cluster, another one or Redis.
+class dump : public abstract_command {
+    bytes _key;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    dump(bytes&& name, bytes&& key)
+        : abstract_command(std::move(name))
+        , _key(std::move(key))
+    {
+    }
+    ~dump() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
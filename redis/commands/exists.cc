@@ -22,7 +22,9 @@ shared_ptr<abstract_command> exists::prepare(service::storage_proxy& proxy, cons
         lists_schema(proxy, cs.get_keyspace()),
         sets_schema(proxy, cs.get_keyspace()),
         maps_schema(proxy, cs.get_keyspace()),
-        zsets_schema(proxy, cs.get_keyspace())
+        zsets_schema(proxy, cs.get_keyspace()),
+        streams_schema(proxy, cs.get_keyspace()),
+        bitmaps_schema(proxy, cs.get_keyspace())
     };
     return seastar::make_shared<exists> (std::move(req._command), std::move(schemas), std::move(req._args[0]));
 }
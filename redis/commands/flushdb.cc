@@ -0,0 +1,65 @@
+#include "redis/commands/flushdb.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "database.hh"
+#include "seastar/core/future-util.hh"
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> flushdb::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count > 1 || (req._args_count == 1 && !option_equals(req._args[0], "async") && !option_equals(req._args[0], "sync"))) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    std::vector<sstring> keyspaces;
+    if (req._command == bytes("flushall")) {
+        for (auto& ks : proxy.get_db().local().get_keyspaces()) {
+            if (ks.first.find(REDIS_DATABASE_NAME_PREFIX) == 0) {
+                keyspaces.push_back(ks.first);
+            }
+        }
+    } else {
+        keyspaces.push_back(cs.get_keyspace());
+    }
+    return seastar::make_shared<flushdb>(std::move(req._command), std::move(keyspaces));
+}
+
+future<redis_message> flushdb::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto& db = proxy.get_db().local();
+    std::vector<std::pair<sstring, sstring>> tables;
+    for (auto& ks : _keyspaces) {
+        for (auto& cf : db.find_keyspace(ks).metadata()->cf_meta_data()) {
+            tables.emplace_back(ks, cf.first);
+        }
+    }
+    // The node running FLUSHDB decides the snapshot for all the nodes.
+    auto with_snapshot = db.get_config().redis_flush_auto_snapshot();
+    return do_with(std::move(tables), [&proxy, with_snapshot] (auto& tables) {
+        return parallel_for_each(tables, [&proxy, with_snapshot] (auto& t) {
+            return proxy.truncate_blocking(t.first, t.second, with_snapshot);
+        });
+    }).then([] {
+        // The tracking clients are told to drop all their keys, the tracking
+        // is not by keyspace.
+        return get_query_processor().invoke_on_all([] (auto& qp) {
+            qp.get_near_cache().invalidate_all();
+            qp.get_client_tracking().invalidate_all();
+        });
+    }).then_wrapped([] (auto f) {
+        try {
+            f.get();
+        } catch (std::exception& e) {
+            return redis_message::make_exception(sprint("-ERR %s\r\n", e.what()));
+        }
+        return redis_message::ok();
+    });
+}
+
+}
+}
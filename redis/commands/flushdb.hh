@@ -0,0 +1,26 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// FLUSHDB and FLUSHALL [ASYNC | SYNC], truncate the tables of the selected
+// keyspace, or of every redis keyspace, on all the nodes. The truncation does
+// not write a tombstone per key, ASYNC is accepted and flushes the same way.
+class flushdb : public abstract_command {
+    // The keyspaces to flush.
+    std::vector<sstring> _keyspaces;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    flushdb(bytes&& name, std::vector<sstring>&& keyspaces)
+        : abstract_command(std::move(name))
+        , _keyspaces(std::move(keyspaces))
+    {
+    }
+    ~flushdb() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
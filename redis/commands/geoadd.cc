@@ -0,0 +1,122 @@
+#include "redis/commands/geoadd.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "redis/geo.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include <unordered_map>
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> geoadd::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 4) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 4, req._args_count);
+    }
+    bool nx = false, xx = false, ch = false;
+    size_t i = 1;
+    for (; i < req._args_count; ++i) {
+        if (option_equals(req._args[i], "nx")) {
+            nx = true;
+        } else if (option_equals(req._args[i], "xx")) {
+            xx = true;
+        } else if (option_equals(req._args[i], "ch")) {
+            ch = true;
+        } else {
+            break;
+        }
+    }
+    if (nx && xx) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR XX and NX options at the same time are not compatible\r\n"));
+    }
+    if (i == req._args_count || (req._args_count - i) % 3 != 0) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    std::vector<std::pair<bytes, uint64_t>> members;
+    // The last position of a member given twice wins.
+    std::unordered_map<bytes, size_t> positions;
+    for (; i < req._args_count; i += 3) {
+        if (!is_number(req._args[i]) || !is_number(req._args[i + 1])) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR value is not a valid float\r\n"));
+        }
+        auto lon = bytes2double(req._args[i]);
+        auto lat = bytes2double(req._args[i + 1]);
+        if (!geo::valid_position(lon, lat)) {
+            return unexpected::make_exception(std::move(req._command), sstring(sprint("-ERR invalid longitude,latitude pair %f,%f\r\n", lon, lat)));
+        }
+        auto it = positions.find(req._args[i + 2]);
+        if (it != positions.end()) {
+            members[it->second].second = geo::encode(lon, lat);
+            continue;
+        }
+        positions.emplace(req._args[i + 2], members.size());
+        members.emplace_back(std::move(req._args[i + 2]), geo::encode(lon, lat));
+    }
+    std::vector<schema_ptr> schemas {
+        zsets_schema(proxy, cs.get_keyspace()),
+        zset_scores_schema(proxy, cs.get_keyspace())
+    };
+    return seastar::make_shared<geoadd>(std::move(req._command), std::move(schemas), std::move(req._args[0]), std::move(members), nx, xx, ch);
+}
+
+future<redis_message> geoadd::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    std::vector<bytes> keys;
+    keys.reserve(_members.size());
+    for (auto& m : _members) {
+        keys.emplace_back(m.first);
+    }
+    // The previous scores are needed to move the members within the score index.
+    return prefetch_map(proxy, _schemas[0], _key, std::move(keys), fetch_options::all, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+        std::unordered_map<bytes, double> previous;
+        for (auto& e : pd->data()) {
+            previous.emplace(*e.first, bytes2double(*e.second));
+        }
+        std::vector<std::pair<bytes, bytes>> cells;
+        std::vector<std::pair<double, bytes>> index_cells;
+        std::vector<std::pair<double, bytes>> dead_index_cells;
+        long changed = 0;
+        for (auto& m : _members) {
+            auto score = static_cast<double>(m.second);
+            auto it = previous.find(m.first);
+            bool exists = it != previous.end();
+            if ((_nx && exists) || (_xx && !exists)) {
+                continue;
+            }
+            if (exists && it->second == score) {
+                continue;
+            }
+            if (exists) {
+                dead_index_cells.emplace_back(it->second, m.first);
+            }
+            if (!exists || _ch) {
+                ++changed;
+            }
+            cells.emplace_back(m.first, double2bytes(score));
+            index_cells.emplace_back(score, m.first);
+            previous[m.first] = score;
+        }
+        if (cells.empty()) {
+            return redis_message::make_long(changed);
+        }
+        return redis::write_mutation(proxy,
+            redis::make_zset_cells(_schemas[0], _key, std::move(cells)),
+            redis::make_zset_score_cells(_schemas[1], _key, std::move(index_cells), std::move(dead_index_cells)),
+            cl, timeout, cs).then_wrapped([changed] (auto f) {
+            try {
+                f.get();
+            } catch (...) {
+                return redis_message::err();
+            }
+            return redis_message::make_long(changed);
+        });
+    });
+}
+
+}
+}
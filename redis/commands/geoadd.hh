@@ -0,0 +1,36 @@
+#pragma once
+#include "redis/command_with_multi_schemas.hh"
+#include "redis/request.hh"
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+// GEOADD key [NX|XX] [CH] longitude latitude member [longitude latitude member ...]
+// The members are written to the sorted set (_schemas[0]) and to its score index (_schemas[1]).
+class geoadd : public command_with_multi_schemas {
+    bytes _key;
+    // The member and its score.
+    std::vector<std::pair<bytes, uint64_t>> _members;
+    bool _nx;
+    bool _xx;
+    bool _ch;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    geoadd(bytes&& name, std::vector<schema_ptr>&& schemas, bytes&& key, std::vector<std::pair<bytes, uint64_t>>&& members, bool nx, bool xx, bool ch)
+        : command_with_multi_schemas(std::move(name), std::move(schemas))
+        , _key(std::move(key))
+        , _members(std::move(members))
+        , _nx(nx)
+        , _xx(xx)
+        , _ch(ch)
+    {
+    }
+    ~geoadd() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
@@ -0,0 +1,115 @@
+#include "redis/commands/geopos.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/prefetcher.hh"
+#include "redis/geo.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include <unordered_map>
+namespace redis {
+namespace commands {
+
+future<std::vector<std::optional<uint64_t>>> fetch_geo_scores(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    std::vector<bytes> members,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    return prefetch_map(proxy, schema, key, members, fetch_options::all, cl, timeout, cs).then([members = std::move(members)] (auto pd) {
+        std::unordered_map<bytes, uint64_t> scores;
+        for (auto& e : pd->data()) {
+            scores.emplace(*e.first, static_cast<uint64_t>(bytes2double(*e.second)));
+        }
+        std::vector<std::optional<uint64_t>> result;
+        result.reserve(members.size());
+        for (auto& m : members) {
+            auto it = scores.find(m);
+            result.emplace_back(it != scores.end() ? std::optional<uint64_t>(it->second) : std::nullopt);
+        }
+        return result;
+    });
+}
+
+template<typename CommandType>
+static shared_ptr<abstract_command> prepare_impl(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 2, req._args_count);
+    }
+    std::vector<bytes> members;
+    members.insert(members.end(), std::make_move_iterator(req._args.begin() + 1), std::make_move_iterator(req._args.end()));
+    return seastar::make_shared<CommandType>(std::move(req._command), zsets_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), std::move(members));
+}
+
+shared_ptr<abstract_command> geopos::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    return prepare_impl<geopos>(proxy, cs, std::move(req));
+}
+
+future<redis_message> geopos::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    return fetch_geo_scores(proxy, _schema, _key, _members, cl, timeout, cs).then([] (auto scores) {
+        std::vector<std::optional<std::pair<double, double>>> positions;
+        positions.reserve(scores.size());
+        for (auto& s : scores) {
+            positions.emplace_back(s ? std::optional<std::pair<double, double>>(geo::decode(*s)) : std::nullopt);
+        }
+        return redis_message::make_geo_positions(positions);
+    });
+}
+
+shared_ptr<abstract_command> geohash::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    return prepare_impl<geohash>(proxy, cs, std::move(req));
+}
+
+future<redis_message> geohash::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    return fetch_geo_scores(proxy, _schema, _key, _members, cl, timeout, cs).then([] (auto scores) {
+        auto result = make_lw_shared<std::vector<std::optional<bytes>>>();
+        for (auto& s : scores) {
+            result->emplace_back(s ? std::optional<bytes>(geo::to_geohash_string(*s)) : std::nullopt);
+        }
+        return redis_message::make_zset_bytes(result);
+    });
+}
+
+shared_ptr<abstract_command> geodist::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 3 && req._args_count != 4) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    double unit = 1.0;
+    if (req._args_count == 4) {
+        auto u = geo::parse_unit(req._args[3]);
+        if (!u) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR unsupported unit provided. please use M, KM, FT, MI\r\n"));
+        }
+        unit = *u;
+    }
+    std::vector<bytes> members { std::move(req._args[1]), std::move(req._args[2]) };
+    return seastar::make_shared<geodist>(std::move(req._command), zsets_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), std::move(members), unit);
+}
+
+future<redis_message> geodist::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    return fetch_geo_scores(proxy, _schema, _key, _members, cl, timeout, cs).then([this, &cs] (auto scores) {
+        if (!scores[0] || !scores[1]) {
+            return redis_message::null(cs.get_redis_protocol_version());
+        }
+        auto p1 = geo::decode(*scores[0]);
+        auto p2 = geo::decode(*scores[1]);
+        auto d = geo::distance(p1.first, p1.second, p2.first, p2.second) / _unit;
+        return redis_message::make_bytes(to_bytes(sprint("%.4f", d)));
+    });
+}
+
+}
+}
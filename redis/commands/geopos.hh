@@ -0,0 +1,73 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include <optional>
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+
+// Returns the geohash scores of the members, in the order of `members`, nothing for a missing member.
+future<std::vector<std::optional<uint64_t>>> fetch_geo_scores(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    std::vector<bytes> members,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs);
+
+// GEOPOS key member [member ...]
+class geopos : public command_with_single_schema {
+    bytes _key;
+    std::vector<bytes> _members;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    geopos(bytes&& name, const schema_ptr schema, bytes&& key, std::vector<bytes>&& members)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _members(std::move(members))
+    {
+    }
+    ~geopos() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+// GEOHASH key member [member ...]
+class geohash : public command_with_single_schema {
+    bytes _key;
+    std::vector<bytes> _members;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    geohash(bytes&& name, const schema_ptr schema, bytes&& key, std::vector<bytes>&& members)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _members(std::move(members))
+    {
+    }
+    ~geohash() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+// GEODIST key member1 member2 [m|km|ft|mi]
+class geodist : public command_with_single_schema {
+    bytes _key;
+    std::vector<bytes> _members;
+    double _unit;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    geodist(bytes&& name, const schema_ptr schema, bytes&& key, std::vector<bytes>&& members, double unit)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _members(std::move(members))
+        , _unit(unit)
+    {
+    }
+    ~geodist() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
@@ -0,0 +1,304 @@
+#include "redis/commands/georadius.hh"
+#include "redis/commands/geopos.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/prefetcher.hh"
+#include "redis/redis_mutation.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+// Parses one of the options shared by GEORADIUS and GEOSEARCH at args[i]. Returns the
+// number of arguments consumed, 0 if args[i] is not such an option.
+static size_t parse_search_option(const std::vector<bytes>& args, size_t i, geo_search_options& options, bool& error)
+{
+    auto& arg = args[i];
+    if (option_equals(arg, "withcoord")) {
+        options._with_coord = true;
+    } else if (option_equals(arg, "withdist")) {
+        options._with_dist = true;
+    } else if (option_equals(arg, "withhash")) {
+        options._with_hash = true;
+    } else if (option_equals(arg, "asc")) {
+        options._order = 1;
+    } else if (option_equals(arg, "desc")) {
+        options._order = -1;
+    } else if (option_equals(arg, "any")) {
+        options._any = true;
+    } else if (option_equals(arg, "count")) {
+        std::optional<long> count;
+        if (i + 1 < args.size()) {
+            count = try_bytes2long(args[i + 1]);
+        }
+        if (!count || *count <= 0) {
+            error = true;
+            return 0;
+        }
+        options._count = *count;
+        return 2;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static std::optional<double> parse_double(const bytes& b)
+{
+    if (!is_number(b)) {
+        return std::nullopt;
+    }
+    return bytes2double(b);
+}
+
+static std::vector<schema_ptr> geo_schemas(service::storage_proxy& proxy, const service::client_state& cs)
+{
+    return std::vector<schema_ptr> {
+        zsets_schema(proxy, cs.get_keyspace()),
+        zset_scores_schema(proxy, cs.get_keyspace())
+    };
+}
+
+// GEORADIUS and GEORADIUSBYMEMBER, the center is given in `center_args` arguments after the key.
+template<typename CommandType>
+static shared_ptr<abstract_command> prepare_radius(service::storage_proxy& proxy, const service::client_state& cs, request&& req, size_t center_args)
+{
+    if (req._args_count < center_args + 3) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), center_args + 3, req._args_count);
+    }
+    auto& args = req._args;
+    geo::shape shape;
+    std::optional<bytes> member;
+    if (center_args == 2) {
+        auto lon = parse_double(args[1]);
+        auto lat = parse_double(args[2]);
+        if (!lon || !lat) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR value is not a valid float\r\n"));
+        }
+        if (!geo::valid_position(*lon, *lat)) {
+            return unexpected::make_exception(std::move(req._command), sstring(sprint("-ERR invalid longitude,latitude pair %f,%f\r\n", *lon, *lat)));
+        }
+        shape._lon = *lon;
+        shape._lat = *lat;
+    } else {
+        member = args[1];
+    }
+    auto radius = parse_double(args[center_args + 1]);
+    if (!radius || *radius < 0) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR need numeric radius\r\n"));
+    }
+    auto unit = geo::parse_unit(args[center_args + 2]);
+    if (!unit) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR unsupported unit provided. please use M, KM, FT, MI\r\n"));
+    }
+    geo_search_options options;
+    options._unit = *unit;
+    shape._radius = *radius * *unit;
+    for (size_t i = center_args + 3; i < args.size(); ) {
+        bool error = false;
+        auto n = parse_search_option(args, i, options, error);
+        if (error) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR COUNT must be > 0\r\n"));
+        }
+        if (n == 0) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+        }
+        i += n;
+    }
+    if (options._any && !options._count) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR the ANY argument requires COUNT argument\r\n"));
+    }
+    return seastar::make_shared<CommandType>(std::move(req._command), geo_schemas(proxy, cs), std::move(args[0]), std::move(member), shape, options);
+}
+
+shared_ptr<abstract_command> georadius::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    return prepare_radius<georadius>(proxy, cs, std::move(req), 2);
+}
+
+shared_ptr<abstract_command> georadiusbymember::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    return prepare_radius<georadiusbymember>(proxy, cs, std::move(req), 1);
+}
+
+shared_ptr<abstract_command> geosearch::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 1) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    auto& args = req._args;
+    geo::shape shape;
+    std::optional<bytes> member;
+    geo_search_options options;
+    bool has_from = false, has_by = false;
+    for (size_t i = 1; i < args.size(); ) {
+        auto& arg = args[i];
+        if (option_equals(arg, "frommember") && i + 1 < args.size() && !has_from) {
+            member = args[i + 1];
+            has_from = true;
+            i += 2;
+        } else if (option_equals(arg, "fromlonlat") && i + 2 < args.size() && !has_from) {
+            auto lon = parse_double(args[i + 1]);
+            auto lat = parse_double(args[i + 2]);
+            if (!lon || !lat) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR value is not a valid float\r\n"));
+            }
+            if (!geo::valid_position(*lon, *lat)) {
+                return unexpected::make_exception(std::move(req._command), sstring(sprint("-ERR invalid longitude,latitude pair %f,%f\r\n", *lon, *lat)));
+            }
+            shape._lon = *lon;
+            shape._lat = *lat;
+            has_from = true;
+            i += 3;
+        } else if (option_equals(arg, "byradius") && i + 2 < args.size() && !has_by) {
+            auto radius = parse_double(args[i + 1]);
+            auto unit = geo::parse_unit(args[i + 2]);
+            if (!radius || *radius < 0) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR need numeric radius\r\n"));
+            }
+            if (!unit) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR unsupported unit provided. please use M, KM, FT, MI\r\n"));
+            }
+            shape._radius = *radius * *unit;
+            options._unit = *unit;
+            has_by = true;
+            i += 3;
+        } else if (option_equals(arg, "bybox") && i + 3 < args.size() && !has_by) {
+            auto width = parse_double(args[i + 1]);
+            auto height = parse_double(args[i + 2]);
+            auto unit = geo::parse_unit(args[i + 3]);
+            if (!width || !height || *width < 0 || *height < 0) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR need numeric width and height\r\n"));
+            }
+            if (!unit) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR unsupported unit provided. please use M, KM, FT, MI\r\n"));
+            }
+            shape._box = true;
+            shape._width = *width * *unit;
+            shape._height = *height * *unit;
+            options._unit = *unit;
+            has_by = true;
+            i += 4;
+        } else {
+            bool error = false;
+            auto n = parse_search_option(args, i, options, error);
+            if (error) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR COUNT must be > 0\r\n"));
+            }
+            if (n == 0) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+            }
+            i += n;
+        }
+    }
+    if (!has_from) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR exactly one of FROMMEMBER or FROMLONLAT can be specified for GEOSEARCH\r\n"));
+    }
+    if (!has_by) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR exactly one of BYRADIUS and BYBOX can be specified for GEOSEARCH\r\n"));
+    }
+    if (options._any && !options._count) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR the ANY argument requires COUNT argument\r\n"));
+    }
+    return seastar::make_shared<geosearch>(std::move(req._command), geo_schemas(proxy, cs), std::move(args[0]), std::move(member), shape, options);
+}
+
+future<redis_message> geo_search::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    if (!_member) {
+        return search(proxy, cl, timeout, cs);
+    }
+    return fetch_geo_scores(proxy, _schemas[0], _key, std::vector<bytes> { *_member }, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto scores) {
+        if (!scores[0]) {
+            return redis_message::make_exception(sstring("-ERR could not decode requested zset member\r\n"));
+        }
+        auto center = geo::decode(*scores[0]);
+        _shape._lon = center.first;
+        _shape._lat = center.second;
+        return search(proxy, cl, timeout, cs);
+    });
+}
+
+future<redis_message> geo_search::search(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    auto& index_schema = *_schemas[1];
+    std::vector<query::clustering_range> ranges;
+    for (auto& r : geo::score_ranges(_shape)) {
+        auto start = clustering_key_prefix::from_single_value(index_schema, double_type->decompose(static_cast<double>(r.first)));
+        auto end = clustering_key_prefix::from_single_value(index_schema, double_type->decompose(static_cast<double>(r.second)));
+        ranges.emplace_back(query::clustering_range::make({ std::move(start), true }, { std::move(end), false }));
+    }
+    return prefetch_zset_scores(proxy, _schemas[1], _key, std::move(ranges), cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+        auto& rows = pd->data();
+        auto n = rows.size();
+        std::vector<double> lons(n), lats(n), distances(n);
+        for (size_t i = 0; i < n; ++i) {
+            auto pos = geo::decode(static_cast<uint64_t>(rows[i].first));
+            lons[i] = pos.first;
+            lats[i] = pos.second;
+        }
+        geo::distances(_shape, lons.data(), lats.data(), n, distances.data());
+        auto matches = make_lw_shared<std::vector<geo::match>>();
+        // The scores of the rows of the index of the matches.
+        std::vector<double> index_scores;
+        std::vector<bytes> members;
+        for (size_t i = 0; i < n; ++i) {
+            if (distances[i] >= 0) {
+                matches->emplace_back(geo::match { rows[i].second, static_cast<uint64_t>(rows[i].first), lons[i], lats[i], distances[i] });
+                index_scores.emplace_back(rows[i].first);
+                members.emplace_back(rows[i].second);
+            }
+        }
+        if (matches->empty()) {
+            return reply(matches);
+        }
+        return fetch_geo_scores(proxy, _schemas[0], _key, std::move(members), cl, timeout, cs).then([this, &proxy, cl, timeout, &cs, matches, index_scores = std::move(index_scores)] (auto scores) {
+            // Drops the rows of the index left behind by the members moved by
+            // ZADD, or expired, and deletes them.
+            std::vector<std::pair<double, bytes>> orphans;
+            size_t kept = 0;
+            for (size_t i = 0; i < matches->size(); ++i) {
+                if (scores[i] && *scores[i] == (*matches)[i]._hash) {
+                    if (kept != i) {
+                        (*matches)[kept] = std::move((*matches)[i]);
+                    }
+                    ++kept;
+                } else {
+                    orphans.emplace_back(index_scores[i], (*matches)[i]._member);
+                }
+            }
+            matches->resize(kept);
+            auto cleanup = make_ready_future<>();
+            if (!orphans.empty()) {
+                // The reply doesn't depend on it, a failure leaves the rows to the next search.
+                cleanup = redis::write_mutation(proxy, redis::make_zset_score_cells(_schemas[1], _key, {}, std::move(orphans)), cl, timeout, cs).handle_exception([] (auto) {});
+            }
+            return cleanup.then([this, matches] {
+                return reply(matches);
+            });
+        });
+    });
+}
+
+future<redis_message> geo_search::reply(lw_shared_ptr<std::vector<geo::match>> matches)
+{
+    auto order = _options._order;
+    if (order == 0 && _options._count && !_options._any) {
+        order = 1;
+    }
+    if (order != 0) {
+        std::sort(matches->begin(), matches->end(), [order] (auto& a, auto& b) {
+            return order > 0 ? a._distance < b._distance : a._distance > b._distance;
+        });
+    }
+    if (_options._count && matches->size() > static_cast<size_t>(*_options._count)) {
+        matches->resize(static_cast<size_t>(*_options._count));
+    }
+    return redis_message::make_geo_matches(matches, _options._with_coord, _options._with_dist, _options._with_hash, _options._unit);
+}
+
+}
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "redis/command_with_multi_schemas.hh"
+#include "redis/request.hh"
+#include "redis/geo.hh"
+#include <optional>
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+
+struct geo_search_options {
+    bool _with_coord = false;
+    bool _with_dist = false;
+    bool _with_hash = false;
+    std::optional<long> _count;
+    bool _any = false;
+    // 1 for ASC, -1 for DESC, 0 if unsorted.
+    int _order = 0;
+    double _unit = 1.0;
+};
+
+// The members of a sorted set (_schemas[0]) within an area. The area is turned into a few
+// ranges of scores read from the score index (_schemas[1]), and the matches are checked
+// against the sorted set, so the stale rows of the index are skipped and deleted.
+class geo_search : public command_with_multi_schemas {
+protected:
+    bytes _key;
+    // Searches around this member when given, otherwise around the center of the shape.
+    std::optional<bytes> _member;
+    geo::shape _shape;
+    geo_search_options _options;
+    future<redis_message> search(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs);
+    // Orders and counts the matches.
+    future<redis_message> reply(lw_shared_ptr<std::vector<geo::match>> matches);
+public:
+    geo_search(bytes&& name, std::vector<schema_ptr>&& schemas, bytes&& key, std::optional<bytes>&& member, geo::shape shape, geo_search_options options)
+        : command_with_multi_schemas(std::move(name), std::move(schemas))
+        , _key(std::move(key))
+        , _member(std::move(member))
+        , _shape(shape)
+        , _options(options)
+    {
+    }
+    ~geo_search() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+// GEORADIUS key longitude latitude radius m|km|ft|mi [WITHCOORD] [WITHDIST] [WITHHASH] [COUNT count [ANY]] [ASC|DESC]
+class georadius : public geo_search {
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    using geo_search::geo_search;
+};
+
+// GEORADIUSBYMEMBER key member radius m|km|ft|mi [WITHCOORD] [WITHDIST] [WITHHASH] [COUNT count [ANY]] [ASC|DESC]
+class georadiusbymember : public geo_search {
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    using geo_search::geo_search;
+};
+
+// GEOSEARCH key FROMMEMBER member|FROMLONLAT longitude latitude BYRADIUS radius unit|BYBOX width height unit
+//     [ASC|DESC] [COUNT count [ANY]] [WITHCOORD] [WITHDIST] [WITHHASH]
+class geosearch : public geo_search {
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    using geo_search::geo_search;
+};
+}
+}
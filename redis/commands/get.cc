@@ -4,6 +4,7 @@
 #include "redis/reply.hh"
 #include "redis/redis_mutation.hh"
 #include "redis/prefetcher.hh"
+#include "redis/query_processor.hh"
 #include "timeout_config.hh"
 #include "service/client_state.hh"
 #include "service/storage_proxy.hh"
@@ -30,12 +31,33 @@ shared_ptr<abstract_command> get::prepare(service::storage_proxy& proxy, const s
 future<redis_message> get::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
     auto timeout = now + tc.read_timeout;
+    auto& cache = get_local_query_processor().get_near_cache();
+    if (cache.enabled()) {
+        if (auto cached = cache.get_string(cs.get_keyspace(), _key)) {
+            if (*cached) {
+                return redis_message::make_bytes(std::move(*cached));
+            }
+            return redis_message::null(cs.get_redis_protocol_version());
+        }
+    }
     auto fetched = prefetch_simple(proxy, _schema, _key, cl, timeout, cs);
-    return fetched.then([this, &proxy, cl, timeout, &cs] (auto pd) {
+    return fetched.then([this, &proxy, cl, timeout, &cache, &cs, generation = cache.generation(cs.get_keyspace(), _key)] (auto pd) {
         if (pd && pd->has_data()) {
+            if (cache.enabled()) {
+                cache.put_string(cs.get_keyspace(), _key, pd, generation);
+            }
             return redis_message::make_bytes(std::move(pd));
         }
-        return redis_message::null();
+        // A bitmap is not a string, see bitmaps.hh.
+        return exists(proxy, bitmaps_schema(proxy, cs.get_keyspace()), _key, cl, timeout, cs).then([this, &cache, &cs, generation] (bool is_bitmap) {
+            if (is_bitmap) {
+                return redis_message::wrong_type();
+            }
+            if (cache.enabled()) {
+                cache.put_string(cs.get_keyspace(), _key, bytes_return_type(), generation);
+            }
+            return redis_message::null(cs.get_redis_protocol_version());
+        });
     });
 }
 /*
@@ -81,7 +103,7 @@ future<redis_message> mget::execute(service::storage_proxy& proxy, db::consisten
         if (pd && pd->has_data()) {
             return redis_message::make_mbytes(pd);
         }
-        return redis_message::null();
+        return redis_message::null(cs.get_redis_protocol_version());
     });
 }
 }
@@ -4,6 +4,7 @@
 #include "redis/reply.hh"
 #include "redis/redis_mutation.hh"
 #include "redis/prefetcher.hh"
+#include "redis/query_processor.hh"
 #include "timeout_config.hh"
 #include "service/client_state.hh"
 #include "service/storage_proxy.hh"
@@ -49,29 +50,31 @@ shared_ptr<abstract_command> hgetall::prepare(service::storage_proxy& proxy, con
 future<redis_message> hget::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
     auto timeout = now + tc.read_timeout;
-    return prefetch_map(proxy, _schema, _key, _map_keys, fetch_options::values, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+    auto& cache = get_local_query_processor().get_near_cache();
+    // HMGET is not cached, a field would be missed as often as another is hit.
+    auto cached = cache.enabled() && !_multi;
+    if (cached) {
+        if (auto value = cache.get_field(cs.get_keyspace(), _key, _map_keys.front())) {
+            if (*value) {
+                return redis_message::make_map_key_bytes(std::move(*value));
+            }
+            return redis_message::null(cs.get_redis_protocol_version());
+        }
+    }
+    auto fetched = prefetch_map(proxy, _schema, _key, _map_keys, fetch_options::values, cl, timeout, cs);
+    return fetched.then([this, &cache, &cs, cached, generation = cache.generation(cs.get_keyspace(), _key)] (auto pd) {
+        if (cached) {
+            cache.put_field(cs.get_keyspace(), _key, _map_keys.front(), pd && pd->has_data() ? pd : map_return_type(), generation);
+        }
         if (pd && pd->has_data()) {
             return redis_message::make_map_key_bytes(pd);
         }
-        return redis_message::null();
+        return redis_message::null(cs.get_redis_protocol_version());
     });
 }
 future<redis_message> hall::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
-    auto timeout = now + tc.read_timeout;
-    return prefetch_map(proxy, _schema, _key, _option, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
-        if (pd && pd->has_data()) {
-            //std::vector<std::optional<bytes>> result;
-            if (_option == redis::fetch_options::keys) {
-                return redis_message::make_map_key_bytes(pd);
-            } else if (_option == redis::fetch_options::values) {
-                return redis_message::make_map_key_bytes(pd);
-            } else {
-                return redis_message::make_map_bytes(pd);
-            }
-        }
-        return redis_message::null();
-    });
+    return fetch_collection_reply(proxy, _schema, _key, _option, false, cl, tc, cs);
 }
 
 }
@@ -0,0 +1,50 @@
+#include "redis/commands/hotkeys.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/hot_keys.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "seastar/core/future-util.hh"
+namespace redis {
+namespace commands {
+
+static constexpr long default_hotkeys_count = 10;
+
+shared_ptr<abstract_command> hotkeys::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count > 1) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    if (req._args_count == 1 && option_equals(req._args[0], "reset")) {
+        return seastar::make_shared<hotkeys>(std::move(req._command), operation::reset, 0);
+    }
+    long count = default_hotkeys_count;
+    if (req._args_count == 1) {
+        auto c = try_bytes2long(req._args[0]);
+        if (!c || *c <= 0) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR count should be greater than 0\r\n"));
+        }
+        count = *c;
+    }
+    return seastar::make_shared<hotkeys>(std::move(req._command), operation::get, count);
+}
+
+future<redis_message> hotkeys::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    if (_op == operation::reset) {
+        return get_query_processor().invoke_on_all([] (auto& qp) {
+            qp.get_hot_keys().reset();
+        }).then([] {
+            return redis_message::ok();
+        });
+    }
+    return get_hot_keys(static_cast<size_t>(_count)).then([] (auto&& entries) {
+        return redis_message::make_hot_keys(make_lw_shared<std::vector<hot_keys::entry>>(std::move(entries)));
+    });
+}
+
+}
+}
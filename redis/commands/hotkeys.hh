@@ -0,0 +1,29 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// HOTKEYS [count] | RESET, the hottest keys of all shards with their estimated
+// recent accesses, the hottest first.
+class hotkeys : public abstract_command {
+public:
+    enum class operation { get, reset };
+private:
+    operation _op;
+    long _count;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    hotkeys(bytes&& name, operation op, long count)
+        : abstract_command(std::move(name))
+        , _op(op)
+        , _count(count)
+    {
+    }
+    ~hotkeys() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
@@ -0,0 +1,324 @@
+#include "redis/commands/info.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_keyspace.hh"
+#include "redis/query_processor.hh"
+#include "transport/redis_server.hh"
+#include "service/storage_service.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "utils/logalloc.hh"
+#include "utils/runtime.hh"
+#include "database.hh"
+#include "types.hh"
+#include "version.hh"
+#include "timeout_config.hh"
+#include "seastar/core/future-util.hh"
+#include "seastar/core/memory.hh"
+#include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <unistd.h>
+namespace redis {
+namespace commands {
+
+// The version of the protocol implemented, which the clients check before
+// using the newer commands (e.g. the streams).
+static constexpr auto compatible_redis_version = "5.0.0";
+
+// The tables holding the keys, the others are indexes or metadata of them.
+static const std::vector<sstring> keys_tables { STRINGS, LISTS, SETS, MAPS, ZSETS, STREAMS, BITMAPS };
+
+static const std::set<sstring> default_sections { "server", "clients", "memory", "stats", "replication", "keyspace" };
+
+namespace {
+
+struct command_totals {
+    uint64_t _calls = 0;
+    uint64_t _failures = 0;
+    // In microseconds.
+    int64_t _duration = 0;
+};
+
+// What INFO needs from a shard.
+struct shard_info {
+    uint64_t _blocked_clients = 0;
+    size_t _total_memory = 0;
+    size_t _free_memory = 0;
+    size_t _lsa_total_space = 0;
+    size_t _lsa_used_space = 0;
+    size_t _cache_used_space = 0;
+    uint64_t _cache_partitions = 0;
+    uint64_t _cache_hits = 0;
+    uint64_t _cache_misses = 0;
+    size_t _dirty_memory = 0;
+    uint64_t _slowlog_len = 0;
+    bool _bigkeys_scan_in_progress = false;
+    uint64_t _bigkeys_scanned_partitions = 0;
+    // The estimated number of partitions of every redis keyspace.
+    std::map<sstring, uint64_t> _keys;
+    std::map<bytes, command_totals> _commands;
+
+    shard_info& operator+=(shard_info&& o) {
+        _blocked_clients += o._blocked_clients;
+        _total_memory += o._total_memory;
+        _free_memory += o._free_memory;
+        _lsa_total_space += o._lsa_total_space;
+        _lsa_used_space += o._lsa_used_space;
+        _cache_used_space += o._cache_used_space;
+        _cache_partitions += o._cache_partitions;
+        _cache_hits += o._cache_hits;
+        _cache_misses += o._cache_misses;
+        _dirty_memory += o._dirty_memory;
+        _slowlog_len += o._slowlog_len;
+        _bigkeys_scan_in_progress = _bigkeys_scan_in_progress || o._bigkeys_scan_in_progress;
+        _bigkeys_scanned_partitions += o._bigkeys_scanned_partitions;
+        for (auto& k : o._keys) {
+            _keys[k.first] += k.second;
+        }
+        for (auto& c : o._commands) {
+            auto& t = _commands[c.first];
+            t._calls += c.second._calls;
+            t._failures += c.second._failures;
+            t._duration += c.second._duration;
+        }
+        return *this;
+    }
+};
+
+}
+
+// The keys are estimated from the sstables summaries and the active memtables,
+// the keys both in a memtable and in a sstable are counted twice.
+static uint64_t estimate_keys(database& db, const sstring& ks)
+{
+    uint64_t keys = 0;
+    for (auto& table : keys_tables) {
+        if (!db.has_schema(ks, table)) {
+            continue;
+        }
+        auto& cf = db.find_column_family(ks, table);
+        for (auto& sst : *cf.get_sstables()) {
+            keys += sst->get_estimated_key_count();
+        }
+        keys += cf.active_memtable().partition_count();
+    }
+    return keys;
+}
+
+static shard_info collect_shard_info(query_processor& qp, bool with_keys, bool with_commands)
+{
+    shard_info s;
+    auto& db = qp.db().local();
+    s._blocked_clients = qp.get_blocked_clients().blocked();
+    auto mem = memory::stats();
+    s._total_memory = mem.total_memory();
+    s._free_memory = mem.free_memory();
+    auto lsa = logalloc::shard_tracker().region_occupancy();
+    s._lsa_total_space = lsa.total_space();
+    s._lsa_used_space = lsa.used_space();
+    auto& cache = db.row_cache_tracker();
+    s._cache_used_space = cache.region().occupancy().used_space();
+    s._cache_partitions = cache.get_stats().partitions;
+    s._cache_hits = cache.get_stats().partition_hits;
+    s._cache_misses = cache.get_stats().partition_misses;
+    s._dirty_memory = db.dirty_memory_region_group().memory_used();
+    s._slowlog_len = qp.get_slowlog().size();
+    s._bigkeys_scan_in_progress = qp.get_big_keys().running();
+    s._bigkeys_scanned_partitions = qp.get_big_keys().scanned_partitions();
+    if (with_keys) {
+        for (auto& ks : db.get_keyspaces()) {
+            if (boost::starts_with(ks.first, REDIS_DATABASE_NAME_PREFIX)) {
+                s._keys.emplace(ks.first, estimate_keys(db, ks.first));
+            }
+        }
+    }
+    if (with_commands) {
+        for (auto& c : qp.get_command_stats()) {
+            if (c._calls) {
+                s._commands.emplace(c._name, command_totals { c._calls, c._failures, c._latency._sample_sum });
+            }
+        }
+    }
+    return s;
+}
+
+static future<redis_transport::redis_server::stats> collect_server_stats()
+{
+    using stats = redis_transport::redis_server::stats;
+    // The server is known by the storage service of shard 0.
+    return service::get_storage_service().invoke_on(0, [] (auto& ss) {
+        return ss.get_redis_server().then([] (auto server) {
+            if (!server) {
+                return make_ready_future<stats>();
+            }
+            return server->map_reduce0([] (auto& s) {
+                return s.get_stats();
+            }, stats {}, [] (stats all, const stats& s) {
+                all += s;
+                return all;
+            }).finally([server] {});
+        });
+    });
+}
+
+static future<replica::status> collect_replication()
+{
+    return get_query_processor().invoke_on(0, [] (auto& qp) {
+        return qp.get_replica().get_status();
+    });
+}
+
+static sstring human_bytes(size_t n)
+{
+    static const char* units[] = { "B", "K", "M", "G", "T" };
+    double v = n;
+    size_t u = 0;
+    while (v >= 1024 && u < 4) {
+        v /= 1024;
+        ++u;
+    }
+    return u ? sprint("%.2f%s", v, units[u]) : sprint("%dB", n);
+}
+
+shared_ptr<abstract_command> info::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    std::set<sstring> sections;
+    for (auto& arg : req._args) {
+        sstring section(reinterpret_cast<const char*>(arg.data()), arg.size());
+        std::transform(section.begin(), section.end(), section.begin(), ::tolower);
+        if (section == "all" || section == "everything") {
+            sections.insert(default_sections.begin(), default_sections.end());
+            sections.insert("commandstats");
+        } else if (section == "default") {
+            sections.insert(default_sections.begin(), default_sections.end());
+        } else {
+            sections.insert(std::move(section));
+        }
+    }
+    if (req._args.empty()) {
+        sections = default_sections;
+    }
+    return seastar::make_shared<info>(std::move(req._command), std::move(sections));
+}
+
+future<redis_message> info::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto with_keys = has_section("keyspace");
+    auto with_commands = has_section("commandstats");
+    auto shards = get_query_processor().map_reduce0([with_keys, with_commands] (auto& qp) {
+        return collect_shard_info(qp, with_keys, with_commands);
+    }, shard_info {}, [] (shard_info all, shard_info s) {
+        all += std::move(s);
+        return all;
+    });
+    return when_all(std::move(shards), collect_server_stats(), collect_replication()).then([this, &proxy] (auto results) {
+        auto totals = std::get<0>(results).get0();
+        auto server = std::get<1>(results).get0();
+        auto replication = std::get<2>(results).get0();
+        auto& cfg = proxy.get_db().local().get_config();
+        std::ostringstream out;
+        auto section = [&out] (const char* name) {
+            if (out.tellp()) {
+                out << "\r\n";
+            }
+            out << "# " << name << "\r\n";
+        };
+        if (has_section("server")) {
+            auto uptime = std::chrono::duration_cast<std::chrono::seconds>(runtime::get_uptime()).count();
+            section("Server");
+            out << "redis_version:" << compatible_redis_version << "\r\n"
+                << "pedis_version:" << version::release() << "\r\n"
+                << "redis_mode:cluster\r\n"
+                << "arch_bits:" << sizeof(void*) * 8 << "\r\n"
+                << "multiplexing_api:seastar\r\n"
+                << "process_id:" << ::getpid() << "\r\n"
+                << "tcp_port:" << cfg.redis_transport_port() << "\r\n"
+                << "uptime_in_seconds:" << uptime << "\r\n"
+                << "uptime_in_days:" << uptime / 86400 << "\r\n"
+                << "shards:" << smp::count << "\r\n";
+        }
+        if (has_section("clients")) {
+            section("Clients");
+            out << "connected_clients:" << server._connections << "\r\n"
+                << "blocked_clients:" << totals._blocked_clients << "\r\n"
+                << "client_output_buffer_limit:" << (size_t(cfg.redis_client_output_buffer_limit_in_mb()) << 20) << "\r\n";
+        }
+        if (has_section("memory")) {
+            auto used = totals._total_memory - totals._free_memory;
+            section("Memory");
+            out << "used_memory:" << used << "\r\n"
+                << "used_memory_human:" << human_bytes(used) << "\r\n"
+                << "total_system_memory:" << totals._total_memory << "\r\n"
+                << "total_system_memory_human:" << human_bytes(totals._total_memory) << "\r\n"
+                << "lsa_total_space:" << totals._lsa_total_space << "\r\n"
+                << "lsa_used_space:" << totals._lsa_used_space << "\r\n"
+                << "cache_used_space:" << totals._cache_used_space << "\r\n"
+                << "cache_partitions:" << totals._cache_partitions << "\r\n"
+                << "memtable_dirty_memory:" << totals._dirty_memory << "\r\n"
+                << "bigkeys_scan_in_progress:" << (totals._bigkeys_scan_in_progress ? 1 : 0) << "\r\n"
+                << "bigkeys_scanned_partitions:" << totals._bigkeys_scanned_partitions << "\r\n";
+        }
+        if (has_section("stats")) {
+            section("Stats");
+            out << "total_connections_received:" << server._total_connections << "\r\n"
+                << "total_commands_processed:" << server._requests_served << "\r\n"
+                << "total_net_input_bytes:" << server._bytes_received << "\r\n"
+                << "total_net_output_bytes:" << server._bytes_sent << "\r\n"
+                << "rejected_connections:0\r\n"
+                << "client_output_buffer_overflows:" << server._output_buffer_overflows << "\r\n"
+                << "blocked_memory_requests:" << server._requests_blocked_memory << "\r\n"
+                << "protocol_errors:" << server._parse_errors << "\r\n"
+                << "cache_hits:" << totals._cache_hits << "\r\n"
+                << "cache_misses:" << totals._cache_misses << "\r\n"
+                << "slowlog_len:" << totals._slowlog_len << "\r\n";
+        }
+        if (has_section("replication")) {
+            section("Replication");
+            if (!replication._master) {
+                out << "role:master\r\n"
+                    << "connected_slaves:0\r\n";
+            } else {
+                out << "role:slave\r\n"
+                    << "master_host:" << replication._master->first << "\r\n"
+                    << "master_port:" << replication._master->second << "\r\n"
+                    << "master_link_status:" << (replication._link_up ? "up" : "down") << "\r\n"
+                    << "master_last_io_seconds_ago:" << (replication._link_up ? replication._last_io.count() : -1) << "\r\n"
+                    << "master_sync_in_progress:" << (replication._sync_in_progress ? 1 : 0) << "\r\n"
+                    << "slave_read_repl_offset:" << replication._received_offset << "\r\n"
+                    << "slave_repl_offset:" << replication._applied_offset << "\r\n"
+                    << "slave_repl_lag_seconds:" << replication._lag.count() << "\r\n"
+                    << "connected_slaves:0\r\n";
+            }
+            out << "master_replid:" << (replication._replid.empty() ? sstring(40, '0') : replication._replid) << "\r\n";
+        }
+        if (has_section("keyspace")) {
+            section("Keyspace");
+            for (auto& k : totals._keys) {
+                if (!k.second) {
+                    continue;
+                }
+                auto db = k.first.substr(std::strlen(REDIS_DATABASE_NAME_PREFIX));
+                out << "db" << db << ":keys=" << k.second << ",expires=0,avg_ttl=0\r\n";
+            }
+        }
+        if (has_section("commandstats")) {
+            section("Commandstats");
+            for (auto& c : totals._commands) {
+                auto& t = c.second;
+                out << "cmdstat_" << sstring(reinterpret_cast<const char*>(c.first.data()), c.first.size())
+                    << ":calls=" << t._calls
+                    << ",usec=" << t._duration
+                    << ",usec_per_call=" << sprint("%.2f", t._calls ? double(t._duration) / t._calls : 0.0)
+                    << ",failed_calls=" << t._failures << "\r\n";
+            }
+        }
+        return redis_message::make_bytes(to_bytes(out.str()));
+    });
+}
+
+}
+}
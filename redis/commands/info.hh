@@ -0,0 +1,29 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+#include <set>
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// INFO [section ...], the sections are server, clients, memory, stats,
+// keyspace and commandstats, summed up over all shards. Like redis, the
+// commandstats are only given when asked for, or with "all".
+class info : public abstract_command {
+    std::set<sstring> _sections;
+    bool has_section(const char* section) const {
+        return _sections.count(section);
+    }
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    info(bytes&& name, std::set<sstring>&& sections)
+        : abstract_command(std::move(name))
+        , _sections(std::move(sections))
+    {
+    }
+    ~info() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
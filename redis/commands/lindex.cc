@@ -31,7 +31,7 @@ future<redis_message> lindex::execute(service::storage_proxy& proxy, db::consist
                 return redis_message::make_list_bytes(pd, _index);
             }
         }
-        return redis_message::null();
+        return redis_message::null(cs.get_redis_protocol_version());
     });
 }
 }
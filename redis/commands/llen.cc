@@ -24,11 +24,11 @@ shared_ptr<abstract_command> llen::prepare(service::storage_proxy& proxy, const
 future<redis_message> llen::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
     auto timeout = now + tc.read_timeout;
-    return prefetch_list(proxy, _schema, _key, fetch_options::values, false, cl, timeout, cs).then([] (auto pd) {
+    return prefetch_list(proxy, _schema, _key, fetch_options::values, false, cl, timeout, cs).then([&cs] (auto pd) {
         if (pd && pd->has_data()) {
             return redis_message::make_long(static_cast<long>(pd->data().size()));
         }
-        return redis_message::null();
+        return redis_message::null(cs.get_redis_protocol_version());
     });
 }
 }
@@ -11,6 +11,9 @@
 #include "dht/i_partitioner.hh"
 #include "redis/prefetcher.hh"
 #include "redis/redis_mutation.hh"
+#include "redis/blocked_clients.hh"
+#include "redis/query_processor.hh"
+#include "schema_registry.hh"
 namespace redis {
 namespace commands {
 
@@ -40,29 +43,69 @@ future<redis_message> rpop::execute(service::storage_proxy& proxy, db::consisten
     return do_execute(proxy, cl, now, tc, cs, false);
 }
 
-future<redis_message> pop::do_execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs, bool left)
+future<std::optional<bytes>> pop_element(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    bool left,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs,
+    std::optional<bytes> destination)
 {
-    auto timeout = now + tc.read_timeout;
-    return prefetch_list(proxy, _schema, _key, fetch_options::all, !left, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs, left] (auto pd) {
+    return prefetch_list(proxy, schema, key, fetch_options::all, !left, cl, timeout, cs).then([schema, &key, &proxy, cl, timeout, &cs, destination = std::move(destination)] (auto pd) {
         if (pd && pd->has_data()) {
             auto removed = pd->data().front();
-            return [this, removed_cell_key = removed.first, &proxy, &cs, timeout, cl, pd] () {
-                // The last cell, delete this partition.
-                if (pd->data_size() == 1) {
-                    return redis::write_mutation(proxy, redis::make_dead(_schema, _key), cl, timeout, cs);
-                }
-                std::vector<std::optional<bytes>> removed_cell_keys { std::move(removed_cell_key) };
-                return redis::write_mutation(proxy, redis::make_list_dead_cells(_schema, _key, std::move(removed_cell_keys)), cl, timeout, cs);
-            } ().then_wrapped([this, pd] (auto f) {
-                try {
-                    f.get();
-                } catch(...) {
-                    return redis_message::err();
-                }
-                return redis_message::make_list_bytes(pd, size_t { 0 } );
+            std::vector<mutation> ms;
+            // The last cell, delete this partition, unless the element goes back to it.
+            if (pd->data_size() == 1 && (!destination || *destination != key)) {
+                ms.emplace_back(internal::make_mutation(redis::make_dead(schema, key)));
+            } else {
+                std::vector<std::optional<bytes>> removed_cell_keys { std::move(removed.first) };
+                ms.emplace_back(internal::make_mutation(redis::make_list_dead_cells(schema, key, std::move(removed_cell_keys))));
+            }
+            if (destination) {
+                ms.emplace_back(internal::make_mutation(redis::make_list_cells(schema, *destination, std::vector<bytes> { *removed.second }, true)));
+            }
+            return internal::write_mutation_impl(proxy, std::move(ms), cl, timeout, cs).then([removed = std::move(removed.second)] {
+                return make_ready_future<std::optional<bytes>>(std::move(removed));
+            });
+        }
+        return make_ready_future<std::optional<bytes>>();
+    });
+}
+
+future<std::optional<bytes>> pop_element_on_owner(const schema_ptr schema,
+    const bytes& key,
+    bool left,
+    std::optional<bytes> destination,
+    db::consistency_level cl,
+    db::timeout_clock::duration timeout)
+{
+    auto shard = blocked_clients::shard_of(*schema, key);
+    return get_query_processor().invoke_on(shard, [s = global_schema_ptr(schema), key, left, destination = std::move(destination), cl, timeout] (auto& qp) mutable {
+        schema_ptr schema = s;
+        auto k = blocked_clients::make_key(*schema, key);
+        return do_with(std::move(key), std::move(destination), service::client_state(service::client_state::internal_tag {}),
+            [&qp, schema, k = std::move(k), left, cl, timeout] (auto& key, auto& destination, auto& cs) {
+            return qp.get_key_locks().with_lock(k, [schema, &key, &destination, &cs, left, cl, timeout] {
+                return pop_element(service::get_local_storage_proxy(), schema, key, left, cl, db::timeout_clock::now() + timeout, cs, destination);
             });
+        });
+    });
+}
+
+future<redis_message> pop::do_execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs, bool left)
+{
+    return pop_element_on_owner(_schema, _key, left, std::nullopt, cl, tc.write_timeout).then_wrapped([this, &cs] (auto f) {
+        try {
+            auto removed = f.get0();
+            if (removed) {
+                return redis_message::make_bytes(*removed);
+            }
+        } catch(...) {
+            return redis_message::err();
         }
-        return redis_message::null();
+        return redis_message::null(cs.get_redis_protocol_version());
     });
 }
 }
@@ -9,6 +9,29 @@ class storage_proxy;
 class timeout_config;
 namespace redis {
 namespace commands {
+// Removes the head (left) or the tail of the list, the removed element is returned.
+// With a destination (BRPOPLPUSH), the element is pushed to the head of that list
+// in the same batch.
+future<std::optional<bytes>> pop_element(service::storage_proxy&,
+    const schema_ptr,
+    const bytes& key,
+    bool left,
+    db::consistency_level,
+    db::timeout_clock::time_point,
+    service::client_state& cs,
+    std::optional<bytes> destination = std::nullopt
+    );
+
+// pop_element on the shard owning the key, under the lock of the key, so the pops
+// never race with each other nor with the pushes serving the blocked clients.
+future<std::optional<bytes>> pop_element_on_owner(const schema_ptr,
+    const bytes& key,
+    bool left,
+    std::optional<bytes> destination,
+    db::consistency_level,
+    db::timeout_clock::duration timeout
+    );
+
 class pop : public command_with_single_schema {
 protected:
     bytes _key;
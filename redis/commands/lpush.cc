@@ -11,6 +11,7 @@
 #include "gc_clock.hh"
 #include "dht/i_partitioner.hh"
 #include "redis/prefetcher.hh"
+#include "redis/blocked_clients.hh"
 #include "cql3/query_options.hh"
 namespace redis {
 namespace commands {
@@ -67,7 +68,10 @@ future<redis_message> push::do_execute(service::storage_proxy& proxy,
                 // FIXME: what kind of exceptions.
                 return redis_message::err();
             }
-            return redis_message::make_long(static_cast<long>(total));
+            // Wake up the clients blocked on this list (BLPOP, BRPOP, BRPOPLPUSH).
+            return serve_blocked_clients(_schema, _key, total).then([total] {
+                return redis_message::make_long(static_cast<long>(total));
+            });
         });
     });
 }
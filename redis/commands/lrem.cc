@@ -75,7 +75,7 @@ future<redis_message> lrem::execute(service::storage_proxy& proxy, db::consisten
                 return redis_message::make_long(static_cast<long>(total));
             });
         }
-        return redis_message::null(); 
+        return redis_message::null(cs.get_redis_protocol_version()); 
     });
 }
 
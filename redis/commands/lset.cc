@@ -29,21 +29,21 @@ future<redis_message> lset::execute(service::storage_proxy& proxy, db::consisten
         if (pd && pd->has_data()) {
             auto& e = pd->data().front();
             std::vector<std::pair<std::optional<bytes>, std::optional<bytes>>> new_cells { { std::move(e.first), std::move(e.second) } };
-            return redis::write_mutation(proxy, redis::make_list_indexed_cells(_schema, _key, std::move(new_cells)), cl, timeout, cs).then_wrapped([this] (auto f) {
+            return redis::write_mutation(proxy, redis::make_list_indexed_cells(_schema, _key, std::move(new_cells)), cl, timeout, cs).then_wrapped([this, &cs] (auto f) {
                 try {
                     f.get();
                 } catch(std::exception& e) {
-                    return redis_message::null();
+                    return redis_message::null(cs.get_redis_protocol_version());
                 }
                 return redis_message::ok();
             });
         }
         std::vector<bytes> data { std::move(_value) };
-        return redis::write_mutation(proxy, redis::make_list_cells(_schema, _key, std::move(data), true), cl, timeout, cs).then_wrapped([this] (auto f) {
+        return redis::write_mutation(proxy, redis::make_list_cells(_schema, _key, std::move(data), true), cl, timeout, cs).then_wrapped([this, &cs] (auto f) {
             try {
                 f.get();
             } catch(...) {
-                return redis_message::null();
+                return redis_message::null(cs.get_redis_protocol_version());
             }
             return redis_message::ok();
         });
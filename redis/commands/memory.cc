@@ -0,0 +1,51 @@
+#include "redis/commands/memory.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/key_footprint.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> memory::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 1 || !option_equals(req._args[0], "usage")) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR Unknown subcommand or wrong number of arguments for MEMORY\r\n"));
+    }
+    if (req._args_count != 2 && req._args_count != 4) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    if (req._args_count == 4) {
+        auto samples = try_bytes2long(req._args[3]);
+        if (!option_equals(req._args[2], "samples")) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+        }
+        if (!samples || *samples < 0) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR value is not an integer or out of range\r\n"));
+        }
+    }
+    return seastar::make_shared<memory>(std::move(req._command), std::move(req._args[1]));
+}
+
+future<redis_message> memory::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto schemas = get_local_query_processor().schemas_of(cs.get_keyspace());
+    return table_of(proxy, schemas, _key, cl, now + tc.read_timeout, cs).then([this, &proxy, schemas, &cs] (schema_ptr s) {
+        if (!s) {
+            return redis_message::null(cs.get_redis_protocol_version());
+        }
+        return get_key_footprint(proxy.get_db(), schemas, _key).then([] (std::vector<table_footprint> footprints) {
+            uint64_t bytes = 0;
+            for (auto& f : footprints) {
+                bytes += f.total();
+            }
+            return redis_message::make_long(bytes);
+        });
+    });
+}
+
+}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// MEMORY USAGE key [SAMPLES count], the bytes of the key on this node: its
+// partitions in the memtables and in the row cache, and in the sstables.
+// Every table the key has a partition in is counted, its tombstones included.
+// The samples are accepted for the compatibility, the partitions are
+// measured whole.
+class memory : public abstract_command {
+    bytes _key;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    memory(bytes&& name, bytes&& key)
+        : abstract_command(std::move(name))
+        , _key(std::move(key))
+    {
+    }
+    ~memory() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
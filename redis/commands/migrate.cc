@@ -0,0 +1,221 @@
+#include "redis/commands/migrate.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/rdb.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/replication.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "gms/inet_address.hh"
+#include "db_clock.hh"
+#include "seastar/core/future-util.hh"
+#include "seastar/core/reactor.hh"
+#include "seastar/core/thread.hh"
+#include "seastar/core/timer.hh"
+#include <boost/lexical_cast.hpp>
+#include <boost/range/irange.hpp>
+namespace redis {
+namespace commands {
+
+namespace {
+
+// An error replied by the target.
+class target_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+}
+
+static sstring to_sstring(const bytes& b)
+{
+    return sstring(reinterpret_cast<const char*>(b.data()), b.size());
+}
+
+shared_ptr<abstract_command> migrate::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 5) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 5, req._args_count);
+    }
+    uint16_t port = 0;
+    uint64_t db = 0;
+    int64_t timeout = 0;
+    try {
+        auto p = boost::lexical_cast<uint32_t>(to_sstring(req._args[1]));
+        if (p < 1 || p > 65535) {
+            throw boost::bad_lexical_cast();
+        }
+        port = p;
+        db = boost::lexical_cast<uint64_t>(to_sstring(req._args[3]));
+        timeout = boost::lexical_cast<int64_t>(to_sstring(req._args[4]));
+    } catch (boost::bad_lexical_cast&) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR value is not an integer or out of range\r\n"));
+    }
+    // As Redis, a timeout of 0 is a second.
+    if (timeout <= 0) {
+        timeout = 1000;
+    }
+    bool copy = false;
+    bool replace = false;
+    std::vector<sstring> auth;
+    std::vector<bytes> keys;
+    for (size_t i = 5; i < req._args.size(); ++i) {
+        auto& a = req._args[i];
+        if (option_equals(a, "copy")) {
+            copy = true;
+        } else if (option_equals(a, "replace")) {
+            replace = true;
+        } else if (option_equals(a, "auth") && i + 1 < req._args.size()) {
+            auth = { to_sstring(req._args[++i]) };
+        } else if (option_equals(a, "auth2") && i + 2 < req._args.size()) {
+            auth = { to_sstring(req._args[i + 1]), to_sstring(req._args[i + 2]) };
+            i += 2;
+        } else if (option_equals(a, "keys")) {
+            if (!req._args[2].empty()) {
+                return unexpected::make_exception(std::move(req._command),
+                    sstring("-ERR When using MIGRATE KEYS option, the key argument must be set to the empty string\r\n"));
+            }
+            std::move(req._args.begin() + i + 1, req._args.end(), std::back_inserter(keys));
+            break;
+        } else {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+        }
+    }
+    if (keys.empty()) {
+        keys.emplace_back(std::move(req._args[2]));
+    }
+    return seastar::make_shared<migrate>(std::move(req._command), to_sstring(req._args[0]), port, std::move(keys), db,
+        std::chrono::milliseconds(timeout), copy, replace, std::move(auth));
+}
+
+// Returns whether any key was migrated, or given to the target which refused it.
+bool migrate::run(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto schemas = get_local_query_processor().schemas_of(cs.get_keyspace());
+    std::vector<std::optional<rdb_entry>> entries(_keys.size());
+    parallel_for_each(boost::irange(size_t(0), _keys.size()), [this, &proxy, &schemas, &entries, cl, timeout = now + tc.read_timeout, &cs] (size_t i) {
+        return read_rdb_entry(proxy, schemas, _keys[i], cl, timeout, cs).then([&entries, i] (std::optional<rdb_entry> e) {
+            entries[i] = std::move(e);
+        });
+    }).get();
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(db_clock::now().time_since_epoch()).count();
+    rdb_writer writer;
+    // The keys restored, with their payload and time to live in milliseconds.
+    std::vector<std::tuple<bytes, bytes, int64_t>> restores;
+    for (auto& e : entries) {
+        if (!e) {
+            continue;
+        }
+        int64_t ttl = 0;
+        if (e->_expire_ms) {
+            ttl = *e->_expire_ms - now_ms;
+            if (ttl <= 0) {
+                continue;
+            }
+        }
+        restores.emplace_back(e->_key, writer.dump(*e), ttl);
+    }
+    if (restores.empty()) {
+        return false;
+    }
+
+    auto deadline = [this] {
+        return lowres_clock::now() + _timeout;
+    };
+    auto addr = with_timeout(deadline(), gms::inet_address::lookup(_host)).get0();
+    auto socket = with_timeout(deadline(), engine().net().connect(make_ipv4_address(ipv4_addr(addr.raw_addr(), _port)))).get0();
+    auto in = socket.input();
+    auto out = socket.output();
+    // Every reply is awaited for the timeout at most.
+    timer<lowres_clock> expiry([&socket] {
+        socket.shutdown_input();
+        socket.shutdown_output();
+    });
+    std::optional<sstring> error;
+    std::vector<bytes> restored;
+    try {
+        expiry.arm(deadline());
+        size_t replies = 0;
+        if (_auth.size() == 1) {
+            send_command(out, { "AUTH", _auth[0] });
+            ++replies;
+        } else if (_auth.size() == 2) {
+            send_command(out, { "AUTH", _auth[0], _auth[1] });
+            ++replies;
+        }
+        send_command(out, { "SELECT", sprint("%d", _db) });
+        ++replies;
+        // The commands are pipelined, the replies read at the end.
+        for (auto& r : restores) {
+            auto key = to_sstring(std::get<0>(r));
+            auto payload = to_sstring(std::get<1>(r));
+            auto ttl = sprint("%d", std::get<2>(r));
+            if (_replace) {
+                send_command(out, { "RESTORE", key, ttl, payload, "REPLACE" });
+            } else {
+                send_command(out, { "RESTORE", key, ttl, payload });
+            }
+        }
+        for (size_t i = 0; i < replies + restores.size(); ++i) {
+            expiry.rearm(deadline());
+            auto reply = read_reply(in);
+            if (reply[0] == '-') {
+                if (!error) {
+                    error = reply.substr(1);
+                }
+                if (i < replies) {
+                    // Not authenticated or no such database, no key is restored.
+                    break;
+                }
+            } else if (i >= replies) {
+                restored.emplace_back(std::get<0>(restores[i - replies]));
+            }
+        }
+    } catch (...) {
+        expiry.cancel();
+        out.close().handle_exception([] (auto ep) {}).get();
+        in.close().handle_exception([] (auto ep) {}).get();
+        throw;
+    }
+    expiry.cancel();
+    out.close().handle_exception([] (auto ep) {}).get();
+    in.close().handle_exception([] (auto ep) {}).get();
+
+    if (!_copy && !restored.empty()) {
+        std::vector<mutation> ms;
+        for (auto& key : restored) {
+            for (auto& s : schemas.all()) {
+                ms.emplace_back(internal::make_mutation(make_dead(s, key)));
+            }
+        }
+        internal::write_mutation_impl(proxy, std::move(ms), cl, now + tc.write_timeout, cs).get();
+    }
+    if (error) {
+        throw target_error(*error);
+    }
+    return true;
+}
+
+future<redis_message> migrate::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    return seastar::async([this, &proxy, cl, now, &tc, &cs] {
+        return run(proxy, cl, now, tc, cs);
+    }).then_wrapped([] (future<bool> f) {
+        try {
+            if (!f.get0()) {
+                return redis_message::make_exception(sstring("+NOKEY\r\n"));
+            }
+        } catch (target_error& e) {
+            return redis_message::make_exception(sprint("-ERR Target instance replied with error: %s\r\n", e.what()));
+        } catch (std::exception& e) {
+            return redis_message::make_exception(sprint("-IOERR error or timeout migrating to the target instance: %s\r\n", e.what()));
+        }
+        return redis_message::ok();
+    });
+}
+
+}
+}
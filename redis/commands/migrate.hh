@@ -0,0 +1,44 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// MIGRATE host port key|"" destination-db timeout [COPY] [REPLACE] [AUTH password]
+// [AUTH2 username password] [KEYS key [key ...]], moves the keys to another
+// cluster, or to Redis, with DUMP and RESTORE. The keys are deleted once
+// restored, but with COPY.
+class migrate : public abstract_command {
+    sstring _host;
+    uint16_t _port;
+    std::vector<bytes> _keys;
+    uint64_t _db;
+    std::chrono::milliseconds _timeout;
+    bool _copy;
+    bool _replace;
+    // The arguments of AUTH, a password or a user and a password.
+    std::vector<sstring> _auth;
+private:
+    bool run(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs);
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    migrate(bytes&& name, sstring&& host, uint16_t port, std::vector<bytes>&& keys, uint64_t db, std::chrono::milliseconds timeout,
+            bool copy, bool replace, std::vector<sstring>&& auth)
+        : abstract_command(std::move(name))
+        , _host(std::move(host))
+        , _port(port)
+        , _keys(std::move(keys))
+        , _db(db)
+        , _timeout(timeout)
+        , _copy(copy)
+        , _replace(replace)
+        , _auth(std::move(auth))
+    {
+    }
+    ~migrate() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
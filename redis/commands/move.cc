@@ -0,0 +1,60 @@
+#include "redis/commands/move.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/key_copy.hh"
+#include "redis/near_cache.hh"
+#include "redis/query_processor.hh"
+#include "redis/rdb.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "database.hh"
+#include <boost/lexical_cast.hpp>
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> move::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 2, req._args_count);
+    }
+    sstring keyspace;
+    try {
+        keyspace = keyspace_of_db(boost::lexical_cast<uint64_t>(sstring(reinterpret_cast<const char*>(req._args[1].data()), req._args[1].size())));
+    } catch (boost::bad_lexical_cast&) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR value is not an integer or out of range\r\n"));
+    }
+    if (!proxy.get_db().local().has_keyspace(keyspace)) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR DB index is out of range\r\n"));
+    }
+    if (keyspace == cs.get_keyspace()) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR source and destination objects are the same\r\n"));
+    }
+    return seastar::make_shared<move>(std::move(req._command), std::move(req._args[0]), std::move(keyspace));
+}
+
+future<redis_message> move::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto& qp = get_local_query_processor();
+    auto from = qp.schemas_of(cs.get_keyspace());
+    auto to = qp.schemas_of(_keyspace);
+    auto read_timeout = now + tc.read_timeout;
+    return key_exists(proxy, to, _key, cl, read_timeout, cs).then([this, &proxy, from, to, cl, read_timeout, write_timeout = now + tc.write_timeout, &cs] (bool taken) {
+        if (taken) {
+            return make_ready_future<bool>(false);
+        }
+        return copy_key(proxy, from, _key, to, _key, true, cl, read_timeout, write_timeout, cs);
+    }).then([this] (bool moved) {
+        if (!moved) {
+            return redis_message::zero();
+        }
+        // The key of the other database is not invalidated with the command.
+        return invalidate_near_caches(_keyspace, { _key }).then([] {
+            return redis_message::one();
+        });
+    });
+}
+
+}
+}
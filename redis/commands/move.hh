@@ -0,0 +1,27 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// MOVE key db, the partitions of the key are copied to the keyspace of the
+// database and deleted in a single batch.
+class move : public abstract_command {
+    bytes _key;
+    // The keyspace of the destination.
+    sstring _keyspace;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    move(bytes&& name, bytes&& key, sstring&& keyspace)
+        : abstract_command(std::move(name))
+        , _key(std::move(key))
+        , _keyspace(std::move(keyspace))
+    {
+    }
+    ~move() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
@@ -0,0 +1,76 @@
+#include "redis/commands/object.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/hot_keys.hh"
+#include "redis/key_footprint.hh"
+#include "redis/query_processor.hh"
+#include "redis/redis_keyspace.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+// The encodings of Redis for the types of the tables, whatever the size.
+static const std::unordered_map<sstring, sstring> encodings {
+    { STRINGS, "raw" },
+    { BITMAPS, "raw" },
+    { LISTS, "quicklist" },
+    { SETS, "hashtable" },
+    { MAPS, "hashtable" },
+    { ZSETS, "skiplist" },
+    { STREAMS, "stream" },
+};
+
+shared_ptr<abstract_command> object::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 2, req._args_count);
+    }
+    operation op;
+    if (option_equals(req._args[0], "encoding")) {
+        op = operation::encoding;
+    } else if (option_equals(req._args[0], "freq")) {
+        op = operation::freq;
+    } else if (option_equals(req._args[0], "idletime")) {
+        op = operation::idletime;
+    } else if (option_equals(req._args[0], "refcount")) {
+        op = operation::refcount;
+    } else {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR Unknown subcommand or wrong number of arguments for OBJECT\r\n"));
+    }
+    return seastar::make_shared<object>(std::move(req._command), op, std::move(req._args[1]));
+}
+
+future<redis_message> object::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto& schemas = get_local_query_processor().schemas_of(cs.get_keyspace());
+    auto timeout = now + tc.read_timeout;
+    return table_of(proxy, schemas, _key, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (schema_ptr s) {
+        if (!s) {
+            return redis_message::null(cs.get_redis_protocol_version());
+        }
+        switch (_op) {
+        case operation::encoding: {
+            auto it = encodings.find(s->cf_name());
+            return redis_message::make_bytes(to_bytes(it != encodings.end() ? it->second : sstring("raw")));
+        }
+        case operation::freq:
+            return get_key_frequency(_key).then([] (uint64_t freq) {
+                return redis_message::make_long(freq);
+            });
+        case operation::idletime:
+            return last_write_of(proxy, s, _key, cl, timeout, cs).then([] (std::optional<api::timestamp_type> written) {
+                auto idle = written ? std::max(api::new_timestamp() - *written, api::timestamp_type(0)) : 0;
+                return redis_message::make_long(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::microseconds(idle)).count());
+            });
+        case operation::refcount:
+            break;
+        }
+        return redis_message::one();
+    });
+}
+
+}
+}
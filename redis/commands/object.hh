@@ -0,0 +1,31 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// OBJECT ENCODING | FREQ | IDLETIME | REFCOUNT key. The encoding is the one
+// Redis would use for the type of the key, the frequency the estimated recent
+// accesses of HOTKEYS, and the idle time is since the last write of the key,
+// the reads are not tracked.
+class object : public abstract_command {
+public:
+    enum class operation { encoding, freq, idletime, refcount };
+private:
+    operation _op;
+    bytes _key;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    object(bytes&& name, operation op, bytes&& key)
+        : abstract_command(std::move(name))
+        , _op(op)
+        , _key(std::move(key))
+    {
+    }
+    ~object() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
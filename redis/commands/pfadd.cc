@@ -0,0 +1,127 @@
+#include "redis/commands/pfadd.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "redis/hyperloglog.hh"
+#include "redis/key_locks.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+static const sstring wrong_type_error { "-WRONGTYPE Key is not a valid HyperLogLog string value.\r\n" };
+
+// Merges all the fetched values, returns nothing if one of them is not a HyperLogLog.
+static std::optional<hyperloglog> merge_all(mbytes_return_type pd)
+{
+    hyperloglog merged;
+    for (auto& e : pd->data()) {
+        auto h = hyperloglog::decode(e.second);
+        if (!h) {
+            return std::nullopt;
+        }
+        merged.merge(*h);
+    }
+    return merged;
+}
+
+shared_ptr<abstract_command> pfadd::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 1) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    std::vector<bytes> elements;
+    elements.reserve(req._args.size() - 1);
+    elements.insert(elements.end(), std::make_move_iterator(req._args.begin() + 1), std::make_move_iterator(req._args.end()));
+    return seastar::make_shared<pfadd>(std::move(req._command), simple_objects_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), std::move(elements));
+}
+
+future<redis_message> pfadd::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    // The registers are read, updated and written back in one cell, the PFADDs of
+    // a key are serialized or the registers set by one of them could be lost.
+    return with_lock_on_owner(_schema, _key, [this, &proxy, cl, timeout, &cs] {
+        return prefetch_simple(proxy, _schema, _key, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+            auto created = !pd->has_data();
+            auto h = created ? std::optional<hyperloglog>(hyperloglog()) : hyperloglog::decode(pd->data());
+            if (!h) {
+                return redis_message::make_exception(wrong_type_error);
+            }
+            bool changed = false;
+            for (auto& e : _elements) {
+                changed |= h->add(e);
+            }
+            // Cells are immutable, the best we can do is to skip the write when no register was updated.
+            if (!changed && !created) {
+                return redis_message::zero();
+            }
+            return redis::write_mutation(proxy, redis::make_simple(_schema, _key, h->encode()), cl, timeout, cs).then_wrapped([] (auto f) {
+                try {
+                    f.get();
+                } catch (...) {
+                    return redis_message::err();
+                }
+                return redis_message::one();
+            });
+        });
+    });
+}
+
+shared_ptr<abstract_command> pfcount::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 1) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    return seastar::make_shared<pfcount>(std::move(req._command), simple_objects_schema(proxy, cs.get_keyspace()), std::move(req._args));
+}
+
+future<redis_message> pfcount::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    return prefetch_simple(proxy, _schema, _keys, cl, timeout, cs).then([] (auto pd) {
+        auto merged = merge_all(pd);
+        if (!merged) {
+            return redis_message::make_exception(wrong_type_error);
+        }
+        return redis_message::make_long(merged->count());
+    });
+}
+
+shared_ptr<abstract_command> pfmerge::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 1) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    auto destination = req._args[0];
+    return seastar::make_shared<pfmerge>(std::move(req._command), simple_objects_schema(proxy, cs.get_keyspace()), std::move(destination), std::move(req._args));
+}
+
+future<redis_message> pfmerge::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    // The destination is one of the sources, it is locked before they are read,
+    // like for PFADD.
+    return with_lock_on_owner(_schema, _destination, [this, &proxy, cl, timeout, &cs] {
+        return prefetch_simple(proxy, _schema, _keys, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+            auto merged = merge_all(pd);
+            if (!merged) {
+                return redis_message::make_exception(wrong_type_error);
+            }
+            return redis::write_mutation(proxy, redis::make_simple(_schema, _destination, merged->encode()), cl, timeout, cs).then_wrapped([] (auto f) {
+                try {
+                    f.get();
+                } catch (...) {
+                    return redis_message::err();
+                }
+                return redis_message::ok();
+            });
+        });
+    });
+}
+
+}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+class pfadd : public command_with_single_schema {
+    bytes _key;
+    std::vector<bytes> _elements;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    pfadd(bytes&& name, const schema_ptr schema, bytes&& key, std::vector<bytes>&& elements)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _elements(std::move(elements))
+    {
+    }
+    ~pfadd() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+class pfcount : public command_with_single_schema {
+    std::vector<bytes> _keys;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    pfcount(bytes&& name, const schema_ptr schema, std::vector<bytes>&& keys)
+        : command_with_single_schema(std::move(name), schema)
+        , _keys(std::move(keys))
+    {
+    }
+    ~pfcount() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+class pfmerge : public command_with_single_schema {
+    bytes _destination;
+    // The destination is merged as well, it's the first key.
+    std::vector<bytes> _keys;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    pfmerge(bytes&& name, const schema_ptr schema, bytes&& destination, std::vector<bytes>&& keys)
+        : command_with_single_schema(std::move(name), schema)
+        , _destination(std::move(destination))
+        , _keys(std::move(keys))
+    {
+    }
+    ~pfmerge() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
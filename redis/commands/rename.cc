@@ -0,0 +1,49 @@
+#include "redis/commands/rename.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/key_copy.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> rename::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 2, req._args_count);
+    }
+    auto nx = req._command == bytes("renamenx");
+    return seastar::make_shared<rename>(std::move(req._command), std::move(req._args[0]), std::move(req._args[1]), nx);
+}
+
+future<redis_message> rename::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto schemas = get_local_query_processor().schemas_of(cs.get_keyspace());
+    auto read_timeout = now + tc.read_timeout;
+    if (_key == _new_key) {
+        return key_exists(proxy, schemas, _key, cl, read_timeout, cs).then([this] (bool exists) {
+            if (!exists) {
+                return redis_message::make_exception(sstring("-ERR no such key\r\n"));
+            }
+            return _nx ? redis_message::zero() : redis_message::ok();
+        });
+    }
+    auto taken = _nx ? key_exists(proxy, schemas, _new_key, cl, read_timeout, cs) : make_ready_future<bool>(false);
+    return taken.then([this, &proxy, schemas, cl, read_timeout, write_timeout = now + tc.write_timeout, &cs] (bool taken) {
+        if (taken) {
+            return redis_message::zero();
+        }
+        return copy_key(proxy, schemas, _key, schemas, _new_key, true, cl, read_timeout, write_timeout, cs).then([this] (bool renamed) {
+            if (!renamed) {
+                return redis_message::make_exception(sstring("-ERR no such key\r\n"));
+            }
+            return _nx ? redis_message::one() : redis_message::ok();
+        });
+    });
+}
+
+}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// RENAME and RENAMENX key newkey, the partitions of the key are copied to the
+// new key and deleted in a single batch.
+class rename : public abstract_command {
+    bytes _key;
+    bytes _new_key;
+    bool _nx;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    rename(bytes&& name, bytes&& key, bytes&& new_key, bool nx)
+        : abstract_command(std::move(name))
+        , _key(std::move(key))
+        , _new_key(std::move(new_key))
+        , _nx(nx)
+    {
+    }
+    ~rename() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
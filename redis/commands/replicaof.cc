@@ -0,0 +1,51 @@
+#include "redis/commands/replicaof.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include <boost/lexical_cast.hpp>
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> replicaof::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 2) {
+        return unexpected::make_exception(std::move(req._command), sprint("-wrong number of arguments (given %ld, expected 2)\r\n", req._args_count));
+    }
+    if (option_equals(req._args[0], "no") && option_equals(req._args[1], "one")) {
+        return seastar::make_shared<replicaof>(std::move(req._command), std::nullopt);
+    }
+    auto host = sstring(reinterpret_cast<const char*>(req._args[0].data()), req._args[0].size());
+    uint16_t port = 0;
+    try {
+        auto p = boost::lexical_cast<uint32_t>(sstring(reinterpret_cast<const char*>(req._args[1].data()), req._args[1].size()));
+        if (p < 1 || p > 65535) {
+            throw boost::bad_lexical_cast();
+        }
+        port = p;
+    } catch (boost::bad_lexical_cast&) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid master port\r\n"));
+    }
+    return seastar::make_shared<replicaof>(std::move(req._command), std::make_pair(std::move(host), port));
+}
+
+future<redis_message> replicaof::execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config&, service::client_state&)
+{
+    return get_query_processor().invoke_on(0, [master = _master] (auto& qp) {
+        auto& r = qp.get_replica();
+        return master ? r.start(master->first, master->second) : r.stop();
+    }).then_wrapped([] (auto f) {
+        try {
+            f.get();
+        } catch (std::exception& e) {
+            return redis_message::make_exception(sprint("-ERR %s\r\n", e.what()));
+        }
+        return redis_message::ok();
+    });
+}
+
+}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// REPLICAOF host port | NO ONE, and SLAVEOF, the node replicates the Redis
+// master, or stops replicating it and keeps the keys replicated.
+class replicaof : public abstract_command {
+    // None for NO ONE.
+    std::optional<std::pair<sstring, uint16_t>> _master;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    replicaof(bytes&& name, std::optional<std::pair<sstring, uint16_t>>&& master)
+        : abstract_command(std::move(name))
+        , _master(std::move(master))
+    {
+    }
+    ~replicaof() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
@@ -0,0 +1,84 @@
+#include "redis/commands/restore.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/key_copy.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "db_clock.hh"
+#include "seastar/core/future-util.hh"
+#include <boost/lexical_cast.hpp>
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> restore::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 3) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    int64_t ttl_ms = 0;
+    try {
+        ttl_ms = boost::lexical_cast<int64_t>(sstring(reinterpret_cast<const char*>(req._args[1].data()), req._args[1].size()));
+    } catch (boost::bad_lexical_cast&) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR value is not an integer or out of range\r\n"));
+    }
+    if (ttl_ms < 0) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid TTL value, must be >= 0\r\n"));
+    }
+    bool replace = false;
+    bool absttl = false;
+    for (size_t i = 3; i < req._args.size(); ++i) {
+        if (option_equals(req._args[i], "replace")) {
+            replace = true;
+        } else if (option_equals(req._args[i], "absttl")) {
+            absttl = true;
+        } else if ((option_equals(req._args[i], "idletime") || option_equals(req._args[i], "freq")) && i + 1 < req._args.size()) {
+            ++i;
+        } else {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+        }
+    }
+    rdb_entry e;
+    try {
+        e = restore_value(std::move(req._args[0]), req._args[2]);
+    } catch (...) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR DUMP payload version or checksum are wrong\r\n"));
+    }
+    std::optional<long> ttl = 0;
+    if (absttl && ttl_ms) {
+        e._expire_ms = ttl_ms;
+        ttl = ttl_of(e);
+    } else if (ttl_ms) {
+        ttl = (ttl_ms + 999) / 1000;
+    }
+    return seastar::make_shared<restore>(std::move(req._command), std::move(e), ttl, replace);
+}
+
+future<redis_message> restore::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto schemas = get_local_query_processor().schemas_of(cs.get_keyspace());
+    auto absent = make_ready_future<bool>(true);
+    if (!_replace) {
+        absent = key_exists(proxy, schemas, _entry._key, cl, now + tc.read_timeout, cs).then([] (bool exists) {
+            return !exists;
+        });
+    }
+    return absent.then([this, &proxy, schemas, cl, timeout = now + tc.write_timeout, &cs] (bool absent) {
+        if (!absent) {
+            return redis_message::make_exception(sstring("-BUSYKEY Target key name already exists.\r\n"));
+        }
+        auto ms = make_restore_mutations(schemas, std::move(_entry), _ttl, _replace);
+        if (ms.empty()) {
+            return redis_message::ok();
+        }
+        return internal::write_mutation_impl(proxy, std::move(ms), cl, timeout, cs).then([] {
+            return redis_message::ok();
+        });
+    });
+}
+
+}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+#include "redis/rdb.hh"
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// RESTORE key ttl payload [REPLACE] [ABSTTL] [IDLETIME seconds] [FREQ frequency],
+// writes the value of a DUMP payload as a single mutation of the partition of
+// the key. IDLETIME and FREQ are accepted and ignored.
+class restore : public abstract_command {
+    rdb_entry _entry;
+    // None if the key already expired.
+    std::optional<long> _ttl;
+    bool _replace;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    restore(bytes&& name, rdb_entry&& entry, std::optional<long> ttl, bool replace)
+        : abstract_command(std::move(name))
+        , _entry(std::move(entry))
+        , _ttl(ttl)
+        , _replace(replace)
+    {
+    }
+    ~restore() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
@@ -0,0 +1,125 @@
+#include "redis/commands/setbit.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "redis/bitmaps.hh"
+#include "redis/key_locks.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "seastar/core/future-util.hh"
+namespace redis {
+namespace commands {
+
+static std::optional<uint64_t> parse_offset(const bytes& b)
+{
+    auto offset = try_bytes2long(b);
+    if (!offset || *offset < 0 || static_cast<uint64_t>(*offset) > bitmaps::max_offset) {
+        return std::nullopt;
+    }
+    return static_cast<uint64_t>(*offset);
+}
+
+static future<bitmap_return_type> fetch_chunk(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    uint64_t offset,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    auto index = bitmaps::chunk_of(offset >> 3);
+    auto range = query::clustering_range::make_singular(clustering_key_prefix::from_single_value(*schema, long_type->decompose(index)));
+    return prefetch_bitmap(proxy, schema, key, std::vector<query::clustering_range> { std::move(range) }, false, 1, cl, timeout, cs);
+}
+
+shared_ptr<abstract_command> setbit::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 3) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    auto offset = parse_offset(req._args[1]);
+    if (!offset) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR bit offset is not an integer or out of range\r\n"));
+    }
+    auto& value = req._args[2];
+    if (value.size() != 1 || (value[0] != '0' && value[0] != '1')) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR bit is not an integer or out of range\r\n"));
+    }
+    return seastar::make_shared<setbit>(std::move(req._command), bitmaps_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), *offset, value[0] == '1');
+}
+
+future<redis_message> setbit::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    // The chunk is read, changed and written back whole, the SETBITs of a key are
+    // serialized or two of them changing the same chunk could lose a bit.
+    return with_lock_on_owner(_schema, _key, [this, &proxy, cl, timeout, &cs] {
+        auto is_string = exists(proxy, simple_objects_schema(proxy, cs.get_keyspace()), _key, cl, timeout, cs);
+        auto fetched = fetch_chunk(proxy, _schema, _key, _offset, cl, timeout, cs);
+        return when_all(std::move(is_string), std::move(fetched)).then([this, &proxy, cl, timeout, &cs] (auto results) {
+            if (std::get<0>(results).get0()) {
+                return redis_message::wrong_type();
+            }
+            auto pd = std::get<1>(results).get0();
+            auto byte = (_offset >> 3) % bitmaps::chunk_size;
+            auto mask = static_cast<uint8_t>(0x80 >> (_offset & 7));
+            bytes chunk = pd->data().empty() ? bytes() : std::move(pd->data().front().second);
+            bool old = byte < chunk.size() && (static_cast<uint8_t>(chunk[byte]) & mask);
+            if (old == _value && byte < chunk.size()) {
+                return old ? redis_message::one() : redis_message::zero();
+            }
+            if (byte >= chunk.size()) {
+                bytes grown(byte + 1, 0);
+                std::copy(chunk.begin(), chunk.end(), grown.begin());
+                chunk = std::move(grown);
+            }
+            if (_value) {
+                chunk[byte] = static_cast<uint8_t>(chunk[byte]) | mask;
+            } else {
+                chunk[byte] = static_cast<uint8_t>(chunk[byte]) & ~mask;
+            }
+            std::vector<std::pair<int64_t, bytes>> chunks;
+            chunks.emplace_back(std::make_pair(bitmaps::chunk_of(_offset >> 3), std::move(chunk)));
+            return redis::write_mutation(proxy, redis::make_bitmap_chunks(_schema, _key, std::move(chunks)), cl, timeout, cs).then_wrapped([old] (auto f) {
+                try {
+                    f.get();
+                } catch (...) {
+                    return redis_message::err();
+                }
+                return old ? redis_message::one() : redis_message::zero();
+            });
+        });
+    });
+}
+
+shared_ptr<abstract_command> getbit::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 2, req._args_count);
+    }
+    auto offset = parse_offset(req._args[1]);
+    if (!offset) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR bit offset is not an integer or out of range\r\n"));
+    }
+    return seastar::make_shared<getbit>(std::move(req._command), bitmaps_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), *offset);
+}
+
+future<redis_message> getbit::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    auto is_string = exists(proxy, simple_objects_schema(proxy, cs.get_keyspace()), _key, cl, timeout, cs);
+    auto fetched = fetch_chunk(proxy, _schema, _key, _offset, cl, timeout, cs);
+    return when_all(std::move(is_string), std::move(fetched)).then([this] (auto results) {
+        if (std::get<0>(results).get0()) {
+            return redis_message::wrong_type();
+        }
+        auto pd = std::get<1>(results).get0();
+        return bitmaps::chunked_bitmap(pd->data()).bit_at(_offset) ? redis_message::one() : redis_message::zero();
+    });
+}
+
+}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+// SETBIT key offset value, only the chunk holding the bit is read and written.
+class setbit : public command_with_single_schema {
+    bytes _key;
+    uint64_t _offset;
+    bool _value;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    setbit(bytes&& name, const schema_ptr schema, bytes&& key, uint64_t offset, bool value)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _offset(offset)
+        , _value(value)
+    {
+    }
+    ~setbit() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+class getbit : public command_with_single_schema {
+    bytes _key;
+    uint64_t _offset;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    getbit(bytes&& name, const schema_ptr schema, bytes&& key, uint64_t offset)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _offset(offset)
+    {
+    }
+    ~getbit() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
@@ -0,0 +1,197 @@
+#include "redis/commands/slowlog.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/slowlog.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "seastar/core/future-util.hh"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+namespace redis {
+namespace commands {
+
+static constexpr long default_slowlog_count = 10;
+
+shared_ptr<abstract_command> slowlog::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 1) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    auto& op = req._args[0];
+    if (option_equals(op, "get") && req._args_count <= 2) {
+        long count = default_slowlog_count;
+        if (req._args_count == 2) {
+            auto c = try_bytes2long(req._args[1]);
+            if (!c || *c < -1) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR count should be greater than or equal to -1\r\n"));
+            }
+            // -1 returns all the entries.
+            count = *c == -1 ? std::numeric_limits<long>::max() : *c;
+        }
+        return seastar::make_shared<slowlog>(std::move(req._command), operation::get, count);
+    } else if (option_equals(op, "len") && req._args_count == 1) {
+        return seastar::make_shared<slowlog>(std::move(req._command), operation::len, 0);
+    } else if (option_equals(op, "reset") && req._args_count == 1) {
+        return seastar::make_shared<slowlog>(std::move(req._command), operation::reset, 0);
+    }
+    return unexpected::make_exception(std::move(req._command), sprint("-ERR unknown subcommand or wrong number of arguments for '%s'\r\n", sstring(reinterpret_cast<const char*>(op.data()), op.size())));
+}
+
+future<redis_message> slowlog::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto& qp = get_query_processor();
+    switch (_op) {
+    case operation::get: {
+        auto count = static_cast<size_t>(_count);
+        return qp.map_reduce0([count] (auto& qp) {
+            return qp.get_slowlog().get(count);
+        }, std::vector<slowlog_entry> {}, [] (auto&& all, auto&& entries) {
+            all.insert(all.end(), std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()));
+            return std::move(all);
+        }).then([count] (auto&& entries) {
+            // The ids are per shard, make them unique.
+            for (auto& e : entries) {
+                e._id = e._id * smp::count + e._shard;
+            }
+            std::sort(entries.begin(), entries.end(), [] (auto& a, auto& b) {
+                return a._timestamp > b._timestamp;
+            });
+            if (entries.size() > count) {
+                entries.resize(count);
+            }
+            return redis_message::make_slowlog_entries(make_lw_shared<std::vector<slowlog_entry>>(std::move(entries)));
+        });
+    }
+    case operation::len:
+        return qp.map_reduce0([] (auto& qp) {
+            return qp.get_slowlog().size();
+        }, size_t { 0 }, std::plus<size_t>()).then([] (size_t len) {
+            return redis_message::make_long(static_cast<long>(len));
+        });
+    case operation::reset:
+        return qp.invoke_on_all([] (auto& qp) {
+            qp.get_slowlog().reset();
+        }).then([] {
+            return redis_message::ok();
+        });
+    }
+    return redis_message::err();
+}
+
+shared_ptr<abstract_command> latency::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 1) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    auto& op = req._args[0];
+    std::vector<sstring> events;
+    for (size_t i = 1; i < req._args.size(); ++i) {
+        auto& e = req._args[i];
+        sstring event(reinterpret_cast<const char*>(e.data()), e.size());
+        std::transform(event.begin(), event.end(), event.begin(), ::tolower);
+        events.emplace_back(std::move(event));
+    }
+    if (option_equals(op, "latest") && req._args_count == 1) {
+        return seastar::make_shared<latency>(std::move(req._command), operation::latest, std::move(events));
+    } else if (option_equals(op, "history") && req._args_count == 2) {
+        return seastar::make_shared<latency>(std::move(req._command), operation::history, std::move(events));
+    } else if (option_equals(op, "reset")) {
+        return seastar::make_shared<latency>(std::move(req._command), operation::reset, std::move(events));
+    }
+    return unexpected::make_exception(std::move(req._command), sprint("-ERR unknown subcommand or wrong number of arguments for '%s'\r\n", sstring(reinterpret_cast<const char*>(op.data()), op.size())));
+}
+
+future<redis_message> latency::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto& qp = get_query_processor();
+    switch (_op) {
+    case operation::latest: {
+        // event -> (the time of the latest spike, the latest latency, the maximum latency)
+        using latest_type = std::map<sstring, std::tuple<int64_t, uint32_t, uint32_t>>;
+        return qp.map_reduce0([] (auto& qp) {
+            latest_type latest;
+            for (auto& e : qp.get_latency_monitor().events()) {
+                if (!e.second._samples.empty()) {
+                    auto& last = e.second._samples.back();
+                    latest.emplace(e.first, std::make_tuple(last._timestamp, last._latency, e.second._max));
+                }
+            }
+            return latest;
+        }, latest_type {}, [] (auto&& all, auto&& latest) {
+            for (auto& e : latest) {
+                auto it = all.find(e.first);
+                if (it == all.end()) {
+                    all.emplace(e.first, e.second);
+                    continue;
+                }
+                auto& a = it->second;
+                auto& b = e.second;
+                auto max = std::max(std::get<2>(a), std::get<2>(b));
+                if (std::make_pair(std::get<0>(b), std::get<1>(b)) > std::make_pair(std::get<0>(a), std::get<1>(a))) {
+                    a = b;
+                }
+                std::get<2>(a) = max;
+            }
+            return std::move(all);
+        }).then([] (auto&& latest) {
+            auto r = make_lw_shared<std::vector<std::tuple<sstring, int64_t, uint32_t, uint32_t>>>();
+            r->reserve(latest.size());
+            for (auto& e : latest) {
+                r->emplace_back(e.first, std::get<0>(e.second), std::get<1>(e.second), std::get<2>(e.second));
+            }
+            return redis_message::make_latency_latest(r);
+        });
+    }
+    case operation::history: {
+        // timestamp -> the highest latency of the second, on all shards.
+        using history_type = std::map<int64_t, uint32_t>;
+        auto& event = _events.front();
+        return qp.map_reduce0([event] (auto& qp) {
+            history_type history;
+            auto& events = qp.get_latency_monitor().events();
+            auto it = events.find(event);
+            if (it != events.end()) {
+                for (auto& s : it->second._samples) {
+                    history.emplace(s._timestamp, s._latency);
+                }
+            }
+            return history;
+        }, history_type {}, [] (auto&& all, auto&& history) {
+            for (auto& s : history) {
+                auto& l = all[s.first];
+                l = std::max(l, s.second);
+            }
+            return std::move(all);
+        }).then([] (auto&& history) {
+            auto r = make_lw_shared<std::vector<latency_monitor::sample>>();
+            auto skip = history.size() > latency_monitor::max_samples ? history.size() - latency_monitor::max_samples : 0;
+            for (auto& s : history) {
+                if (skip) {
+                    --skip;
+                    continue;
+                }
+                r->emplace_back(latency_monitor::sample { s.first, s.second });
+            }
+            return redis_message::make_latency_history(r);
+        });
+    }
+    case operation::reset:
+        return qp.map_reduce0([events = _events] (auto& qp) {
+            return qp.get_latency_monitor().reset(events);
+        }, std::set<sstring> {}, [] (auto&& all, auto&& reset) {
+            all.insert(reset.begin(), reset.end());
+            return std::move(all);
+        }).then([] (auto&& reset) {
+            return redis_message::make_long(static_cast<long>(reset.size()));
+        });
+    }
+    return redis_message::err();
+}
+
+}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "redis/request.hh"
+#include "redis/abstract_command.hh"
+#include <vector>
+
+class timeout_config;
+namespace redis {
+namespace commands {
+// SLOWLOG GET [count] | LEN | RESET, over the slowlogs of all shards.
+class slowlog : public abstract_command {
+public:
+    enum class operation { get, len, reset };
+private:
+    operation _op;
+    long _count;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    slowlog(bytes&& name, operation op, long count)
+        : abstract_command(std::move(name))
+        , _op(op)
+        , _count(count)
+    {
+    }
+    ~slowlog() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+// LATENCY LATEST | HISTORY event | RESET [event ...], the events are the names of the commands.
+class latency : public abstract_command {
+public:
+    enum class operation { latest, history, reset };
+private:
+    operation _op;
+    std::vector<sstring> _events;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    latency(bytes&& name, operation op, std::vector<sstring>&& events)
+        : abstract_command(std::move(name))
+        , _op(op)
+        , _events(std::move(events))
+    {
+    }
+    ~latency() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+}
+}
@@ -26,13 +26,7 @@ shared_ptr<abstract_command> smembers::prepare(service::storage_proxy& proxy, co
 
 future<redis_message> smembers::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
-    auto timeout = now + tc.read_timeout;
-    return prefetch_set(proxy, _schema, _key, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
-        if (pd && pd->has_data()) {
-            return redis_message::make_map_key_bytes(pd);
-        }
-        return redis_message::null(); 
-    });
+    return fetch_collection_reply(proxy, _schema, _key, fetch_options::keys, true, cl, tc, cs);
 }
 
 }
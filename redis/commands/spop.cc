@@ -41,7 +41,7 @@ future<redis_message> spop::execute(service::storage_proxy& proxy, db::consisten
                 return redis_message::make_set_bytes(pd, index); 
             });
         }
-        return redis_message::null(); 
+        return redis_message::null(cs.get_redis_protocol_version()); 
     });
 }
 
@@ -64,7 +64,7 @@ future<redis_message> srandmember::execute(service::storage_proxy& proxy, db::co
             auto indexes = make_random_indexes(pd->data().size(), _count);
             return redis_message::make_set_bytes(pd, std::move(indexes)); 
         }
-        return redis_message::null(); 
+        return redis_message::null(cs.get_redis_protocol_version()); 
     });
 }
 
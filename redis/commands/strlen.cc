@@ -27,7 +27,13 @@ future<redis_message> strlen::execute(service::storage_proxy& proxy, db::consist
         if (pd && pd->has_data()) {
             return redis_message::make_long(static_cast<long>(pd->data_size()));
         }
-        return redis_message::make_long(long { 0 } );
+        // A bitmap is not a string, see bitmaps.hh.
+        return exists(proxy, bitmaps_schema(proxy, cs.get_keyspace()), _key, cl, timeout, cs).then([] (bool is_bitmap) {
+            if (is_bitmap) {
+                return redis_message::wrong_type();
+            }
+            return redis_message::make_long(long { 0 } );
+        });
     });
 }
 }
@@ -0,0 +1,132 @@
+#include "redis/commands/xadd.hh"
+#include "redis/commands/xgroup.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "redis/blocked_clients.hh"
+#include "redis/key_locks.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "db_clock.hh"
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> xadd::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 4) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 4, req._args_count);
+    }
+    size_t i = 1;
+    bool nomkstream = false;
+    if (option_equals(req._args[i], "nomkstream")) {
+        nomkstream = true;
+        ++i;
+    }
+    std::optional<stream_trim_options> trim;
+    if (i < req._args.size() && (option_equals(req._args[i], "maxlen") || option_equals(req._args[i], "minid"))) {
+        trim = parse_stream_trim_options(req._args, i);
+        if (!trim) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+        }
+    }
+    if (i >= req._args.size()) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    std::optional<uint64_t> ms, seq;
+    auto& id = req._args[i++];
+    if (!(id.size() == 1 && id[0] == '*')) {
+        std::optional<stream_id> parsed;
+        if (id.size() > 2 && id[id.size() - 2] == '-' && id.back() == '*') {
+            parsed = parse_stream_id(bytes(id.begin(), id.end() - 2));
+        } else {
+            parsed = parse_stream_id(id);
+            if (parsed) {
+                seq = parsed->_seq;
+            }
+        }
+        if (!parsed) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid stream ID specified as stream command argument\r\n"));
+        }
+        ms = parsed->_ms;
+    }
+    auto fields_count = req._args.size() - i;
+    if (fields_count == 0 || fields_count % 2 != 0) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR wrong number of arguments for 'xadd' command\r\n"));
+    }
+    std::vector<bytes> fields;
+    fields.reserve(fields_count);
+    fields.insert(fields.end(), std::make_move_iterator(req._args.begin() + i), std::make_move_iterator(req._args.end()));
+    return seastar::make_shared<xadd>(std::move(req._command), streams_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), nomkstream, ms, seq, trim, std::move(fields));
+}
+
+std::optional<stream_id> xadd::make_id(const std::optional<stream_id>& top) const
+{
+    if (!_ms) {
+        uint64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(db_clock::now().time_since_epoch()).count();
+        if (top && ms <= top->_ms) {
+            return top->next();
+        }
+        return stream_id { ms, 0 };
+    }
+    stream_id id { *_ms, _seq ? *_seq : 0 };
+    if (!_seq) {
+        if (top && *_ms == top->_ms) {
+            if (top->_seq == std::numeric_limits<uint64_t>::max()) {
+                return std::nullopt;
+            }
+            id = top->next();
+        } else if (*_ms == 0) {
+            id._seq = 1;
+        }
+    }
+    if (id == stream_id::min() || (top && id <= *top)) {
+        return std::nullopt;
+    }
+    return id;
+}
+
+future<redis_message> xadd::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    // The new ID must be greater than the top item, the XADDs of the stream are
+    // serialized from its top ID to its write, or two of them could add the same ID.
+    return with_lock_on_owner(_schema, _key, [this, &proxy, cl, timeout, &cs] {
+        return fetch_top_id(proxy, _schema, _key, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto top) {
+            // A stream only exists while it has entries.
+            if (!top && _nomkstream) {
+                return redis_message::null(cs.get_redis_protocol_version());
+            }
+            auto id = make_id(top);
+            if (!id) {
+                if (_ms && _seq && *_ms == 0 && *_seq == 0) {
+                    return redis_message::make_exception(sstring("-ERR The ID specified in XADD must be greater than 0-0\r\n"));
+                }
+                return redis_message::make_exception(sstring("-ERR The ID specified in XADD is equal or smaller than the target stream top item\r\n"));
+            }
+            std::vector<std::pair<stream_id, bytes>> cells;
+            cells.emplace_back(std::make_pair(*id, encode_stream_fields(_fields)));
+            return redis::write_mutation(proxy, redis::make_stream_cells(_schema, _key, std::move(cells)), cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] {
+                if (_trim) {
+                    return trim_stream(proxy, _schema, _key, *_trim, false, cl, timeout, cs).discard_result();
+                }
+                return make_ready_future<>();
+            }).then([this] {
+                // Wake up the clients blocked on this stream (XREAD, XREADGROUP).
+                return notify_blocked_clients(_schema, _key);
+            }).then_wrapped([id = *id] (auto f) {
+                try {
+                    f.get();
+                } catch (...) {
+                    return redis_message::err();
+                }
+                return redis_message::make_stream_id(id);
+            });
+        });
+    });
+}
+
+}
+}
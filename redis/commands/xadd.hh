@@ -0,0 +1,41 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include "redis/commands/xtrim.hh"
+#include <optional>
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+// XADD key [NOMKSTREAM] [MAXLEN|MINID [=|~] threshold] *|id field value [field value ...]
+class xadd : public command_with_single_schema {
+    bytes _key;
+    // NOMKSTREAM, nothing is added to a stream which doesn't exist.
+    bool _nomkstream;
+    // An absent part of the ID is generated, from the clock (ms) or from the top item (seq).
+    std::optional<uint64_t> _ms;
+    std::optional<uint64_t> _seq;
+    std::optional<stream_trim_options> _trim;
+    std::vector<bytes> _fields;
+    std::optional<stream_id> make_id(const std::optional<stream_id>& top) const;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xadd(bytes&& name, const schema_ptr schema, bytes&& key, bool nomkstream, std::optional<uint64_t> ms, std::optional<uint64_t> seq, std::optional<stream_trim_options> trim, std::vector<bytes>&& fields)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _nomkstream(nomkstream)
+        , _ms(ms)
+        , _seq(seq)
+        , _trim(trim)
+        , _fields(std::move(fields))
+    {
+    }
+    ~xadd() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
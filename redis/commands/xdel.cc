@@ -0,0 +1,60 @@
+#include "redis/commands/xdel.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include <boost/range/adaptor/transformed.hpp>
+#include <boost/range/algorithm/sort.hpp>
+#include <boost/range/algorithm/unique.hpp>
+#include <boost/range/algorithm_ext/erase.hpp>
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> xdel::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 2) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 2, req._args_count);
+    }
+    std::vector<stream_id> ids;
+    ids.reserve(req._args.size() - 1);
+    for (size_t i = 1; i < req._args.size(); ++i) {
+        auto id = parse_stream_id(req._args[i]);
+        if (!id) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid stream ID specified as stream command argument\r\n"));
+        }
+        ids.emplace_back(*id);
+    }
+    // The clustering ranges of a read must be ordered and must not overlap.
+    boost::erase(ids, boost::unique<boost::return_found_end>(boost::sort(ids)));
+    return seastar::make_shared<xdel>(std::move(req._command), streams_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), std::move(ids));
+}
+
+future<redis_message> xdel::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    auto ranges = boost::copy_range<std::vector<query::clustering_range>>(_ids | boost::adaptors::transformed([this] (auto& id) {
+        return query::clustering_range::make_singular(id.to_clustering_key(*_schema));
+    }));
+    return prefetch_stream(proxy, _schema, _key, std::move(ranges), false, std::numeric_limits<uint32_t>::max(), cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+        if (!pd->has_data() || pd->data().empty()) {
+            return redis_message::zero();
+        }
+        auto removed = boost::copy_range<std::vector<stream_id>>(pd->data() | boost::adaptors::transformed([] (auto& e) { return e.first; }));
+        auto total = static_cast<long>(removed.size());
+        return redis::write_mutation(proxy, redis::make_stream_dead_cells(_schema, _key, std::move(removed)), cl, timeout, cs).then_wrapped([total] (auto f) {
+            try {
+                f.get();
+            } catch (...) {
+                return redis_message::err();
+            }
+            return redis_message::make_long(total);
+        });
+    });
+}
+
+}
+}
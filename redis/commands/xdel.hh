@@ -0,0 +1,28 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include "redis/streams.hh"
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+class xdel : public command_with_single_schema {
+    bytes _key;
+    std::vector<stream_id> _ids;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xdel(bytes&& name, const schema_ptr schema, bytes&& key, std::vector<stream_id>&& ids)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _ids(std::move(ids))
+    {
+    }
+    ~xdel() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
@@ -0,0 +1,238 @@
+#include "redis/commands/xgroup.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include <boost/range/adaptor/transformed.hpp>
+#include <boost/range/algorithm/sort.hpp>
+#include <boost/range/algorithm/unique.hpp>
+#include <boost/range/algorithm_ext/erase.hpp>
+namespace redis {
+namespace commands {
+
+static sstring make_no_group_error(const bytes& key, const bytes& group)
+{
+    return sprint("-NOGROUP No such key '%s' or consumer group '%s'\r\n", abstract_command::make_sstring(key), abstract_command::make_sstring(group));
+}
+
+future<std::optional<stream_id>> fetch_last_delivered(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    const bytes& group,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    auto ranges = std::vector<nonwrapping_range<stream_id>> { nonwrapping_range<stream_id>::make_singular(stream_id::group_metadata()) };
+    return prefetch_stream_group(proxy, schema, key, group, std::move(ranges), cl, timeout, cs).then([] (auto pd) {
+        std::optional<stream_id> id;
+        if (pd->has_data() && !pd->data().empty()) {
+            id = parse_stream_id(pd->data().front().second);
+        }
+        return id;
+    });
+}
+
+future<std::optional<stream_id>> fetch_top_id(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    return prefetch_stream(proxy, schema, key, std::vector<query::clustering_range> { query::clustering_range::make_open_ended_both_sides() },
+            true, 1, cl, timeout, cs).then([] (auto pd) {
+        std::optional<stream_id> id;
+        if (pd->has_data() && !pd->data().empty()) {
+            id = pd->data().front().first;
+        }
+        return id;
+    });
+}
+
+static std::vector<schema_ptr> stream_group_schemas(service::storage_proxy& proxy, const service::client_state& cs)
+{
+    return std::vector<schema_ptr> {
+        streams_schema(proxy, cs.get_keyspace()),
+        stream_groups_schema(proxy, cs.get_keyspace())
+    };
+}
+
+shared_ptr<abstract_command> xgroup::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 3) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    auto& sub = req._args[0];
+    subcommand s;
+    if (option_equals(sub, "create")) {
+        s = subcommand::create;
+    } else if (option_equals(sub, "setid")) {
+        s = subcommand::setid;
+    } else if (option_equals(sub, "destroy")) {
+        s = subcommand::destroy;
+    } else {
+        return unexpected::make_exception(std::move(req._command), sprint("-ERR Unknown XGROUP subcommand '%s'\r\n", abstract_command::make_sstring(sub)));
+    }
+    std::optional<stream_id> id;
+    bool mkstream = false;
+    if (s == subcommand::destroy) {
+        if (req._args_count != 3) {
+            return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+        }
+    } else {
+        if (req._args_count < 4) {
+            return unexpected::make_wrong_arguments_exception(std::move(req._command), 4, req._args_count);
+        }
+        auto& i = req._args[3];
+        if (!(i.size() == 1 && i[0] == '$')) {
+            id = parse_stream_id(i);
+            if (!id) {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid stream ID specified as stream command argument\r\n"));
+            }
+        }
+        for (size_t k = 4; k < req._args.size(); ++k) {
+            if (s == subcommand::create && option_equals(req._args[k], "mkstream")) {
+                mkstream = true;
+            } else {
+                return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+            }
+        }
+    }
+    return seastar::make_shared<xgroup>(std::move(req._command), stream_group_schemas(proxy, cs), s, std::move(req._args[1]), std::move(req._args[2]), id, mkstream);
+}
+
+future<redis_message> xgroup::set_id(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs, bool create)
+{
+    return fetch_last_delivered(proxy, _schemas[1], _key, _group, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs, create] (auto last_delivered) {
+        if (create && last_delivered) {
+            return redis_message::make_exception(sstring("-BUSYGROUP Consumer Group name already exists\r\n"));
+        }
+        if (!create && !last_delivered) {
+            return redis_message::make_exception(make_no_group_error(_key, _group));
+        }
+        return fetch_top_id(proxy, _schemas[0], _key, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs, create] (auto top) {
+            if (!top && !(create && _mkstream)) {
+                return redis_message::make_exception(sstring("-ERR The XGROUP subcommand requires the key to exist. "
+                    "Note that for CREATE you may want to use the MKSTREAM option to create an empty stream automatically.\r\n"));
+            }
+            auto id = _id ? *_id : (top ? *top : stream_id::min());
+            auto m = redis::make_stream_group_cells(_schemas[1], _key, _group, id, std::vector<std::pair<stream_id, bytes>> {});
+            return redis::write_mutation(proxy, m, cl, timeout, cs).then_wrapped([] (auto f) {
+                try {
+                    f.get();
+                } catch (...) {
+                    return redis_message::err();
+                }
+                return redis_message::ok();
+            });
+        });
+    });
+}
+
+future<redis_message> xgroup::destroy(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    return fetch_last_delivered(proxy, _schemas[1], _key, _group, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto last_delivered) {
+        if (!last_delivered) {
+            return redis_message::zero();
+        }
+        return redis::write_mutation(proxy, redis::make_stream_group_dead_cells(_schemas[1], _key, _group, std::vector<stream_id> {}), cl, timeout, cs).then_wrapped([] (auto f) {
+            try {
+                f.get();
+            } catch (...) {
+                return redis_message::err();
+            }
+            return redis_message::one();
+        });
+    });
+}
+
+future<redis_message> xgroup::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    switch (_subcommand) {
+    case subcommand::create:
+        return set_id(proxy, cl, timeout, cs, true);
+    case subcommand::setid:
+        return set_id(proxy, cl, timeout, cs, false);
+    case subcommand::destroy:
+        return destroy(proxy, cl, timeout, cs);
+    }
+    return redis_message::err();
+}
+
+shared_ptr<abstract_command> xack::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 3) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    std::vector<stream_id> ids;
+    ids.reserve(req._args.size() - 2);
+    for (size_t i = 2; i < req._args.size(); ++i) {
+        auto id = parse_stream_id(req._args[i]);
+        if (!id) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid stream ID specified as stream command argument\r\n"));
+        }
+        // 0-0 is never pending, its row holds the metadata of the group.
+        if (*id != stream_id::group_metadata()) {
+            ids.emplace_back(*id);
+        }
+    }
+    // The clustering ranges of a read must be ordered and must not overlap.
+    boost::erase(ids, boost::unique<boost::return_found_end>(boost::sort(ids)));
+    return seastar::make_shared<xack>(std::move(req._command), stream_group_schemas(proxy, cs), std::move(req._args[0]), std::move(req._args[1]), std::move(ids));
+}
+
+future<redis_message> xack::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    if (_ids.empty()) {
+        return redis_message::zero();
+    }
+    auto ranges = boost::copy_range<std::vector<nonwrapping_range<stream_id>>>(_ids | boost::adaptors::transformed([] (auto& id) {
+        return nonwrapping_range<stream_id>::make_singular(id);
+    }));
+    return prefetch_stream_group(proxy, _schemas[1], _key, _group, std::move(ranges), cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+        if (!pd->has_data() || pd->data().empty()) {
+            return redis_message::zero();
+        }
+        auto acked = boost::copy_range<std::vector<stream_id>>(pd->data() | boost::adaptors::transformed([] (auto& e) { return e.first; }));
+        auto total = static_cast<long>(acked.size());
+        return redis::write_mutation(proxy, redis::make_stream_group_dead_cells(_schemas[1], _key, _group, std::move(acked)), cl, timeout, cs).then_wrapped([total] (auto f) {
+            try {
+                f.get();
+            } catch (...) {
+                return redis_message::err();
+            }
+            return redis_message::make_long(total);
+        });
+    });
+}
+
+shared_ptr<abstract_command> xpending::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 2) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR only the summary form of XPENDING is supported\r\n"));
+    }
+    return seastar::make_shared<xpending>(std::move(req._command), stream_group_schemas(proxy, cs), std::move(req._args[0]), std::move(req._args[1]));
+}
+
+future<redis_message> xpending::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    auto ranges = std::vector<nonwrapping_range<stream_id>> { nonwrapping_range<stream_id>::make_open_ended_both_sides() };
+    return prefetch_stream_group(proxy, _schemas[1], _key, _group, std::move(ranges), cl, timeout, cs).then([this] (auto pd) {
+        // The metadata row sorts first.
+        if (!pd->has_data() || pd->data().empty() || pd->data().front().first != stream_id::group_metadata()) {
+            return redis_message::make_exception(make_no_group_error(_key, _group));
+        }
+        return redis_message::make_stream_pending_summary(pd);
+    });
+}
+
+}
+}
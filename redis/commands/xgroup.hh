@@ -0,0 +1,99 @@
+#pragma once
+#include "redis/command_with_multi_schemas.hh"
+#include "redis/request.hh"
+#include "redis/streams.hh"
+#include <optional>
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+
+// The consumer group commands work on two schemas, the entries of the
+// streams (_schemas[0]) and the consumer groups (_schemas[1]).
+
+// Returns the last delivered ID of the group, or nothing if the group does not exist.
+future<std::optional<stream_id>> fetch_last_delivered(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    const bytes& group,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs);
+
+// Returns the ID of the top item of the stream, or nothing if the stream is empty.
+future<std::optional<stream_id>> fetch_top_id(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs);
+
+// XGROUP CREATE key group id|$ [MKSTREAM], XGROUP SETID key group id|$, XGROUP DESTROY key group
+class xgroup : public command_with_multi_schemas {
+public:
+    enum class subcommand { create, setid, destroy };
+private:
+    subcommand _subcommand;
+    bytes _key;
+    bytes _group;
+    // Nothing means '$', the top item of the stream.
+    std::optional<stream_id> _id;
+    bool _mkstream;
+    future<redis_message> create(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs);
+    future<redis_message> destroy(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs);
+    future<redis_message> set_id(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs, bool create);
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xgroup(bytes&& name, std::vector<schema_ptr>&& schemas, subcommand sub, bytes&& key, bytes&& group, std::optional<stream_id> id, bool mkstream)
+        : command_with_multi_schemas(std::move(name), std::move(schemas))
+        , _subcommand(sub)
+        , _key(std::move(key))
+        , _group(std::move(group))
+        , _id(id)
+        , _mkstream(mkstream)
+    {
+    }
+    ~xgroup() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+// XACK key group id [id ...], removes the entries from the pending list of the group.
+class xack : public command_with_multi_schemas {
+    bytes _key;
+    bytes _group;
+    std::vector<stream_id> _ids;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xack(bytes&& name, std::vector<schema_ptr>&& schemas, bytes&& key, bytes&& group, std::vector<stream_id>&& ids)
+        : command_with_multi_schemas(std::move(name), std::move(schemas))
+        , _key(std::move(key))
+        , _group(std::move(group))
+        , _ids(std::move(ids))
+    {
+    }
+    ~xack() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+// XPENDING key group, the summary form only. The idle time and the delivery counter
+// of the extended form are not tracked.
+class xpending : public command_with_multi_schemas {
+    bytes _key;
+    bytes _group;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xpending(bytes&& name, std::vector<schema_ptr>&& schemas, bytes&& key, bytes&& group)
+        : command_with_multi_schemas(std::move(name), std::move(schemas))
+        , _key(std::move(key))
+        , _group(std::move(group))
+    {
+    }
+    ~xpending() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
@@ -0,0 +1,33 @@
+#include "redis/commands/xlen.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/prefetcher.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+shared_ptr<abstract_command> xlen::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count != 1) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 1, req._args_count);
+    }
+    return seastar::make_shared<xlen>(std::move(req._command), streams_schema(proxy, cs.get_keyspace()), std::move(req._args[0]));
+}
+
+future<redis_message> xlen::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    return prefetch_stream(proxy, _schema, _key, std::vector<query::clustering_range> { query::clustering_range::make_open_ended_both_sides() },
+            false, std::numeric_limits<uint32_t>::max(), cl, timeout, cs).then([] (auto pd) {
+        if (pd->has_data()) {
+            return redis_message::make_long(static_cast<long>(pd->data().size()));
+        }
+        return redis_message::zero();
+    });
+}
+
+}
+}
@@ -0,0 +1,76 @@
+#include "redis/commands/xrange.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/prefetcher.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+// A boundary prefixed with '(' is exclusive.
+template<typename Parser>
+static std::optional<std::pair<stream_id, bool>> parse_boundary(const bytes& b, Parser&& parser)
+{
+    if (!b.empty() && b[0] == '(') {
+        auto id = parser(bytes(b.begin() + 1, b.end()));
+        if (!id) {
+            return std::nullopt;
+        }
+        return std::make_pair(*id, false);
+    }
+    auto id = parser(b);
+    if (!id) {
+        return std::nullopt;
+    }
+    return std::make_pair(*id, true);
+}
+
+template<typename RangeType>
+shared_ptr<abstract_command> prepare_impl(service::storage_proxy& proxy, const service::client_state& cs, request&& req, bool reversed)
+{
+    if (req._args_count != 3 && req._args_count != 5) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    auto start = parse_boundary(req._args[reversed ? 2 : 1], parse_stream_range_start);
+    auto end = parse_boundary(req._args[reversed ? 1 : 2], parse_stream_range_end);
+    if (!start || !end) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid stream ID specified as stream command argument\r\n"));
+    }
+    long count = -1;
+    if (req._args_count == 5) {
+        if (!option_equals(req._args[3], "count") || !is_number(req._args[4])) {
+            return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+        }
+        count = bytes2long(req._args[4]);
+    }
+    return seastar::make_shared<RangeType>(std::move(req._command), streams_schema(proxy, cs.get_keyspace()), std::move(req._args[0]),
+        start->first, start->second, end->first, end->second, count);
+}
+
+shared_ptr<abstract_command> xrange::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    return prepare_impl<xrange>(proxy, cs, std::move(req), false);
+}
+
+shared_ptr<abstract_command> xrevrange::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    return prepare_impl<xrevrange>(proxy, cs, std::move(req), true);
+}
+
+future<redis_message> xrange::execute_impl(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs, bool reversed)
+{
+    if (_count == 0 || _end < _start || (_end == _start && !(_start_inclusive && _end_inclusive))) {
+        return redis_message::make_empty_list_bytes();
+    }
+    auto timeout = now + tc.read_timeout;
+    auto range = query::clustering_range::make({ _start.to_clustering_key(*_schema), _start_inclusive }, { _end.to_clustering_key(*_schema), _end_inclusive });
+    auto limit = _count < 0 ? std::numeric_limits<uint32_t>::max() : static_cast<uint32_t>(std::min<long>(_count, std::numeric_limits<uint32_t>::max()));
+    return prefetch_stream(proxy, _schema, _key, std::vector<query::clustering_range> { std::move(range) }, reversed, limit, cl, timeout, cs).then([] (auto pd) {
+        return redis_message::make_stream_entries(pd);
+    });
+}
+
+}
+}
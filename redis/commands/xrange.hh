@@ -0,0 +1,54 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include "redis/streams.hh"
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+// XRANGE key start end [COUNT count], served by a clustering range read.
+class xrange : public command_with_single_schema {
+protected:
+    bytes _key;
+    stream_id _start;
+    bool _start_inclusive;
+    stream_id _end;
+    bool _end_inclusive;
+    long _count;
+    future<redis_message> execute_impl(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs, bool reversed);
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xrange(bytes&& name, const schema_ptr schema, bytes&& key, stream_id start, bool start_inclusive, stream_id end, bool end_inclusive, long count)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _start(start)
+        , _start_inclusive(start_inclusive)
+        , _end(end)
+        , _end_inclusive(end_inclusive)
+        , _count(count)
+    {
+    }
+    ~xrange() {}
+    future<redis_message> execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs) override {
+        return execute_impl(proxy, cl, now, tc, cs, false);
+    }
+};
+
+// XREVRANGE key end start [COUNT count]
+class xrevrange : public xrange {
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xrevrange(bytes&& name, const schema_ptr schema, bytes&& key, stream_id start, bool start_inclusive, stream_id end, bool end_inclusive, long count)
+        : xrange(std::move(name), schema, std::move(key), start, start_inclusive, end, end_inclusive, count)
+    {
+    }
+    ~xrevrange() {}
+    future<redis_message> execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs) override {
+        return execute_impl(proxy, cl, now, tc, cs, true);
+    }
+};
+}
+}
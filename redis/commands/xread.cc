@@ -0,0 +1,322 @@
+#include "redis/commands/xread.hh"
+#include "redis/commands/xgroup.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "redis/blocked_clients.hh"
+#include "redis/key_locks.hh"
+#include "redis/query_processor.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "seastar/core/future-util.hh"
+#include <boost/range/irange.hpp>
+#include <boost/range/adaptor/transformed.hpp>
+namespace redis {
+namespace commands {
+
+struct stream_read_options {
+    long _count = -1;
+    std::optional<long> _block;
+    bool _noack = false;
+    std::optional<std::pair<bytes, bytes>> _group;
+    std::vector<bytes> _keys;
+    std::vector<bytes> _ids;
+};
+
+static bool is_unsigned(const bytes& b)
+{
+    return !b.empty() && std::all_of(b.begin(), b.end(), [] (auto c) { return std::isdigit(c); });
+}
+
+// Returns the error message, or an empty string if the options are valid.
+static sstring parse_stream_read_options(std::vector<bytes>& args, bool with_group, stream_read_options& options)
+{
+    size_t i = 0;
+    while (i < args.size()) {
+        auto& opt = args[i];
+        if (option_equals(opt, "count") && i + 1 < args.size()) {
+            if (!is_unsigned(args[i + 1])) {
+                return sstring("-ERR value is not an integer or out of range\r\n");
+            }
+            options._count = bytes2long(args[i + 1]);
+            i += 2;
+        } else if (option_equals(opt, "block") && i + 1 < args.size()) {
+            if (!is_unsigned(args[i + 1])) {
+                return sstring("-ERR timeout is not an integer or out of range\r\n");
+            }
+            options._block = bytes2long(args[i + 1]);
+            i += 2;
+        } else if (with_group && option_equals(opt, "noack")) {
+            options._noack = true;
+            ++i;
+        } else if (with_group && option_equals(opt, "group") && i + 2 < args.size()) {
+            options._group = std::make_pair(std::move(args[i + 1]), std::move(args[i + 2]));
+            i += 3;
+        } else if (option_equals(opt, "streams")) {
+            ++i;
+            auto streams = args.size() - i;
+            if (streams == 0 || streams % 2 != 0) {
+                return sprint("-ERR Unbalanced '%s' list of streams: for each stream key an ID or '%s' must be specified.\r\n",
+                    with_group ? "xreadgroup" : "xread", with_group ? ">" : "$");
+            }
+            auto ids = args.begin() + i + streams / 2;
+            options._keys.insert(options._keys.end(), std::make_move_iterator(args.begin() + i), std::make_move_iterator(ids));
+            options._ids.insert(options._ids.end(), std::make_move_iterator(ids), std::make_move_iterator(args.end()));
+            return sstring();
+        } else {
+            return sstring("-ERR syntax error\r\n");
+        }
+    }
+    return sstring("-ERR syntax error\r\n");
+}
+
+// The IDs given as `special` ('$' or '>') are resolved when the command is executed.
+static std::optional<std::vector<std::optional<stream_id>>> parse_stream_read_ids(const std::vector<bytes>& ids, char special)
+{
+    std::vector<std::optional<stream_id>> parsed;
+    parsed.reserve(ids.size());
+    for (auto& b : ids) {
+        if (b.size() == 1 && b[0] == special) {
+            parsed.emplace_back(std::nullopt);
+            continue;
+        }
+        auto id = parse_stream_id(b);
+        if (!id) {
+            return std::nullopt;
+        }
+        parsed.emplace_back(*id);
+    }
+    return parsed;
+}
+
+static uint32_t read_limit(long count)
+{
+    return count <= 0 ? std::numeric_limits<uint32_t>::max() : static_cast<uint32_t>(std::min<long>(count, std::numeric_limits<uint32_t>::max()));
+}
+
+static std::optional<blocked_clients::clock_type::time_point> block_deadline(long block)
+{
+    // BLOCK 0 blocks forever.
+    if (block == 0) {
+        return std::nullopt;
+    }
+    return blocked_clients::clock_type::now() + std::chrono::milliseconds(block);
+}
+
+static future<redis_message> make_stream_read_reply(future<std::optional<stream_read_type>> f, int protocol_version)
+{
+    try {
+        auto result = f.get0();
+        if (result) {
+            return redis_message::make_stream_read(*result);
+        }
+    } catch (...) {
+        return redis_message::err();
+    }
+    return redis_message::null_array(protocol_version);
+}
+
+shared_ptr<abstract_command> xread::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 3) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    stream_read_options options;
+    auto error = parse_stream_read_options(req._args, false, options);
+    if (!error.empty()) {
+        return unexpected::make_exception(std::move(req._command), error);
+    }
+    auto ids = parse_stream_read_ids(options._ids, '$');
+    if (!ids) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid stream ID specified as stream command argument\r\n"));
+    }
+    return seastar::make_shared<xread>(std::move(req._command), streams_schema(proxy, cs.get_keyspace()), std::move(options._keys), std::move(*ids), options._count, options._block);
+}
+
+future<> xread::resolve_ids(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    return parallel_for_each(boost::irange<size_t>(0, _keys.size()), [this, &proxy, cl, timeout, &cs] (size_t i) {
+        if (_ids[i]) {
+            return make_ready_future<>();
+        }
+        return fetch_top_id(proxy, _schema, _keys[i], cl, timeout, cs).then([this, i] (auto top) {
+            _ids[i] = top ? *top : stream_id::min();
+        });
+    });
+}
+
+future<std::optional<stream_read_type>> xread::read(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    auto results = make_lw_shared<std::vector<stream_return_type>>(_keys.size());
+    return parallel_for_each(boost::irange<size_t>(0, _keys.size()), [this, &proxy, cl, timeout, &cs, results] (size_t i) {
+        auto range = query::clustering_range::make_starting_with({ _ids[i]->to_clustering_key(*_schema), false });
+        return prefetch_stream(proxy, _schema, _keys[i], std::vector<query::clustering_range> { std::move(range) }, false, read_limit(_count), cl, timeout, cs).then([results, i] (auto pd) {
+            (*results)[i] = pd;
+        });
+    }).then([this, results] {
+        auto streams = make_lw_shared<std::vector<std::pair<bytes, stream_return_type>>>();
+        for (size_t i = 0; i < _keys.size(); ++i) {
+            auto& pd = (*results)[i];
+            if (pd->has_data() && !pd->data().empty()) {
+                streams->emplace_back(std::make_pair(_keys[i], pd));
+            }
+        }
+        return streams->empty() ? std::optional<stream_read_type> {} : std::optional<stream_read_type> { streams };
+    });
+}
+
+future<redis_message> xread::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.read_timeout;
+    return resolve_ids(proxy, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] {
+        return read(proxy, cl, timeout, cs);
+    }).then([this, &proxy, cl, &tc, &cs] (auto result) {
+        if (result || !_block) {
+            return make_ready_future<std::optional<stream_read_type>>(std::move(result));
+        }
+        auto& blocked = get_local_query_processor().get_blocked_clients();
+        return block_on_keys<stream_read_type>(blocked, _schema, _keys, block_deadline(*_block), [this, &proxy, cl, &tc, &cs] {
+            return read(proxy, cl, db::timeout_clock::now() + tc.read_timeout, cs);
+        });
+    }).then_wrapped([&cs] (auto f) {
+        return make_stream_read_reply(std::move(f), cs.get_redis_protocol_version());
+    });
+}
+
+shared_ptr<abstract_command> xreadgroup::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 6) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 6, req._args_count);
+    }
+    stream_read_options options;
+    auto error = parse_stream_read_options(req._args, true, options);
+    if (!error.empty()) {
+        return unexpected::make_exception(std::move(req._command), error);
+    }
+    if (!options._group) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR Missing GROUP option for XREADGROUP\r\n"));
+    }
+    auto ids = parse_stream_read_ids(options._ids, '>');
+    if (!ids) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR Invalid stream ID specified as stream command argument\r\n"));
+    }
+    std::vector<schema_ptr> schemas {
+        streams_schema(proxy, cs.get_keyspace()),
+        stream_groups_schema(proxy, cs.get_keyspace())
+    };
+    return seastar::make_shared<xreadgroup>(std::move(req._command), std::move(schemas), std::move(options._group->first), std::move(options._group->second),
+        std::move(options._keys), std::move(*ids), options._count, options._block, options._noack);
+}
+
+future<stream_return_type> xreadgroup::read_new(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs, const bytes& key)
+{
+    // Serialized from the read of the last delivered ID to its write, or two
+    // consumers of the group could be delivered the same entries.
+    return with_lock_on_owner(_schemas[1], key, [this, &proxy, cl, timeout, &cs, &key] {
+        return read_new_locked(proxy, cl, timeout, cs, key);
+    });
+}
+
+future<stream_return_type> xreadgroup::read_new_locked(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs, const bytes& key)
+{
+    return fetch_last_delivered(proxy, _schemas[1], key, _group, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs, &key] (auto last_delivered) {
+        if (!last_delivered) {
+            // The group was destroyed meanwhile.
+            return make_ready_future<stream_return_type>(make_lw_shared<prefetched_stream_type>(_schemas[0]));
+        }
+        auto range = query::clustering_range::make_starting_with({ last_delivered->to_clustering_key(*_schemas[0]), false });
+        return prefetch_stream(proxy, _schemas[0], key, std::vector<query::clustering_range> { std::move(range) }, false, read_limit(_count), cl, timeout, cs).then([this, &proxy, cl, timeout, &cs, &key] (auto pd) {
+            if (!pd->has_data() || pd->data().empty()) {
+                return make_ready_future<stream_return_type>(pd);
+            }
+            std::vector<std::pair<stream_id, bytes>> pending;
+            if (!_noack) {
+                pending = boost::copy_range<std::vector<std::pair<stream_id, bytes>>>(pd->data() | boost::adaptors::transformed([this] (auto& e) {
+                    return std::make_pair(e.first, _consumer);
+                }));
+            }
+            auto m = redis::make_stream_group_cells(_schemas[1], key, _group, pd->data().back().first, std::move(pending));
+            return redis::write_mutation(proxy, m, cl, timeout, cs).then([pd] {
+                return pd;
+            });
+        });
+    });
+}
+
+future<stream_return_type> xreadgroup::read_pending(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs, const bytes& key, stream_id after)
+{
+    auto ranges = std::vector<nonwrapping_range<stream_id>> { nonwrapping_range<stream_id>::make_starting_with({ after, false }) };
+    return prefetch_stream_group(proxy, _schemas[1], key, _group, std::move(ranges), cl, timeout, cs).then([this, &proxy, cl, timeout, &cs, &key] (auto pd) {
+        std::vector<query::clustering_range> ranges;
+        auto limit = read_limit(_count);
+        for (auto& e : pd->data()) {
+            if (ranges.size() == limit) {
+                break;
+            }
+            if (e.second == _consumer) {
+                ranges.emplace_back(query::clustering_range::make_singular(e.first.to_clustering_key(*_schemas[0])));
+            }
+        }
+        if (ranges.empty()) {
+            return make_ready_future<stream_return_type>(make_lw_shared<prefetched_stream_type>(_schemas[0]));
+        }
+        return prefetch_stream(proxy, _schemas[0], key, std::move(ranges), false, limit, cl, timeout, cs);
+    });
+}
+
+future<std::optional<stream_read_type>> xreadgroup::read(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    auto results = make_lw_shared<std::vector<stream_return_type>>(_keys.size());
+    return parallel_for_each(boost::irange<size_t>(0, _keys.size()), [this, &proxy, cl, timeout, &cs, results] (size_t i) {
+        auto f = _ids[i] ? read_pending(proxy, cl, timeout, cs, _keys[i], *_ids[i]) : read_new(proxy, cl, timeout, cs, _keys[i]);
+        return f.then([results, i] (auto pd) {
+            (*results)[i] = pd;
+        });
+    }).then([this, results] {
+        // The pending lists are always returned, the new entries only if there are any.
+        auto streams = make_lw_shared<std::vector<std::pair<bytes, stream_return_type>>>();
+        for (size_t i = 0; i < _keys.size(); ++i) {
+            auto& pd = (*results)[i];
+            if (_ids[i] || (pd->has_data() && !pd->data().empty())) {
+                streams->emplace_back(std::make_pair(_keys[i], pd));
+            }
+        }
+        return streams->empty() ? std::optional<stream_read_type> {} : std::optional<stream_read_type> { streams };
+    });
+}
+
+future<redis_message> xreadgroup::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    auto missing = make_lw_shared<std::optional<bytes>>();
+    return parallel_for_each(_keys.begin(), _keys.end(), [this, &proxy, cl, timeout, &cs, missing] (auto& key) {
+        return fetch_last_delivered(proxy, _schemas[1], key, _group, cl, timeout, cs).then([&key, missing] (auto last_delivered) {
+            if (!last_delivered) {
+                *missing = key;
+            }
+        });
+    }).then([this, &proxy, cl, &tc, &cs, timeout, missing] {
+        if (*missing) {
+            return redis_message::make_exception(sprint("-NOGROUP No such key '%s' or consumer group '%s' in XREADGROUP with GROUP option\r\n",
+                make_sstring(**missing), make_sstring(_group)));
+        }
+        return read(proxy, cl, timeout, cs).then([this, &proxy, cl, &tc, &cs] (auto result) {
+            if (result || !_block) {
+                return make_ready_future<std::optional<stream_read_type>>(std::move(result));
+            }
+            // Only the new entries ('>') are waited for, the pending lists are returned immediately.
+            auto& blocked = get_local_query_processor().get_blocked_clients();
+            return block_on_keys<stream_read_type>(blocked, _schemas[0], _keys, block_deadline(*_block), [this, &proxy, cl, &tc, &cs] {
+                return read(proxy, cl, db::timeout_clock::now() + tc.write_timeout, cs);
+            });
+        }).then_wrapped([&cs] (auto f) {
+            return make_stream_read_reply(std::move(f), cs.get_redis_protocol_version());
+        });
+    });
+}
+
+}
+}
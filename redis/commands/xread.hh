@@ -0,0 +1,75 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/command_with_multi_schemas.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/streams.hh"
+#include <optional>
+#include <vector>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+using stream_read_type = lw_shared_ptr<std::vector<std::pair<bytes, stream_return_type>>>;
+
+// XREAD [COUNT count] [BLOCK milliseconds] STREAMS key [key ...] id [id ...]
+class xread : public command_with_single_schema {
+    std::vector<bytes> _keys;
+    // Nothing means '$', the top item of the stream when the command is executed.
+    std::vector<std::optional<stream_id>> _ids;
+    long _count;
+    std::optional<long> _block;
+    future<> resolve_ids(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs);
+    future<std::optional<stream_read_type>> read(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs);
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xread(bytes&& name, const schema_ptr schema, std::vector<bytes>&& keys, std::vector<std::optional<stream_id>>&& ids, long count, std::optional<long> block)
+        : command_with_single_schema(std::move(name), schema)
+        , _keys(std::move(keys))
+        , _ids(std::move(ids))
+        , _count(count)
+        , _block(block)
+    {
+    }
+    ~xread() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+
+// XREADGROUP GROUP group consumer [COUNT count] [BLOCK milliseconds] [NOACK] STREAMS key [key ...] id [id ...]
+// The entries after the last delivered ID ('>') are added to the pending list of the consumer,
+// any other ID reads the pending list of the consumer instead.
+class xreadgroup : public command_with_multi_schemas {
+    bytes _group;
+    bytes _consumer;
+    std::vector<bytes> _keys;
+    // Nothing means '>', the entries never delivered to the group.
+    std::vector<std::optional<stream_id>> _ids;
+    long _count;
+    std::optional<long> _block;
+    bool _noack;
+    future<stream_return_type> read_new(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs, const bytes& key);
+    future<stream_return_type> read_new_locked(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs, const bytes& key);
+    future<stream_return_type> read_pending(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs, const bytes& key, stream_id after);
+    future<std::optional<stream_read_type>> read(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, service::client_state& cs);
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xreadgroup(bytes&& name, std::vector<schema_ptr>&& schemas, bytes&& group, bytes&& consumer, std::vector<bytes>&& keys,
+        std::vector<std::optional<stream_id>>&& ids, long count, std::optional<long> block, bool noack)
+        : command_with_multi_schemas(std::move(name), std::move(schemas))
+        , _group(std::move(group))
+        , _consumer(std::move(consumer))
+        , _keys(std::move(keys))
+        , _ids(std::move(ids))
+        , _count(count)
+        , _block(block)
+        , _noack(noack)
+    {
+    }
+    ~xreadgroup() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
@@ -0,0 +1,116 @@
+#include "redis/commands/xtrim.hh"
+#include "redis/commands/unexpected.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "redis/redis_mutation.hh"
+#include "redis/prefetcher.hh"
+#include "timeout_config.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+namespace redis {
+namespace commands {
+
+std::optional<stream_trim_options> parse_stream_trim_options(const std::vector<bytes>& args, size_t& i)
+{
+    if (i >= args.size()) {
+        return std::nullopt;
+    }
+    stream_trim_options options;
+    if (option_equals(args[i], "maxlen")) {
+        options._by_maxlen = true;
+    } else if (option_equals(args[i], "minid")) {
+        options._by_maxlen = false;
+    } else {
+        return std::nullopt;
+    }
+    ++i;
+    if (i < args.size() && args[i].size() == 1 && (args[i][0] == '=' || args[i][0] == '~')) {
+        ++i;
+    }
+    if (i >= args.size()) {
+        return std::nullopt;
+    }
+    auto& threshold = args[i++];
+    if (options._by_maxlen) {
+        if (threshold.empty() || !std::all_of(threshold.begin(), threshold.end(), [] (auto c) { return std::isdigit(c); })) {
+            return std::nullopt;
+        }
+        options._maxlen = bytes2long(threshold);
+    } else {
+        auto id = parse_stream_id(threshold);
+        if (!id) {
+            return std::nullopt;
+        }
+        options._minid = *id;
+    }
+    return options;
+}
+
+future<long> trim_stream(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    const stream_trim_options& options,
+    bool count_removed,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    auto count_and_trim = [&proxy, schema, &key, count_removed, cl, timeout, &cs] (stream_id end, bool inclusive) {
+        auto removed = make_ready_future<long>(0);
+        if (count_removed) {
+            auto range = query::clustering_range::make_ending_with({ end.to_clustering_key(*schema), inclusive });
+            removed = prefetch_stream(proxy, schema, key, std::vector<query::clustering_range> { std::move(range) }, false,
+                    std::numeric_limits<uint32_t>::max(), cl, timeout, cs).then([] (auto pd) {
+                return pd->has_data() ? static_cast<long>(pd->data().size()) : 0L;
+            });
+        }
+        return removed.then([&proxy, schema, &key, count_removed, cl, timeout, &cs, end, inclusive] (long removed) {
+            if (count_removed && removed == 0) {
+                return make_ready_future<long>(0);
+            }
+            return redis::write_mutation(proxy, redis::make_stream_trim(schema, key, end, inclusive), cl, timeout, cs).then([removed] {
+                return removed;
+            });
+        });
+    };
+    if (!options._by_maxlen) {
+        return count_and_trim(options._minid, false);
+    }
+    // The oldest of the newest MAXLEN + 1 entries is the last one to remove.
+    auto limit = static_cast<uint32_t>(std::min<long>(options._maxlen + 1, std::numeric_limits<uint32_t>::max()));
+    return prefetch_stream(proxy, schema, key, std::vector<query::clustering_range> { query::clustering_range::make_open_ended_both_sides() },
+            true, limit, cl, timeout, cs).then([options, limit, count_and_trim = std::move(count_and_trim)] (auto pd) {
+        if (!pd->has_data() || pd->data().size() < limit) {
+            return make_ready_future<long>(0);
+        }
+        return count_and_trim(pd->data().back().first, true);
+    });
+}
+
+shared_ptr<abstract_command> xtrim::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req)
+{
+    if (req._args_count < 3) {
+        return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
+    }
+    size_t i = 1;
+    auto options = parse_stream_trim_options(req._args, i);
+    if (!options || i != req._args.size()) {
+        return unexpected::make_exception(std::move(req._command), sstring("-ERR syntax error\r\n"));
+    }
+    return seastar::make_shared<xtrim>(std::move(req._command), streams_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), *options);
+}
+
+future<redis_message> xtrim::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
+{
+    auto timeout = now + tc.write_timeout;
+    return trim_stream(proxy, _schema, _key, _options, true, cl, timeout, cs).then_wrapped([] (auto f) {
+        try {
+            return redis_message::make_long(f.get0());
+        } catch (...) {
+            return redis_message::err();
+        }
+    });
+}
+
+}
+}
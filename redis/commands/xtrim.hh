@@ -0,0 +1,51 @@
+#pragma once
+#include "redis/command_with_single_schema.hh"
+#include "redis/request.hh"
+#include "redis/streams.hh"
+#include <optional>
+
+namespace service {
+class storage_proxy;
+}
+class timeout_config;
+namespace redis {
+namespace commands {
+
+// MAXLEN <count> keeps the newest entries, MINID <id> removes the entries older than the ID.
+struct stream_trim_options {
+    bool _by_maxlen = true;
+    long _maxlen = 0;
+    stream_id _minid;
+};
+
+// Parses "MAXLEN|MINID [=|~] <threshold>" at args[i], `i` is moved past the options.
+// The approximate trimming (~) is accepted, but always trims exactly.
+std::optional<stream_trim_options> parse_stream_trim_options(const std::vector<bytes>& args, size_t& i);
+
+// Removes the entries beyond the threshold with a single range tombstone, and
+// returns the number of removed entries when `count_removed` is set.
+future<long> trim_stream(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    const stream_trim_options& options,
+    bool count_removed,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs);
+
+class xtrim : public command_with_single_schema {
+    bytes _key;
+    stream_trim_options _options;
+public:
+    static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
+    xtrim(bytes&& name, const schema_ptr schema, bytes&& key, stream_trim_options options)
+        : command_with_single_schema(std::move(name), schema)
+        , _key(std::move(key))
+        , _options(options)
+    {
+    }
+    ~xtrim() {}
+    future<redis_message> execute(service::storage_proxy&, db::consistency_level, db::timeout_clock::time_point, const timeout_config& tc, service::client_state& cs) override;
+};
+}
+}
@@ -36,14 +36,28 @@ shared_ptr<abstract_command> zadd::prepare(service::storage_proxy& proxy, const
         }
         data.emplace_back(std::make_pair(req._args[i + 1], req._args[i]));
     }
-    return seastar::make_shared<zadd> (std::move(req._command), zsets_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), std::move(data));
+    std::vector<schema_ptr> schemas {
+        zsets_schema(proxy, cs.get_keyspace()),
+        zset_scores_schema(proxy, cs.get_keyspace())
+    };
+    return seastar::make_shared<zadd> (std::move(req._command), std::move(schemas), std::move(req._args[0]), std::move(data));
 }
 
 future<redis_message> zadd::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
     auto timeout = now + tc.write_timeout;
     auto total = _data.size();
-    return redis::write_mutation(proxy, redis::make_zset_cells(_schema, _key, std::move(_data)), cl, timeout, cs).then_wrapped([this, total] (auto f) {
+    // The rows of the previous scores are left in the index, the searches
+    // drop them.
+    std::vector<std::pair<double, bytes>> index_cells;
+    index_cells.reserve(_data.size());
+    for (auto& d : _data) {
+        index_cells.emplace_back(bytes2double(d.second), d.first);
+    }
+    return redis::write_mutation(proxy,
+        redis::make_zset_cells(_schemas[0], _key, std::move(_data)),
+        redis::make_zset_score_cells(_schemas[1], _key, std::move(index_cells), {}),
+        cl, timeout, cs).then_wrapped([this, total] (auto f) {
         try {
             f.get();
         } catch (std::exception& e) {
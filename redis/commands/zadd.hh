@@ -1,18 +1,19 @@
 #pragma once
-#include "redis/command_with_single_schema.hh"
+#include "redis/command_with_multi_schemas.hh"
 #include "redis/request.hh"
 class timeout_config;
 namespace redis {
 namespace commands {
-class zadd : public command_with_single_schema {
+// The members are written to the sorted set (_schemas[0]) and to its score index (_schemas[1]).
+class zadd : public command_with_multi_schemas {
 private:
     bytes _key;
     std::vector<std::pair<bytes, bytes>> _data;
 public:
 
     static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
-    zadd(bytes&& name, const schema_ptr schema, bytes&& key, std::vector<std::pair<bytes, bytes>>&& data) 
-        : command_with_single_schema(std::move(name), schema)
+    zadd(bytes&& name, std::vector<schema_ptr>&& schemas, bytes&& key, std::vector<std::pair<bytes, bytes>>&& data) 
+        : command_with_multi_schemas(std::move(name), std::move(schemas))
         , _key(std::move(key))
         , _data(std::move(data))
     {
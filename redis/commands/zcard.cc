@@ -34,7 +34,7 @@ future<redis_message> zcard::execute(service::storage_proxy& proxy, db::consiste
         if (pd && pd->has_data()) {
             return redis_message::make_long(static_cast<long>(pd->data().size()));
         }
-        return redis_message::null();
+        return redis_message::null(cs.get_redis_protocol_version());
     });
 }
 
@@ -41,7 +41,7 @@ future<redis_message> zcount::execute(service::storage_proxy& proxy, db::consist
             });
             return redis_message::make_long(static_cast<long>(count));
         }
-        return redis_message::null();
+        return redis_message::null(cs.get_redis_protocol_version());
     });
 }
 
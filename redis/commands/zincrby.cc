@@ -24,28 +24,39 @@ shared_ptr<abstract_command> zincrby::prepare(service::storage_proxy& proxy, con
     if (req._args_count < 3) {
         return unexpected::make_wrong_arguments_exception(std::move(req._command), 3, req._args_count);
     }
-    return seastar::make_shared<zincrby>(std::move(req._command), zsets_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), std::move(req._args[2]), bytes2double(req._args[1]));
+    std::vector<schema_ptr> schemas {
+        zsets_schema(proxy, cs.get_keyspace()),
+        zset_scores_schema(proxy, cs.get_keyspace())
+    };
+    return seastar::make_shared<zincrby>(std::move(req._command), std::move(schemas), std::move(req._args[0]), std::move(req._args[2]), bytes2double(req._args[1]));
 }
 
 future<redis_message> zincrby::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
     auto timeout = now + tc.read_timeout;
-    return prefetch_map(proxy, _schema, _key, std::vector<bytes> { _member }, fetch_options::values, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+    return prefetch_map(proxy, _schemas[0], _key, std::vector<bytes> { _member }, fetch_options::values, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
         double result = 0; 
+        std::vector<std::pair<double, bytes>> dead_index_cells;
         if (pd && pd->has_data()) {
             auto&& existing = pd->data().front().first;
             result = bytes2double(*existing);
+            dead_index_cells.emplace_back(result, _member);
         }
         result += _increment;
         auto new_value = double2bytes(result);
+        // The score as it is read back from the sorted set.
+        std::vector<std::pair<double, bytes>> index_cells { std::make_pair(bytes2double(new_value), _member) };
         std::vector<std::pair<bytes, bytes>> data { std::make_pair(std::move(_member), std::move(new_value)) };
-        return redis::write_mutation(proxy, redis::make_zset_cells(_schema, _key, std::move(data)), cl, timeout, cs).then_wrapped([this, result] (auto f) {
+        return redis::write_mutation(proxy,
+            redis::make_zset_cells(_schemas[0], _key, std::move(data)),
+            redis::make_zset_score_cells(_schemas[1], _key, std::move(index_cells), std::move(dead_index_cells)),
+            cl, timeout, cs).then_wrapped([this, result, &cs] (auto f) {
             try {
                 f.get();
             } catch (std::exception& e) {
                 return redis_message::err();
             }
-            return redis_message::make_bytes(double2bytes(result));
+            return redis_message::make_double(result, cs.get_redis_protocol_version());
         });
     });
 }
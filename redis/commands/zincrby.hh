@@ -1,10 +1,11 @@
 #pragma once
-#include "redis/command_with_single_schema.hh"
+#include "redis/command_with_multi_schemas.hh"
 #include "redis/request.hh"
 class timeout_config;
 namespace redis {
 namespace commands {
-class zincrby : public command_with_single_schema {
+// The members are written to the sorted set (_schemas[0]) and to its score index (_schemas[1]).
+class zincrby : public command_with_multi_schemas {
 private:
     bytes _key;
     bytes _member;
@@ -12,8 +13,8 @@ private:
 public:
 
     static shared_ptr<abstract_command> prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req);
-    zincrby(bytes&& name, const schema_ptr schema, bytes&& key, bytes&& member, double increment) 
-        : command_with_single_schema(std::move(name), schema)
+    zincrby(bytes&& name, std::vector<schema_ptr>&& schemas, bytes&& key, bytes&& member, double increment) 
+        : command_with_multi_schemas(std::move(name), std::move(schemas))
         , _key(std::move(key))
         , _member(std::move(member))
         , _increment(increment)
@@ -47,7 +47,7 @@ future<redis_message> zrange::execute_impl(service::storage_proxy& proxy, db::co
 {
     auto timeout = now + tc.read_timeout;
     return prefetch_map(proxy, _schema, _key, fetch_options::all, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs, reversed] (auto pd) {
-        auto results = make_lw_shared<std::vector<std::optional<bytes>>> ();
+        reply_writer w(cs.get_redis_protocol_version());
         if (_begin < 0) _begin = 0;
         if (pd && pd->has_data()) {
             while (_end < 0 && pd->data().size() > 0) _end += static_cast<long>(pd->data().size());
@@ -67,15 +67,18 @@ future<redis_message> zrange::execute_impl(service::storage_proxy& proxy, db::co
                 if (_begin > 0) {
                     result_scores.erase(result_scores.begin(), result_scores.begin() + static_cast<size_t>(_begin));
                 }
+                w.write_array_header(result_scores.size() * (_with_scores ? 2 : 1));
                 for (auto&& e : result_scores) {
-                    results->emplace_back(std::move(e.first));
+                    w.write_bytes(*e.first);
                     if (_with_scores) {
-                        results->emplace_back(std::move(double2bytes(e.second)));
+                        w.write_double(e.second);
                     }
                 }
+                return w.done();
             }
         }
-        return redis_message::make_zset_bytes(results);
+        w.write_array_header(0);
+        return w.done();
     });
 }
 
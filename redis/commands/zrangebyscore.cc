@@ -58,7 +58,7 @@ future<redis_message> zrangebyscore::execute_impl(service::storage_proxy& proxy,
 {
     auto timeout = now + tc.read_timeout;
     return prefetch_map(proxy, _schema, _key, fetch_options::all, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs, reversed] (auto pd) {
-        auto results = make_lw_shared<std::vector<std::optional<bytes>>> ();
+        reply_writer w(cs.get_redis_protocol_version());
         if (pd && pd->has_data()) {
             using result_type = std::vector<std::pair<std::optional<bytes>, double>>;
             auto result_scores = boost::copy_range<result_type> (pd->data() | boost::adaptors::filtered([min = _min, max = _max] (auto& e) {
@@ -78,14 +78,17 @@ future<redis_message> zrangebyscore::execute_impl(service::storage_proxy& proxy,
             if (result_scores.size() > static_cast<size_t>(_count)) {
                 result_scores.erase(result_scores.begin() + static_cast<size_t>(_count), result_scores.end());
             }
+            w.write_array_header(result_scores.size() * (_with_scores ? 2 : 1));
             for (auto&& e : result_scores) {
-                results->emplace_back(std::move(e.first));
+                w.write_bytes(*e.first);
                 if (_with_scores) {
-                    results->emplace_back(std::move(double2bytes(e.second)));
+                    w.write_double(e.second);
                 }
             }
+            return w.done();
         }
-        return redis_message::make_zset_bytes(results);
+        w.write_array_header(0);
+        return w.done();
     });
 }
 
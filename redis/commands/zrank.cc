@@ -56,7 +56,7 @@ future<redis_message> zrank::execute_impl(service::storage_proxy& proxy, db::con
                 return redis_message::make_long(static_cast<long>(rank));
             }
         }
-        return redis_message::null();
+        return redis_message::null(cs.get_redis_protocol_version());
     });
 }
 
@@ -27,7 +27,11 @@ shared_ptr<abstract_command> zrem::prepare(service::storage_proxy& proxy, const
     for (size_t i = 1; i < req._args_count; i++) {
         members.emplace_back(std::move(req._args[i]));
     }
-    return seastar::make_shared<zrem>(std::move(req._command), zsets_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), std::move(members));
+    std::vector<schema_ptr> schemas {
+        zsets_schema(proxy, cs.get_keyspace()),
+        zset_scores_schema(proxy, cs.get_keyspace())
+    };
+    return seastar::make_shared<zrem>(std::move(req._command), std::move(schemas), std::move(req._args[0]), std::move(members));
 }
 
 shared_ptr<abstract_command> zremrangebyrank::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req) {
@@ -36,7 +40,11 @@ shared_ptr<abstract_command> zremrangebyrank::prepare(service::storage_proxy& pr
     }
     auto begin = bytes2long(req._args[1]);
     auto end = bytes2long(req._args[2]);
-    return seastar::make_shared<zremrangebyrank>(std::move(req._command), zsets_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), begin, end);
+    std::vector<schema_ptr> schemas {
+        zsets_schema(proxy, cs.get_keyspace()),
+        zset_scores_schema(proxy, cs.get_keyspace())
+    };
+    return seastar::make_shared<zremrangebyrank>(std::move(req._command), std::move(schemas), std::move(req._args[0]), begin, end);
 }
 
 shared_ptr<abstract_command> zremrangebyscore::prepare(service::storage_proxy& proxy, const service::client_state& cs, request&& req) {
@@ -45,24 +53,34 @@ shared_ptr<abstract_command> zremrangebyscore::prepare(service::storage_proxy& p
     }
     auto min = bytes2double(req._args[1]);
     auto max = bytes2double(req._args[2]);
-    return seastar::make_shared<zremrangebyscore>(std::move(req._command), zsets_schema(proxy, cs.get_keyspace()), std::move(req._args[0]), min, max);
+    std::vector<schema_ptr> schemas {
+        zsets_schema(proxy, cs.get_keyspace()),
+        zset_scores_schema(proxy, cs.get_keyspace())
+    };
+    return seastar::make_shared<zremrangebyscore>(std::move(req._command), std::move(schemas), std::move(req._args[0]), min, max);
 }
 
 future<redis_message> zrem::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
     auto timeout = now + tc.read_timeout;
-    return prefetch_map(proxy, _schema, _key, _members, fetch_options::keys, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+    return prefetch_map(proxy, _schemas[0], _key, _members, fetch_options::all, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
         size_t total_removed = 0; 
         if (pd && pd->has_data()) {
             // FIXME: We should delete the empty zsets.
-            auto&& removed_keys = boost::copy_range<std::vector<bytes>> (pd->data() | boost::adaptors::transformed([] (auto& e) {
-                return std::move(*(e.first));
-            }));
+            std::vector<bytes> removed_keys;
+            std::vector<std::pair<double, bytes>> dead_index_cells;
+            for (auto& e : pd->data()) {
+                dead_index_cells.emplace_back(bytes2double(*e.second), *e.first);
+                removed_keys.emplace_back(std::move(*e.first));
+            }
             total_removed = removed_keys.size();
             if (total_removed == 0) {
                 return redis_message::make_long(static_cast<long>(total_removed));
             }
-            return redis::write_mutation(proxy, redis::make_zset_dead_cells(_schema, _key, std::move(removed_keys)), cl, timeout, cs).then_wrapped([this, total_removed] (auto f) {
+            return redis::write_mutation(proxy,
+                redis::make_zset_dead_cells(_schemas[0], _key, std::move(removed_keys)),
+                redis::make_zset_score_cells(_schemas[1], _key, {}, std::move(dead_index_cells)),
+                cl, timeout, cs).then_wrapped([this, total_removed] (auto f) {
                 try {
                     f.get();
                 } catch (std::exception& e) {
@@ -78,7 +96,7 @@ future<redis_message> zrem::execute(service::storage_proxy& proxy, db::consisten
 future<redis_message> zremrangebyrank::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
     auto timeout = now + tc.read_timeout;
-    return prefetch_map(proxy, _schema, _key, fetch_options::all, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+    return prefetch_map(proxy, _schemas[0], _key, fetch_options::all, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
         size_t total_removed = 0; 
         if (_begin < 0) _begin = 0;
         while (_end < 0 && pd->data().size() > 0) _end += static_cast<long>(pd->data().size());
@@ -94,14 +112,20 @@ future<redis_message> zremrangebyrank::execute(service::storage_proxy& proxy, db
             if (_begin > 0) {
                 result_scores.erase(result_scores.begin(), result_scores.begin() + static_cast<size_t>(_begin));
             }
-            auto&& removed_keys = boost::copy_range<std::vector<bytes>> (std::move(result_scores) | boost::adaptors::transformed([] (auto& e) {
-                return std::move(*(e.first)); 
-            }));
+            std::vector<bytes> removed_keys;
+            std::vector<std::pair<double, bytes>> dead_index_cells;
+            for (auto& e : result_scores) {
+                dead_index_cells.emplace_back(e.second, *e.first);
+                removed_keys.emplace_back(std::move(*e.first));
+            }
             total_removed = removed_keys.size();
             if (total_removed == 0) {
                 return redis_message::make_long(static_cast<long>(total_removed));
             }
-            return redis::write_mutation(proxy, redis::make_zset_dead_cells(_schema, _key, std::move(removed_keys)), cl, timeout, cs).then_wrapped([this, total_removed] (auto f) {
+            return redis::write_mutation(proxy,
+                redis::make_zset_dead_cells(_schemas[0], _key, std::move(removed_keys)),
+                redis::make_zset_score_cells(_schemas[1], _key, {}, std::move(dead_index_cells)),
+                cl, timeout, cs).then_wrapped([this, total_removed] (auto f) {
                 try {
                     f.get();
                 } catch (std::exception& e) {
@@ -117,20 +141,26 @@ future<redis_message> zremrangebyrank::execute(service::storage_proxy& proxy, db
 future<redis_message> zremrangebyscore::execute(service::storage_proxy& proxy, db::consistency_level cl, db::timeout_clock::time_point now, const timeout_config& tc, service::client_state& cs)
 {
     auto timeout = now + tc.read_timeout;
-    return prefetch_map(proxy, _schema, _key, fetch_options::all, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
+    return prefetch_map(proxy, _schemas[0], _key, fetch_options::all, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
         size_t total_removed = 0; 
         if (pd && pd->has_data()) {
-            auto&& removed_keys = boost::copy_range<std::vector<bytes>> (pd->data() | boost::adaptors::filtered([min = _min, max = _max] (auto& e) {
+            std::vector<bytes> removed_keys;
+            std::vector<std::pair<double, bytes>> dead_index_cells;
+            for (auto& e : pd->data()) {
                 auto v = bytes2double(*(e.second));
-                return min <= v && v <= max;
-            }) | boost::adaptors::transformed([] (auto& e) {
-                return std::move(*(e.first));
-            }));
+                if (_min <= v && v <= _max) {
+                    dead_index_cells.emplace_back(v, *e.first);
+                    removed_keys.emplace_back(std::move(*e.first));
+                }
+            }
             total_removed = removed_keys.size();
             if (total_removed == 0) {
                 return redis_message::make_long(static_cast<long>(total_removed));
             }
-            return redis::write_mutation(proxy, redis::make_zset_dead_cells(_schema, _key, std::move(removed_keys)), cl, timeout, cs).then_wrapped([this, total_removed] (auto f) {
+            return redis::write_mutation(proxy,
+                redis::make_zset_dead_cells(_schemas[0], _key, std::move(removed_keys)),
+                redis::make_zset_score_cells(_schemas[1], _key, {}, std::move(dead_index_cells)),
+                cl, timeout, cs).then_wrapped([this, total_removed] (auto f) {
                 try {
                     f.get();
                 } catch (std::exception& e) {
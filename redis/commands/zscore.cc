@@ -35,9 +35,12 @@ future<redis_message> zscore::execute(service::storage_proxy& proxy, db::consist
     auto timeout = now + tc.read_timeout;
     return prefetch_map(proxy, _schema, _key, _map_keys, fetch_options::values, cl, timeout, cs).then([this, &proxy, cl, timeout, &cs] (auto pd) {
         if (pd && pd->has_data()) {
+            if (_map_keys.size() == 1) {
+                return redis_message::make_double(bytes2double(*pd->data().front().first), cs.get_redis_protocol_version());
+            }
             return redis_message::make_map_key_bytes(pd);
         }
-        return redis_message::null();
+        return redis_message::null(cs.get_redis_protocol_version());
     });
 }
 
@@ -0,0 +1,213 @@
+#include "redis/geo.hh"
+#include "redis/abstract_command.hh"
+#include <algorithm>
+#include <cmath>
+
+namespace redis {
+namespace geo {
+
+static constexpr double mercator_max = 20037726.37;
+
+static inline double deg_rad(double deg) { return deg * (M_PI / 180.0); }
+static inline double rad_deg(double rad) { return rad / (M_PI / 180.0); }
+
+// Spreads the 32 low bits of `v` to the even bits.
+static inline uint64_t spread(uint64_t v)
+{
+    v &= 0xffffffff;
+    v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+    v = (v | (v << 8)) & 0x00ff00ff00ff00ffULL;
+    v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    v = (v | (v << 2)) & 0x3333333333333333ULL;
+    v = (v | (v << 1)) & 0x5555555555555555ULL;
+    return v;
+}
+
+static inline uint64_t squash(uint64_t v)
+{
+    v &= 0x5555555555555555ULL;
+    v = (v | (v >> 1)) & 0x3333333333333333ULL;
+    v = (v | (v >> 2)) & 0x0f0f0f0f0f0f0f0fULL;
+    v = (v | (v >> 4)) & 0x00ff00ff00ff00ffULL;
+    v = (v | (v >> 8)) & 0x0000ffff0000ffffULL;
+    v = (v | (v >> 16)) & 0x00000000ffffffffULL;
+    return v;
+}
+
+// The latitude takes the even bits and the longitude the odd bits.
+static inline uint64_t interleave(uint64_t lat_bits, uint64_t lon_bits) { return spread(lat_bits) | (spread(lon_bits) << 1); }
+
+static inline uint64_t cell_of(double v, double min, double max, unsigned step)
+{
+    auto cells = static_cast<double>(uint64_t(1) << step);
+    auto c = static_cast<uint64_t>((v - min) / (max - min) * cells);
+    return std::min(c, (uint64_t(1) << step) - 1);
+}
+
+uint64_t encode(double lon, double lat, unsigned step)
+{
+    return interleave(cell_of(lat, min_latitude, max_latitude, step), cell_of(lon, min_longitude, max_longitude, step));
+}
+
+std::pair<double, double> decode(uint64_t hash)
+{
+    auto cells = static_cast<double>(uint64_t(1) << max_step);
+    auto lat_cell = static_cast<double>(squash(hash));
+    auto lon_cell = static_cast<double>(squash(hash >> 1));
+    auto lat = min_latitude + (lat_cell + 0.5) / cells * (max_latitude - min_latitude);
+    auto lon = min_longitude + (lon_cell + 0.5) / cells * (max_longitude - min_longitude);
+    return { std::max(min_longitude, std::min(max_longitude, lon)), std::max(min_latitude, std::min(max_latitude, lat)) };
+}
+
+bytes to_geohash_string(uint64_t hash)
+{
+    static const char alphabet[] = "0123456789bcdefghjkmnpqrstuvwxyz";
+    // The standard geohash spans latitudes of [-90, 90], the position is encoded again.
+    auto pos = decode(hash);
+    auto lat_cell = cell_of(pos.second, -90.0, 90.0, max_step);
+    auto lon_cell = cell_of(pos.first, min_longitude, max_longitude, max_step);
+    auto bits = interleave(lat_cell, lon_cell);
+    bytes out(bytes::initialized_later(), 11);
+    for (int i = 0; i < 11; ++i) {
+        // There are only 52 bits, the 11th character is always '0' as in Redis.
+        auto idx = i == 10 ? 0 : (bits >> (52 - (i + 1) * 5)) & 0x1f;
+        out[i] = alphabet[idx];
+    }
+    return out;
+}
+
+std::optional<double> parse_unit(const bytes& b)
+{
+    if (option_equals(b, "m")) {
+        return 1.0;
+    } else if (option_equals(b, "km")) {
+        return 1000.0;
+    } else if (option_equals(b, "mi")) {
+        return 1609.34;
+    } else if (option_equals(b, "ft")) {
+        return 0.3048;
+    }
+    return std::nullopt;
+}
+
+static unsigned estimate_step(double range, double lat)
+{
+    if (range == 0) {
+        return max_step;
+    }
+    int step = 1;
+    while (range < mercator_max) {
+        range *= 2;
+        ++step;
+    }
+    // Cells shrink towards the poles, so fewer steps are needed to cover the range.
+    step -= 2;
+    if (lat > 66 || lat < -66) {
+        --step;
+        if (lat > 80 || lat < -80) {
+            --step;
+        }
+    }
+    return static_cast<unsigned>(std::max(1, std::min(static_cast<int>(max_step), step)));
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> score_ranges(const shape& s)
+{
+    auto half_height = s._box ? s._height / 2 : s._radius;
+    auto half_width = s._box ? s._width / 2 : s._radius;
+    auto lat_delta = rad_deg(half_height / earth_radius);
+    // The longitude delta is the widest at the edge farthest from the equator.
+    auto far_lat = std::min(89.0, std::abs(s._lat) + lat_delta);
+    auto lon_delta = rad_deg(half_width / earth_radius / std::cos(deg_rad(far_lat)));
+    auto range = s._box ? std::sqrt(half_width * half_width + half_height * half_height) : s._radius;
+
+    auto step = estimate_step(range, s._lat);
+    uint64_t lat_cell, lon_cell;
+    for (;; --step) {
+        lat_cell = cell_of(s._lat, min_latitude, max_latitude, step);
+        lon_cell = cell_of(s._lon, min_longitude, max_longitude, step);
+        // The 3x3 cells around the center must cover the bounding box of the shape.
+        auto lat_size = (max_latitude - min_latitude) / (uint64_t(1) << step);
+        auto lon_size = (max_longitude - min_longitude) / (uint64_t(1) << step);
+        auto lat_low = min_latitude + (static_cast<double>(lat_cell) - 1) * lat_size;
+        auto lat_high = min_latitude + (static_cast<double>(lat_cell) + 2) * lat_size;
+        auto lon_low = min_longitude + (static_cast<double>(lon_cell) - 1) * lon_size;
+        auto lon_high = min_longitude + (static_cast<double>(lon_cell) + 2) * lon_size;
+        bool covered = s._lat - lat_delta >= lat_low && s._lat + lat_delta <= lat_high
+            && s._lon - lon_delta >= lon_low && s._lon + lon_delta <= lon_high;
+        if (covered || step == 1) {
+            break;
+        }
+    }
+
+    auto cells = int64_t(1) << step;
+    auto shift = 2 * (max_step - step);
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    for (int64_t dlat = -1; dlat <= 1; ++dlat) {
+        auto lat = static_cast<int64_t>(lat_cell) + dlat;
+        if (lat < 0 || lat >= cells) {
+            continue;
+        }
+        for (int64_t dlon = -1; dlon <= 1; ++dlon) {
+            // The longitude wraps around the antimeridian.
+            auto lon = (static_cast<int64_t>(lon_cell) + dlon + cells) % cells;
+            auto hash = interleave(static_cast<uint64_t>(lat), static_cast<uint64_t>(lon));
+            ranges.emplace_back(hash << shift, (hash + 1) << shift);
+        }
+    }
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<std::pair<uint64_t, uint64_t>> merged;
+    for (auto& r : ranges) {
+        if (!merged.empty() && r.first <= merged.back().second) {
+            merged.back().second = std::max(merged.back().second, r.second);
+        } else {
+            merged.push_back(r);
+        }
+    }
+    return merged;
+}
+
+double distance(double lon1, double lat1, double lon2, double lat2)
+{
+    auto lat1r = deg_rad(lat1);
+    auto lat2r = deg_rad(lat2);
+    auto u = std::sin((lat2r - lat1r) / 2);
+    auto v = std::sin(deg_rad(lon2 - lon1) / 2);
+    return 2.0 * earth_radius * std::asin(std::sqrt(u * u + std::cos(lat1r) * std::cos(lat2r) * v * v));
+}
+
+void distances(const shape& s, const double* lons, const double* lats, size_t n, double* out)
+{
+    auto lat0r = deg_rad(s._lat);
+    auto cos_lat0 = std::cos(lat0r);
+    if (!s._box) {
+        // hav(d / R) = u^2 + cos(lat0) * cos(lat) * v^2, a point is within the circle iff
+        // this term is not greater than hav(radius / R).
+        auto h_max = std::sin(s._radius / earth_radius / 2);
+        h_max *= h_max;
+        // The terms are computed over the whole batch first, this loop has no branches.
+        for (size_t i = 0; i < n; ++i) {
+            auto latr = deg_rad(lats[i]);
+            auto u = std::sin((latr - lat0r) / 2);
+            auto v = std::sin(deg_rad(lons[i] - s._lon) / 2);
+            out[i] = u * u + cos_lat0 * std::cos(latr) * v * v;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = out[i] <= h_max ? 2.0 * earth_radius * std::asin(std::sqrt(out[i])) : -1;
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        // Within the box if the distance along the meridian and along the parallel of the
+        // point are within the half sizes, as in Redis.
+        auto lat_distance = earth_radius * std::abs(deg_rad(lats[i]) - lat0r);
+        if (lat_distance > s._height / 2 || distance(lons[i], lats[i], s._lon, lats[i]) > s._width / 2) {
+            out[i] = -1;
+            continue;
+        }
+        out[i] = distance(s._lon, s._lat, lons[i], lats[i]);
+    }
+}
+
+}
+}
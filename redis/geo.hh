@@ -0,0 +1,66 @@
+#pragma once
+#include "bytes.hh"
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace redis {
+namespace geo {
+
+// Positions are kept in sorted sets as 52 bits geohash scores (26 bits of longitude
+// interleaved with 26 bits of latitude), as Redis does, so that an area is a small set
+// of ranges of scores.
+static constexpr unsigned max_step = 26;
+static constexpr double min_longitude = -180.0;
+static constexpr double max_longitude = 180.0;
+static constexpr double min_latitude = -85.05112878;
+static constexpr double max_latitude = 85.05112878;
+static constexpr double earth_radius = 6372797.560856; // in meters
+
+static inline bool valid_position(double lon, double lat) {
+    return lon >= min_longitude && lon <= max_longitude && lat >= min_latitude && lat <= max_latitude;
+}
+
+uint64_t encode(double lon, double lat, unsigned step = max_step);
+// Returns the center of the cell of a score.
+std::pair<double, double> decode(uint64_t hash);
+// The 11 characters standard geohash of a score, for GEOHASH.
+bytes to_geohash_string(uint64_t hash);
+
+// Returns the factor converting the unit to meters, or nothing.
+std::optional<double> parse_unit(const bytes& b);
+
+// The area searched by GEORADIUS or GEOSEARCH, a circle or a box (sizes in meters).
+struct shape {
+    double _lon;
+    double _lat;
+    bool _box = false;
+    double _radius = 0;
+    double _width = 0;
+    double _height = 0;
+};
+
+// Returns the ranges of scores [start, end) covering the shape, sorted and merged: the cell
+// of the center and its 8 neighbours, at the finest step where they cover the shape.
+std::vector<std::pair<uint64_t, uint64_t>> score_ranges(const shape& s);
+
+// A member found by GEORADIUS or GEOSEARCH.
+struct match {
+    bytes _member;
+    uint64_t _hash;
+    double _lon;
+    double _lat;
+    double _distance; // in meters
+};
+
+double distance(double lon1, double lat1, double lon2, double lat2);
+
+// Computes the distances (in meters) from the center of the shape to `n` points given as
+// arrays of longitudes and latitudes, and sets `out[i]` to -1 for the points outside of the
+// shape. The points are rejected by comparing the haversine term against that of the radius,
+// so asin() and sqrt() are only computed for the matches.
+void distances(const shape& s, const double* lons, const double* lats, size_t n, double* out);
+
+}
+}
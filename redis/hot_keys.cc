@@ -0,0 +1,232 @@
+#include "redis/hot_keys.hh"
+#include "redis/command_keys.hh"
+#include "redis/query_processor.hh"
+#include "seastar/core/future-util.hh"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace redis {
+
+count_min_sketch::count_min_sketch(size_t width)
+    : _width(width)
+    , _counters(depth * width, 0)
+{
+    assert(width && !(width & (width - 1)));
+}
+
+uint32_t count_min_sketch::increment(uint64_t hash)
+{
+    auto min = estimate(hash);
+    if (min == std::numeric_limits<uint32_t>::max()) {
+        return min;
+    }
+    for (unsigned row = 0; row < depth; ++row) {
+        auto& c = _counters[index(hash, row)];
+        if (c == min) {
+            ++c;
+        }
+    }
+    return min + 1;
+}
+
+uint32_t count_min_sketch::estimate(uint64_t hash) const
+{
+    auto min = std::numeric_limits<uint32_t>::max();
+    for (unsigned row = 0; row < depth; ++row) {
+        min = std::min(min, _counters[index(hash, row)]);
+    }
+    return min;
+}
+
+void count_min_sketch::age()
+{
+    for (auto& c : _counters) {
+        c >>= 1;
+    }
+}
+
+void count_min_sketch::reset()
+{
+    std::fill(_counters.begin(), _counters.end(), 0);
+}
+
+// The commands whose first argument is not a key.
+const bytes* hot_keys::key_of(const request& req)
+{
+    return command_keys::first_key(req);
+}
+
+hot_keys::hot_keys(size_t capacity, uint32_t sample_every)
+    : _sketch(capacity ? sketch_width : 1)
+    , _capacity(capacity)
+    , _sample_every(std::max(sample_every, uint32_t(1)))
+{
+    _heap.reserve(capacity);
+}
+
+void hot_keys::swap_entries(size_t a, size_t b)
+{
+    std::swap(_heap[a], _heap[b]);
+    _positions[_heap[a]._key] = a;
+    _positions[_heap[b]._key] = b;
+}
+
+void hot_keys::sift_up(size_t i)
+{
+    while (i > 0) {
+        auto parent = (i - 1) / 2;
+        if (_heap[parent]._count <= _heap[i]._count) {
+            break;
+        }
+        swap_entries(parent, i);
+        i = parent;
+    }
+}
+
+void hot_keys::sift_down(size_t i)
+{
+    for (;;) {
+        auto min = i;
+        auto left = 2 * i + 1;
+        auto right = left + 1;
+        if (left < _heap.size() && _heap[left]._count < _heap[min]._count) {
+            min = left;
+        }
+        if (right < _heap.size() && _heap[right]._count < _heap[min]._count) {
+            min = right;
+        }
+        if (min == i) {
+            break;
+        }
+        swap_entries(min, i);
+        i = min;
+    }
+}
+
+void hot_keys::age()
+{
+    _sketch.age();
+    // Halving keeps the order, the heap stays one.
+    for (auto& e : _heap) {
+        e._count >>= 1;
+    }
+}
+
+void hot_keys::record(const bytes& key)
+{
+    if (!enabled() || ++_skipped < _sample_every) {
+        return;
+    }
+    _skipped = 0;
+    if (++_samples % (10 * _sketch.width()) == 0) {
+        age();
+    }
+    uint64_t count = _sketch.increment(std::hash<bytes>()(key));
+    auto it = _positions.find(key);
+    if (it != _positions.end()) {
+        auto i = it->second;
+        _heap[i]._count = count;
+        sift_down(i);
+    } else if (_heap.size() < _capacity) {
+        _heap.push_back(entry { key, count });
+        _positions.emplace(key, _heap.size() - 1);
+        sift_up(_heap.size() - 1);
+    } else if (count > _heap.front()._count) {
+        _positions.erase(_heap.front()._key);
+        _heap.front() = entry { key, count };
+        _positions.emplace(key, 0);
+        sift_down(0);
+    }
+}
+
+void hot_keys::record(const request& req)
+{
+    if (!enabled()) {
+        return;
+    }
+    if (auto key = key_of(req)) {
+        record(*key);
+    }
+}
+
+std::vector<hot_keys::entry> hot_keys::get(size_t count) const
+{
+    auto entries = _heap;
+    std::sort(entries.begin(), entries.end(), [] (auto& a, auto& b) {
+        return a._count > b._count;
+    });
+    if (entries.size() > count) {
+        entries.resize(count);
+    }
+    for (auto& e : entries) {
+        e._count *= _sample_every;
+    }
+    return entries;
+}
+
+uint64_t hot_keys::hottest() const
+{
+    uint64_t count = 0;
+    for (auto& e : _heap) {
+        count = std::max(count, e._count);
+    }
+    return count * _sample_every;
+}
+
+uint64_t hot_keys::estimate(const bytes& key) const
+{
+    if (!enabled()) {
+        return 0;
+    }
+    return uint64_t(_sketch.estimate(std::hash<bytes>()(key))) * _sample_every;
+}
+
+void hot_keys::reset()
+{
+    _sketch.reset();
+    _heap.clear();
+    _positions.clear();
+    _skipped = 0;
+    _samples = 0;
+}
+
+future<std::vector<hot_keys::entry>> get_hot_keys(size_t count)
+{
+    // A key may be hot on several shards, as the connections spread the
+    // requests, so every shard gives all of its keys before they are summed.
+    using counts = std::unordered_map<bytes, uint64_t>;
+    return get_query_processor().map_reduce0([] (auto& qp) {
+        auto& hk = qp.get_hot_keys();
+        return hk.get(hk.capacity());
+    }, counts {}, [] (auto&& all, auto&& entries) {
+        for (auto& e : entries) {
+            all[std::move(e._key)] += e._count;
+        }
+        return std::move(all);
+    }).then([count] (counts&& all) {
+        std::vector<hot_keys::entry> entries;
+        entries.reserve(all.size());
+        for (auto& e : all) {
+            entries.emplace_back(hot_keys::entry { e.first, e.second });
+        }
+        std::sort(entries.begin(), entries.end(), [] (auto& a, auto& b) {
+            return a._count > b._count;
+        });
+        if (entries.size() > count) {
+            entries.resize(count);
+        }
+        return entries;
+    });
+}
+
+future<uint64_t> get_key_frequency(bytes key)
+{
+    return do_with(std::move(key), [] (auto& key) {
+        return get_query_processor().map_reduce0([&key] (auto& qp) {
+            return qp.get_hot_keys().estimate(key);
+        }, uint64_t(0), std::plus<uint64_t>());
+    });
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "bytes.hh"
+#include "seastar/core/future.hh"
+#include <unordered_map>
+#include <vector>
+using namespace seastar;
+
+namespace redis {
+
+struct request;
+
+// A count-min sketch of 32 bits counters. The estimate of a key is never lower
+// than its count, the collisions make it higher by at most 2 / width of the
+// total with a probability of 1 - 1 / 2^depth. The counters are incremented
+// with the conservative update, only the lowest ones are, which lowers the
+// overestimation of the keys seldom seen.
+class count_min_sketch {
+public:
+    static constexpr unsigned depth = 4;
+private:
+    // A power of two.
+    size_t _width;
+    std::vector<uint32_t> _counters;
+    size_t index(uint64_t hash, unsigned row) const {
+        // Double hashing, the rows are derived from the two halves of the hash.
+        auto h1 = uint32_t(hash);
+        auto h2 = uint32_t(hash >> 32) | 1;
+        return row * _width + ((h1 + row * h2) & (_width - 1));
+    }
+public:
+    explicit count_min_sketch(size_t width);
+    // Adds one to the count of the hash, returns its new estimate.
+    uint32_t increment(uint64_t hash);
+    uint32_t estimate(uint64_t hash) const;
+    // Halves every counter, so that the estimates follow the recent accesses.
+    void age();
+    void reset();
+    size_t width() const { return _width; }
+};
+
+// The hottest keys of this shard, a streaming top-k: every sampled access is
+// counted in a count-min sketch, and the keys of the highest estimates are kept
+// in a min-heap of `capacity` entries, so that a key colder than the coldest
+// of the heap costs the hashing and no allocation. The counts are halved every
+// ten accesses per counter of a row, the keys hot a while ago fade out.
+class hot_keys {
+public:
+    struct entry {
+        bytes _key;
+        // The estimated accesses, scaled back by the sampling.
+        uint64_t _count;
+    };
+private:
+    static constexpr size_t sketch_width = 4096;
+    count_min_sketch _sketch;
+    // A min-heap on the counts, _positions maps the keys to their entries.
+    std::vector<entry> _heap;
+    std::unordered_map<bytes, size_t> _positions;
+    size_t _capacity;
+    uint32_t _sample_every;
+    uint32_t _skipped = 0;
+    uint64_t _samples = 0;
+    void swap_entries(size_t a, size_t b);
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+    void age();
+public:
+    // A zero capacity disables the sampling, one access out of `sample_every`
+    // is counted.
+    hot_keys(size_t capacity, uint32_t sample_every);
+
+    bool enabled() const {
+        return _capacity > 0;
+    }
+    void record(const bytes& key);
+    // Records the key of the request, if the command has one.
+    void record(const request& req);
+    // The hottest keys first.
+    std::vector<entry> get(size_t count) const;
+    size_t capacity() const { return _capacity; }
+    // The estimated accesses of the hottest key, zero if none.
+    uint64_t hottest() const;
+    // The estimated recent accesses of the key, whether it is among the
+    // hottest ones or not.
+    uint64_t estimate(const bytes& key) const;
+    void reset();
+
+    // The key counted for the request, its first argument when it is a key.
+    // The keys of all the databases are counted together.
+    static const bytes* key_of(const request& req);
+};
+
+// The hottest keys of all the shards, their counts summed up.
+future<std::vector<hot_keys::entry>> get_hot_keys(size_t count);
+// OBJECT FREQ, the estimated accesses of the key on all the shards.
+future<uint64_t> get_key_frequency(bytes key);
+
+}
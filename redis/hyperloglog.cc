@@ -0,0 +1,89 @@
+#include "redis/hyperloglog.hh"
+#include "utils/murmur_hash.hh"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace redis {
+
+static constexpr char magic[] = { 'H', 'Y', 'L', 'L' };
+
+std::optional<hyperloglog> hyperloglog::decode(bytes_view b)
+{
+    if (b.size() < header_size || !std::equal(std::begin(magic), std::end(magic), reinterpret_cast<const char*>(b.data()))) {
+        return std::nullopt;
+    }
+    auto enc = static_cast<encoding>(b[4]);
+    b.remove_prefix(header_size);
+    hyperloglog h;
+    auto& registers = h._hll.registers();
+    if (enc == encoding::dense) {
+        if (b.size() != registers.size()) {
+            return std::nullopt;
+        }
+        std::memcpy(registers.data(), b.data(), b.size());
+        return h;
+    }
+    if (enc != encoding::sparse || b.size() % 3 != 0) {
+        return std::nullopt;
+    }
+    for (size_t i = 0; i < b.size(); i += 3) {
+        auto index = (static_cast<uint8_t>(b[i]) << 8) | static_cast<uint8_t>(b[i + 1]);
+        if (index >= registers.size()) {
+            return std::nullopt;
+        }
+        registers[index] = static_cast<uint8_t>(b[i + 2]);
+    }
+    return h;
+}
+
+bytes hyperloglog::encode() const
+{
+    auto& registers = _hll.registers();
+    auto non_zero = registers.size() - std::count(registers.begin(), registers.end(), 0);
+    auto sparse = non_zero * 3 <= sparse_max_bytes;
+    bytes b(bytes::initialized_later(), header_size + (sparse ? non_zero * 3 : registers.size()));
+    auto out = reinterpret_cast<uint8_t*>(b.begin());
+    std::copy(std::begin(magic), std::end(magic), out);
+    out[4] = static_cast<uint8_t>(sparse ? encoding::sparse : encoding::dense);
+    std::fill_n(out + 5, 3, 0);
+    out += header_size;
+    if (!sparse) {
+        std::memcpy(out, registers.data(), registers.size());
+        return b;
+    }
+    for (size_t i = 0; i < registers.size(); ++i) {
+        if (registers[i]) {
+            *out++ = static_cast<uint8_t>(i >> 8);
+            *out++ = static_cast<uint8_t>(i);
+            *out++ = registers[i];
+        }
+    }
+    return b;
+}
+
+bool hyperloglog::add(bytes_view element)
+{
+    std::array<uint64_t, 2> hash;
+    utils::murmur_hash::hash3_x64_128(element, 0, hash);
+    return _hll.offer_hashed(hash[0]);
+}
+
+bool hyperloglog::merge(const hyperloglog& o)
+{
+    auto& registers = _hll.registers();
+    auto& other = o._hll.registers();
+    // Only a register greater than ours changes the value.
+    auto changed = !std::equal(registers.begin(), registers.end(), other.begin(), [] (uint8_t a, uint8_t b) { return a >= b; });
+    if (changed) {
+        _hll.merge(o._hll);
+    }
+    return changed;
+}
+
+long hyperloglog::count() const
+{
+    return std::llround(_hll.estimate());
+}
+
+}
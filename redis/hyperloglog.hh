@@ -0,0 +1,36 @@
+#pragma once
+#include "bytes.hh"
+#include "seastar/core/temporary_buffer.hh"
+#include "sstables/hyperloglog.hh"
+#include <optional>
+
+namespace redis {
+
+// The value of PFADD, PFCOUNT and PFMERGE, kept in the strings table. The registers
+// are those of hll::HyperLogLog (one byte per register), the value is laid out as:
+//   "HYLL" | encoding (1 byte) | 3 unused bytes | registers
+// A dense value keeps all 2^14 registers, a sparse value keeps the non-zero registers
+// only, as (index: 2 bytes big endian, rank: 1 byte), sorted by index. A value is
+// sparse as long as it fits in sparse_max_bytes.
+class hyperloglog {
+    hll::HyperLogLog _hll;
+public:
+    static constexpr uint8_t precision = 14;
+    static constexpr size_t header_size = 8;
+    static constexpr size_t sparse_max_bytes = 3000;
+    enum class encoding : uint8_t { dense = 0, sparse = 1 };
+
+    hyperloglog() : _hll(precision) {}
+
+    // Returns nothing if `b` is not a HyperLogLog value.
+    static std::optional<hyperloglog> decode(bytes_view b);
+    bytes encode() const;
+
+    // Returns true if a register was updated, i.e. the value has to be written back.
+    bool add(bytes_view element);
+    // Returns true if a register was updated.
+    bool merge(const hyperloglog& o);
+    long count() const;
+};
+
+}
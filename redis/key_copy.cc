@@ -0,0 +1,149 @@
+#include "redis/key_copy.hh"
+#include "redis/prefetcher.hh"
+#include "redis/query_processor.hh"
+#include "redis/redis_keyspace.hh"
+#include "redis/redis_mutation.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "dht/i_partitioner.hh"
+#include "query-result-reader.hh"
+#include "seastar/core/future-util.hh"
+#include <boost/range/adaptor/transformed.hpp>
+#include <boost/range/irange.hpp>
+
+namespace redis {
+
+future<bool> key_exists(service::storage_proxy& proxy, const keyspace_schemas& schemas, const bytes& key,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    return do_with(schemas.all(), [&proxy, &key, cl, timeout, &cs] (auto& tables) {
+        return map_reduce(tables.begin(), tables.end(), [&proxy, &key, cl, timeout, &cs] (const schema_ptr& s) {
+            return exists(proxy, s, key, cl, timeout, cs);
+        }, false, std::bit_or<bool>());
+    });
+}
+
+namespace {
+
+// The live rows of the partition read, written to the partition of the
+// destination key.
+class partition_copier {
+    const schema& _from;
+    const query::partition_slice& _slice;
+    mutation& _to;
+    api::timestamp_type _timestamp;
+    bool _live = false;
+private:
+    void copy(const clustering_key& key, const query::result_row_view& row) {
+        auto it = row.iterator();
+        for (auto id : _slice.regular_columns) {
+            auto cell = it.next_atomic_cell();
+            if (!cell) {
+                continue;
+            }
+            _live = true;
+            auto& column = *_to.schema()->get_column_definition(_from.regular_column_at(id).name());
+            auto value = cell->value().linearize();
+            auto expiry = cell->expiry();
+            auto ttl = cell->ttl();
+            _to.set_clustered_cell(key, column, expiry && ttl
+                ? atomic_cell::make_live(*column.type, _timestamp, value, *expiry, *ttl)
+                : atomic_cell::make_live(*column.type, _timestamp, value));
+        }
+    }
+public:
+    partition_copier(const schema& from, const query::partition_slice& slice, mutation& to, api::timestamp_type timestamp)
+        : _from(from), _slice(slice), _to(to), _timestamp(timestamp) {}
+    void accept_new_partition(const partition_key& key, uint32_t row_count) {}
+    void accept_new_partition(uint32_t row_count) {}
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row) {
+        copy(key, row);
+    }
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {
+        copy(clustering_key::make_empty(), row);
+    }
+    void accept_partition_end(const query::result_row_view& static_row) {}
+    bool live() const {
+        return _live;
+    }
+};
+
+// Reads the partition of the key in the table, as the partition of the new
+// key in the destination table. None if the key has no live row.
+future<std::optional<mutation>> read_partition_as(service::storage_proxy& proxy, schema_ptr from, const bytes& key,
+    schema_ptr to, const bytes& new_key, api::timestamp_type timestamp,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    auto regular_cols = boost::copy_range<std::vector<column_id>>(from->regular_columns() | boost::adaptors::transformed([] (auto& c) {
+        return c.id;
+    }));
+    query::partition_slice ps(
+            { query::full_clustering_range },
+            {},
+            std::move(regular_cols),
+            query::partition_slice::option_set::of<
+                query::partition_slice::option::send_partition_key,
+                query::partition_slice::option::send_clustering_key,
+                query::partition_slice::option::send_expiry,
+                query::partition_slice::option::send_ttl>());
+    auto cmd = make_lw_shared<query::read_command>(from->id(), from->version(), ps, std::numeric_limits<uint32_t>::max(), gc_clock::now(), std::experimental::nullopt, 1);
+    dht::partition_range_vector ranges;
+    ranges.emplace_back(dht::partition_range::make_singular(dht::global_partitioner().decorate_key(*from, partition_key::from_single_value(*from, key))));
+    return proxy.query(from, cmd, std::move(ranges), cl, {timeout, cs.get_trace_state()}).then([from, to, ps, new_key, timestamp] (auto qr) {
+        return query::result_view::do_with(*qr.query_result, [&] (query::result_view v) {
+            mutation m(to, partition_key::from_single_value(*to, new_key));
+            partition_copier copier(*from, ps, m, timestamp);
+            v.consume(ps, copier);
+            return copier.live() ? std::optional<mutation>(std::move(m)) : std::optional<mutation>();
+        });
+    });
+}
+
+}
+
+future<bool> copy_key(service::storage_proxy& proxy,
+    const keyspace_schemas& from, const bytes& key,
+    const keyspace_schemas& to, const bytes& new_key,
+    bool move,
+    db::consistency_level cl, db::timeout_clock::time_point read_timeout, db::timeout_clock::time_point write_timeout,
+    service::client_state& cs)
+{
+    // The previous value of the destination is deleted before the copy is
+    // written, the source after it was read.
+    auto deleted = api::new_timestamp();
+    auto written = deleted + 1;
+    auto sources = from.all();
+    auto destinations = to.all();
+    auto tables = sources.size();
+    return do_with(std::move(sources), std::move(destinations), std::vector<std::optional<mutation>>(tables),
+            [&proxy, &key, &new_key, move, cl, read_timeout, write_timeout, &cs, deleted, written] (auto& sources, auto& destinations, auto& copies) {
+        return parallel_for_each(boost::irange(size_t(0), sources.size()), [&, written] (size_t i) {
+            return read_partition_as(proxy, sources[i], key, destinations[i], new_key, written, cl, read_timeout, cs).then([&copies, i] (std::optional<mutation> m) {
+                copies[i] = std::move(m);
+            });
+        }).then([&, deleted, written] {
+            if (std::none_of(copies.begin(), copies.end(), [] (auto& m) { return bool(m); })) {
+                return make_ready_future<bool>(false);
+            }
+            std::vector<mutation> ms;
+            for (size_t i = 0; i < destinations.size(); ++i) {
+                auto& s = destinations[i];
+                ms.emplace_back(s, partition_key::from_single_value(*s, new_key));
+                ms.back().partition().apply(tombstone { deleted, gc_clock::now() });
+                if (copies[i]) {
+                    ms.back().apply(std::move(*copies[i]));
+                }
+                if (move) {
+                    auto& src = sources[i];
+                    ms.emplace_back(src, partition_key::from_single_value(*src, key));
+                    ms.back().partition().apply(tombstone { written, gc_clock::now() });
+                }
+            }
+            return internal::write_mutation_impl(proxy, std::move(ms), cl, write_timeout, cs).then([] {
+                return true;
+            });
+        });
+    });
+}
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "bytes.hh"
+#include "db/consistency_level_type.hh"
+#include "db/timeout_clock.hh"
+#include "seastar/core/future.hh"
+using namespace seastar;
+
+namespace service {
+class storage_proxy;
+class client_state;
+}
+
+namespace redis {
+
+struct keyspace_schemas;
+
+// Whether the key is in any of the tables of the keyspace.
+future<bool> key_exists(service::storage_proxy& proxy, const keyspace_schemas& schemas, const bytes& key,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs);
+
+// RENAME, COPY and MOVE: copies the partitions of the key, in every table, to
+// another key of the same keyspace or of another one. The rows are copied as
+// they are stored, with their clustering keys and expiry, into one mutation
+// per table, which replaces the previous value of the destination key. With
+// `move`, the source key is deleted in the same batch. Returns false if the
+// source key does not exist.
+future<bool> copy_key(service::storage_proxy& proxy,
+    const keyspace_schemas& from, const bytes& key,
+    const keyspace_schemas& to, const bytes& new_key,
+    bool move,
+    db::consistency_level cl, db::timeout_clock::time_point read_timeout, db::timeout_clock::time_point write_timeout,
+    service::client_state& cs);
+
+}
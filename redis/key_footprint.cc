@@ -0,0 +1,339 @@
+#include "redis/key_footprint.hh"
+#include "redis/prefetcher.hh"
+#include "redis/query_processor.hh"
+#include "redis/redis_keyspace.hh"
+#include "service/client_state.hh"
+#include "service/priority_manager.hh"
+#include "service/storage_proxy.hh"
+#include "sstables/sstables.hh"
+#include "sstables/index_reader.hh"
+#include "database.hh"
+#include "dht/i_partitioner.hh"
+#include "query-result-reader.hh"
+#include "log.hh"
+#include "seastar/core/future-util.hh"
+#include <boost/range/adaptor/filtered.hpp>
+#include <boost/range/adaptor/map.hpp>
+#include <boost/range/adaptor/transformed.hpp>
+#include <boost/range/irange.hpp>
+
+namespace redis {
+
+static logging::logger logging("bigkeys");
+
+// The bytes of the data file taken by a partition, from the distance between
+// uncompressed positions.
+static uint64_t disk_bytes(const sstables::sstable& sst, uint64_t uncompressed)
+{
+    auto data_size = sst.data_size();
+    return data_size ? uncompressed * sst.ondisk_data_size() / data_size : 0;
+}
+
+static future<uint64_t> partition_disk_bytes(sstables::shared_sstable sst, const dht::decorated_key& dk)
+{
+    auto index = make_lw_shared<sstables::index_reader>(sst, default_priority_class());
+    // Both bounds are past the partition when the sstable doesn't have it.
+    return index->advance_to(dht::partition_range::make_singular(dk)).then([index, sst] {
+        auto positions = index->data_file_positions();
+        auto end = positions.end ? *positions.end : sst->data_size();
+        return disk_bytes(*sst, end - positions.start);
+    }).finally([index] {
+        return index->close();
+    });
+}
+
+static future<table_footprint> table_footprint_of(column_family& cf, const bytes& key)
+{
+    auto s = cf.schema();
+    auto dk = dht::global_partitioner().decorate_key(*s, partition_key::from_single_value(*s, key));
+    table_footprint f;
+    f._memtable_bytes = cf.partition_memtable_memory_usage(dk);
+    f._cache_bytes = cf.get_row_cache().partition_memory_usage(dk);
+    auto sstables = cf.select_sstables(dht::partition_range::make_singular(dk));
+    // The filters spare the reads of the indexes of most of the sstables
+    // without the key.
+    auto candidates = boost::copy_range<std::vector<sstables::shared_sstable>>(sstables
+        | boost::adaptors::filtered([&] (auto& sst) { return sst->filter_has_key(*s, dk); }));
+    return do_with(std::move(candidates), std::move(dk), [f] (auto& candidates, auto& dk) {
+        return map_reduce(candidates.begin(), candidates.end(), [&dk] (auto& sst) {
+            return partition_disk_bytes(sst, dk);
+        }, uint64_t(0), std::plus<uint64_t>()).then([f] (uint64_t disk) mutable {
+            f._disk_bytes = disk;
+            return f;
+        });
+    });
+}
+
+future<std::vector<table_footprint>> get_key_footprint(distributed<database>& db, const keyspace_schemas& schemas, const bytes& key)
+{
+    auto tables = boost::copy_range<std::vector<utils::UUID>>(schemas.all() | boost::adaptors::transformed([] (auto& s) {
+        return s->id();
+    }));
+    auto count = tables.size();
+    auto& s = *schemas._strings;
+    auto shard = dht::global_partitioner().shard_of(dht::global_partitioner().get_token(s, partition_key::from_single_value(s, key)));
+    return db.invoke_on(shard, [tables = std::move(tables), count, key] (database& db) {
+        return do_with(tables, std::vector<table_footprint>(count), key,
+                [&db] (auto& tables, auto& footprints, auto& key) {
+            return parallel_for_each(boost::irange(size_t(0), tables.size()), [&] (size_t i) {
+                return table_footprint_of(db.find_column_family(tables[i]), key).then([&footprints, i] (table_footprint f) {
+                    footprints[i] = f;
+                });
+            }).then([&footprints] {
+                return std::move(footprints);
+            });
+        });
+    });
+}
+
+future<schema_ptr> table_of(service::storage_proxy& proxy, const keyspace_schemas& schemas, const bytes& key,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    auto tables = schemas.all();
+    auto count = tables.size();
+    return do_with(std::move(tables), std::vector<bool>(count), [&proxy, &key, cl, timeout, &cs] (auto& tables, auto& live) {
+        return parallel_for_each(boost::irange(size_t(0), tables.size()), [&] (size_t i) {
+            return exists(proxy, tables[i], key, cl, timeout, cs).then([&live, i] (bool exists) {
+                live[i] = exists;
+            });
+        }).then([&tables, &live] {
+            auto it = std::find(live.begin(), live.end(), true);
+            return it != live.end() ? tables[it - live.begin()] : schema_ptr();
+        });
+    });
+}
+
+namespace {
+
+// The most recent timestamp of the live cells of the partition read.
+class last_write_finder {
+    const query::partition_slice& _slice;
+    std::optional<api::timestamp_type> _last;
+private:
+    void visit(const query::result_row_view& row) {
+        auto it = row.iterator();
+        for (size_t i = 0; i < _slice.regular_columns.size(); ++i) {
+            auto cell = it.next_atomic_cell();
+            if (cell) {
+                _last = std::max(_last.value_or(api::min_timestamp), cell->timestamp());
+            }
+        }
+    }
+public:
+    explicit last_write_finder(const query::partition_slice& slice) : _slice(slice) {}
+    void accept_new_partition(const partition_key& key, uint32_t row_count) {}
+    void accept_new_partition(uint32_t row_count) {}
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row) {
+        visit(row);
+    }
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {
+        visit(row);
+    }
+    void accept_partition_end(const query::result_row_view& static_row) {}
+    std::optional<api::timestamp_type> last() const {
+        return _last;
+    }
+};
+
+}
+
+future<std::optional<api::timestamp_type>> last_write_of(service::storage_proxy& proxy, schema_ptr schema, const bytes& key,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    auto regular_cols = boost::copy_range<std::vector<column_id>>(schema->regular_columns() | boost::adaptors::transformed([] (auto& c) {
+        return c.id;
+    }));
+    query::partition_slice ps(
+            { query::full_clustering_range },
+            {},
+            std::move(regular_cols),
+            query::partition_slice::option_set::of<query::partition_slice::option::send_timestamp>());
+    auto cmd = make_lw_shared<query::read_command>(schema->id(), schema->version(), ps, std::numeric_limits<uint32_t>::max(), gc_clock::now(), std::experimental::nullopt, 1);
+    dht::partition_range_vector ranges;
+    ranges.emplace_back(dht::partition_range::make_singular(dht::global_partitioner().decorate_key(*schema, partition_key::from_single_value(*schema, key))));
+    return proxy.query(schema, cmd, std::move(ranges), cl, {timeout, cs.get_trace_state()}).then([ps] (auto qr) {
+        return query::result_view::do_with(*qr.query_result, [&] (query::result_view v) {
+            last_write_finder finder(ps);
+            v.consume(ps, finder);
+            return finder.last();
+        });
+    });
+}
+
+std::optional<sstring> type_of(const schema& s)
+{
+    static const std::unordered_map<sstring, sstring> types {
+        { STRINGS, "string" },
+        { BITMAPS, "string" },
+        { LISTS, "list" },
+        { SETS, "set" },
+        { MAPS, "hash" },
+        { ZSETS, "zset" },
+        { STREAMS, "stream" },
+    };
+    auto it = types.find(s.cf_name());
+    return it != types.end() ? std::optional<sstring>(it->second) : std::nullopt;
+}
+
+void big_keys::add(big_key&& k)
+{
+    auto cmp = [] (const big_key& a, const big_key& b) {
+        return a._bytes > b._bytes;
+    };
+    auto& heap = _largest[k._type];
+    if (heap.size() < _per_type) {
+        heap.push_back(std::move(k));
+        std::push_heap(heap.begin(), heap.end(), cmp);
+    } else if (k._bytes > heap.front()._bytes) {
+        std::pop_heap(heap.begin(), heap.end(), cmp);
+        heap.back() = std::move(k);
+        std::push_heap(heap.begin(), heap.end(), cmp);
+    }
+}
+
+future<> big_keys::scan()
+{
+    struct table {
+        schema_ptr _schema;
+        sstring _type;
+        uint64_t _db;
+        std::vector<sstables::shared_sstable> _sstables;
+    };
+    std::vector<table> tables;
+    auto& db = service::get_local_storage_proxy().get_db().local();
+    for (auto& cf : db.get_column_families() | boost::adaptors::map_values) {
+        auto s = cf->schema();
+        auto type = type_of(*s);
+        auto& ks = s->ks_name();
+        if (!type || ks.find(REDIS_DATABASE_NAME_PREFIX) != 0) {
+            continue;
+        }
+        uint64_t db_index;
+        try {
+            db_index = std::stoull(ks.substr(strlen(REDIS_DATABASE_NAME_PREFIX)));
+        } catch (std::exception&) {
+            continue;
+        }
+        auto sstables = cf->get_sstables();
+        tables.push_back(table { s, *type, db_index, std::vector<sstables::shared_sstable>(sstables->begin(), sstables->end()) });
+    }
+    return do_with(std::move(tables), [this] (auto& tables) {
+        return do_for_each(tables, [this] (table& t) {
+            return do_for_each(t._sstables, [this, &t] (sstables::shared_sstable& sst) {
+                if (_stopping) {
+                    return make_ready_future<>();
+                }
+                auto index = make_lw_shared<sstables::index_reader>(sst, service::get_local_compaction_priority());
+                // The key read last and its position, its size is known with
+                // the position of the next one.
+                auto previous = make_lw_shared<std::optional<std::pair<bytes, uint64_t>>>();
+                auto add_previous = [this, &t, sst, previous] (uint64_t end) {
+                    if (*previous) {
+                        add(big_key { t._type, t._db, std::move((*previous)->first), disk_bytes(*sst, end - (*previous)->second) });
+                        *previous = std::nullopt;
+                    }
+                };
+                return repeat([this, &t, index, previous, add_previous] () mutable {
+                    if (_stopping || index->eof()) {
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    }
+                    return index->read_partition_data().then([this, &t, index, previous, add_previous] () mutable {
+                        auto start = index->data_file_positions().start;
+                        add_previous(start);
+                        ++_scanned_partitions;
+                        // The sstables shared by several shards are scanned by
+                        // each of them, the keys are counted by their owner.
+                        auto key = index->partition_key();
+                        auto pk = key.to_partition_key(*t._schema);
+                        if (dht::shard_of(dht::global_partitioner().decorate_key(*t._schema, pk).token()) == engine().cpu_id()) {
+                            *previous = std::make_pair(bytes(bytes_view(key)), start);
+                        }
+                        return index->advance_to_next_partition().then([] {
+                            return stop_iteration::no;
+                        });
+                    });
+                }).then([this, sst, add_previous] () mutable {
+                    if (!_stopping) {
+                        add_previous(sst->data_size());
+                    }
+                }).finally([index] {
+                    return index->close();
+                });
+            });
+        });
+    });
+}
+
+bool big_keys::start()
+{
+    if (_running) {
+        return false;
+    }
+    _largest.clear();
+    _scanned_partitions = 0;
+    _running = true;
+    _scan = scan().handle_exception([] (std::exception_ptr e) {
+        logging.warn("The scan of the big keys failed: {}", e);
+    }).finally([this] {
+        _running = false;
+    });
+    return true;
+}
+
+std::vector<big_key> big_keys::get() const
+{
+    std::vector<big_key> keys;
+    for (auto& heap : _largest | boost::adaptors::map_values) {
+        keys.insert(keys.end(), heap.begin(), heap.end());
+    }
+    std::sort(keys.begin(), keys.end(), [] (auto& a, auto& b) {
+        return std::tie(a._type, b._bytes) < std::tie(b._type, a._bytes);
+    });
+    return keys;
+}
+
+future<> big_keys::stop()
+{
+    _stopping = true;
+    return std::exchange(_scan, make_ready_future<>());
+}
+
+future<bool> start_big_keys_scan()
+{
+    return get_query_processor().map_reduce0([] (auto& qp) {
+        return qp.get_big_keys().running();
+    }, false, std::logical_or<bool>()).then([] (bool running) {
+        if (running) {
+            return make_ready_future<bool>(false);
+        }
+        return get_query_processor().invoke_on_all([] (auto& qp) {
+            qp.get_big_keys().start();
+        }).then([] {
+            return true;
+        });
+    });
+}
+
+future<std::vector<big_key>> get_big_keys(size_t count)
+{
+    return get_query_processor().map_reduce0([] (auto& qp) {
+        return qp.get_big_keys().get();
+    }, std::vector<big_key>(), [] (std::vector<big_key>&& all, std::vector<big_key>&& keys) {
+        all.insert(all.end(), std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()));
+        return std::move(all);
+    }).then([count] (std::vector<big_key>&& keys) {
+        std::sort(keys.begin(), keys.end(), [] (auto& a, auto& b) {
+            return std::tie(a._type, b._bytes) < std::tie(b._type, a._bytes);
+        });
+        std::vector<big_key> largest;
+        for (size_t i = 0, of_type = 0; i < keys.size(); ++i) {
+            of_type = i > 0 && keys[i]._type == keys[i - 1]._type ? of_type + 1 : 0;
+            if (of_type < count) {
+                largest.push_back(keys[i]);
+            }
+        }
+        return largest;
+    });
+}
+
+}
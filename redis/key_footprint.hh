@@ -0,0 +1,106 @@
+#pragma once
+#include "bytes.hh"
+#include "schema.hh"
+#include "timestamp.hh"
+#include "db/consistency_level_type.hh"
+#include "db/timeout_clock.hh"
+#include "seastar/core/distributed.hh"
+#include "seastar/core/future.hh"
+#include "seastar/core/sstring.hh"
+#include <optional>
+#include <unordered_map>
+#include <vector>
+using namespace seastar;
+
+class database;
+
+namespace service {
+class storage_proxy;
+class client_state;
+}
+
+namespace redis {
+
+struct keyspace_schemas;
+
+// The footprint of the partition of a key in a table, on this node.
+struct table_footprint {
+    // The memory of the partition in the memtables and in the row cache, as
+    // accounted in their LSA regions.
+    uint64_t _memtable_bytes = 0;
+    uint64_t _cache_bytes = 0;
+    // The bytes of the partition in the data files of the sstables, from the
+    // positions of their index entries, scaled by the compression ratio.
+    uint64_t _disk_bytes = 0;
+
+    uint64_t total() const {
+        return _memtable_bytes + _cache_bytes + _disk_bytes;
+    }
+};
+
+// MEMORY USAGE, the footprint of the key in each table of the keyspace, in the
+// order of keyspace_schemas::all(), measured on the shard of this node owning
+// the key. All zero if this node doesn't replicate the key.
+future<std::vector<table_footprint>> get_key_footprint(distributed<database>& db, const keyspace_schemas& schemas, const bytes& key);
+
+// The first table of keyspace_schemas::all() where the key has a live row,
+// null if the key doesn't exist.
+future<schema_ptr> table_of(service::storage_proxy& proxy, const keyspace_schemas& schemas, const bytes& key,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs);
+
+// The most recent write of the live cells of the key in the table.
+future<std::optional<api::timestamp_type>> last_write_of(service::storage_proxy& proxy, schema_ptr schema, const bytes& key,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs);
+
+// The type of the keys of the table, as TYPE names it: the bitmaps are strings,
+// none for the tables of the secondary rows of a type.
+std::optional<sstring> type_of(const schema& s);
+
+// A key of the largest ones of its type found by BIGKEYS.
+struct big_key {
+    sstring _type;
+    uint64_t _db;
+    bytes _key;
+    uint64_t _bytes;
+};
+
+// BIGKEYS, like redis-cli --bigkeys: a background scan of the redis keyspaces
+// of the shard, which keeps the largest partitions of each type. Only the
+// index files of the sstables are read, with the compaction priority, the size
+// of a partition being the distance to the next one in the data file. The
+// keys not flushed yet are not seen, and a key spread over several sstables is
+// counted per sstable.
+class big_keys {
+    size_t _per_type;
+    // Min-heaps on the sizes, by type.
+    std::unordered_map<sstring, std::vector<big_key>> _largest;
+    future<> _scan = make_ready_future<>();
+    bool _running = false;
+    bool _stopping = false;
+    uint64_t _scanned_partitions = 0;
+private:
+    void add(big_key&& k);
+    future<> scan();
+public:
+    explicit big_keys(size_t per_type) : _per_type(per_type) {}
+    // Starts a scan, the results of the previous one are dropped. False if a
+    // scan is running.
+    bool start();
+    bool running() const {
+        return _running;
+    }
+    uint64_t scanned_partitions() const {
+        return _scanned_partitions;
+    }
+    // The largest keys of each type, the largest first.
+    std::vector<big_key> get() const;
+    future<> stop();
+};
+
+// Starts the scan on every shard, false if one is still running.
+future<bool> start_big_keys_scan();
+// The largest keys of every type of all the shards, `count` per type at most,
+// by type and the largest first.
+future<std::vector<big_key>> get_big_keys(size_t count);
+
+}
@@ -0,0 +1,44 @@
+#include "redis/key_locks.hh"
+#include "redis/blocked_clients.hh"
+#include "redis/query_processor.hh"
+namespace redis {
+
+future<> key_locks::lock(const bytes& key)
+{
+    auto it = _locks.find(key);
+    if (it == _locks.end()) {
+        it = _locks.emplace(key, make_lw_shared<semaphore>(1)).first;
+    }
+    // Keeps the semaphore alive while waiting, unlock() may erase it meanwhile.
+    auto sem = it->second;
+    return sem->wait(1).finally([sem] {});
+}
+
+void key_locks::unlock(const bytes& key)
+{
+    auto it = _locks.find(key);
+    if (it == _locks.end()) {
+        return;
+    }
+    auto sem = it->second;
+    sem->signal(1);
+    if (sem->waiters() == 0 && sem->available_units() == 1) {
+        _locks.erase(it);
+    }
+}
+
+future<> lock_on_owner(const schema_ptr schema, const bytes& key)
+{
+    return get_query_processor().invoke_on(blocked_clients::shard_of(*schema, key), [k = blocked_clients::make_key(*schema, key)] (auto& qp) {
+        return qp.get_key_locks().lock(k);
+    });
+}
+
+future<> unlock_on_owner(const schema_ptr schema, const bytes& key)
+{
+    return get_query_processor().invoke_on(blocked_clients::shard_of(*schema, key), [k = blocked_clients::make_key(*schema, key)] (auto& qp) {
+        qp.get_key_locks().unlock(k);
+    });
+}
+
+}
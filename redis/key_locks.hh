@@ -0,0 +1,55 @@
+#pragma once
+#include "bytes.hh"
+#include "schema.hh"
+#include "seastar/core/future.hh"
+#include "seastar/core/future-util.hh"
+#include "seastar/core/semaphore.hh"
+#include "seastar/core/shared_ptr.hh"
+#include <unordered_map>
+using namespace seastar;
+
+namespace redis {
+
+// The locks of the keys owned by this shard, for the commands which read a key
+// and write it back depending on what they read (the pops of the lists, the IDs
+// of the streams and the last delivered IDs of their groups, the chunks of the
+// bitmaps, the HyperLogLogs). The keys are made by blocked_clients::make_key,
+// the lock of a key only exists while it is held or waited for.
+class key_locks {
+    std::unordered_map<bytes, lw_shared_ptr<semaphore>> _locks;
+public:
+    key_locks() {}
+    key_locks(const key_locks&) = delete;
+    key_locks& operator=(const key_locks&) = delete;
+
+    future<> lock(const bytes& key);
+    void unlock(const bytes& key);
+
+    template<typename Func>
+    futurize_t<std::result_of_t<Func()>> with_lock(const bytes& key, Func&& func) {
+        return lock(key).then([this, key, func = std::forward<Func>(func)] () mutable {
+            return futurize_apply(func).finally([this, key] {
+                unlock(key);
+            });
+        });
+    }
+
+    size_t locked() const { return _locks.size(); }
+};
+
+// Locks the key on the shard owning it, from any shard.
+future<> lock_on_owner(const schema_ptr schema, const bytes& key);
+future<> unlock_on_owner(const schema_ptr schema, const bytes& key);
+
+// Runs `func` on this shard under the lock of the key on the shard owning it, so
+// the read-modify-writes of a key made from all the shards are serialized.
+template<typename Func>
+futurize_t<std::result_of_t<Func()>> with_lock_on_owner(const schema_ptr schema, const bytes& key, Func&& func) {
+    return lock_on_owner(schema, key).then([schema, key, func = std::forward<Func>(func)] () mutable {
+        return futurize_apply(func).finally([schema, key] {
+            return unlock_on_owner(schema, key);
+        });
+    });
+}
+
+}
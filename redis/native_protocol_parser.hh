@@ -29,6 +29,7 @@
 #include "core/future.hh"
 #include "exceptions/exceptions.hh"
 #include "redis/request.hh"
+#include "redis/command_factory.hh"
 #include "protocol_parser.hh"
 namespace redis {
 
@@ -44,6 +45,7 @@ public:
     virtual char* parse(char* p, char* limit, char* eof);
     virtual redis::request& get_request() { 
         std::transform(_req._command.begin(), _req._command.end(), _req._command.begin(), ::tolower);
+        _req._code = command_factory::code_of(_req._command);
         return _req;
     }
 };
@@ -0,0 +1,221 @@
+#include "redis/near_cache.hh"
+#include "redis/query_processor.hh"
+#include "seastar/core/future-util.hh"
+
+namespace redis {
+
+static uint64_t hash_of(const sstring& keyspace, const bytes& key)
+{
+    return std::hash<bytes>()(key) * 31 + std::hash<sstring>()(keyspace);
+}
+
+static size_t size_of(const bytes_return_type& v)
+{
+    return v && v->has_data() ? v->data().size() : 0;
+}
+
+static size_t size_of(const map_return_type& v)
+{
+    size_t size = 0;
+    if (v) {
+        for (auto& e : v->data()) {
+            size += (e.first ? e.first->size() : 0) + (e.second ? e.second->size() : 0);
+        }
+    }
+    return size;
+}
+
+near_cache::near_cache(size_t capacity, clock::duration staleness)
+    : _frequencies(capacity ? sketch_width : 1)
+    , _generations(generation_buckets, 0)
+    , _capacity(capacity)
+    , _staleness(staleness)
+{
+}
+
+near_cache::~near_cache()
+{
+    _lru.clear();
+}
+
+void near_cache::touch(const sstring& keyspace, const bytes& key)
+{
+    // Halved like the hot keys, the admission follows the recent reads.
+    if (++_samples % (10 * sketch_width) == 0) {
+        _frequencies.age();
+    }
+    _frequencies.increment(hash_of(keyspace, key));
+}
+
+uint64_t near_cache::generation(const sstring& keyspace, const bytes& key) const
+{
+    return _generations[hash_of(keyspace, key) & (generation_buckets - 1)];
+}
+
+near_cache::entry* near_cache::find(const sstring& keyspace, const bytes& key)
+{
+    auto ks = _keyspaces.find(keyspace);
+    if (ks == _keyspaces.end()) {
+        return nullptr;
+    }
+    auto it = ks->second.find(key);
+    return it != ks->second.end() ? &it->second : nullptr;
+}
+
+near_cache::entry* near_cache::admit(const sstring& keyspace, const bytes& key)
+{
+    auto size = entry_overhead + key.size();
+    auto frequency = _frequencies.estimate(hash_of(keyspace, key));
+    // The least recently used keys make room for the new one as long as they
+    // are read less often.
+    while (_used + size > _capacity) {
+        if (_lru.empty()) {
+            ++_stats._rejections;
+            return nullptr;
+        }
+        auto& victim = _lru.back();
+        if (_frequencies.estimate(hash_of(*victim._keyspace, *victim._key)) >= frequency) {
+            ++_stats._rejections;
+            return nullptr;
+        }
+        evict(victim);
+        ++_stats._evictions;
+    }
+    auto ks = _keyspaces.emplace(keyspace, std::unordered_map<bytes, entry>()).first;
+    auto it = ks->second.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first;
+    auto& e = it->second;
+    e._keyspace = &ks->first;
+    e._key = &it->first;
+    e._size = size;
+    _used += size;
+    _lru.push_front(e);
+    ++_stats._insertions;
+    return &e;
+}
+
+bool near_cache::resize(entry& e, size_t size)
+{
+    _used = _used - e._size + size;
+    e._size = size;
+    _lru.erase(_lru.iterator_to(e));
+    _lru.push_front(e);
+    while (_used > _capacity) {
+        auto& victim = _lru.back();
+        auto self = &victim == &e;
+        evict(victim);
+        ++_stats._evictions;
+        if (self) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void near_cache::evict(entry& e)
+{
+    _lru.erase(_lru.iterator_to(e));
+    _used -= e._size;
+    auto ks = _keyspaces.find(*e._keyspace);
+    ks->second.erase(ks->second.find(*e._key));
+    if (ks->second.empty()) {
+        _keyspaces.erase(ks);
+    }
+}
+
+std::optional<bytes_return_type> near_cache::get_string(const sstring& keyspace, const bytes& key)
+{
+    touch(keyspace, key);
+    auto e = find(keyspace, key);
+    if (e && e->_string && e->_string->_expiry > clock::now()) {
+        ++_stats._hits;
+        _lru.erase(_lru.iterator_to(*e));
+        _lru.push_front(*e);
+        return e->_string->_value;
+    }
+    ++_stats._misses;
+    return std::nullopt;
+}
+
+void near_cache::put_string(const sstring& keyspace, const bytes& key, bytes_return_type value, uint64_t generation)
+{
+    if (generation != near_cache::generation(keyspace, key)) {
+        return;
+    }
+    auto e = find(keyspace, key);
+    if (!e && !(e = admit(keyspace, key))) {
+        return;
+    }
+    auto size = e->_size - (e->_string ? size_of(e->_string->_value) : 0) + size_of(value);
+    e->_string = cached<bytes_return_type> { std::move(value), clock::now() + _staleness };
+    resize(*e, size);
+}
+
+std::optional<map_return_type> near_cache::get_field(const sstring& keyspace, const bytes& key, const bytes& field)
+{
+    touch(keyspace, key);
+    auto e = find(keyspace, key);
+    if (e) {
+        auto it = e->_fields.find(field);
+        if (it != e->_fields.end() && it->second._expiry > clock::now()) {
+            ++_stats._hits;
+            _lru.erase(_lru.iterator_to(*e));
+            _lru.push_front(*e);
+            return it->second._value;
+        }
+    }
+    ++_stats._misses;
+    return std::nullopt;
+}
+
+void near_cache::put_field(const sstring& keyspace, const bytes& key, const bytes& field, map_return_type value, uint64_t generation)
+{
+    if (generation != near_cache::generation(keyspace, key)) {
+        return;
+    }
+    auto e = find(keyspace, key);
+    if (!e && !(e = admit(keyspace, key))) {
+        return;
+    }
+    auto size = e->_size + size_of(value);
+    auto it = e->_fields.find(field);
+    if (it != e->_fields.end()) {
+        size -= size_of(it->second._value);
+        it->second = cached<map_return_type> { std::move(value), clock::now() + _staleness };
+    } else {
+        size += field.size();
+        e->_fields.emplace(field, cached<map_return_type> { std::move(value), clock::now() + _staleness });
+    }
+    resize(*e, size);
+}
+
+void near_cache::invalidate(const sstring& keyspace, const std::vector<bytes>& keys)
+{
+    for (auto& key : keys) {
+        ++_generations[hash_of(keyspace, key) & (generation_buckets - 1)];
+        if (auto e = find(keyspace, key)) {
+            evict(*e);
+            ++_stats._invalidations;
+        }
+    }
+}
+
+void near_cache::invalidate_all()
+{
+    for (auto& g : _generations) {
+        ++g;
+    }
+    _lru.clear();
+    _keyspaces.clear();
+    _used = 0;
+}
+
+future<> invalidate_near_caches(sstring keyspace, std::vector<bytes> keys)
+{
+    return do_with(std::move(keyspace), std::move(keys), [] (auto& keyspace, auto& keys) {
+        return get_query_processor().invoke_on_all([&keyspace, &keys] (auto& qp) {
+            qp.get_near_cache().invalidate(keyspace, keys);
+        });
+    });
+}
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "bytes.hh"
+#include "redis/reply.hh"
+#include "redis/hot_keys.hh"
+#include "seastar/core/future.hh"
+#include "seastar/core/lowres_clock.hh"
+#include "seastar/core/sstring.hh"
+#include <boost/intrusive/list.hpp>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+using namespace seastar;
+
+namespace redis {
+
+// The values read by GET and HGET on this shard, kept for the next reads of
+// the same keys, which would otherwise go to the shard or the replica owning
+// them. The cache is bounded by bytes, a new key is admitted only if it is
+// read more often than the least recently used key it evicts (TinyLFU), the
+// reads being counted in a count-min sketch, so a scan doesn't flush the hot
+// keys.
+//
+// The writes processed by this node invalidate the keys they write on every
+// shard, see command_keys::cached_written_keys(). The writes processed by the other nodes are not
+// seen, a value is served for at most `staleness` after it was read.
+class near_cache {
+public:
+    using clock = lowres_clock;
+    struct stats {
+        uint64_t _hits = 0;
+        uint64_t _misses = 0;
+        uint64_t _insertions = 0;
+        // The insertions refused by the admission.
+        uint64_t _rejections = 0;
+        uint64_t _evictions = 0;
+        uint64_t _invalidations = 0;
+    };
+private:
+    // An estimate of the memory of an entry besides the keys and the values.
+    static constexpr size_t entry_overhead = 256;
+    static constexpr size_t sketch_width = 4096;
+    // A power of two.
+    static constexpr size_t generation_buckets = 1024;
+    template<typename Value>
+    struct cached {
+        // Null when the key has no value.
+        Value _value;
+        clock::time_point _expiry;
+    };
+    // The values of a key, its string and its hash fields.
+    struct entry {
+        boost::intrusive::list_member_hook<> _lru_link;
+        const sstring* _keyspace = nullptr;
+        const bytes* _key = nullptr;
+        std::optional<cached<bytes_return_type>> _string;
+        std::unordered_map<bytes, cached<map_return_type>> _fields;
+        size_t _size = 0;
+    };
+    using lru_type = boost::intrusive::list<entry,
+        boost::intrusive::member_hook<entry, boost::intrusive::list_member_hook<>, &entry::_lru_link>,
+        boost::intrusive::constant_time_size<false>>;
+    // By keyspace, then by key, so that a lookup doesn't copy the key.
+    std::unordered_map<sstring, std::unordered_map<bytes, entry>> _keyspaces;
+    // The most recently used first.
+    lru_type _lru;
+    count_min_sketch _frequencies;
+    uint64_t _samples = 0;
+    size_t _capacity;
+    size_t _used = 0;
+    clock::duration _staleness;
+    // By hash bucket of the keys, bumped by the invalidations of the keys of
+    // the bucket. A read started before one doesn't insert what it read, it
+    // may be older than the write, the reads of the other keys still do.
+    std::vector<uint64_t> _generations;
+    stats _stats;
+
+    void touch(const sstring& keyspace, const bytes& key);
+    entry* find(const sstring& keyspace, const bytes& key);
+    // Creates the entry of the key if the admission accepts it.
+    entry* admit(const sstring& keyspace, const bytes& key);
+    // Accounts the new size of the entry, evicting the least recently used
+    // entries over the capacity. Returns false if the entry itself was.
+    bool resize(entry& e, size_t size);
+    void evict(entry& e);
+public:
+    // A zero capacity disables the cache.
+    near_cache(size_t capacity, clock::duration staleness);
+    ~near_cache();
+
+    bool enabled() const {
+        return _capacity > 0;
+    }
+    uint64_t generation(const sstring& keyspace, const bytes& key) const;
+    // The value of GET, null if the key has no value, or nothing if the key
+    // is not cached.
+    std::optional<bytes_return_type> get_string(const sstring& keyspace, const bytes& key);
+    void put_string(const sstring& keyspace, const bytes& key, bytes_return_type value, uint64_t generation);
+    // The value of HGET.
+    std::optional<map_return_type> get_field(const sstring& keyspace, const bytes& key, const bytes& field);
+    void put_field(const sstring& keyspace, const bytes& key, const bytes& field, map_return_type value, uint64_t generation);
+
+    void invalidate(const sstring& keyspace, const std::vector<bytes>& keys);
+    void invalidate_all();
+
+    const stats& get_stats() const {
+        return _stats;
+    }
+    size_t used_space() const {
+        return _used;
+    }
+};
+
+// Invalidates the keys in the near caches of all shards.
+future<> invalidate_near_caches(sstring keyspace, std::vector<bytes> keys);
+
+}
@@ -6,6 +6,8 @@
 #include "dht/i_partitioner.hh"
 #include "partition_slice_builder.hh"
 #include "query-result-reader.hh"
+#include "redis/query_processor.hh"
+#include "redis/cluster.hh"
 #include "gc_clock.hh"
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
@@ -139,6 +141,271 @@ future<map_return_type> prefetch_map(service::storage_proxy& proxy,
     return prefetch_map_impl(proxy, schema, key, std::move(ranges), option, false, cl, timeout, cs);
 }
 
+// HKEYS, HVALS, HGETALL and SMEMBERS. The rows are read a page at a time and
+// written into the reply as they are consumed, the next page is read once the
+// previous one was written to the connection, so a reply takes the memory of a
+// page whatever the size of the collection.
+//
+// A collection read in a single page is replied at once. A larger one is a
+// streamed aggregate in RESP3. RESP2 needs the size first: the following pages
+// are read and counted, one at a time, before the first one is written, then
+// read again as they are written. The rows added in between are left out once
+// the counted rows are written. If rows were removed in between, the reply
+// can't be completed and fails, the connection being closed.
+class collection_pager final : public reply_stream {
+    service::storage_proxy& _proxy;
+    const schema_ptr _schema;
+    const bytes _key;
+    const fetch_options _option;
+    const bool _set;
+    const db::consistency_level _cl;
+    const db::timeout_clock::duration _timeout;
+    const int _protocol_version;
+    const uint32_t _page_rows;
+    // The last row read, the next page starts after it.
+    std::optional<clustering_key> _last;
+    bool _done = false;
+
+    struct page {
+        query::partition_slice _slice;
+        foreign_ptr<lw_shared_ptr<query::result>> _result;
+    };
+    // The rows left to write in the counted size of a RESP2 reply.
+    std::optional<uint64_t> _remaining;
+
+    // Consumes a page, writing its rows into the reply if given one.
+    class page_consumer {
+        collection_pager& _pager;
+        reply_writer* _writer;
+    public:
+        bool _found = false;
+        uint32_t _rows = 0;
+        // The rows with a live value, the ones written.
+        uint32_t _live = 0;
+        std::optional<clustering_key> _last;
+
+        page_consumer(collection_pager& pager, reply_writer* writer) : _pager(pager), _writer(writer) {}
+        void accept_new_partition(const partition_key& key, uint32_t row_count)
+        {
+            _found = true;
+        }
+        void accept_new_partition(uint32_t row_count) {}
+        void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row)
+        {
+            ++_rows;
+            _last = key;
+            auto row_iterator = row.iterator();
+            auto cell = row_iterator.next_atomic_cell();
+            if (!cell) {
+                return;
+            }
+            ++_live;
+            if (_writer && _pager.take_row()) {
+                _pager.write_row(*_writer, key, *cell);
+            }
+        }
+        void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {}
+        void accept_partition_end(const query::result_row_view& static_row) {}
+    };
+
+    // The values are read by HKEYS too, the rows without a live value being
+    // skipped.
+    future<page> read_page(const std::optional<clustering_key>& after)
+    {
+        std::vector<column_id> regular_cols { _schema->get_column_definition(redis::DATA_COLUMN_NAME)->id };
+        auto range = after ? query::clustering_range::make_starting_with({ *after, false }) : query::full_clustering_range;
+        query::partition_slice ps(
+                std::vector<query::clustering_range> { std::move(range) },
+                std::move(std::vector<column_id> {}),
+                std::move(regular_cols),
+                query::partition_slice::option_set::of<
+                    query::partition_slice::option::send_partition_key,
+                    query::partition_slice::option::send_clustering_key,
+                    query::partition_slice::option::collections_as_maps>());
+        query::read_command cmd(_schema->id(), _schema->version(), ps, _page_rows, gc_clock::now(), std::experimental::nullopt, 1);
+        auto pkey = partition_key::from_single_value(*_schema, _key);
+        auto partition_range = dht::partition_range::make_singular(dht::global_partitioner().decorate_key(*_schema, std::move(pkey)));
+        dht::partition_range_vector partition_ranges;
+        partition_ranges.emplace_back(std::move(partition_range));
+        return _proxy.query(_schema, make_lw_shared(std::move(cmd)), std::move(partition_ranges), _cl, {db::timeout_clock::now() + _timeout, nullptr}).then([ps] (auto qr) {
+            return page { std::move(ps), std::move(qr.query_result) };
+        });
+    }
+
+    bool last_page(const page& p, const page_consumer& c) const {
+        return c._rows < _page_rows && !p._result->is_short_read();
+    }
+
+    // Counts the rows with a live value after the given row, a page at a time.
+    future<uint64_t> count_rows(std::optional<clustering_key> after)
+    {
+        return do_with(std::move(after), uint64_t(0), [this] (auto& after, auto& count) {
+            return repeat([this, &after, &count] {
+                return read_page(after).then([this, &after, &count] (page p) {
+                    page_consumer c(*this, nullptr);
+                    query::result_view::consume(*p._result, p._slice, c);
+                    count += c._live;
+                    after = std::move(c._last);
+                    return last_page(p, c) ? stop_iteration::yes : stop_iteration::no;
+                });
+            }).then([&count] {
+                return count;
+            });
+        });
+    }
+
+    // Whether the next row is written, false once the counted rows are.
+    bool take_row() {
+        if (!_remaining) {
+            return true;
+        }
+        if (*_remaining == 0) {
+            return false;
+        }
+        --*_remaining;
+        return true;
+    }
+
+    // RESP2 counts the elements of a map, RESP3 the pairs.
+    void write_header(reply_writer& w, uint64_t rows) {
+        if (_option == fetch_options::all) {
+            w.write_map_header(rows);
+        } else if (_set) {
+            w.write_set_header(rows);
+        } else {
+            w.write_array_header(rows);
+        }
+    }
+
+    void write_streamed_header(reply_writer& w) {
+        if (_option == fetch_options::all) {
+            w.write_streamed_map_header();
+        } else if (_set) {
+            w.write_streamed_set_header();
+        } else {
+            w.write_streamed_array_header();
+        }
+    }
+
+    // The rows without a live value are skipped, neither counted nor written.
+    void write_row(reply_writer& w, const clustering_key& key, const query::result_atomic_cell_view& cell)
+    {
+        if (_option != fetch_options::values) {
+            w.write_bytes(*key.begin(*_schema));
+        }
+        if (_option == fetch_options::keys) {
+            return;
+        }
+        cell.value().with_linearized([&w] (bytes_view cell_view) {
+            w.write_bytes(cell_view);
+        });
+    }
+public:
+    collection_pager(service::storage_proxy& proxy, const schema_ptr schema, const bytes& key, fetch_options option, bool set,
+        db::consistency_level cl, db::timeout_clock::duration timeout, int protocol_version, uint32_t page_rows)
+        : _proxy(proxy)
+        , _schema(schema)
+        , _key(key)
+        , _option(option)
+        , _set(set)
+        , _cl(cl)
+        , _timeout(timeout)
+        , _protocol_version(protocol_version)
+        , _page_rows(std::max(page_rows, uint32_t(1)))
+    {
+    }
+
+    // The first page of the reply, the whole reply if the collection fits in
+    // it. The pager is given to the reply to write the following pages.
+    static future<redis_message> start(std::unique_ptr<collection_pager> pager)
+    {
+        auto& p = *pager;
+        return p.read_page(std::nullopt).then([pager = std::move(pager)] (page first) mutable {
+            auto& p = *pager;
+            // The rows are consumed once to know the size of the page, then
+            // again to write them after the header.
+            page_consumer c(p, nullptr);
+            query::result_view::consume(*first._result, first._slice, c);
+            if (!c._found) {
+                return redis_message::null(p._protocol_version);
+            }
+            auto single = p.last_page(first, c);
+            auto rest = make_ready_future<std::optional<uint64_t>>(std::nullopt);
+            if (!single && p._protocol_version != 3) {
+                rest = p.count_rows(c._last).then([] (uint64_t count) {
+                    return std::optional<uint64_t>(count);
+                });
+            }
+            return rest.then([pager = std::move(pager), first = std::move(first), live = c._live, last = std::move(c._last), single] (std::optional<uint64_t> rest) mutable {
+                auto& p = *pager;
+                reply_writer w(p._protocol_version);
+                if (single) {
+                    p.write_header(w, live);
+                } else if (rest) {
+                    p._remaining = live + *rest;
+                    p.write_header(w, *p._remaining);
+                } else {
+                    p.write_streamed_header(w);
+                }
+                page_consumer c(p, &w);
+                query::result_view::consume(*first._result, first._slice, c);
+                if (single) {
+                    return w.done();
+                }
+                p._last = std::move(last);
+                get_local_query_processor().account_paged_reply();
+                return w.done(std::move(pager));
+            });
+        });
+    }
+
+    future<std::optional<redis_message>> next() override
+    {
+        if (_done) {
+            return make_ready_future<std::optional<redis_message>>(std::nullopt);
+        }
+        if (_remaining && *_remaining == 0) {
+            _done = true;
+            return make_ready_future<std::optional<redis_message>>(std::nullopt);
+        }
+        return read_page(_last).then([this] (page p) {
+            reply_writer w(_protocol_version);
+            page_consumer c(*this, &w);
+            query::result_view::consume(*p._result, p._slice, c);
+            if (c._last) {
+                _last = std::move(c._last);
+            }
+            if (last_page(p, c)) {
+                if (_remaining && *_remaining > 0) {
+                    throw std::runtime_error(sprint("%d rows of the collection were removed while it was replied", *_remaining));
+                }
+                if (!_remaining) {
+                    w.write_streamed_end();
+                }
+                _done = true;
+            }
+            get_local_query_processor().account_reply_page();
+            return w.done().then([] (redis_message m) {
+                return std::optional<redis_message>(std::move(m));
+            });
+        });
+    }
+};
+
+future<redis_message> fetch_collection_reply(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    fetch_options option,
+    bool set,
+    db::consistency_level cl,
+    const timeout_config& tc,
+    service::client_state& cs)
+{
+    auto& qp = get_local_query_processor();
+    return collection_pager::start(std::make_unique<collection_pager>(proxy, schema, key, option, set, cl, tc.read_timeout,
+        cs.get_redis_protocol_version(), qp.reply_page_rows()));
+}
+
 class prefetched_bytes_builder {
     using data_type = prefetched_struct<bytes>;
     data_type& _data;
@@ -444,4 +711,334 @@ future<zset_return_type> prefetch_zset(service::storage_proxy& proxy,
     std::vector<query::clustering_range> ranges { query::full_clustering_range };
     return prefetch_zset_impl(proxy, schema, key, std::move(ranges), option, false, cl, timeout, cs);
 }
+
+class prefetched_stream_builder {
+    using data_type = prefetched_stream_type;
+    data_type& _data;
+    const query::partition_slice& _partition_slice;
+    const schema_ptr _schema;
+public:
+    prefetched_stream_builder(lw_shared_ptr<data_type> data, const schema_ptr schema, const query::partition_slice& ps)
+        : _data(*data)
+        , _partition_slice(ps)
+        , _schema(schema)
+    {
+    }
+    void accept_new_partition(const partition_key& key, uint32_t row_count) {}
+    void accept_new_partition(uint32_t row_count) {}
+
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row)
+    {
+        auto row_iterator = row.iterator();
+        auto cell = row_iterator.next_atomic_cell();
+        if (cell) {
+            cell->value().with_linearized([this, &key] (bytes_view cell_view) {
+                _data._data.emplace_back(std::make_pair(stream_id::from_clustering_key(*_schema, key), decode_stream_fields(cell_view)));
+                _data._inited = true;
+            });
+        }
+    }
+
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {}
+    void accept_partition_end(const query::result_row_view& static_row) {}
+};
+
+future<stream_return_type> prefetch_stream(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    std::vector<query::clustering_range>&& ranges,
+    bool reversed,
+    uint32_t count,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    std::vector<column_id> regular_cols { schema->get_column_definition(redis::DATA_COLUMN_NAME)->id };
+    query::partition_slice ps(
+            std::move(ranges),
+            std::move(std::vector<column_id> {}),
+            std::move(regular_cols),
+            query::partition_slice::option_set::of<
+                query::partition_slice::option::send_partition_key,
+                query::partition_slice::option::send_clustering_key>());
+    if (reversed) {
+        ps.set_reversed();
+    }
+    query::read_command cmd(schema->id(), schema->version(), ps, count, gc_clock::now(), std::experimental::nullopt, 1);
+    auto pkey = partition_key::from_single_value(*schema, key);
+    auto partition_range = dht::partition_range::make_singular(dht::global_partitioner().decorate_key(*schema, std::move(pkey)));
+    dht::partition_range_vector partition_ranges;
+    partition_ranges.emplace_back(std::move(partition_range));
+    return proxy.query(schema, make_lw_shared(std::move(cmd)), std::move(partition_ranges), cl, {timeout, cs.get_trace_state()}).then([ps, schema] (auto qr) {
+        return query::result_view::do_with(*qr.query_result, [&] (query::result_view v) {
+            auto pd = make_lw_shared<prefetched_stream_type>(schema);
+            v.consume(ps, prefetched_stream_builder(pd, schema, ps));
+            return stream_return_type { pd };
+        });
+    });
+}
+
+class prefetched_stream_group_builder {
+    using data_type = prefetched_stream_group_type;
+    data_type& _data;
+    const query::partition_slice& _partition_slice;
+    const schema_ptr _schema;
+public:
+    prefetched_stream_group_builder(lw_shared_ptr<data_type> data, const schema_ptr schema, const query::partition_slice& ps)
+        : _data(*data)
+        , _partition_slice(ps)
+        , _schema(schema)
+    {
+    }
+    void accept_new_partition(const partition_key& key, uint32_t row_count) {}
+    void accept_new_partition(uint32_t row_count) {}
+
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row)
+    {
+        auto row_iterator = row.iterator();
+        auto cell = row_iterator.next_atomic_cell();
+        if (cell) {
+            cell->value().with_linearized([this, &key] (bytes_view cell_view) {
+                _data._data.emplace_back(std::make_pair(stream_id::from_group_clustering_key(*_schema, key), bytes(cell_view.begin(), cell_view.end())));
+                _data._inited = true;
+            });
+        }
+    }
+
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {}
+    void accept_partition_end(const query::result_row_view& static_row) {}
+};
+
+future<stream_group_return_type> prefetch_stream_group(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    const bytes& group,
+    std::vector<nonwrapping_range<stream_id>>&& ranges,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    // The ranges are given over IDs, prefix them with the group. An open side
+    // is bounded by the group itself.
+    auto group_prefix = clustering_key_prefix::from_exploded(*schema, std::vector<bytes> { group });
+    auto make_bound = [schema, &group, &group_prefix] (const std::experimental::optional<nonwrapping_range<stream_id>::bound>& b) {
+        if (!b) {
+            return query::clustering_range::bound(group_prefix, true);
+        }
+        return query::clustering_range::bound(b->value().to_group_clustering_key(*schema, group), b->is_inclusive());
+    };
+    std::vector<query::clustering_range> group_ranges;
+    for (auto&& r : ranges) {
+        group_ranges.emplace_back(query::clustering_range::make(make_bound(r.start()), make_bound(r.end())));
+    }
+    std::vector<column_id> regular_cols { schema->get_column_definition(redis::DATA_COLUMN_NAME)->id };
+    query::partition_slice ps(
+            std::move(group_ranges),
+            std::move(std::vector<column_id> {}),
+            std::move(regular_cols),
+            query::partition_slice::option_set::of<
+                query::partition_slice::option::send_partition_key,
+                query::partition_slice::option::send_clustering_key>());
+    query::read_command cmd(schema->id(), schema->version(), ps, std::numeric_limits<uint32_t>::max(), gc_clock::now(), std::experimental::nullopt, 1);
+    auto pkey = partition_key::from_single_value(*schema, key);
+    auto partition_range = dht::partition_range::make_singular(dht::global_partitioner().decorate_key(*schema, std::move(pkey)));
+    dht::partition_range_vector partition_ranges;
+    partition_ranges.emplace_back(std::move(partition_range));
+    return proxy.query(schema, make_lw_shared(std::move(cmd)), std::move(partition_ranges), cl, {timeout, cs.get_trace_state()}).then([ps, schema] (auto qr) {
+        return query::result_view::do_with(*qr.query_result, [&] (query::result_view v) {
+            auto pd = make_lw_shared<prefetched_stream_group_type>(schema);
+            v.consume(ps, prefetched_stream_group_builder(pd, schema, ps));
+            return stream_group_return_type { pd };
+        });
+    });
+}
+
+class prefetched_bitmap_builder {
+    using data_type = prefetched_bitmap_type;
+    data_type& _data;
+    const query::partition_slice& _partition_slice;
+    const schema_ptr _schema;
+public:
+    prefetched_bitmap_builder(lw_shared_ptr<data_type> data, const schema_ptr schema, const query::partition_slice& ps)
+        : _data(*data)
+        , _partition_slice(ps)
+        , _schema(schema)
+    {
+    }
+    void accept_new_partition(const partition_key& key, uint32_t row_count) {}
+    void accept_new_partition(uint32_t row_count) {}
+
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row)
+    {
+        auto row_iterator = row.iterator();
+        auto cell = row_iterator.next_atomic_cell();
+        if (cell) {
+            cell->value().with_linearized([this, &key] (bytes_view cell_view) {
+                auto index = value_cast<int64_t>(long_type->deserialize_value(*key.begin(*_schema)));
+                _data._data.emplace_back(std::make_pair(index, bytes(cell_view.begin(), cell_view.end())));
+                _data._inited = true;
+            });
+        }
+    }
+
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {}
+    void accept_partition_end(const query::result_row_view& static_row) {}
+};
+
+future<bitmap_return_type> prefetch_bitmap(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    std::vector<query::clustering_range>&& ranges,
+    bool reversed,
+    uint32_t count,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    std::vector<column_id> regular_cols { schema->get_column_definition(redis::DATA_COLUMN_NAME)->id };
+    query::partition_slice ps(
+            std::move(ranges),
+            std::move(std::vector<column_id> {}),
+            std::move(regular_cols),
+            query::partition_slice::option_set::of<
+                query::partition_slice::option::send_partition_key,
+                query::partition_slice::option::send_clustering_key>());
+    if (reversed) {
+        ps.set_reversed();
+    }
+    query::read_command cmd(schema->id(), schema->version(), ps, count, gc_clock::now(), std::experimental::nullopt, 1);
+    auto pkey = partition_key::from_single_value(*schema, key);
+    auto partition_range = dht::partition_range::make_singular(dht::global_partitioner().decorate_key(*schema, std::move(pkey)));
+    dht::partition_range_vector partition_ranges;
+    partition_ranges.emplace_back(std::move(partition_range));
+    return proxy.query(schema, make_lw_shared(std::move(cmd)), std::move(partition_ranges), cl, {timeout, cs.get_trace_state()}).then([ps, schema] (auto qr) {
+        return query::result_view::do_with(*qr.query_result, [&] (query::result_view v) {
+            auto pd = make_lw_shared<prefetched_bitmap_type>(schema);
+            v.consume(ps, prefetched_bitmap_builder(pd, schema, ps));
+            return bitmap_return_type { pd };
+        });
+    });
+}
+
+class prefetched_zset_score_builder {
+    using data_type = prefetched_zset_score_type;
+    data_type& _data;
+    const query::partition_slice& _partition_slice;
+    const schema_ptr _schema;
+public:
+    prefetched_zset_score_builder(lw_shared_ptr<data_type> data, const schema_ptr schema, const query::partition_slice& ps)
+        : _data(*data)
+        , _partition_slice(ps)
+        , _schema(schema)
+    {
+    }
+    void accept_new_partition(const partition_key& key, uint32_t row_count) {}
+    void accept_new_partition(uint32_t row_count) {}
+
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row)
+    {
+        auto i = key.begin(*_schema);
+        auto score = value_cast<double>(double_type->deserialize_value(*i));
+        ++i;
+        _data._data.emplace_back(std::make_pair(score, bytes(*i)));
+        _data._inited = true;
+    }
+
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {}
+    void accept_partition_end(const query::result_row_view& static_row) {}
+};
+
+future<zset_score_return_type> prefetch_zset_scores(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    std::vector<query::clustering_range>&& ranges,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    std::vector<column_id> regular_cols { schema->get_column_definition(redis::DATA_COLUMN_NAME)->id };
+    query::partition_slice ps(
+            std::move(ranges),
+            std::move(std::vector<column_id> {}),
+            std::move(regular_cols),
+            query::partition_slice::option_set::of<
+                query::partition_slice::option::send_partition_key,
+                query::partition_slice::option::send_clustering_key>());
+    query::read_command cmd(schema->id(), schema->version(), ps, std::numeric_limits<uint32_t>::max(), gc_clock::now(), std::experimental::nullopt, 1);
+    auto pkey = partition_key::from_single_value(*schema, key);
+    auto partition_range = dht::partition_range::make_singular(dht::global_partitioner().decorate_key(*schema, std::move(pkey)));
+    dht::partition_range_vector partition_ranges;
+    partition_ranges.emplace_back(std::move(partition_range));
+    return proxy.query(schema, make_lw_shared(std::move(cmd)), std::move(partition_ranges), cl, {timeout, cs.get_trace_state()}).then([ps, schema] (auto qr) {
+        return query::result_view::do_with(*qr.query_result, [&] (query::result_view v) {
+            auto pd = make_lw_shared<prefetched_zset_score_type>(schema);
+            v.consume(ps, prefetched_zset_score_builder(pd, schema, ps));
+            return zset_score_return_type { pd };
+        });
+    });
+}
+
+class slot_keys_counter {
+    const schema& _schema;
+    const uint16_t _slot;
+public:
+    uint32_t _partitions = 0;
+    uint64_t _keys = 0;
+    std::optional<partition_key> _last;
+
+    slot_keys_counter(const schema& s, uint16_t slot) : _schema(s), _slot(slot) {}
+    void accept_new_partition(const partition_key& key, uint32_t row_count)
+    {
+        ++_partitions;
+        if (hash_slot(*key.begin(_schema)) == _slot) {
+            ++_keys;
+        }
+        _last = key;
+    }
+    void accept_new_partition(uint32_t row_count) {}
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row) {}
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {}
+    void accept_partition_end(const query::result_row_view& static_row) {}
+};
+
+future<uint64_t> count_keys_in_slot(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    uint16_t slot,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs)
+{
+    static constexpr uint32_t page_partitions = 1000;
+    return do_with(std::optional<dht::decorated_key>(), uint64_t(0), [&proxy, schema, slot, cl, timeout, &cs] (auto& last, auto& count) {
+        return repeat([&proxy, schema, slot, cl, timeout, &cs, &last, &count] {
+            auto start = last ? dht::partition_range::bound(dht::ring_position(*last), false)
+                              : dht::partition_range::bound(dht::ring_position::starting_at(slot_first_token(slot)), true);
+            auto end = dht::partition_range::bound(dht::ring_position::ending_at(slot_last_token(slot)), true);
+            dht::partition_range_vector partition_ranges;
+            partition_ranges.emplace_back(dht::partition_range::make(std::move(start), std::move(end)));
+            // The partition keys only, a row of each partition.
+            query::partition_slice ps(
+                    std::vector<query::clustering_range> { query::full_clustering_range },
+                    std::move(std::vector<column_id> {}),
+                    std::move(std::vector<column_id> {}),
+                    query::partition_slice::option_set::of<
+                        query::partition_slice::option::send_partition_key,
+                        query::partition_slice::option::distinct>());
+            auto cmd = make_lw_shared<query::read_command>(schema->id(), schema->version(), ps, page_partitions, gc_clock::now(),
+                tracing::make_trace_info(cs.get_trace_state()), page_partitions);
+            return proxy.query(schema, cmd, std::move(partition_ranges), cl, {timeout, cs.get_trace_state()}).then([schema, slot, ps, &last, &count] (auto qr) {
+                slot_keys_counter c(*schema, slot);
+                query::result_view::consume(*qr.query_result, ps, c);
+                count += c._keys;
+                if (c._last) {
+                    last = dht::global_partitioner().decorate_key(*schema, std::move(*c._last));
+                }
+                auto done = !c._last || (c._partitions < page_partitions && !qr.query_result->is_short_read());
+                return done ? stop_iteration::yes : stop_iteration::no;
+            });
+        }).then([&count] {
+            return count;
+        });
+    });
+}
 } // end of redis namespace
@@ -47,6 +47,18 @@ future<map_return_type> prefetch_set(service::storage_proxy& proxy,
     db::timeout_clock::time_point timeout,
     service::client_state& cs
     );
+// HKEYS, HVALS, HGETALL and SMEMBERS (keys of a set), the fields and/or the
+// values of the collection are written into the reply as they are read, a page
+// at a time. The reply is null if the key has no field.
+future<redis_message> fetch_collection_reply(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    fetch_options option,
+    bool set,
+    db::consistency_level cl,
+    const timeout_config& tc,
+    service::client_state& cs
+    );
 future<map_return_type> prefetch_list(service::storage_proxy& proxy,
     const schema_ptr schema,
     const bytes& key,
@@ -104,6 +116,47 @@ future<mbytes_return_type> prefetch_simple(service::storage_proxy& proxy,
     db::timeout_clock::time_point timeout,
     service::client_state& cs
     );
+// Reads the entries of a stream within the ranges of IDs, at most `count` entries.
+future<stream_return_type> prefetch_stream(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    std::vector<query::clustering_range>&& ranges,
+    bool reversed,
+    uint32_t count,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs
+    );
+// Reads the rows of a consumer group within the range of IDs, the metadata row included.
+future<stream_group_return_type> prefetch_stream_group(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    const bytes& group,
+    std::vector<nonwrapping_range<stream_id>>&& ranges,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs
+    );
+// Reads the chunks of a bitmap within the ranges of chunk indexes, at most `count` chunks.
+future<bitmap_return_type> prefetch_bitmap(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    std::vector<query::clustering_range>&& ranges,
+    bool reversed,
+    uint32_t count,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs
+    );
+// Reads the score index of a sorted set within the ranges of scores.
+future<zset_score_return_type> prefetch_zset_scores(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    const bytes& key,
+    std::vector<query::clustering_range>&& ranges,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs
+    );
 future<bool> exists(service::storage_proxy& proxy,
     const schema_ptr schema,
     const bytes& key,
@@ -111,4 +164,13 @@ future<bool> exists(service::storage_proxy& proxy,
     db::timeout_clock::time_point timeout,
     service::client_state& cs
     );
+// Counts the keys of the table in the token range of the hash slot which are
+// in the slot, a page of partitions at a time.
+future<uint64_t> count_keys_in_slot(service::storage_proxy& proxy,
+    const schema_ptr schema,
+    uint16_t slot,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& cs
+    );
 } // end of redis namespace
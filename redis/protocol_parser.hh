@@ -56,7 +56,7 @@ public:
         }
         return make_ready_future<unconsumed_remainder>();
     }
-    inline request get_request() {
+    inline request& get_request() {
         return _impl->get_request();
     }
 private:
@@ -19,9 +19,13 @@
 
 #include "redis/query_processor.hh"
 #include "redis/command_factory.hh"
+#include "redis/command_keys.hh"
 #include "redis/request.hh"
 #include "redis/reply.hh"
 #include "redis/abstract_command.hh"
+#include "service/client_state.hh"
+#include "tracing/trace_state.hh"
+#include <seastar/core/reactor.hh>
 #include <seastar/core/metrics.hh>
 #include "timeout_config.hh"
 #include "log.hh"
@@ -30,25 +34,212 @@ namespace redis {
 static logging::logger logging("redisqp");
 distributed<query_processor> _the_query_processor;
 
+static const bytes unknown_command { "unknown" };
+
+// Drops the schemas resolved on this shard once a redis keyspace changed.
+class query_processor::migration_subscriber : public service::migration_listener {
+    query_processor& _qp;
+    void changed(const sstring& ks_name) {
+        if (ks_name.find(REDIS_DATABASE_NAME_PREFIX) == 0) {
+            _qp.invalidate_schemas();
+        }
+    }
+public:
+    explicit migration_subscriber(query_processor& qp) : _qp(qp) {}
+    virtual void on_create_keyspace(const sstring& ks_name) override { changed(ks_name); }
+    virtual void on_create_column_family(const sstring& ks_name, const sstring& cf_name) override { changed(ks_name); }
+    virtual void on_create_user_type(const sstring& ks_name, const sstring& type_name) override {}
+    virtual void on_create_function(const sstring& ks_name, const sstring& function_name) override {}
+    virtual void on_create_aggregate(const sstring& ks_name, const sstring& aggregate_name) override {}
+    virtual void on_create_view(const sstring& ks_name, const sstring& view_name) override {}
+    virtual void on_update_keyspace(const sstring& ks_name) override { changed(ks_name); }
+    virtual void on_update_column_family(const sstring& ks_name, const sstring& cf_name, bool columns_changed) override { changed(ks_name); }
+    virtual void on_update_user_type(const sstring& ks_name, const sstring& type_name) override {}
+    virtual void on_update_function(const sstring& ks_name, const sstring& function_name) override {}
+    virtual void on_update_aggregate(const sstring& ks_name, const sstring& aggregate_name) override {}
+    virtual void on_update_view(const sstring& ks_name, const sstring& view_name, bool columns_changed) override {}
+    virtual void on_drop_keyspace(const sstring& ks_name) override { changed(ks_name); }
+    virtual void on_drop_column_family(const sstring& ks_name, const sstring& cf_name) override { changed(ks_name); }
+    virtual void on_drop_user_type(const sstring& ks_name, const sstring& type_name) override {}
+    virtual void on_drop_function(const sstring& ks_name, const sstring& function_name) override {}
+    virtual void on_drop_aggregate(const sstring& ks_name, const sstring& aggregate_name) override {}
+    virtual void on_drop_view(const sstring& ks_name, const sstring& view_name) override {}
+};
+
 query_processor::query_processor(service::storage_proxy& proxy, distributed<database>& db)
         : _proxy(proxy)
         , _db(db)
+        , _command_stats(size_t(command_code::count))
+        , _slowlog(db.local().get_config().redis_slowlog_log_slower_than(), db.local().get_config().redis_slowlog_max_len())
+        , _latency_monitor(db.local().get_config().redis_latency_monitor_threshold_in_ms())
+        , _hot_keys(db.local().get_config().redis_hotkeys_capacity(), db.local().get_config().redis_hotkeys_sample_every())
+        , _big_keys(db.local().get_config().redis_bigkeys_per_type())
+        , _near_cache(size_t(db.local().get_config().redis_near_cache_size_in_kb()) << 10,
+                      std::chrono::milliseconds(db.local().get_config().redis_near_cache_staleness_in_ms()))
+        , _client_tracking(db.local().get_config().redis_tracking_table_max_keys())
+        , _slot_map(db.local().get_config().redis_transport_port())
+        , _reply_page_rows(db.local().get_config().redis_reply_page_rows())
+        , _migration_subscriber(std::make_unique<migration_subscriber>(*this))
 {
     namespace sm = seastar::metrics;
+    sm::label command_label("command");
+    auto names = command_factory::names();
+    names.emplace_back(unknown_command);
+    for (auto& name : names) {
+        auto& stats = stats_of(command_factory::code_of(name));
+        stats._name = name;
+        auto command = command_label(sstring(reinterpret_cast<const char*>(name.data()), name.size()));
+        _metrics.add_group("redis", {
+            sm::make_derive("commands", stats._calls,
+                            sm::description("Counts the number of calls of the command."))(command),
+            sm::make_derive("command_failures", stats._failures,
+                            sm::description("Counts the number of calls of the command failed with an exception."))(command),
+            sm::make_histogram("command_latency", sm::description("The latency histogram of the command, in microseconds."),
+                            [&stats] { return stats._latency.get_histogram(std::chrono::microseconds(100)); })(command),
+        });
+    }
+    _metrics.add_group("redis", {
+        sm::make_gauge("hottest_key_accesses", [this] { return _hot_keys.hottest(); },
+                        sm::description("Holds the estimated recent accesses of the hottest key of the shard, see HOTKEYS.")),
+        sm::make_derive("near_cache_hits", [this] { return _near_cache.get_stats()._hits; },
+                        sm::description("Counts the GET and HGET served by the near cache.")),
+        sm::make_derive("near_cache_misses", [this] { return _near_cache.get_stats()._misses; },
+                        sm::description("Counts the GET and HGET not found in the near cache.")),
+        sm::make_derive("near_cache_insertions", [this] { return _near_cache.get_stats()._insertions; },
+                        sm::description("Counts the keys inserted in the near cache.")),
+        sm::make_derive("near_cache_rejections", [this] { return _near_cache.get_stats()._rejections; },
+                        sm::description("Counts the keys refused by the near cache, read less often than the keys they would evict.")),
+        sm::make_derive("near_cache_evictions", [this] { return _near_cache.get_stats()._evictions; },
+                        sm::description("Counts the keys evicted from the near cache.")),
+        sm::make_derive("near_cache_invalidations", [this] { return _near_cache.get_stats()._invalidations; },
+                        sm::description("Counts the keys of the near cache invalidated by a write.")),
+        sm::make_gauge("near_cache_used_bytes", [this] { return _near_cache.used_space(); },
+                        sm::description("Holds the estimated memory used by the near cache.")),
+        sm::make_gauge("tracking_table_keys", [this] { return _client_tracking.size(); },
+                        sm::description("Holds the number of keys of the shard read by the clients with CLIENT TRACKING.")),
+        sm::make_derive("tracking_invalidations", [this] { return _client_tracking.get_stats()._invalidations; },
+                        sm::description("Counts the keys invalidated to the clients with CLIENT TRACKING by the writes of the shard.")),
+        sm::make_derive("tracking_table_evictions", [this] { return _client_tracking.get_stats()._evictions; },
+                        sm::description("Counts the keys invalidated to make room in the tracking table.")),
+        sm::make_derive("paged_replies", _paged_replies,
+                        sm::description("Counts the replies of collections larger than a page, written page by page.")),
+        sm::make_derive("reply_pages", _reply_pages,
+                        sm::description("Counts the pages read after the first one of the replies written page by page.")),
+    });
+    service::get_local_migration_manager().register_listener(_migration_subscriber.get());
+    if (engine().cpu_id() == 0) {
+        _replica = std::make_unique<replica>(_proxy, db.local().get_config());
+    }
+}
+
+const keyspace_schemas& query_processor::schemas_of(const sstring& keyspace) {
+    if (_last_keyspace && *_last_keyspace == keyspace) {
+        return *_last_schemas;
+    }
+    auto it = _schemas.find(keyspace);
+    if (it == _schemas.end()) {
+        auto& db = _db.local();
+        keyspace_schemas schemas {
+            db.find_schema(keyspace, STRINGS),
+            db.find_schema(keyspace, LISTS),
+            db.find_schema(keyspace, SETS),
+            db.find_schema(keyspace, MAPS),
+            db.find_schema(keyspace, ZSETS),
+            db.find_schema(keyspace, STREAMS),
+            db.find_schema(keyspace, STREAM_GROUPS),
+            db.find_schema(keyspace, BITMAPS),
+            db.find_schema(keyspace, ZSET_SCORES),
+        };
+        it = _schemas.emplace(keyspace, std::move(schemas)).first;
+    }
+    _last_keyspace = &it->first;
+    _last_schemas = &it->second;
+    return it->second;
 }
 
 query_processor::~query_processor() {
 }
 
 future<> query_processor::stop() {
-    return make_ready_future<>();
+    service::get_local_migration_manager().unregister_listener(_migration_subscriber.get());
+    auto replica_stopped = _replica ? _replica->stop() : make_ready_future<>();
+    return replica_stopped.then([this] {
+        return _big_keys.stop();
+    }).then([this] {
+        return _blocked_clients.stop();
+    });
 }
 
 future<redis_message> query_processor::process(request&& req, service::client_state& client_state, const timeout_config& config) {
     // FIXME: timeout, consistency level should be configurable.
-    return do_with(command_factory::create(_proxy, client_state, std::move(req)), [this, &client_state, config] (auto& e) {
-        return e->execute(_proxy, db::consistency_level::LOCAL_ONE, db::timeout_clock::now(), config, client_state);
+    using clock = utils::estimated_histogram::clock;
+    auto& stats = stats_of(req._code);
+    ++stats._calls;
+    auto start = clock::now();
+    _hot_keys.record(req);
+    // The request is consumed by the command, keep what the slowlog needs. The
+    // arguments are copied only when the slowlog is enabled.
+    std::vector<bytes> args;
+    if (_slowlog.enabled()) {
+        args = slowlog::truncate_args(req);
+    } else {
+        args.emplace_back(req._command);
+    }
+    auto written = _near_cache.enabled() ? command_keys::cached_written_keys(req) : std::vector<bytes>();
+    auto command = command_factory::create(_proxy, client_state, std::move(req));
+    auto prepared = clock::now();
+    auto f = command->execute(_proxy, db::consistency_level::LOCAL_ONE, db::timeout_clock::now(), config, client_state);
+    if (!written.empty()) {
+        // The write is replied once no shard of this node serves the previous values.
+        f = std::move(f).then_wrapped([keyspace = client_state.get_keyspace(), written = std::move(written)] (future<redis_message> f) mutable {
+            return invalidate_near_caches(std::move(keyspace), std::move(written)).then_wrapped([f = std::move(f)] (future<> invalidated) mutable {
+                invalidated.ignore_ready_future();
+                return std::move(f);
+            });
+        });
+    }
+    return f.then_wrapped([this, &stats, &client_state, command, args = std::move(args), start, prepared] (future<redis_message> f) {
+        auto end = clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        stats._latency.add(duration.count());
+        if (f.failed()) {
+            ++stats._failures;
+        }
+        if (_slowlog.is_slow(duration) || _latency_monitor.is_spike(duration)) {
+            record_slow_command(args, client_state, duration,
+                std::chrono::duration_cast<std::chrono::microseconds>(prepared - start),
+                std::chrono::duration_cast<std::chrono::microseconds>(end - prepared));
+        }
+        return f;
     });
 }
 
+void query_processor::record_slow_command(const std::vector<bytes>& args, const service::client_state& client_state,
+    std::chrono::microseconds duration, std::chrono::microseconds prepare, std::chrono::microseconds execute) {
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch());
+    if (_slowlog.is_slow(duration)) {
+        std::optional<utils::UUID> session_id;
+        if (client_state.get_trace_state()) {
+            session_id = client_state.get_trace_state()->session_id();
+        }
+        _slowlog.add(slowlog_entry {
+            0,
+            (now - duration).count(),
+            duration,
+            prepare,
+            execute,
+            args,
+            client_state.get_client_address().to_sstring(),
+            engine().cpu_id(),
+            std::move(session_id),
+        });
+    }
+    if (_latency_monitor.is_spike(duration)) {
+        auto& name = args.front();
+        _latency_monitor.add(sstring(reinterpret_cast<const char*>(name.data()), name.size()),
+            std::chrono::duration_cast<std::chrono::seconds>(now).count(),
+            std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+    }
+}
+
 }
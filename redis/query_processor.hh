@@ -33,6 +33,17 @@
 #include "service/migration_manager.hh"
 #include "service/query_state.hh"
 #include "transport/messages/result_message.hh"
+#include "redis/blocked_clients.hh"
+#include "redis/hot_keys.hh"
+#include "redis/key_locks.hh"
+#include "redis/key_footprint.hh"
+#include "redis/near_cache.hh"
+#include "redis/redis_command_code.hh"
+#include "redis/client_tracking.hh"
+#include "redis/cluster.hh"
+#include "redis/replication.hh"
+#include "redis/slowlog.hh"
+#include "utils/estimated_histogram.hh"
 
 class timeout_config;
 
@@ -41,10 +52,70 @@ namespace redis {
 struct request;
 struct reply;
 class redis_message;
+// The statistics of a command on one shard.
+struct command_stats {
+    // The name of the command, empty for the codes of no supported command.
+    bytes _name;
+    uint64_t _calls = 0;
+    // The calls failed with an exception, rather than with an error reply.
+    uint64_t _failures = 0;
+    // In microseconds.
+    utils::estimated_histogram _latency;
+};
+
+// The schemas of the tables of a redis keyspace.
+struct keyspace_schemas {
+    schema_ptr _strings;
+    schema_ptr _lists;
+    schema_ptr _sets;
+    schema_ptr _maps;
+    schema_ptr _zsets;
+    schema_ptr _streams;
+    schema_ptr _stream_groups;
+    schema_ptr _bitmaps;
+    schema_ptr _zset_scores;
+
+    // The tables a key may be in.
+    std::vector<schema_ptr> all() const {
+        return { _strings, _lists, _sets, _maps, _zsets, _streams, _stream_groups, _bitmaps, _zset_scores };
+    }
+};
+
 class query_processor {
+    class migration_subscriber;
     service::storage_proxy& _proxy;
     distributed<database>& _db;
     seastar::metrics::metric_groups _metrics;
+    blocked_clients _blocked_clients;
+    key_locks _key_locks;
+    // Indexed by the command codes, the unknown commands are accounted under
+    // command_code::unknown.
+    std::vector<command_stats> _command_stats;
+    slowlog _slowlog;
+    latency_monitor _latency_monitor;
+    hot_keys _hot_keys;
+    big_keys _big_keys;
+    near_cache _near_cache;
+    client_tracking _client_tracking;
+    slot_map _slot_map;
+    // The rows of a page of the collections replied page by page.
+    uint32_t _reply_page_rows;
+    uint64_t _paged_replies = 0;
+    uint64_t _reply_pages = 0;
+    std::unique_ptr<migration_subscriber> _migration_subscriber;
+    // REPLICAOF, on shard 0 only.
+    std::unique_ptr<replica> _replica;
+    // The schemas of the keyspaces used on this shard, resolved by their
+    // first command and dropped on a schema change.
+    std::unordered_map<sstring, keyspace_schemas> _schemas;
+    // The last keyspace resolved, the connections mostly use the same one.
+    const sstring* _last_keyspace = nullptr;
+    const keyspace_schemas* _last_schemas = nullptr;
+    command_stats& stats_of(command_code code) {
+        return _command_stats[size_t(code)];
+    }
+    void record_slow_command(const std::vector<bytes>& args, const service::client_state& client_state,
+        std::chrono::microseconds duration, std::chrono::microseconds prepare, std::chrono::microseconds execute);
 public:
     query_processor(service::storage_proxy& proxy, distributed<database>& db);
 
@@ -58,6 +129,69 @@ public:
         return _proxy;
     }
 
+    blocked_clients& get_blocked_clients() {
+        return _blocked_clients;
+    }
+
+    key_locks& get_key_locks() {
+        return _key_locks;
+    }
+
+    const std::vector<command_stats>& get_command_stats() const {
+        return _command_stats;
+    }
+
+    slowlog& get_slowlog() {
+        return _slowlog;
+    }
+
+    latency_monitor& get_latency_monitor() {
+        return _latency_monitor;
+    }
+
+    hot_keys& get_hot_keys() {
+        return _hot_keys;
+    }
+    big_keys& get_big_keys() {
+        return _big_keys;
+    }
+
+    near_cache& get_near_cache() {
+        return _near_cache;
+    }
+
+    client_tracking& get_client_tracking() {
+        return _client_tracking;
+    }
+
+    const keyspace_schemas& schemas_of(const sstring& keyspace);
+    void invalidate_schemas() {
+        _last_keyspace = nullptr;
+        _last_schemas = nullptr;
+        _schemas.clear();
+    }
+
+    // Must be called on shard 0.
+    replica& get_replica() {
+        return *_replica;
+    }
+
+    slot_map& get_slot_map() {
+        return _slot_map;
+    }
+
+    uint32_t reply_page_rows() const {
+        return _reply_page_rows;
+    }
+
+    void account_paged_reply() {
+        ++_paged_replies;
+    }
+
+    void account_reply_page() {
+        ++_reply_pages;
+    }
+
     future<redis_message> process(request&&, service::client_state&, const timeout_config& config);
 
     future<> stop();
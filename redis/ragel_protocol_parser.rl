@@ -31,6 +31,7 @@
 #include "bytes.hh"
 #include "redis/protocol_parser.hh"
 #include "redis/request.hh"
+#include "redis/command_factory.hh"
 #include "log.hh"
 using namespace seastar;
 using namespace redis;
@@ -217,6 +218,7 @@ public:
     }
     virtual redis::request& get_request() { 
         std::transform(_req._command.begin(), _req._command.end(), _req._command.begin(), ::tolower);
+        _req._code = command_factory::code_of(_req._command);
         return _req;
     }
 };
@@ -0,0 +1,1260 @@
+#include "redis/rdb.hh"
+#include "redis/abstract_command.hh"
+#include "redis/query_processor.hh"
+#include "redis/redis_keyspace.hh"
+#include "redis/redis_mutation.hh"
+#include "checked-file-impl.hh"
+#include "database.hh"
+#include "disk-error-handler.hh"
+#include "flat_mutation_reader.hh"
+#include "mutation_reader.hh"
+#include "query-result-reader.hh"
+#include "service/client_state.hh"
+#include "service/priority_manager.hh"
+#include "service/storage_proxy.hh"
+#include "service/storage_service.hh"
+#include "sstables/sstables.hh"
+#include "utils/fb_utilities.hh"
+#include "log.hh"
+#include "seastar/core/fstream.hh"
+#include "seastar/core/future-util.hh"
+#include "seastar/core/memory.hh"
+#include "seastar/core/reactor.hh"
+#include "seastar/core/thread.hh"
+#include <boost/lexical_cast.hpp>
+#include <boost/range/irange.hpp>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+
+namespace redis {
+
+static logging::logger rdblog("rdb");
+
+namespace {
+
+enum rdb_opcode : uint8_t {
+    opcode_slot_info = 0xf4,
+    opcode_function2 = 0xf5,
+    opcode_function = 0xf6,
+    opcode_module_aux = 0xf7,
+    opcode_idle = 0xf8,
+    opcode_freq = 0xf9,
+    opcode_aux = 0xfa,
+    opcode_resizedb = 0xfb,
+    opcode_expiretime_ms = 0xfc,
+    opcode_expiretime = 0xfd,
+    opcode_selectdb = 0xfe,
+    opcode_eof = 0xff,
+};
+
+enum rdb_type : uint8_t {
+    type_string = 0,
+    type_list = 1,
+    type_set = 2,
+    type_zset = 3,
+    type_hash = 4,
+    type_zset_2 = 5,
+    type_hash_zipmap = 9,
+    type_list_ziplist = 10,
+    type_set_intset = 11,
+    type_zset_ziplist = 12,
+    type_hash_ziplist = 13,
+    type_list_quicklist = 14,
+    type_hash_listpack = 16,
+    type_zset_listpack = 17,
+    type_list_quicklist_2 = 18,
+    type_set_listpack = 20,
+};
+
+// The nodes of a quicklist 2.
+enum quicklist_container : uint64_t {
+    container_plain = 1,
+    container_packed = 2,
+};
+
+static constexpr unsigned rdb_max_version = 12;
+static constexpr unsigned rdb_export_version = 9;
+
+[[noreturn]] void throw_invalid(const sstring& what)
+{
+    throw std::runtime_error(sprint("invalid RDB file: %s", what));
+}
+
+// Reads the encodings held in a string of the file, ziplists, listpacks,
+// intsets and zipmaps.
+class blob_reader {
+    bytes_view _b;
+public:
+    explicit blob_reader(bytes_view b) : _b(b) {}
+    bytes_view take(size_t n) {
+        if (n > _b.size()) {
+            throw_invalid("truncated encoded value");
+        }
+        auto v = _b.substr(0, n);
+        _b.remove_prefix(n);
+        return v;
+    }
+    uint8_t byte() {
+        return uint8_t(take(1)[0]);
+    }
+    uint64_t unsigned_le(size_t n) {
+        auto v = take(n);
+        uint64_t r = 0;
+        for (size_t i = 0; i < n; ++i) {
+            r |= uint64_t(uint8_t(v[i])) << (8 * i);
+        }
+        return r;
+    }
+    uint64_t unsigned_be(size_t n) {
+        auto v = take(n);
+        uint64_t r = 0;
+        for (size_t i = 0; i < n; ++i) {
+            r = (r << 8) | uint8_t(v[i]);
+        }
+        return r;
+    }
+    int64_t signed_le(size_t n) {
+        auto v = unsigned_le(n);
+        if (n < 8 && (v >> (8 * n - 1)) & 1) {
+            v |= ~uint64_t(0) << (8 * n);
+        }
+        return int64_t(v);
+    }
+};
+
+bytes int_bytes(int64_t v)
+{
+    return to_bytes(std::to_string(v));
+}
+
+bytes score_bytes(double d)
+{
+    if (std::isinf(d)) {
+        return to_bytes(d > 0 ? "inf" : "-inf");
+    }
+    return to_bytes(sprint("%.17g", d));
+}
+
+// The CRC-64 of Redis (Jones polynomial, reflected), of the DUMP payloads.
+uint64_t crc64(bytes_view b)
+{
+    static const auto table = [] {
+        std::array<uint64_t, 256> t;
+        for (uint64_t i = 0; i < 256; ++i) {
+            auto c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = c & 1 ? (c >> 1) ^ 0x95ac9329ac4bc9b5ULL : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint64_t crc = 0;
+    for (auto c : b) {
+        crc = table[(crc ^ uint8_t(c)) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+bytes lzf_decompress(bytes_view in, size_t len)
+{
+    bytes out(bytes::initialized_later(), len);
+    size_t ip = 0, op = 0;
+    while (ip < in.size()) {
+        size_t ctrl = uint8_t(in[ip++]);
+        if (ctrl < 32) {
+            // A literal run.
+            ++ctrl;
+            if (ip + ctrl > in.size() || op + ctrl > len) {
+                throw_invalid("corrupted compressed string");
+            }
+            std::copy_n(in.begin() + ip, ctrl, out.begin() + op);
+            ip += ctrl;
+            op += ctrl;
+            continue;
+        }
+        // A back reference, which may overlap the bytes it copies.
+        size_t n = ctrl >> 5;
+        if (n == 7) {
+            if (ip >= in.size()) {
+                throw_invalid("corrupted compressed string");
+            }
+            n += uint8_t(in[ip++]);
+        }
+        if (ip >= in.size()) {
+            throw_invalid("corrupted compressed string");
+        }
+        size_t back = ((ctrl & 0x1f) << 8) + uint8_t(in[ip++]) + 1;
+        n += 2;
+        if (back > op || op + n > len) {
+            throw_invalid("corrupted compressed string");
+        }
+        for (size_t i = 0; i < n; ++i, ++op) {
+            out[op] = out[op - back];
+        }
+    }
+    if (op != len) {
+        throw_invalid("corrupted compressed string");
+    }
+    return out;
+}
+
+std::vector<bytes> parse_ziplist(bytes_view blob)
+{
+    blob_reader r(blob);
+    // The size of the ziplist, the offset of its tail and its number of
+    // entries, which saturates at 65535.
+    r.take(10);
+    std::vector<bytes> elements;
+    while (true) {
+        auto prevlen = r.byte();
+        if (prevlen == 0xff) {
+            break;
+        }
+        if (prevlen == 0xfe) {
+            r.take(4);
+        }
+        auto enc = r.byte();
+        switch (enc >> 6) {
+        case 0:
+            elements.emplace_back(to_bytes(r.take(enc & 0x3f)));
+            continue;
+        case 1:
+            elements.emplace_back(to_bytes(r.take((size_t(enc & 0x3f) << 8) | r.byte())));
+            continue;
+        case 2:
+            elements.emplace_back(to_bytes(r.take(r.unsigned_be(4))));
+            continue;
+        }
+        int64_t v;
+        switch (enc) {
+        case 0xc0: v = r.signed_le(2); break;
+        case 0xd0: v = r.signed_le(4); break;
+        case 0xe0: v = r.signed_le(8); break;
+        case 0xf0: v = r.signed_le(3); break;
+        case 0xfe: v = r.signed_le(1); break;
+        default:
+            if (enc < 0xf1 || enc > 0xfd) {
+                throw_invalid(sprint("unknown ziplist encoding %d", int(enc)));
+            }
+            // An immediate integer from 0 to 12.
+            v = (enc & 0x0f) - 1;
+        }
+        elements.emplace_back(int_bytes(v));
+    }
+    return elements;
+}
+
+// The size of the back length of a listpack entry of `len` bytes.
+size_t listpack_backlen_size(size_t len)
+{
+    if (len <= 127) {
+        return 1;
+    } else if (len < 16383) {
+        return 2;
+    } else if (len < 2097151) {
+        return 3;
+    } else if (len < 268435455) {
+        return 4;
+    }
+    return 5;
+}
+
+std::vector<bytes> parse_listpack(bytes_view blob)
+{
+    blob_reader r(blob);
+    // The size of the listpack and its number of entries.
+    r.take(6);
+    std::vector<bytes> elements;
+    while (true) {
+        auto enc = r.byte();
+        if (enc == 0xff) {
+            break;
+        }
+        size_t len = 0;
+        if ((enc & 0x80) == 0) {
+            elements.emplace_back(int_bytes(enc & 0x7f));
+            len = 1;
+        } else if ((enc & 0xc0) == 0x80) {
+            size_t n = enc & 0x3f;
+            elements.emplace_back(to_bytes(r.take(n)));
+            len = 1 + n;
+        } else if ((enc & 0xe0) == 0xc0) {
+            int64_t v = (int64_t(enc & 0x1f) << 8) | r.byte();
+            elements.emplace_back(int_bytes(v >= 4096 ? v - 8192 : v));
+            len = 2;
+        } else if ((enc & 0xf0) == 0xe0) {
+            size_t n = (size_t(enc & 0x0f) << 8) | r.byte();
+            elements.emplace_back(to_bytes(r.take(n)));
+            len = 2 + n;
+        } else {
+            switch (enc) {
+            case 0xf0: {
+                size_t n = r.unsigned_le(4);
+                elements.emplace_back(to_bytes(r.take(n)));
+                len = 5 + n;
+                break;
+            }
+            case 0xf1: elements.emplace_back(int_bytes(r.signed_le(2))); len = 3; break;
+            case 0xf2: elements.emplace_back(int_bytes(r.signed_le(3))); len = 4; break;
+            case 0xf3: elements.emplace_back(int_bytes(r.signed_le(4))); len = 5; break;
+            case 0xf4: elements.emplace_back(int_bytes(r.signed_le(8))); len = 9; break;
+            default:
+                throw_invalid(sprint("unknown listpack encoding %d", int(enc)));
+            }
+        }
+        r.take(listpack_backlen_size(len));
+    }
+    return elements;
+}
+
+std::vector<bytes> parse_intset(bytes_view blob)
+{
+    blob_reader r(blob);
+    auto width = r.unsigned_le(4);
+    auto count = r.unsigned_le(4);
+    if (width != 2 && width != 4 && width != 8) {
+        throw_invalid(sprint("unknown intset encoding %d", width));
+    }
+    std::vector<bytes> elements;
+    elements.reserve(std::min(count, blob.size() / width));
+    for (uint64_t i = 0; i < count; ++i) {
+        elements.emplace_back(int_bytes(r.signed_le(width)));
+    }
+    return elements;
+}
+
+std::vector<std::pair<bytes, bytes>> parse_zipmap(bytes_view blob)
+{
+    blob_reader r(blob);
+    auto length = [&r] () -> std::optional<size_t> {
+        auto b = r.byte();
+        if (b == 0xff) {
+            return std::nullopt;
+        }
+        return b < 0xfe ? size_t(b) : size_t(r.unsigned_le(4));
+    };
+    r.byte();
+    std::vector<std::pair<bytes, bytes>> pairs;
+    while (auto key_len = length()) {
+        auto key = to_bytes(r.take(*key_len));
+        auto value_len = length();
+        if (!value_len) {
+            throw_invalid("truncated zipmap");
+        }
+        auto free = r.byte();
+        pairs.emplace_back(std::move(key), to_bytes(r.take(*value_len)));
+        r.take(free);
+    }
+    return pairs;
+}
+
+std::vector<std::pair<bytes, bytes>> to_pairs(std::vector<bytes>&& elements)
+{
+    if (elements.size() % 2) {
+        throw_invalid("odd number of elements in a hash or a sorted set");
+    }
+    std::vector<std::pair<bytes, bytes>> pairs;
+    pairs.reserve(elements.size() / 2);
+    for (size_t i = 0; i < elements.size(); i += 2) {
+        pairs.emplace_back(std::move(elements[i]), std::move(elements[i + 1]));
+    }
+    return pairs;
+}
+
+}
+
+size_t rdb_entry::memory_usage() const
+{
+    auto size = _key.size() + _string.size();
+    for (auto& e : _elements) {
+        size += e.size();
+    }
+    for (auto& p : _pairs) {
+        size += p.first.size() + p.second.size();
+    }
+    return size;
+}
+
+bytes rdb_reader::read_bytes(size_t n)
+{
+    if (!_in) {
+        if (n > _value.size()) {
+            throw_invalid("truncated value");
+        }
+        auto v = _value.substr(0, n);
+        _value.remove_prefix(n);
+        return bytes(v);
+    }
+    auto buf = _in->read_exactly(n).get0();
+    if (buf.size() != n) {
+        throw_invalid("unexpected end of file");
+    }
+    return bytes(reinterpret_cast<const int8_t*>(buf.get()), n);
+}
+
+uint8_t rdb_reader::read_byte()
+{
+    return uint8_t(read_bytes(1)[0]);
+}
+
+uint64_t rdb_reader::read_length(bool* encoded)
+{
+    auto b = read_byte();
+    if (encoded) {
+        *encoded = false;
+    }
+    switch (b >> 6) {
+    case 0:
+        return b & 0x3f;
+    case 1:
+        return (uint64_t(b & 0x3f) << 8) | read_byte();
+    case 2:
+        if (b == 0x80) {
+            return blob_reader(read_bytes(4)).unsigned_be(4);
+        } else if (b == 0x81) {
+            return blob_reader(read_bytes(8)).unsigned_be(8);
+        }
+        throw_invalid(sprint("unknown length encoding %d", int(b)));
+    }
+    if (!encoded) {
+        throw_invalid("encoded value instead of a length");
+    }
+    *encoded = true;
+    return b & 0x3f;
+}
+
+bytes rdb_reader::read_string()
+{
+    bool encoded;
+    auto len = read_length(&encoded);
+    if (!encoded) {
+        return read_bytes(len);
+    }
+    switch (len) {
+    case 0:
+        return int_bytes(int8_t(read_byte()));
+    case 1:
+        return int_bytes(blob_reader(read_bytes(2)).signed_le(2));
+    case 2:
+        return int_bytes(blob_reader(read_bytes(4)).signed_le(4));
+    case 3: {
+        auto compressed_len = read_length();
+        auto len = read_length();
+        return lzf_decompress(read_bytes(compressed_len), len);
+    }
+    }
+    throw_invalid(sprint("unknown string encoding %d", len));
+}
+
+// The scores of the sorted sets of the first versions, as text.
+bytes rdb_reader::read_old_score()
+{
+    auto len = read_byte();
+    switch (len) {
+    case 253: return to_bytes("nan");
+    case 254: return to_bytes("inf");
+    case 255: return to_bytes("-inf");
+    }
+    return read_bytes(len);
+}
+
+void rdb_reader::read_value(uint8_t type, rdb_entry& e)
+{
+    switch (type) {
+    case type_string:
+        e._kind = rdb_entry::kind::string;
+        e._string = read_string();
+        break;
+    case type_list:
+    case type_set: {
+        e._kind = type == type_list ? rdb_entry::kind::list : rdb_entry::kind::set;
+        auto n = read_length();
+        for (uint64_t i = 0; i < n; ++i) {
+            e._elements.emplace_back(read_string());
+        }
+        break;
+    }
+    case type_zset:
+    case type_zset_2:
+    case type_hash: {
+        e._kind = type == type_hash ? rdb_entry::kind::hash : rdb_entry::kind::zset;
+        auto n = read_length();
+        for (uint64_t i = 0; i < n; ++i) {
+            auto first = read_string();
+            if (type == type_hash) {
+                e._pairs.emplace_back(std::move(first), read_string());
+            } else if (type == type_zset) {
+                e._pairs.emplace_back(std::move(first), read_old_score());
+            } else {
+                auto bits = blob_reader(read_bytes(8)).unsigned_le(8);
+                double score;
+                std::memcpy(&score, &bits, sizeof(score));
+                e._pairs.emplace_back(std::move(first), score_bytes(score));
+            }
+        }
+        break;
+    }
+    case type_hash_zipmap:
+        e._kind = rdb_entry::kind::hash;
+        e._pairs = parse_zipmap(read_string());
+        break;
+    case type_list_ziplist:
+        e._kind = rdb_entry::kind::list;
+        e._elements = parse_ziplist(read_string());
+        break;
+    case type_set_intset:
+        e._kind = rdb_entry::kind::set;
+        e._elements = parse_intset(read_string());
+        break;
+    case type_set_listpack:
+        e._kind = rdb_entry::kind::set;
+        e._elements = parse_listpack(read_string());
+        break;
+    case type_zset_ziplist:
+    case type_hash_ziplist:
+        e._kind = type == type_hash_ziplist ? rdb_entry::kind::hash : rdb_entry::kind::zset;
+        e._pairs = to_pairs(parse_ziplist(read_string()));
+        break;
+    case type_zset_listpack:
+    case type_hash_listpack:
+        e._kind = type == type_hash_listpack ? rdb_entry::kind::hash : rdb_entry::kind::zset;
+        e._pairs = to_pairs(parse_listpack(read_string()));
+        break;
+    case type_list_quicklist:
+    case type_list_quicklist_2: {
+        e._kind = rdb_entry::kind::list;
+        auto nodes = read_length();
+        for (uint64_t i = 0; i < nodes; ++i) {
+            auto container = type == type_list_quicklist ? uint64_t(container_packed) : read_length();
+            auto node = read_string();
+            if (container == container_plain) {
+                e._elements.emplace_back(std::move(node));
+                continue;
+            } else if (container != container_packed) {
+                throw_invalid(sprint("unknown quicklist container %d", container));
+            }
+            auto elements = type == type_list_quicklist ? parse_ziplist(node) : parse_listpack(node);
+            std::move(elements.begin(), elements.end(), std::back_inserter(e._elements));
+        }
+        break;
+    }
+    default:
+        throw std::runtime_error(sprint("unsupported RDB type %d of the key %s", int(type), sstring(reinterpret_cast<const char*>(e._key.data()), e._key.size())));
+    }
+}
+
+void rdb_reader::start()
+{
+    auto magic = read_bytes(9);
+    if (!std::equal(magic.begin(), magic.begin() + 5, "REDIS")) {
+        throw_invalid("not an RDB file");
+    }
+    try {
+        _version = boost::lexical_cast<unsigned>(sstring(reinterpret_cast<const char*>(magic.data()) + 5, 4));
+    } catch (boost::bad_lexical_cast&) {
+        throw_invalid("bad version");
+    }
+    if (_version < 1 || _version > rdb_max_version) {
+        throw std::runtime_error(sprint("unsupported RDB version %d", _version));
+    }
+}
+
+std::optional<rdb_entry> rdb_reader::next()
+{
+    std::optional<int64_t> expire_ms;
+    while (true) {
+        auto type = read_byte();
+        switch (type) {
+        case opcode_eof:
+            // The checksum, which is not verified.
+            if (_version >= 5) {
+                read_bytes(8);
+            }
+            return std::nullopt;
+        case opcode_selectdb:
+            _db = read_length();
+            continue;
+        case opcode_resizedb:
+            read_length();
+            read_length();
+            continue;
+        case opcode_aux:
+            read_string();
+            read_string();
+            continue;
+        case opcode_expiretime:
+            expire_ms = blob_reader(read_bytes(4)).signed_le(4) * 1000;
+            continue;
+        case opcode_expiretime_ms:
+            expire_ms = blob_reader(read_bytes(8)).signed_le(8);
+            continue;
+        case opcode_idle:
+            read_length();
+            continue;
+        case opcode_freq:
+            read_byte();
+            continue;
+        case opcode_slot_info:
+            read_length();
+            read_length();
+            read_length();
+            continue;
+        case opcode_function2:
+            // The libraries of functions are not loaded.
+            read_string();
+            continue;
+        case opcode_function:
+        case opcode_module_aux:
+            throw std::runtime_error(sprint("unsupported RDB opcode %d", int(type)));
+        }
+        rdb_entry e;
+        e._db = _db;
+        e._expire_ms = expire_ms;
+        e._key = read_string();
+        read_value(type, e);
+        return std::move(e);
+    }
+}
+
+void rdb_reader::read_dump_value(rdb_entry& e)
+{
+    read_value(read_byte(), e);
+    if (!_value.empty()) {
+        throw_invalid("trailing bytes after the value");
+    }
+}
+
+void rdb_writer::put_byte(uint8_t b)
+{
+    _buffer.push_back(int8_t(b));
+}
+
+void rdb_writer::put_length(uint64_t len)
+{
+    if (len < (1 << 6)) {
+        put_byte(len);
+    } else if (len < (1 << 14)) {
+        put_byte(0x40 | (len >> 8));
+        put_byte(len & 0xff);
+    } else {
+        auto size = len <= std::numeric_limits<uint32_t>::max() ? 4 : 8;
+        put_byte(size == 4 ? 0x80 : 0x81);
+        for (int i = size - 1; i >= 0; --i) {
+            put_byte((len >> (8 * i)) & 0xff);
+        }
+    }
+}
+
+void rdb_writer::put_string(bytes_view s)
+{
+    put_length(s.size());
+    _buffer.insert(_buffer.end(), s.begin(), s.end());
+}
+
+void rdb_writer::flush_if_full()
+{
+    static constexpr size_t buffer_size = 128 * 1024;
+    if (_out && _buffer.size() >= buffer_size) {
+        _out->write(reinterpret_cast<const char*>(_buffer.data()), _buffer.size()).get();
+        _buffer.clear();
+    }
+}
+
+void rdb_writer::start()
+{
+    auto magic = sprint("REDIS%04d", rdb_export_version);
+    _buffer.insert(_buffer.end(), magic.begin(), magic.end());
+}
+
+void rdb_writer::select_db(uint64_t db)
+{
+    put_byte(opcode_selectdb);
+    put_length(db);
+}
+
+void rdb_writer::write(const rdb_entry& e)
+{
+    if (e._expire_ms) {
+        put_byte(opcode_expiretime_ms);
+        for (int i = 0; i < 8; ++i) {
+            put_byte((uint64_t(*e._expire_ms) >> (8 * i)) & 0xff);
+        }
+    }
+    put_value(e, true);
+    flush_if_full();
+}
+
+bytes rdb_writer::dump(const rdb_entry& e)
+{
+    _buffer.clear();
+    put_value(e, false);
+    put_byte(rdb_export_version & 0xff);
+    put_byte(rdb_export_version >> 8);
+    auto crc = crc64(bytes_view(_buffer.data(), _buffer.size()));
+    for (int i = 0; i < 8; ++i) {
+        put_byte((crc >> (8 * i)) & 0xff);
+    }
+    bytes payload(_buffer.data(), _buffer.size());
+    _buffer.clear();
+    return payload;
+}
+
+// The type, the key in a file, then the value.
+void rdb_writer::put_value(const rdb_entry& e, bool with_key)
+{
+    auto put_key = [this, &e, with_key] {
+        if (with_key) {
+            put_string(e._key);
+        }
+    };
+    switch (e._kind) {
+    case rdb_entry::kind::string:
+        put_byte(type_string);
+        put_key();
+        put_string(e._string);
+        break;
+    case rdb_entry::kind::list:
+    case rdb_entry::kind::set:
+        put_byte(e._kind == rdb_entry::kind::list ? type_list : type_set);
+        put_key();
+        put_length(e._elements.size());
+        for (auto& element : e._elements) {
+            put_string(element);
+        }
+        break;
+    case rdb_entry::kind::hash:
+        put_byte(type_hash);
+        put_key();
+        put_length(e._pairs.size());
+        for (auto& p : e._pairs) {
+            put_string(p.first);
+            put_string(p.second);
+        }
+        break;
+    case rdb_entry::kind::zset:
+        put_byte(type_zset_2);
+        put_key();
+        put_length(e._pairs.size());
+        for (auto& p : e._pairs) {
+            put_string(p.first);
+            auto score = bytes2double(p.second);
+            uint64_t bits;
+            std::memcpy(&bits, &score, sizeof(bits));
+            for (int i = 0; i < 8; ++i) {
+                put_byte((bits >> (8 * i)) & 0xff);
+            }
+        }
+        break;
+    }
+}
+
+void rdb_writer::finish()
+{
+    put_byte(opcode_eof);
+    // A null checksum is not verified by Redis.
+    for (int i = 0; i < 8; ++i) {
+        put_byte(0);
+    }
+    _out->write(reinterpret_cast<const char*>(_buffer.data()), _buffer.size()).get();
+    _buffer.clear();
+    _out->flush().get();
+}
+
+sstring keyspace_of_db(uint64_t db)
+{
+    return sprint("%s%d", REDIS_DATABASE_NAME_PREFIX, db);
+}
+
+std::optional<long> ttl_of(const rdb_entry& e)
+{
+    if (!e._expire_ms) {
+        return 0;
+    }
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(db_clock::now().time_since_epoch()).count();
+    if (*e._expire_ms <= now) {
+        return std::nullopt;
+    }
+    return (*e._expire_ms - now + 999) / 1000;
+}
+
+static mutation make_value_mutation(const keyspace_schemas& schemas, rdb_entry&& e, long ttl)
+{
+    switch (e._kind) {
+    case rdb_entry::kind::string:
+        return internal::make_mutation(make_simple(schemas._strings, e._key, std::move(e._string), ttl));
+    case rdb_entry::kind::list:
+        return internal::make_mutation(make_list_cells(schemas._lists, e._key, std::move(e._elements), false, ttl));
+    case rdb_entry::kind::set:
+        return internal::make_mutation(make_set_cells(schemas._sets, e._key, std::move(e._elements), ttl));
+    case rdb_entry::kind::hash: {
+        std::unordered_map<bytes, bytes> fields;
+        for (auto& p : e._pairs) {
+            fields.emplace(std::move(p.first), std::move(p.second));
+        }
+        return internal::make_mutation(make_map_cells(schemas._maps, e._key, std::move(fields), ttl));
+    }
+    case rdb_entry::kind::zset:
+        return internal::make_mutation(make_zset_cells(schemas._zsets, e._key, std::move(e._pairs), ttl));
+    }
+    abort();
+}
+
+std::vector<mutation> make_rdb_mutations(const keyspace_schemas& schemas, rdb_entry&& e, long ttl)
+{
+    std::vector<mutation> ms;
+    if (e._kind == rdb_entry::kind::zset) {
+        std::vector<std::pair<double, bytes>> index_cells;
+        index_cells.reserve(e._pairs.size());
+        for (auto& p : e._pairs) {
+            index_cells.emplace_back(bytes2double(p.second), p.first);
+        }
+        ms.emplace_back(internal::make_mutation(make_zset_score_cells(schemas._zset_scores, e._key, std::move(index_cells), {}, ttl)));
+    }
+    ms.emplace_back(make_value_mutation(schemas, std::move(e), ttl));
+    return ms;
+}
+
+std::vector<mutation> make_restore_mutations(const keyspace_schemas& schemas, rdb_entry&& e, std::optional<long> ttl, bool replace)
+{
+    std::vector<mutation> ms;
+    if (replace) {
+        // Older than the cells of the value, which may be written within the same microsecond.
+        tombstone t { api::new_timestamp() - 1, gc_clock::now() };
+        for (auto& s : schemas.all()) {
+            ms.emplace_back(s, partition_key::from_single_value(*s, e._key));
+            ms.back().partition().apply(t);
+        }
+    }
+    if (!ttl) {
+        return ms;
+    }
+    for (auto& m : make_rdb_mutations(schemas, std::move(e), *ttl)) {
+        auto it = std::find_if(ms.begin(), ms.end(), [&m] (const mutation& d) {
+            return d.schema()->id() == m.schema()->id();
+        });
+        if (it != ms.end()) {
+            it->apply(std::move(m));
+        } else {
+            ms.emplace_back(std::move(m));
+        }
+    }
+    return ms;
+}
+
+rdb_entry restore_value(bytes key, bytes_view payload)
+{
+    static constexpr size_t footer_size = 10;
+    if (payload.size() < footer_size + 1) {
+        throw std::runtime_error("DUMP payload version or checksum are wrong");
+    }
+    auto footer = blob_reader(payload.substr(payload.size() - footer_size));
+    auto version = footer.unsigned_le(2);
+    auto crc = footer.unsigned_le(8);
+    if (version > rdb_max_version || crc != crc64(payload.substr(0, payload.size() - 8))) {
+        throw std::runtime_error("DUMP payload version or checksum are wrong");
+    }
+    rdb_entry e;
+    e._key = std::move(key);
+    rdb_reader(payload.substr(0, payload.size() - footer_size), version).read_dump_value(e);
+    return e;
+}
+
+namespace {
+
+// The live rows of a partition of a table of the kind, into the entry.
+class entry_builder {
+    const schema& _schema;
+    const query::partition_slice& _slice;
+    rdb_entry& _entry;
+    bool& _live;
+    std::optional<gc_clock::time_point>& _expiry;
+private:
+    void add(const clustering_key* key, const query::result_row_view& row) {
+        auto cell = row.iterator().next_atomic_cell();
+        if (!cell) {
+            return;
+        }
+        _live = true;
+        if (auto expiry = cell->expiry()) {
+            _expiry = _expiry ? std::max(*_expiry, *expiry) : *expiry;
+        }
+        auto value = cell->value().linearize();
+        auto ckey = [this, key] {
+            return key ? to_bytes(*key->begin(_schema)) : bytes();
+        };
+        switch (_entry._kind) {
+        case rdb_entry::kind::string:
+            _entry._string = std::move(value);
+            break;
+        case rdb_entry::kind::list:
+            _entry._elements.emplace_back(std::move(value));
+            break;
+        case rdb_entry::kind::set:
+            _entry._elements.emplace_back(ckey());
+            break;
+        case rdb_entry::kind::hash:
+        case rdb_entry::kind::zset:
+            _entry._pairs.emplace_back(ckey(), std::move(value));
+            break;
+        }
+    }
+public:
+    entry_builder(const schema& s, const query::partition_slice& slice, rdb_entry& e, bool& live, std::optional<gc_clock::time_point>& expiry)
+        : _schema(s), _slice(slice), _entry(e), _live(live), _expiry(expiry) {}
+    void accept_new_partition(const partition_key& key, uint32_t row_count) {}
+    void accept_new_partition(uint32_t row_count) {}
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row) {
+        add(&key, row);
+    }
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {
+        add(nullptr, row);
+    }
+    void accept_partition_end(const query::result_row_view& static_row) {}
+};
+
+future<std::optional<rdb_entry>> read_entry_of(service::storage_proxy& proxy, schema_ptr s, rdb_entry::kind kind, const bytes& key,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    std::vector<column_id> regular_cols { s->get_column_definition(DATA_COLUMN_NAME)->id };
+    query::partition_slice ps(
+            { query::full_clustering_range },
+            {},
+            std::move(regular_cols),
+            query::partition_slice::option_set::of<
+                query::partition_slice::option::send_partition_key,
+                query::partition_slice::option::send_clustering_key,
+                query::partition_slice::option::send_expiry>());
+    auto cmd = make_lw_shared<query::read_command>(s->id(), s->version(), ps, std::numeric_limits<uint32_t>::max(), gc_clock::now(), std::experimental::nullopt, 1);
+    auto pkey = partition_key::from_single_value(*s, key);
+    dht::partition_range_vector ranges;
+    ranges.emplace_back(dht::partition_range::make_singular(dht::global_partitioner().decorate_key(*s, std::move(pkey))));
+    return proxy.query(s, cmd, std::move(ranges), cl, {timeout, cs.get_trace_state()}).then([s, ps, kind, key] (auto qr) {
+        return query::result_view::do_with(*qr.query_result, [&] (query::result_view v) {
+            rdb_entry e;
+            e._key = key;
+            e._kind = kind;
+            bool live = false;
+            std::optional<gc_clock::time_point> expiry;
+            v.consume(ps, entry_builder(*s, ps, e, live, expiry));
+            if (!live) {
+                return std::optional<rdb_entry>();
+            }
+            if (expiry) {
+                e._expire_ms = std::chrono::duration_cast<std::chrono::milliseconds>(expiry->time_since_epoch()).count();
+            }
+            return std::optional<rdb_entry>(std::move(e));
+        });
+    });
+}
+
+}
+
+future<std::optional<rdb_entry>> read_rdb_entry(service::storage_proxy& proxy, const keyspace_schemas& schemas, const bytes& key,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs)
+{
+    std::vector<std::pair<schema_ptr, rdb_entry::kind>> tables {
+        { schemas._strings, rdb_entry::kind::string },
+        { schemas._lists, rdb_entry::kind::list },
+        { schemas._sets, rdb_entry::kind::set },
+        { schemas._maps, rdb_entry::kind::hash },
+        { schemas._zsets, rdb_entry::kind::zset },
+    };
+    return do_with(std::move(tables), std::optional<rdb_entry>(), [&proxy, &key, cl, timeout, &cs] (auto& tables, auto& found) {
+        return parallel_for_each(tables, [&proxy, &key, cl, timeout, &cs, &found] (auto& t) {
+            return read_entry_of(proxy, t.first, t.second, key, cl, timeout, cs).then([&found] (std::optional<rdb_entry> e) {
+                if (e && !found) {
+                    found = std::move(e);
+                }
+            });
+        }).then([&found] {
+            return std::move(found);
+        });
+    });
+}
+
+namespace {
+
+struct import_result {
+    uint64_t _keys = 0;
+    // The tables with new sstables in their upload directory.
+    std::set<std::pair<sstring, sstring>> _tables;
+};
+
+// The keys of the file owned by a shard, buffered as mutations by table, then
+// written to sstables sorted by key once the buffer is full.
+class shard_importer {
+    database& _db;
+    const size_t _max_buffered;
+    size_t _buffered = 0;
+    std::unordered_map<utils::UUID, std::vector<mutation>> _tables;
+    std::set<uint64_t> _missing_dbs;
+    import_result _result;
+private:
+    bool owned(const sstring& keyspace, const dht::token& token) {
+        if (dht::global_partitioner().shard_of(token) != engine().cpu_id()) {
+            return false;
+        }
+        auto& strategy = _db.find_keyspace(keyspace).get_replication_strategy();
+        auto endpoints = strategy.get_natural_endpoints(token);
+        return std::find(endpoints.begin(), endpoints.end(), utils::fb_utilities::get_broadcast_address()) != endpoints.end();
+    }
+    void write_sstable(column_family& cf, std::vector<mutation>&& ms) {
+        auto s = ms.front().schema();
+        std::sort(ms.begin(), ms.end(), [less = dht::decorated_key::less_comparator(s)] (const mutation& a, const mutation& b) {
+            return less(a.decorated_key(), b.decorated_key());
+        });
+        auto partitions = ms.size();
+        auto sst = cf.make_streaming_sstable_for_write(sstring("upload"));
+        sstables::sstable_writer_config cfg;
+        cfg.large_partition_handler = cf.get_large_partition_handler();
+        auto& pc = service::get_local_streaming_write_priority();
+        sst->write_components(flat_mutation_reader_from_mutations(std::move(ms)), partitions, s, cfg, {}, pc).get();
+        _result._tables.emplace(s->ks_name(), s->cf_name());
+    }
+public:
+    shard_importer(database& db, size_t max_buffered) : _db(db), _max_buffered(max_buffered) {}
+
+    void add(rdb_entry&& e) {
+        auto keyspace = keyspace_of_db(e._db);
+        if (!_db.has_keyspace(keyspace)) {
+            if (_missing_dbs.insert(e._db).second) {
+                rdblog.warn("No keyspace {} for the database {} of the RDB file, its keys are skipped", keyspace, e._db);
+            }
+            return;
+        }
+        auto ttl = ttl_of(e);
+        if (!ttl) {
+            return;
+        }
+        auto& schemas = get_local_query_processor().schemas_of(keyspace);
+        auto pkey = partition_key::from_single_value(*schemas._strings, e._key);
+        if (!owned(keyspace, dht::global_partitioner().get_token(*schemas._strings, pkey))) {
+            return;
+        }
+        auto size = e.memory_usage();
+        for (auto& m : make_rdb_mutations(schemas, std::move(e), *ttl)) {
+            _tables[m.schema()->id()].emplace_back(std::move(m));
+        }
+        ++_result._keys;
+        _buffered += size;
+        if (_buffered >= _max_buffered) {
+            flush();
+        }
+    }
+
+    void flush() {
+        for (auto& t : _tables) {
+            if (!t.second.empty()) {
+                write_sstable(_db.find_column_family(t.first), std::move(t.second));
+            }
+        }
+        _tables.clear();
+        _buffered = 0;
+    }
+
+    import_result result() && {
+        return std::move(_result);
+    }
+};
+
+}
+
+// Each shard reads the whole file and keeps its own keys, so that the keys are
+// neither copied nor freed across shards.
+static future<import_result> import_rdb_on_shard(sstring path)
+{
+    return seastar::async([path] {
+        auto& db = service::get_local_storage_proxy().get_db().local();
+        file_input_stream_options options;
+        options.buffer_size = 128 * 1024;
+        options.read_ahead = 4;
+        auto f = open_checked_file_dma(general_disk_error_handler, path, open_flags::ro).get0();
+        auto in = make_file_input_stream(std::move(f), options);
+        // The raw size of the values buffered, the mutations take a few times more.
+        shard_importer importer(db, memory::stats().total_memory() / 32);
+        try {
+            rdb_reader reader(in);
+            reader.start();
+            while (auto e = reader.next()) {
+                importer.add(std::move(*e));
+                if (need_preempt()) {
+                    seastar::thread::yield();
+                }
+            }
+            importer.flush();
+        } catch (...) {
+            in.close().get();
+            throw;
+        }
+        in.close().get();
+        return std::move(importer).result();
+    });
+}
+
+future<uint64_t> import_rdb(sstring path)
+{
+    auto shards = boost::irange(0u, smp::count);
+    return map_reduce(shards.begin(), shards.end(), [path] (unsigned shard) {
+        return smp::submit_to(shard, [path] {
+            return import_rdb_on_shard(path);
+        });
+    }, import_result(), [] (import_result all, import_result r) {
+        all._keys += r._keys;
+        all._tables.insert(r._tables.begin(), r._tables.end());
+        return all;
+    }).then([path] (import_result r) {
+        return do_with(std::move(r), [path] (auto& r) {
+            // Like a refresh, one table at a time on the shard given by its name.
+            return do_for_each(r._tables, [] (auto& t) {
+                auto coordinator = std::hash<sstring>()(t.second) % smp::count;
+                return service::get_storage_service().invoke_on(coordinator, [ks = t.first, cf = t.second] (service::storage_service& ss) {
+                    return ss.load_new_sstables(ks, cf);
+                });
+            }).then([path, &r] {
+                rdblog.info("Loaded {} keys of the RDB file {}", r._keys, path);
+                return r._keys;
+            });
+        });
+    });
+}
+
+static const std::vector<std::pair<sstring, rdb_entry::kind>> exported_tables {
+    { STRINGS, rdb_entry::kind::string },
+    { LISTS, rdb_entry::kind::list },
+    { SETS, rdb_entry::kind::set },
+    { MAPS, rdb_entry::kind::hash },
+    { ZSETS, rdb_entry::kind::zset },
+};
+
+static std::optional<rdb_entry> to_entry(mutation& m, rdb_entry::kind kind, uint64_t db)
+{
+    auto& s = *m.schema();
+    auto now = gc_clock::now();
+    std::vector<query::clustering_range> ranges { query::full_clustering_range };
+    m.partition().compact_for_query(s, now, ranges, false, query::max_rows);
+    auto& column = *s.get_column_definition(DATA_COLUMN_NAME);
+    rdb_entry e;
+    e._db = db;
+    e._kind = kind;
+    e._key = to_bytes(*m.key().begin(s));
+    bool live = false;
+    std::optional<gc_clock::time_point> expiry;
+    for (auto& re : m.partition().clustered_rows()) {
+        auto cell = re.row().cells().find_cell(column.id);
+        if (!cell) {
+            continue;
+        }
+        auto c = cell->as_atomic_cell(column);
+        if (!c.is_live()) {
+            continue;
+        }
+        live = true;
+        if (c.is_live_and_has_ttl()) {
+            expiry = expiry ? std::max(*expiry, c.expiry()) : c.expiry();
+        }
+        switch (kind) {
+        case rdb_entry::kind::string:
+            e._string = c.value().linearize();
+            break;
+        case rdb_entry::kind::list:
+            e._elements.emplace_back(c.value().linearize());
+            break;
+        case rdb_entry::kind::set:
+            e._elements.emplace_back(to_bytes(*re.key().begin(s)));
+            break;
+        case rdb_entry::kind::hash:
+        case rdb_entry::kind::zset:
+            e._pairs.emplace_back(to_bytes(*re.key().begin(s)), c.value().linearize());
+            break;
+        }
+    }
+    if (!live) {
+        return std::nullopt;
+    }
+    if (expiry) {
+        e._expire_ms = std::chrono::duration_cast<std::chrono::milliseconds>(expiry->time_since_epoch()).count();
+    }
+    return std::move(e);
+}
+
+// Reads the table of the shard from this one.
+static flat_mutation_reader make_shard_reader(unsigned shard, schema_ptr s)
+{
+    auto remote = smp::submit_to(shard, [ks = s->ks_name(), cf = s->cf_name()] {
+        auto& table = service::get_local_storage_proxy().get_db().local().find_column_family(ks, cf);
+        return make_foreign(std::make_unique<flat_mutation_reader>(table.make_reader(table.schema())));
+    }).get0();
+    return make_foreign_reader(std::move(s), std::move(remote));
+}
+
+static uint64_t export_keyspace(database& db, const sstring& keyspace, uint64_t db_number, rdb_writer& writer)
+{
+    auto& strategy = db.find_keyspace(keyspace).get_replication_strategy();
+    auto me = utils::fb_utilities::get_broadcast_address();
+    uint64_t keys = 0;
+    for (auto& t : exported_tables) {
+        auto s = db.find_column_family(keyspace, t.first).schema();
+        for (unsigned shard = 0; shard < smp::count; ++shard) {
+            auto reader = shard == engine().cpu_id() ? db.find_column_family(s->id()).make_reader(s) : make_shard_reader(shard, s);
+            while (auto m = read_mutation_from_flat_mutation_reader(reader, db::no_timeout).get0()) {
+                auto endpoints = strategy.get_natural_endpoints(m->token());
+                if (endpoints.empty() || endpoints.front() != me) {
+                    continue;
+                }
+                if (auto e = to_entry(*m, t.second, db_number)) {
+                    writer.write(*e);
+                    ++keys;
+                }
+                if (need_preempt()) {
+                    seastar::thread::yield();
+                }
+            }
+        }
+    }
+    return keys;
+}
+
+future<uint64_t> export_rdb(sstring path)
+{
+    return seastar::async([path] {
+        auto& db = service::get_local_storage_proxy().get_db().local();
+        std::map<uint64_t, sstring> keyspaces;
+        for (auto& ks : db.get_keyspaces()) {
+            if (ks.first.find(REDIS_DATABASE_NAME_PREFIX) != 0) {
+                continue;
+            }
+            try {
+                keyspaces.emplace(boost::lexical_cast<uint64_t>(ks.first.substr(std::strlen(REDIS_DATABASE_NAME_PREFIX))), ks.first);
+            } catch (boost::bad_lexical_cast&) {
+            }
+        }
+        // Written aside, so that a failed export leaves no partial file.
+        auto tmp = path + ".tmp";
+        auto f = open_checked_file_dma(general_disk_error_handler, tmp, open_flags::wo | open_flags::create | open_flags::truncate).get0();
+        auto out = make_file_output_stream(std::move(f));
+        uint64_t keys = 0;
+        try {
+            rdb_writer writer(out);
+            writer.start();
+            for (auto& ks : keyspaces) {
+                writer.select_db(ks.first);
+                keys += export_keyspace(db, ks.second, ks.first, writer);
+            }
+            writer.finish();
+        } catch (...) {
+            out.close().get();
+            remove_file(tmp).get();
+            throw;
+        }
+        out.close().get();
+        rename_file(tmp, path).get();
+        rdblog.info("Exported {} keys to the RDB file {}", keys, path);
+        return keys;
+    });
+}
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "bytes.hh"
+#include "mutation.hh"
+#include "db/consistency_level_type.hh"
+#include "db/timeout_clock.hh"
+#include "seastar/core/future.hh"
+#include "seastar/core/iostream.hh"
+#include "seastar/core/sstring.hh"
+#include <optional>
+#include <vector>
+using namespace seastar;
+
+namespace service {
+class storage_proxy;
+class client_state;
+}
+
+namespace redis {
+
+struct keyspace_schemas;
+
+// A key of an RDB file with its value, the value is in the member of its kind.
+struct rdb_entry {
+    enum class kind {
+        string,
+        list,
+        set,
+        hash,
+        zset,
+    };
+    uint64_t _db = 0;
+    bytes _key;
+    kind _kind = kind::string;
+    // The absolute expiry time, in milliseconds since the epoch.
+    std::optional<int64_t> _expire_ms;
+    bytes _string;
+    // The elements of a list or the members of a set.
+    std::vector<bytes> _elements;
+    // The fields and values of a hash, the members and scores (as text, like
+    // ZADD writes them) of a sorted set.
+    std::vector<std::pair<bytes, bytes>> _pairs;
+
+    size_t memory_usage() const;
+};
+
+// Reads the keys of an RDB file, from version 1 to 12, the ziplist, listpack,
+// intset, zipmap and quicklist encodings included. Streams and module types
+// are not supported. Must be used in a thread, but for a DUMP payload.
+class rdb_reader {
+    input_stream<char>* _in = nullptr;
+    // The value of a DUMP payload, read instead of a file.
+    bytes_view _value;
+    uint64_t _db = 0;
+    unsigned _version = 0;
+private:
+    bytes read_bytes(size_t n);
+    uint8_t read_byte();
+    uint64_t read_length(bool* encoded = nullptr);
+    bytes read_string();
+    bytes read_old_score();
+    void read_value(uint8_t type, rdb_entry& e);
+public:
+    explicit rdb_reader(input_stream<char>& in) : _in(&in) {}
+    rdb_reader(bytes_view value, unsigned version) : _value(value), _version(version) {}
+    // Reads the header of the file.
+    void start();
+    // The next key, none at the end of the file, once its checksum was read.
+    std::optional<rdb_entry> next();
+    // The type and the value of a DUMP payload.
+    void read_dump_value(rdb_entry& e);
+};
+
+// The keyspace of the database N, redis_N.
+sstring keyspace_of_db(uint64_t db);
+// The time to live of the key in seconds, 0 without expiry, none if the key
+// already expired.
+std::optional<long> ttl_of(const rdb_entry& e);
+// The mutations writing the key into its table, and the score index of a
+// sorted set, with the builders of the commands, as if the key had been
+// written by them.
+std::vector<mutation> make_rdb_mutations(const keyspace_schemas& schemas, rdb_entry&& e, long ttl);
+// The mutations writing the key, none if its time to live is none, after
+// deleting the key from every table if replaced.
+std::vector<mutation> make_restore_mutations(const keyspace_schemas& schemas, rdb_entry&& e, std::optional<long> ttl, bool replace);
+// The value of a payload of DUMP, from Redis or from this node, of which the
+// version and the checksum are verified.
+rdb_entry restore_value(bytes key, bytes_view payload);
+// Reads the key, of any of the five types of RDB, with its expiry. The whole
+// partition of a collection is read at once. None if the key does not exist.
+future<std::optional<rdb_entry>> read_rdb_entry(service::storage_proxy& proxy, const keyspace_schemas& schemas, const bytes& key,
+    db::consistency_level cl, db::timeout_clock::time_point timeout, service::client_state& cs);
+
+// Writes an RDB file of version 9, the strings are not compressed and the
+// collections are in the plain encodings, which every version of Redis since
+// 5.0 loads. The checksum is disabled. Must be used in a thread, but for a
+// DUMP payload.
+class rdb_writer {
+    output_stream<char>* _out = nullptr;
+    std::vector<int8_t> _buffer;
+private:
+    void put_byte(uint8_t b);
+    void put_length(uint64_t len);
+    void put_string(bytes_view s);
+    void put_value(const rdb_entry& e, bool with_key);
+    void flush_if_full();
+public:
+    // Writes DUMP payloads.
+    rdb_writer() = default;
+    explicit rdb_writer(output_stream<char>& out) : _out(&out) {}
+    // The payload of DUMP: the type and the value of the key, the version of
+    // the encoding and the checksum of the payload, as Redis writes it.
+    bytes dump(const rdb_entry& e);
+    void start();
+    void select_db(uint64_t db);
+    void write(const rdb_entry& e);
+    void finish();
+};
+
+// Loads an RDB file into the redis keyspaces of this node: the keys of the
+// database N go to the keyspace redis_N. Each shard writes the keys it owns,
+// among the ones this node replicates, to sorted sstables in the upload
+// directories of the tables, which are then loaded like a refresh. The keys
+// already expired are skipped. Returns the number of keys loaded, to be run on
+// every node of the cluster.
+future<uint64_t> import_rdb(sstring path);
+
+// Writes the keys of the redis keyspaces of which this node is the primary
+// replica to an RDB file, the keyspace redis_N being the database N. Returns
+// the number of keys written, the files of all the nodes of the cluster make
+// the whole data set.
+future<uint64_t> export_rdb(sstring path);
+
+}
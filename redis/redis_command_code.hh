@@ -10,6 +10,7 @@ enum class protocol_state {
 enum class command_code {
     unknown,
     set,
+    setex,
     mset,
     get,
     mget,
@@ -35,6 +36,9 @@ enum class command_code {
     rpush,
     rpushx,
     rpop,
+    blpop,
+    brpop,
+    brpoplpush,
     lrem,
     ltrim,
     hset,
@@ -101,6 +105,7 @@ enum class command_code {
     geopos,
     georadius,
     georadiusbymember,
+    geosearch,
     setbit,
     getbit,
     bitcount,
@@ -110,5 +115,37 @@ enum class command_code {
     pfadd,
     pfcount,
     pfmerge,
+    xadd,
+    xtrim,
+    xdel,
+    xlen,
+    xrange,
+    xrevrange,
+    xread,
+    xreadgroup,
+    xgroup,
+    xack,
+    xpending,
+    slowlog,
+    latency,
+    info,
+    hotkeys,
+    cluster,
+    flushdb,
+    flushall,
+    replicaof,
+    slaveof,
+    dump,
+    restore,
+    migrate,
+    rename,
+    renamenx,
+    copy,
+    move,
+    object,
+    memory,
+    bigkeys,
+    // The number of the codes, not a command.
+    count,
 };
 }
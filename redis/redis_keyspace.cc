@@ -116,6 +116,88 @@ schema_ptr zsets_schema(sstring ks_name) {
     builder.with_version(db::system_keyspace::generate_schema_version(builder.uuid()));
     return builder.build(schema_builder::compact_storage::yes);
 }
+schema_ptr streams_schema(sstring ks_name) {
+     schema_builder builder(make_lw_shared(schema(generate_legacy_id(ks_name, redis::STREAMS), ks_name, redis::STREAMS,
+     // partition key
+     {{"pkey", utf8_type}},
+     // clustering key, the entry ID: <ms>-<seq>
+     {{"ms", long_type}, {"seq", long_type}},
+     // regular columns
+     {{"data", bytes_type}},
+     // static columns
+     {},
+     // regular column name type
+     utf8_type,
+     // comment
+     "save streams for redis"
+    )));
+    builder.set_gc_grace_seconds(0);
+    builder.with_version(db::system_keyspace::generate_schema_version(builder.uuid()));
+    return builder.build(schema_builder::compact_storage::yes);
+}
+
+schema_ptr stream_groups_schema(sstring ks_name) {
+     schema_builder builder(make_lw_shared(schema(generate_legacy_id(ks_name, redis::STREAM_GROUPS), ks_name, redis::STREAM_GROUPS,
+     // partition key
+     {{"pkey", utf8_type}},
+     // clustering key, the group and the ID of the pending entry.
+     // The row (group, 0-0) keeps the last delivered ID of the group, see
+     // stream_id for the encoding of the IDs.
+     {{"ckey", utf8_type}, {"ms", long_type}, {"seq", long_type}},
+     // regular columns, the consumer owning the pending entry.
+     {{"data", utf8_type}},
+     // static columns
+     {},
+     // regular column name type
+     utf8_type,
+     // comment
+     "save consumer groups of streams for redis"
+    )));
+    builder.set_gc_grace_seconds(0);
+    builder.with_version(db::system_keyspace::generate_schema_version(builder.uuid()));
+    return builder.build(schema_builder::compact_storage::yes);
+}
+
+schema_ptr bitmaps_schema(sstring ks_name) {
+     schema_builder builder(make_lw_shared(schema(generate_legacy_id(ks_name, redis::BITMAPS), ks_name, redis::BITMAPS,
+     // partition key
+     {{"pkey", utf8_type}},
+     // clustering key, the index of the chunk.
+     {{"ckey", long_type}},
+     // regular columns, the bytes of the chunk.
+     {{"data", bytes_type}},
+     // static columns
+     {},
+     // regular column name type
+     utf8_type,
+     // comment
+     "save bitmaps for redis"
+    )));
+    builder.set_gc_grace_seconds(0);
+    builder.with_version(db::system_keyspace::generate_schema_version(builder.uuid()));
+    return builder.build(schema_builder::compact_storage::yes);
+}
+
+schema_ptr zset_scores_schema(sstring ks_name) {
+     schema_builder builder(make_lw_shared(schema(generate_legacy_id(ks_name, redis::ZSET_SCORES), ks_name, redis::ZSET_SCORES,
+     // partition key
+     {{"pkey", utf8_type}},
+     // clustering key, the members of a sorted set ordered by score.
+     {{"score", double_type}, {"ckey", utf8_type}},
+     // regular columns
+     {{"data", bytes_type}},
+     // static columns
+     {},
+     // regular column name type
+     utf8_type,
+     // comment
+     "save score index of sorted sets for redis"
+    )));
+    builder.set_gc_grace_seconds(0);
+    builder.with_version(db::system_keyspace::generate_schema_version(builder.uuid()));
+    return builder.build(schema_builder::compact_storage::yes);
+}
+
 future<> redis_keyspace_helper::create_if_not_exists(lw_shared_ptr<db::config> config) {
     auto keyspace_replication_properties = config->redis_keyspace_replication_properties();
     if (keyspace_replication_properties.count("class") == 0) {
@@ -153,7 +235,11 @@ future<> redis_keyspace_helper::create_if_not_exists(lw_shared_ptr<db::config> c
                 table_gen(ks_name, redis::LISTS, lists_schema(ks_name)),
                 table_gen(ks_name, redis::SETS, sets_schema(ks_name)),
                 table_gen(ks_name, redis::MAPS, maps_schema(ks_name)),
-                table_gen(ks_name, redis::ZSETS, zsets_schema(ks_name))
+                table_gen(ks_name, redis::ZSETS, zsets_schema(ks_name)),
+                table_gen(ks_name, redis::STREAMS, streams_schema(ks_name)),
+                table_gen(ks_name, redis::STREAM_GROUPS, stream_groups_schema(ks_name)),
+                table_gen(ks_name, redis::BITMAPS, bitmaps_schema(ks_name)),
+                table_gen(ks_name, redis::ZSET_SCORES, zset_scores_schema(ks_name))
             ).then([] {
                 return make_ready_future<>();
             });
@@ -19,6 +19,10 @@ static constexpr auto LISTS = "lists";
 static constexpr auto SETS = "sets";
 static constexpr auto MAPS = "maps";
 static constexpr auto ZSETS = "zsets";
+static constexpr auto STREAMS = "streams";
+static constexpr auto STREAM_GROUPS = "stream_groups";
+static constexpr auto BITMAPS = "bitmaps";
+static constexpr auto ZSET_SCORES = "zset_scores";
 static constexpr auto DATA_COLUMN_NAME = "data";
 static constexpr auto PKEY_COLUMN_NAME = "pkey";
 static constexpr auto CKEY_COLUMN_NAME = "ckey";
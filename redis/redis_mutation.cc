@@ -255,6 +255,112 @@ mutation make_mutation(seastar::lw_shared_ptr<zset_dead_cells_mutation> r)
     return std::move(m);
 }
 
+mutation make_mutation(seastar::lw_shared_ptr<stream_mutation> r)
+{
+    auto schema = r->schema();
+    const column_definition& column = *schema->get_column_definition(redis::DATA_COLUMN_NAME);
+    auto pkey = partition_key::from_single_value(*schema, r->key());
+    auto m = mutation(schema, std::move(pkey));
+    for (auto&& e : r->data()._cells) {
+        m.set_cell(e.first.to_clustering_key(*schema), column, make_cell(schema, *column.type, e.second, r->ttl()));
+    }
+    return std::move(m);
+}
+
+mutation make_mutation(seastar::lw_shared_ptr<stream_dead_cells_mutation> r)
+{
+    auto schema = r->schema();
+    auto pkey = partition_key::from_single_value(*schema, r->key());
+    auto m = mutation(schema, std::move(pkey));
+    for (auto&& id : r->data()._ids) {
+        m.partition().apply_delete(*schema, id.to_clustering_key(*schema), tombstone { api::new_timestamp(), gc_clock::now() });
+    }
+    return std::move(m);
+}
+
+mutation make_mutation(seastar::lw_shared_ptr<stream_trim_mutation> r)
+{
+    auto schema = r->schema();
+    auto pkey = partition_key::from_single_value(*schema, r->key());
+    auto m = mutation(schema, std::move(pkey));
+    auto& range = r->data();
+    auto end_kind = range._inclusive ? bound_kind::incl_end : bound_kind::excl_end;
+    m.partition().apply_delete(*schema, range_tombstone(clustering_key_prefix::make_empty(), bound_kind::incl_start,
+        range._end.to_clustering_key(*schema), end_kind, tombstone { api::new_timestamp(), gc_clock::now() }));
+    return std::move(m);
+}
+
+mutation make_mutation(seastar::lw_shared_ptr<stream_group_mutation> r)
+{
+    auto schema = r->schema();
+    const column_definition& column = *schema->get_column_definition(redis::DATA_COLUMN_NAME);
+    auto pkey = partition_key::from_single_value(*schema, r->key());
+    auto m = mutation(schema, std::move(pkey));
+    auto& data = r->data();
+    if (data._last_delivered) {
+        auto id = data._last_delivered->to_bytes();
+        m.set_cell(stream_id::group_metadata().to_group_clustering_key(*schema, data._group), column, make_cell(schema, *column.type, id));
+    }
+    for (auto&& e : data._pending) {
+        m.set_cell(e.first.to_group_clustering_key(*schema, data._group), column, make_cell(schema, *column.type, e.second));
+    }
+    return std::move(m);
+}
+
+mutation make_mutation(seastar::lw_shared_ptr<stream_group_dead_cells_mutation> r)
+{
+    auto schema = r->schema();
+    auto pkey = partition_key::from_single_value(*schema, r->key());
+    auto m = mutation(schema, std::move(pkey));
+    auto& data = r->data();
+    if (data._ids.empty()) {
+        auto prefix = clustering_key_prefix::from_exploded(*schema, std::vector<bytes> { data._group });
+        m.partition().apply_delete(*schema, std::move(prefix), tombstone { api::new_timestamp(), gc_clock::now() });
+    }
+    for (auto&& id : data._ids) {
+        m.partition().apply_delete(*schema, id.to_group_clustering_key(*schema, data._group), tombstone { api::new_timestamp(), gc_clock::now() });
+    }
+    return std::move(m);
+}
+
+mutation make_mutation(seastar::lw_shared_ptr<bitmap_mutation> r)
+{
+    auto schema = r->schema();
+    const column_definition& column = *schema->get_column_definition(redis::DATA_COLUMN_NAME);
+    auto pkey = partition_key::from_single_value(*schema, r->key());
+    auto m = mutation(schema, std::move(pkey));
+    if (r->data()._replaced) {
+        auto& replaced = *r->data()._replaced;
+        auto first = clustering_key_prefix::from_single_value(*schema, long_type->decompose(replaced.first));
+        auto last = replaced.second ? clustering_key_prefix::from_single_value(*schema, long_type->decompose(*replaced.second)) : clustering_key_prefix::make_empty();
+        // Older than the new chunks, which may be written within the same microsecond.
+        m.partition().apply_delete(*schema, range_tombstone(std::move(first), bound_kind::incl_start, std::move(last), bound_kind::incl_end,
+            tombstone { api::new_timestamp() - 1, gc_clock::now() }));
+    }
+    for (auto&& e : r->data()._chunks) {
+        m.set_cell(clustering_key::from_single_value(*schema, long_type->decompose(e.first)), column, make_cell(schema, *column.type, e.second, r->ttl()));
+    }
+    return std::move(m);
+}
+
+mutation make_mutation(seastar::lw_shared_ptr<zset_score_mutation> r)
+{
+    auto schema = r->schema();
+    const column_definition& column = *schema->get_column_definition(redis::DATA_COLUMN_NAME);
+    auto pkey = partition_key::from_single_value(*schema, r->key());
+    auto m = mutation(schema, std::move(pkey));
+    auto make_ckey = [&schema] (const std::pair<double, bytes>& e) {
+        return clustering_key::from_exploded(*schema, std::vector<bytes> { double_type->decompose(e.first), e.second });
+    };
+    for (auto&& e : r->data()._dead_cells) {
+        m.set_cell(make_ckey(e), column, make_dead_cell());
+    }
+    for (auto&& e : r->data()._cells) {
+        m.set_cell(make_ckey(e), column, make_cell(schema, *column.type, bytes(), r->ttl()));
+    }
+    return std::move(m);
+}
+
 future<> write_mutation_impl(service::storage_proxy& proxy,
     std::vector<mutation>&& ms,
     db::consistency_level cl,
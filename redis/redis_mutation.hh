@@ -12,6 +12,7 @@
 #include "keys.hh"
 #include "timestamp.hh"
 #include "redis/redis_keyspace.hh"
+#include "redis/streams.hh"
 #include <unordered_map>
 
 using namespace seastar;
@@ -150,6 +151,67 @@ struct zset_dead_cells {
 using zset_mutation = redis_mutation<zset_cells>;
 using zset_dead_cells_mutation = redis_mutation<zset_dead_cells>;
 
+struct stream_cells {
+    std::vector<std::pair<stream_id, bytes>> _cells;
+    size_t size() const { return _cells.size(); }
+    stream_cells(std::vector<std::pair<stream_id, bytes>>&& cells) : _cells(std::move(cells)) {}
+};
+using stream_mutation = redis_mutation<stream_cells>;
+
+struct stream_dead_cells {
+    std::vector<stream_id> _ids;
+    size_t size() const { return _ids.size(); }
+    stream_dead_cells(std::vector<stream_id>&& ids) : _ids(std::move(ids)) {}
+};
+using stream_dead_cells_mutation = redis_mutation<stream_dead_cells>;
+
+// Removes all entries up to `_end` with a single range tombstone (XTRIM).
+struct stream_trimmed_range {
+    stream_id _end;
+    bool _inclusive;
+    stream_trimmed_range(stream_id end, bool inclusive) : _end(end), _inclusive(inclusive) {}
+};
+using stream_trim_mutation = redis_mutation<stream_trimmed_range>;
+
+// The pending entries of a consumer group, and optionally its last delivered ID.
+struct stream_group_cells {
+    bytes _group;
+    std::optional<stream_id> _last_delivered;
+    std::vector<std::pair<stream_id, bytes>> _pending;
+    stream_group_cells(bytes&& group, std::optional<stream_id> last_delivered, std::vector<std::pair<stream_id, bytes>>&& pending)
+        : _group(std::move(group)), _last_delivered(last_delivered), _pending(std::move(pending)) {}
+};
+using stream_group_mutation = redis_mutation<stream_group_cells>;
+
+// Acknowledged entries, or the whole group when `_ids` is empty.
+struct stream_group_dead_cells {
+    bytes _group;
+    std::vector<stream_id> _ids;
+    stream_group_dead_cells(bytes&& group, std::vector<stream_id>&& ids) : _group(std::move(group)), _ids(std::move(ids)) {}
+};
+using stream_group_dead_cells_mutation = redis_mutation<stream_group_dead_cells>;
+
+// Chunks of a bitmap. The previous chunks within `_replaced` are removed first (BITOP),
+// from the first index to the last one, or to the end without a last one.
+struct bitmap_chunks {
+    using replaced_range = std::pair<int64_t, std::optional<int64_t>>;
+    std::vector<std::pair<int64_t, bytes>> _chunks;
+    std::optional<replaced_range> _replaced;
+    size_t size() const { return _chunks.size(); }
+    bitmap_chunks(std::vector<std::pair<int64_t, bytes>>&& chunks, std::optional<replaced_range> replaced) : _chunks(std::move(chunks)), _replaced(std::move(replaced)) {}
+};
+using bitmap_mutation = redis_mutation<bitmap_chunks>;
+
+// Rows of the score index of a sorted set, (score, member).
+struct zset_score_cells {
+    std::vector<std::pair<double, bytes>> _cells;
+    std::vector<std::pair<double, bytes>> _dead_cells;
+    size_t size() const { return _cells.size() + _dead_cells.size(); }
+    zset_score_cells(std::vector<std::pair<double, bytes>>&& cells, std::vector<std::pair<double, bytes>>&& dead_cells)
+        : _cells(std::move(cells)), _dead_cells(std::move(dead_cells)) {}
+};
+using zset_score_mutation = redis_mutation<zset_score_cells>;
+
 static inline seastar::lw_shared_ptr<redis_mutation<bytes>> make_simple(const schema_ptr schema, const bytes& key, bytes&& data, long ttl = 0) {
     return seastar::make_lw_shared<redis_mutation<bytes>>(schema, key, std::move(data), ttl);
 }
@@ -216,6 +278,40 @@ static inline seastar::lw_shared_ptr<zset_dead_cells_mutation> make_zset_dead_ce
     return seastar::make_lw_shared<zset_dead_cells_mutation> (schema, key, std::move(zset_dead_cells (std::move(set_keys))));
 }
 
+static inline seastar::lw_shared_ptr<stream_mutation> make_stream_cells(const schema_ptr schema, const bytes& key, std::vector<std::pair<stream_id, bytes>>&& cells) {
+    return seastar::make_lw_shared<stream_mutation> (schema, key, std::move(stream_cells (std::move(cells))));
+}
+static inline seastar::lw_shared_ptr<stream_dead_cells_mutation> make_stream_dead_cells(const schema_ptr schema, const bytes& key, std::vector<stream_id>&& ids) {
+    return seastar::make_lw_shared<stream_dead_cells_mutation> (schema, key, std::move(stream_dead_cells (std::move(ids))));
+}
+static inline seastar::lw_shared_ptr<stream_trim_mutation> make_stream_trim(const schema_ptr schema, const bytes& key, stream_id end, bool inclusive) {
+    return seastar::make_lw_shared<stream_trim_mutation> (schema, key, std::move(stream_trimmed_range (end, inclusive)));
+}
+static inline seastar::lw_shared_ptr<stream_group_mutation> make_stream_group_cells(const schema_ptr schema,
+    const bytes& key,
+    bytes group,
+    std::optional<stream_id> last_delivered,
+    std::vector<std::pair<stream_id, bytes>>&& pending)
+{
+    return seastar::make_lw_shared<stream_group_mutation> (schema, key, std::move(stream_group_cells (std::move(group), last_delivered, std::move(pending))));
+}
+static inline seastar::lw_shared_ptr<stream_group_dead_cells_mutation> make_stream_group_dead_cells(const schema_ptr schema, const bytes& key, bytes group, std::vector<stream_id>&& ids) {
+    return seastar::make_lw_shared<stream_group_dead_cells_mutation> (schema, key, std::move(stream_group_dead_cells (std::move(group), std::move(ids))));
+}
+
+static inline seastar::lw_shared_ptr<bitmap_mutation> make_bitmap_chunks(const schema_ptr schema, const bytes& key, std::vector<std::pair<int64_t, bytes>>&& chunks,
+    std::optional<bitmap_chunks::replaced_range> replaced = std::nullopt) {
+    return seastar::make_lw_shared<bitmap_mutation> (schema, key, std::move(bitmap_chunks (std::move(chunks), std::move(replaced))));
+}
+
+static inline seastar::lw_shared_ptr<zset_score_mutation> make_zset_score_cells(const schema_ptr schema,
+    const bytes& key,
+    std::vector<std::pair<double, bytes>>&& cells,
+    std::vector<std::pair<double, bytes>>&& dead_cells, long ttl = 0)
+{
+    return seastar::make_lw_shared<zset_score_mutation> (schema, key, std::move(zset_score_cells (std::move(cells), std::move(dead_cells))), ttl);
+}
+
 namespace internal {
 mutation make_mutation(seastar::lw_shared_ptr<redis_mutation<bytes>> r);
 mutation make_mutation(seastar::lw_shared_ptr<redis_mutation<partition_dead_tag>> r);
@@ -231,6 +327,13 @@ mutation make_mutation(seastar::lw_shared_ptr<set_dead_cells_mutation> r);
 mutation make_mutation(seastar::lw_shared_ptr<zset_mutation> r);
 mutation make_mutation(seastar::lw_shared_ptr<zset_indexed_cells_mutation> r);
 mutation make_mutation(seastar::lw_shared_ptr<zset_dead_cells_mutation> r);
+mutation make_mutation(seastar::lw_shared_ptr<stream_mutation> r);
+mutation make_mutation(seastar::lw_shared_ptr<stream_dead_cells_mutation> r);
+mutation make_mutation(seastar::lw_shared_ptr<stream_trim_mutation> r);
+mutation make_mutation(seastar::lw_shared_ptr<stream_group_mutation> r);
+mutation make_mutation(seastar::lw_shared_ptr<stream_group_dead_cells_mutation> r);
+mutation make_mutation(seastar::lw_shared_ptr<bitmap_mutation> r);
+mutation make_mutation(seastar::lw_shared_ptr<zset_score_mutation> r);
 future<> write_mutation_impl(
     service::storage_proxy&,
     std::vector<mutation>&& ms,
@@ -252,6 +355,23 @@ future<> write_mutation(
     return internal::write_mutation_impl(proxy, std::vector<mutation> { std::move(internal::make_mutation(r)) }, cl ,timeout, client_state).finally([r] {});
 }
 
+// Writes two mutations of different tables atomically, e.g. a sorted set and its score index.
+template<typename ContainerType1, typename ContainerType2>
+future<> write_mutation(
+    service::storage_proxy& proxy,
+    seastar::lw_shared_ptr<redis_mutation<ContainerType1>> r1,
+    seastar::lw_shared_ptr<redis_mutation<ContainerType2>> r2,
+    db::consistency_level cl,
+    db::timeout_clock::time_point timeout,
+    service::client_state& client_state
+)
+{
+    std::vector<mutation> ms;
+    ms.emplace_back(internal::make_mutation(r1));
+    ms.emplace_back(internal::make_mutation(r2));
+    return internal::write_mutation_impl(proxy, std::move(ms), cl ,timeout, client_state).finally([r1, r2] {});
+}
+
 future<> write_mutations(
     service::storage_proxy& proxy,
     std::vector<seastar::lw_shared_ptr<redis_mutation<bytes>>> ms,
@@ -0,0 +1,653 @@
+#include "redis/replication.hh"
+#include "redis/client_tracking.hh"
+#include "redis/command_factory.hh"
+#include "redis/command_keys.hh"
+#include "redis/query_processor.hh"
+#include "redis/rdb.hh"
+#include "redis/reply.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "db/config.hh"
+#include "dht/i_partitioner.hh"
+#include "gms/inet_address.hh"
+#include "database.hh"
+#include "log.hh"
+#include "seastar/core/future-util.hh"
+#include "seastar/core/metrics.hh"
+#include "seastar/core/reactor.hh"
+#include "seastar/core/semaphore.hh"
+#include "seastar/core/thread.hh"
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <experimental/optional>
+#include <map>
+
+namespace redis {
+
+static logging::logger rlogger("replica");
+
+static constexpr auto retry_interval = std::chrono::seconds(1);
+static constexpr auto ack_interval = std::chrono::seconds(1);
+// The commands and the bytes of a batch of the replication stream.
+static constexpr size_t max_batch_commands = 512;
+static constexpr size_t max_batch_size = 1 << 20;
+// The mutations of a write of the full synchronization, and the writes in flight.
+static constexpr size_t rdb_write_mutations = 128;
+static constexpr size_t rdb_writes_in_flight = 16;
+
+namespace {
+
+// Reads a line or an array of bulk strings of the connection to the master,
+// the bytes following it are left to the stream. The empty lines, which the
+// master sends to keep the connection alive while it prepares the snapshot,
+// are skipped.
+class resp_parser {
+    enum class state {
+        line,
+        count,
+        length,
+        bulk,
+    };
+public:
+    using unconsumed_remainder = std::experimental::optional<temporary_buffer<char>>;
+private:
+    state _state;
+    bool _done;
+    sstring _line;
+    uint64_t _elements_left;
+    std::vector<bytes> _elements;
+    bytes _bulk;
+    size_t _bulk_pos;
+    // The bulk string and its CRLF.
+    size_t _bulk_left;
+    size_t _size;
+
+    static uint64_t parse_number(const sstring& line, size_t from) {
+        try {
+            return boost::lexical_cast<uint64_t>(line.substr(from));
+        } catch (boost::bad_lexical_cast&) {
+            throw std::runtime_error(sprint("protocol error, unexpected '%s' from the master", line));
+        }
+    }
+    // Takes the bytes of a line, returns whether the line is complete.
+    bool take_line(temporary_buffer<char>& buf) {
+        auto end = std::find(buf.begin(), buf.end(), '\n');
+        auto complete = end != buf.end();
+        size_t n = complete ? end - buf.begin() + 1 : buf.size();
+        _line += sstring(buf.get(), n);
+        _size += n;
+        buf.trim_front(n);
+        if (complete) {
+            _line.resize(_line.size() - (_line.size() >= 2 && _line[_line.size() - 2] == '\r' ? 2 : 1));
+        }
+        return complete;
+    }
+    void line_done() {
+        switch (_state) {
+        case state::line:
+            _done = !_line.empty();
+            break;
+        case state::count:
+            if (_line.empty()) {
+                break;
+            }
+            if (_line[0] != '*') {
+                throw std::runtime_error(sprint("protocol error, unexpected '%s' from the master", _line));
+            }
+            _elements_left = parse_number(_line, 1);
+            _elements.reserve(_elements_left);
+            _state = state::length;
+            _done = !_elements_left;
+            break;
+        case state::length: {
+            if (_line.empty() || _line[0] != '$') {
+                throw std::runtime_error(sprint("protocol error, unexpected '%s' from the master", _line));
+            }
+            auto len = parse_number(_line, 1);
+            _bulk = bytes(bytes::initialized_later(), len);
+            _bulk_pos = 0;
+            _bulk_left = len + 2;
+            _state = state::bulk;
+            break;
+        }
+        case state::bulk:
+            break;
+        }
+    }
+public:
+    void init_line() {
+        _state = state::line;
+        _done = false;
+        _line = {};
+        _size = 0;
+    }
+    void init_array() {
+        init_line();
+        _state = state::count;
+        _elements.clear();
+    }
+    future<unconsumed_remainder> operator()(temporary_buffer<char> buf) {
+        if (buf.empty()) {
+            // The end of the stream.
+            return make_ready_future<unconsumed_remainder>(std::move(buf));
+        }
+        while (!buf.empty()) {
+            if (_state != state::bulk) {
+                if (!take_line(buf)) {
+                    continue;
+                }
+                line_done();
+                _line = {};
+            } else {
+                auto n = std::min(buf.size(), _bulk_left);
+                auto data = std::min(n, _bulk.size() - _bulk_pos);
+                std::copy_n(buf.get(), data, _bulk.begin() + _bulk_pos);
+                _bulk_pos += data;
+                _bulk_left -= n;
+                _size += n;
+                buf.trim_front(n);
+                if (!_bulk_left) {
+                    _elements.emplace_back(std::move(_bulk));
+                    _state = state::length;
+                    _done = !--_elements_left;
+                }
+            }
+            if (_done) {
+                return make_ready_future<unconsumed_remainder>(std::move(buf));
+            }
+        }
+        return make_ready_future<unconsumed_remainder>();
+    }
+    bool done() const {
+        return _done;
+    }
+    // The line read, in the line state.
+    const sstring& line() const {
+        return _line;
+    }
+    std::vector<bytes>& elements() {
+        return _elements;
+    }
+    // The bytes read, the empty lines included.
+    size_t size() const {
+        return _size;
+    }
+};
+
+sstring make_command(std::initializer_list<sstring> args)
+{
+    auto cmd = sprint("*%d\r\n", args.size());
+    for (auto& a : args) {
+        cmd += sprint("$%d\r\n", a.size()) + a + "\r\n";
+    }
+    return cmd;
+}
+
+sstring to_sstring(const bytes& b)
+{
+    return sstring(reinterpret_cast<const char*>(b.data()), b.size());
+}
+
+// Applies a command of the stream on this shard, returns whether it failed.
+future<bool> apply_command(query_processor& qp, sstring keyspace, timeout_config tc, request&& req)
+{
+    auto written = command_keys::written_keys(req);
+    auto cs = make_lw_shared<service::client_state>(service::client_state::internal_tag{});
+    cs->set_raw_keyspace(std::move(keyspace));
+    return do_with(std::move(tc), [&qp, cs, req = std::move(req)] (auto& tc) mutable {
+        return qp.process(std::move(req), *cs, tc);
+    }).then_wrapped([cs] (future<redis_message> f) {
+        auto failed = f.failed();
+        if (failed) {
+            rlogger.debug("A replicated command failed: {}", f.get_exception());
+        }
+        return failed;
+    }).then([written = std::move(written)] (bool failed) mutable {
+        return invalidate_tracked_keys(std::move(written), std::nullopt).then([failed] {
+            return failed;
+        });
+    });
+}
+
+}
+
+replica::replica(service::storage_proxy& proxy, const db::config& cfg)
+    : _proxy(proxy)
+    , _timeout_config(make_timeout_config(cfg))
+    , _masterauth(cfg.redis_masterauth())
+    , _listening_port(cfg.redis_transport_port())
+    , _keyspace(keyspace_of_db(0))
+    , _ack_timer([this] { send_ack(); })
+{
+    namespace sm = seastar::metrics;
+    _metrics.add_group("redis", {
+        sm::make_gauge("replica_link_up", [this] { return _link_up ? 1 : 0; },
+                       sm::description("Holds 1 when the node replicates a master (REPLICAOF) and is connected to it.")),
+        sm::make_gauge("replica_sync_in_progress", [this] { return _sync_in_progress ? 1 : 0; },
+                       sm::description("Holds 1 while the snapshot of the master is loaded.")),
+        sm::make_gauge("replica_received_offset", [this] { return _received_offset; },
+                       sm::description("Holds the offset of the replication stream of the master received.")),
+        sm::make_gauge("replica_applied_offset", [this] { return _applied_offset; },
+                       sm::description("Holds the offset of the replication stream of the master applied.")),
+        sm::make_gauge("replica_lag_bytes", [this] { return _received_offset - _applied_offset; },
+                       sm::description("Holds the bytes of the replication stream received and not applied yet.")),
+        sm::make_gauge("replica_lag_seconds", [this] { return get_status()._lag.count(); },
+                       sm::description("Holds the seconds since the commands received from the master were all applied.")),
+        sm::make_gauge("replica_last_io_seconds", [this] { return get_status()._last_io.count(); },
+                       sm::description("Holds the seconds since the last bytes received from the master.")),
+        sm::make_derive("replica_full_syncs", [this] { return _stats._full_syncs; },
+                        sm::description("Counts the full synchronizations with the master.")),
+        sm::make_derive("replica_partial_syncs", [this] { return _stats._partial_syncs; },
+                        sm::description("Counts the replications resumed from the backlog of the master.")),
+        sm::make_derive("replica_rdb_keys", [this] { return _stats._rdb_keys; },
+                        sm::description("Counts the keys of the snapshots of the master loaded.")),
+        sm::make_derive("replica_commands", [this] { return _stats._commands; },
+                        sm::description("Counts the commands of the replication stream applied.")),
+        sm::make_derive("replica_command_failures", [this] { return _stats._command_failures; },
+                        sm::description("Counts the commands of the replication stream failed with an exception.")),
+    });
+}
+
+future<> replica::start(sstring host, uint16_t port)
+{
+    auto master = std::make_pair(std::move(host), port);
+    auto same_master = _master == master;
+    return stop().then([this, master = std::move(master), same_master] () mutable {
+        if (!same_master) {
+            // The offsets of another master are meaningless.
+            _replid = {};
+            _received_offset = _applied_offset = 0;
+        }
+        _master = std::move(master);
+        _stopping = false;
+        _done = seastar::async([this] {
+            replicate();
+        });
+        rlogger.info("Replicating the master {}:{}", _master->first, _master->second);
+    });
+}
+
+future<> replica::stop()
+{
+    if (!_done) {
+        return make_ready_future<>();
+    }
+    _stopping = true;
+    _retry.signal();
+    if (_socket) {
+        _socket->shutdown_input();
+        _socket->shutdown_output();
+    }
+    auto done = std::move(*_done);
+    _done = {};
+    return done.then([this] {
+        rlogger.info("Stopped replicating the master {}:{}", _master->first, _master->second);
+        _master = {};
+    });
+}
+
+replica::status replica::get_status() const
+{
+    auto now = clock::now();
+    status s;
+    s._master = _master;
+    s._link_up = _link_up;
+    s._sync_in_progress = _sync_in_progress;
+    s._replid = _replid;
+    s._received_offset = _received_offset;
+    s._applied_offset = _applied_offset;
+    s._last_io = _link_up ? std::chrono::duration_cast<std::chrono::seconds>(now - _last_io) : std::chrono::seconds(0);
+    s._lag = _link_up && _applied_offset < _received_offset ? std::chrono::duration_cast<std::chrono::seconds>(now - _caught_up) : std::chrono::seconds(0);
+    return s;
+}
+
+void replica::replicate()
+{
+    while (!_stopping) {
+        try {
+            sync();
+        } catch (...) {
+            if (!_stopping) {
+                rlogger.warn("Replication of the master {}:{} failed: {}, retrying", _master->first, _master->second, std::current_exception());
+            }
+        }
+        _link_up = false;
+        _sync_in_progress = false;
+        if (_stopping) {
+            break;
+        }
+        try {
+            _retry.wait(retry_interval).get();
+        } catch (condition_variable_timed_out&) {
+        }
+    }
+}
+
+void send_command(output_stream<char>& out, std::initializer_list<sstring> args)
+{
+    out.write(make_command(args)).get();
+    out.flush().get();
+}
+
+sstring read_reply(input_stream<char>& in)
+{
+    resp_parser parser;
+    parser.init_line();
+    in.consume(parser).get();
+    if (!parser.done()) {
+        throw std::runtime_error("connection closed by the server");
+    }
+    return parser.line();
+}
+
+void replica::sync()
+{
+    auto addr = gms::inet_address::lookup(_master->first).get0();
+    _socket = engine().net().connect(make_ipv4_address(ipv4_addr(addr.raw_addr(), _master->second))).get0();
+    auto in = _socket->input();
+    auto out = _socket->output();
+    auto close = [this, &in, &out] {
+        _ack_timer.cancel();
+        _out = nullptr;
+        _writes.handle_exception([] (auto ep) {}).get();
+        _writes = make_ready_future<>();
+        out.close().handle_exception([] (auto ep) {}).get();
+        in.close().handle_exception([] (auto ep) {}).get();
+        _socket = {};
+    };
+    try {
+        if (!_masterauth.empty()) {
+            send_command(out, { "AUTH", _masterauth });
+            auto reply = read_reply(in);
+            if (reply[0] == '-') {
+                throw std::runtime_error(sprint("AUTH failed: %s", reply));
+            }
+        }
+        send_command(out, { "PING" });
+        auto pong = read_reply(in);
+        if (pong[0] == '-') {
+            throw std::runtime_error(sprint("PING failed: %s", pong));
+        }
+        // The master may not know them, as Redis, the replication goes on.
+        send_command(out, { "REPLCONF", "listening-port", sprint("%d", _listening_port) });
+        read_reply(in);
+        send_command(out, { "REPLCONF", "capa", "eof", "capa", "psync2" });
+        read_reply(in);
+        send_command(out, { "PSYNC", _replid.empty() ? sstring("?") : _replid, sprint("%d", _replid.empty() ? -1 : _applied_offset + 1) });
+        auto reply = read_reply(in);
+        _last_io = clock::now();
+        if (reply.find("+FULLRESYNC ") == 0) {
+            std::vector<sstring> words;
+            boost::split(words, reply, boost::is_any_of(" "));
+            if (words.size() != 3) {
+                throw std::runtime_error(sprint("unexpected PSYNC reply: %s", reply));
+            }
+            full_sync(in, words[1], boost::lexical_cast<int64_t>(words[2]));
+        } else if (reply.find("+CONTINUE") == 0) {
+            // The master may continue under a new replication ID.
+            if (reply.size() > 10) {
+                _replid = reply.substr(10);
+            }
+            _received_offset = _applied_offset;
+            ++_stats._partial_syncs;
+            rlogger.info("Resumed the replication of the master {}:{} from the offset {}", _master->first, _master->second, _applied_offset);
+        } else {
+            throw std::runtime_error(sprint("PSYNC failed: %s", reply));
+        }
+        _out = &out;
+        _ack_timer.arm_periodic(ack_interval);
+        stream(in);
+    } catch (...) {
+        // The commands read are applied before the replication is resumed.
+        try {
+            wait_applied();
+        } catch (...) {
+        }
+        close();
+        throw;
+    }
+    close();
+}
+
+// The snapshot is read as it comes, its keys are written by batches of
+// mutations, the previous keys are not removed.
+void replica::full_sync(input_stream<char>& in, sstring replid, int64_t offset)
+{
+    _sync_in_progress = true;
+    ++_stats._full_syncs;
+    auto header = read_reply(in);
+    if (header[0] != '$') {
+        throw std::runtime_error(sprint("unexpected snapshot header: %s", header));
+    }
+    // Without a disk, the master ends the snapshot with a mark instead of
+    // giving its size first.
+    std::optional<sstring> eof_mark;
+    if (header.find("$EOF:") == 0) {
+        eof_mark = header.substr(5);
+    }
+    rlogger.info("Loading the snapshot of the master {}:{}", _master->first, _master->second);
+    semaphore writes(rdb_writes_in_flight);
+    std::exception_ptr failure;
+    std::vector<mutation> ms;
+    auto& db = _proxy.get_db().local();
+    auto flush = [this, &writes, &failure, &ms] {
+        if (ms.empty()) {
+            return;
+        }
+        auto units = get_units(writes, 1).get0();
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        auto timeout = db::timeout_clock::now() + _timeout_config.write_timeout;
+        _proxy.mutate(std::move(ms), db::consistency_level::LOCAL_ONE, timeout, nullptr).then_wrapped([&failure, units = std::move(units)] (future<> f) {
+            if (f.failed()) {
+                failure = f.get_exception();
+            }
+        });
+        ms = {};
+    };
+    uint64_t keys = 0;
+    rdb_reader reader(in);
+    reader.start();
+    while (auto e = reader.next()) {
+        _last_io = clock::now();
+        auto keyspace = keyspace_of_db(e->_db);
+        auto ttl = ttl_of(*e);
+        if (!ttl || !db.has_keyspace(keyspace)) {
+            continue;
+        }
+        for (auto& m : make_rdb_mutations(get_local_query_processor().schemas_of(keyspace), std::move(*e), *ttl)) {
+            ms.emplace_back(std::move(m));
+        }
+        ++keys;
+        if (ms.size() >= rdb_write_mutations) {
+            flush();
+        }
+        if (need_preempt()) {
+            seastar::thread::yield();
+        }
+    }
+    if (eof_mark) {
+        auto mark = in.read_exactly(eof_mark->size()).get0();
+        if (sstring(mark.get(), mark.size()) != *eof_mark) {
+            throw std::runtime_error("the snapshot does not end with its mark");
+        }
+    }
+    flush();
+    writes.wait(rdb_writes_in_flight).get();
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    // The values cached before the snapshot are stale.
+    get_query_processor().invoke_on_all([] (auto& qp) {
+        qp.get_near_cache().invalidate_all();
+        qp.get_client_tracking().invalidate_all();
+    }).get();
+    _stats._rdb_keys += keys;
+    _replid = std::move(replid);
+    _received_offset = _applied_offset = offset;
+    _sync_in_progress = false;
+    rlogger.info("Loaded {} keys of the snapshot of the master {}:{}, replicating from the offset {}", keys, _master->first, _master->second, offset);
+}
+
+void replica::stream(input_stream<char>& in)
+{
+    _link_up = true;
+    _caught_up = clock::now();
+    _keyspace = keyspace_of_db(0);
+    resp_parser parser;
+    while (true) {
+        parser.init_array();
+        auto f = in.consume(parser);
+        // The batch read is applied while waiting for the next commands.
+        if (!f.available() && _batch._commands) {
+            apply_batch();
+        }
+        f.get();
+        if (!parser.done()) {
+            throw std::runtime_error("connection closed by the master");
+        }
+        _last_io = clock::now();
+        process(std::move(parser.elements()), parser.size());
+    }
+}
+
+void replica::process(std::vector<bytes>&& args, size_t size)
+{
+    auto start = _received_offset;
+    _received_offset += size;
+    if (args.empty()) {
+        return;
+    }
+    request req { protocol_state::ok, std::move(args[0]), uint32_t(args.size() - 1), {} };
+    std::transform(req._command.begin(), req._command.end(), req._command.begin(), ::tolower);
+    req._code = command_factory::code_of(req._command);
+    std::move(args.begin() + 1, args.end(), std::back_inserter(req._args));
+    auto& cmd = req._command;
+    if (cmd == "ping" || cmd == "multi" || cmd == "exec") {
+        // The commands of a transaction are applied as they come.
+        if (!_batch._commands && !_applying) {
+            _applied_offset = _received_offset;
+        }
+        return;
+    }
+    if (cmd == "replconf") {
+        if (!req._args.empty() && to_sstring(req._args[0]) == "getack") {
+            // The offset acknowledged is the one of the commands before.
+            wait_applied();
+            _applied_offset = start;
+            send_ack();
+        }
+        _applied_offset = _received_offset;
+        return;
+    }
+    if (cmd == "select") {
+        wait_applied();
+        _keyspace = req._args.empty() ? keyspace_of_db(0) : keyspace_of_db(boost::lexical_cast<uint64_t>(to_sstring(req._args[0])));
+        _applied_offset = _received_offset;
+        return;
+    }
+    auto keys = command_keys::written_keys(req);
+    if (keys.size() != 1) {
+        wait_applied();
+        auto failed = apply_command(get_local_query_processor(), _keyspace, _timeout_config, std::move(req)).get0();
+        ++_stats._commands;
+        _stats._command_failures += failed;
+        _applied_offset = _received_offset;
+        _caught_up = clock::now();
+        return;
+    }
+    _batch._size += size;
+    ++_batch._commands;
+    _batch._keys[std::move(keys.front())].emplace_back(std::move(req));
+    if (_batch._commands >= max_batch_commands || _batch._size >= max_batch_size) {
+        apply_batch();
+    }
+}
+
+unsigned replica::shard_of(const bytes& key)
+{
+    if (!_proxy.get_db().local().has_keyspace(_keyspace)) {
+        return engine().cpu_id();
+    }
+    auto& s = *get_local_query_processor().schemas_of(_keyspace)._strings;
+    auto token = dht::global_partitioner().get_token(s, partition_key::from_single_value(s, key));
+    return dht::global_partitioner().shard_of(token);
+}
+
+// The batch is applied once the previous one was, so that the commands of a
+// key in both are applied in order.
+void replica::apply_batch()
+{
+    if (_applying) {
+        auto f = std::move(*_applying);
+        _applying = {};
+        f.get();
+    }
+    auto b = std::move(_batch);
+    _batch = {};
+    auto end = _received_offset;
+    _applying = apply(std::move(b)).then([this, end] {
+        _applied_offset = end;
+        if (_applied_offset == _received_offset) {
+            _caught_up = clock::now();
+        }
+    });
+}
+
+void replica::wait_applied()
+{
+    if (_batch._commands) {
+        apply_batch();
+    }
+    if (_applying) {
+        auto f = std::move(*_applying);
+        _applying = {};
+        f.get();
+    }
+}
+
+future<> replica::apply(batch&& b)
+{
+    std::map<unsigned, std::vector<std::vector<request>>> by_shard;
+    for (auto& k : b._keys) {
+        by_shard[shard_of(k.first)].emplace_back(std::move(k.second));
+    }
+    auto commands = b._commands;
+    return do_with(std::move(by_shard), [this] (auto& by_shard) {
+        return map_reduce(by_shard.begin(), by_shard.end(), [keyspace = _keyspace, tc = _timeout_config] (auto& s) {
+            return get_query_processor().invoke_on(s.first, [keyspace, tc, keys = std::move(s.second)] (query_processor& qp) mutable {
+                return do_with(std::move(keys), uint64_t(0), [&qp, keyspace, tc] (auto& keys, auto& failures) {
+                    return parallel_for_each(keys, [&qp, keyspace, tc, &failures] (auto& commands) {
+                        return do_for_each(commands, [&qp, keyspace, tc, &failures] (request& req) {
+                            return apply_command(qp, keyspace, tc, std::move(req)).then([&failures] (bool failed) {
+                                failures += failed;
+                            });
+                        });
+                    }).then([&failures] {
+                        return failures;
+                    });
+                });
+            });
+        }, uint64_t(0), std::plus<uint64_t>());
+    }).then([this, commands] (uint64_t failures) {
+        _stats._commands += commands;
+        _stats._command_failures += failures;
+    });
+}
+
+void replica::send_ack()
+{
+    if (!_out) {
+        return;
+    }
+    _writes = _writes.then([out = _out, cmd = make_command({ "REPLCONF", "ACK", sprint("%d", _applied_offset) })] {
+        return out->write(cmd).then([out] {
+            return out->flush();
+        });
+    }).handle_exception([] (auto ep) {
+        rlogger.debug("Failed to acknowledge the offset to the master: {}", ep);
+    });
+}
+
+}
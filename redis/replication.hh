@@ -0,0 +1,126 @@
+#pragma once
+#include "bytes.hh"
+#include "redis/request.hh"
+#include "timeout_config.hh"
+#include "seastar/core/condition-variable.hh"
+#include "seastar/core/future.hh"
+#include "seastar/core/iostream.hh"
+#include "seastar/core/metrics_registration.hh"
+#include "seastar/core/sstring.hh"
+#include "seastar/core/timer.hh"
+#include "seastar/net/api.hh"
+#include <chrono>
+#include <initializer_list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+using namespace seastar;
+
+namespace db {
+class config;
+}
+
+namespace service {
+class storage_proxy;
+}
+
+namespace redis {
+
+// A client of another Redis server, in a thread: sends a command, and reads a
+// reply of a line (a status, an error or an integer).
+void send_command(output_stream<char>& out, std::initializer_list<sstring> args);
+sstring read_reply(input_stream<char>& in);
+
+// REPLICAOF, the node replicates an upstream Redis master to migrate its data
+// with no downtime. It connects to the master like a replica: the RDB snapshot
+// of the full synchronization is written as mutations, then the commands of
+// the replication stream are applied through the command layer as they come.
+// On a reconnection, the replication resumes from the offset applied if the
+// master still has it in its backlog.
+//
+// The commands are applied in batches, read while the previous batch is
+// applied. The commands of a batch are grouped by key and sent to the shards
+// owning the keys, the keys are applied concurrently and the commands of a key
+// in order. A command of several keys, or of none, is applied alone once the
+// previous ones were.
+//
+// Lives on shard 0.
+class replica {
+public:
+    struct status {
+        std::optional<std::pair<sstring, uint16_t>> _master;
+        bool _link_up = false;
+        bool _sync_in_progress = false;
+        sstring _replid;
+        int64_t _received_offset = 0;
+        int64_t _applied_offset = 0;
+        // Since the last bytes received from the master.
+        std::chrono::seconds _last_io;
+        // Since the commands received were all applied.
+        std::chrono::seconds _lag;
+    };
+    struct stats {
+        uint64_t _full_syncs = 0;
+        uint64_t _partial_syncs = 0;
+        uint64_t _rdb_keys = 0;
+        uint64_t _commands = 0;
+        uint64_t _command_failures = 0;
+    };
+private:
+    using clock = std::chrono::steady_clock;
+    // The commands of a batch by key, in the order of the stream.
+    struct batch {
+        std::unordered_map<bytes, std::vector<request>> _keys;
+        size_t _commands = 0;
+        size_t _size = 0;
+    };
+    service::storage_proxy& _proxy;
+    timeout_config _timeout_config;
+    sstring _masterauth;
+    uint16_t _listening_port;
+    std::optional<std::pair<sstring, uint16_t>> _master;
+    bool _stopping = false;
+    std::optional<future<>> _done;
+    condition_variable _retry;
+    std::optional<connected_socket> _socket;
+    // The replication of the master, the offsets are the ones of its stream.
+    sstring _replid;
+    int64_t _received_offset = 0;
+    int64_t _applied_offset = 0;
+    bool _link_up = false;
+    bool _sync_in_progress = false;
+    clock::time_point _last_io;
+    clock::time_point _caught_up;
+    // The keyspace of the database selected by the stream.
+    sstring _keyspace;
+    batch _batch;
+    std::optional<future<>> _applying;
+    output_stream<char>* _out = nullptr;
+    future<> _writes = make_ready_future<>();
+    timer<> _ack_timer;
+    stats _stats;
+    seastar::metrics::metric_groups _metrics;
+private:
+    void replicate();
+    void sync();
+    void full_sync(input_stream<char>& in, sstring replid, int64_t offset);
+    void stream(input_stream<char>& in);
+    void process(std::vector<bytes>&& args, size_t size);
+    void apply_batch();
+    void wait_applied();
+    future<> apply(batch&& b);
+    void send_ack();
+    unsigned shard_of(const bytes& key);
+public:
+    replica(service::storage_proxy& proxy, const db::config& cfg);
+    // Replicates the master, after stopping the replication of the previous one.
+    future<> start(sstring host, uint16_t port);
+    // REPLICAOF NO ONE, the keys replicated are kept.
+    future<> stop();
+    status get_status() const;
+    const stats& get_stats() const {
+        return _stats;
+    }
+};
+
+}
@@ -1,4 +1,7 @@
 #include "reply.hh"
+#include <cmath>
+#include <cstring>
+#include <map>
 namespace redis {
 future<redis_message> redis_message::make_list_bytes(map_return_type r, size_t begin, size_t end) {
     auto m = make_lw_shared<scattered_message<char>> ();
@@ -49,16 +52,29 @@ future<redis_message> redis_message::make_map_val_bytes(map_return_type r) {
     return make_ready_future<redis_message>(m);
 }
 
-future<redis_message> redis_message::make_map_bytes(map_return_type r) {
-    auto m = make_lw_shared<scattered_message<char>> ();
-    auto& data = r->data();
-    m->append(sstring(sprint("*%d\r\n", 2 * data.size())));
-    for (size_t i = 0; i < data.size(); ++i) {
-        write_bytes(m, *(data[i].first));
-        write_bytes(m, *(data[i].second));
+future<foreign_ptr<std::unique_ptr<redis_message>>> redis_message::next_page() {
+    return _stream->next().then([] (std::optional<redis_message> page) {
+        if (!page) {
+            return foreign_ptr<std::unique_ptr<redis_message>>();
+        }
+        return make_foreign(std::make_unique<redis_message>(std::move(*page)));
+    });
+}
+
+future<redis_message> redis_message::make_double(double d, int protocol_version) {
+    reply_writer w(protocol_version);
+    w.write_double(d);
+    return w.done();
+}
+
+void reply_writer::write_double(double d) {
+    // The same digits as the scores stored, see double2bytes().
+    auto s = std::isinf(d) ? sstring(d > 0 ? "inf" : "-inf") : sstring(sprint("%lf", d));
+    if (resp3()) {
+        _m->append(sstring(sprint(",%s\r\n", s)));
+    } else {
+        _m->append(sstring(sprint("$%d\r\n%s\r\n", s.size(), s)));
     }
-    m->on_delete([ r = std::move(foreign_ptr { r }) ] {});
-    return make_ready_future<redis_message>(m);
 }
 
 future<redis_message> redis_message::make_set_bytes(map_return_type r, size_t index) {
@@ -82,7 +98,11 @@ future<redis_message> redis_message::make_zset_bytes(lw_shared_ptr<std::vector<s
     auto m = make_lw_shared<scattered_message<char>> ();
     m->append(sstring(sprint("*%d\r\n", r->size())));
     for (auto& e : *r) {
-        write_bytes(m, *e);
+        if (e) {
+            write_bytes(m, *e);
+        } else {
+            m->append_static("$-1\r\n");
+        }
     }
     m->on_delete([ r = std::move(foreign_ptr { r }) ] {});
     return make_ready_future<redis_message>(m);
@@ -97,4 +117,243 @@ future<redis_message> redis_message::make_mbytes(mbytes_return_type r) {
     m->on_delete([ r = std::move(foreign_ptr { r }) ] {});
     return make_ready_future<redis_message>(m);
 }
+
+void redis_message::write_stream_entries(lw_shared_ptr<scattered_message<char>> m, std::vector<std::pair<redis::stream_id, std::vector<bytes>>>& entries) {
+    m->append(sstring(sprint("*%d\r\n", entries.size())));
+    for (auto& e : entries) {
+        m->append_static("*2\r\n");
+        auto id = e.first.to_bytes();
+        m->append(sstring(sprint("$%d\r\n", id.size())));
+        m->append(sstring(reinterpret_cast<const char*>(id.data()), id.size()));
+        m->append_static("\r\n");
+        m->append(sstring(sprint("*%d\r\n", e.second.size())));
+        for (auto& f : e.second) {
+            write_bytes(m, f);
+        }
+    }
+}
+
+future<redis_message> redis_message::make_stream_entries(stream_return_type r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    write_stream_entries(m, r->data());
+    m->on_delete([ r = std::move(foreign_ptr { r }) ] {});
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_stream_read(lw_shared_ptr<std::vector<std::pair<bytes, stream_return_type>>> r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    m->append(sstring(sprint("*%d\r\n", r->size())));
+    for (auto& e : *r) {
+        m->append_static("*2\r\n");
+        write_bytes(m, e.first);
+        write_stream_entries(m, e.second->data());
+    }
+    m->on_delete([ r = std::move(foreign_ptr { r }) ] {});
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_stream_pending_summary(stream_group_return_type r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    std::map<bytes, long> consumers;
+    std::optional<redis::stream_id> min, max;
+    long total = 0;
+    for (auto& e : r->data()) {
+        if (e.first == redis::stream_id::group_metadata()) {
+            continue;
+        }
+        if (!min) {
+            min = e.first;
+        }
+        max = e.first;
+        ++consumers[e.second];
+        ++total;
+    }
+    m->append_static("*4\r\n");
+    m->append(sstring(sprint(":%ld\r\n", total)));
+    if (total == 0) {
+        m->append_static("$-1\r\n$-1\r\n*-1\r\n");
+        return make_ready_future<redis_message>(m);
+    }
+    auto min_id = min->to_bytes();
+    auto max_id = max->to_bytes();
+    m->append(sstring(sprint("$%d\r\n", min_id.size())));
+    m->append(sstring(reinterpret_cast<const char*>(min_id.data()), min_id.size()));
+    m->append_static("\r\n");
+    m->append(sstring(sprint("$%d\r\n", max_id.size())));
+    m->append(sstring(reinterpret_cast<const char*>(max_id.data()), max_id.size()));
+    m->append_static("\r\n");
+    m->append(sstring(sprint("*%d\r\n", consumers.size())));
+    for (auto& c : consumers) {
+        m->append_static("*2\r\n");
+        m->append(sstring(sprint("$%d\r\n", c.first.size())));
+        m->append(sstring(reinterpret_cast<const char*>(c.first.data()), c.first.size()));
+        m->append_static("\r\n");
+        auto count = sprint("%ld", c.second);
+        m->append(sstring(sprint("$%d\r\n", count.size())));
+        m->append(sstring(count));
+        m->append_static("\r\n");
+    }
+    return make_ready_future<redis_message>(m);
+}
+
+static void write_coordinates(lw_shared_ptr<scattered_message<char>> m, double lon, double lat) {
+    auto lon_str = sprint("%.17g", lon);
+    auto lat_str = sprint("%.17g", lat);
+    m->append(sstring(sprint("*2\r\n$%d\r\n%s\r\n$%d\r\n%s\r\n", lon_str.size(), lon_str, lat_str.size(), lat_str)));
+}
+
+future<redis_message> redis_message::make_geo_positions(const std::vector<std::optional<std::pair<double, double>>>& r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    m->append(sstring(sprint("*%d\r\n", r.size())));
+    for (auto& e : r) {
+        if (e) {
+            write_coordinates(m, e->first, e->second);
+        } else {
+            m->append_static("*-1\r\n");
+        }
+    }
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_geo_matches(lw_shared_ptr<std::vector<geo::match>> r, bool with_coord, bool with_dist, bool with_hash, double unit) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    auto fields = 1 + (with_coord ? 1 : 0) + (with_dist ? 1 : 0) + (with_hash ? 1 : 0);
+    m->append(sstring(sprint("*%d\r\n", r->size())));
+    for (auto& e : *r) {
+        if (fields == 1) {
+            write_bytes(m, e._member);
+            continue;
+        }
+        m->append(sstring(sprint("*%d\r\n", fields)));
+        write_bytes(m, e._member);
+        if (with_dist) {
+            auto d = sprint("%.4f", e._distance / unit);
+            m->append(sstring(sprint("$%d\r\n%s\r\n", d.size(), d)));
+        }
+        if (with_hash) {
+            m->append(sstring(sprint(":%ld\r\n", static_cast<long>(e._hash))));
+        }
+        if (with_coord) {
+            write_coordinates(m, e._lon, e._lat);
+        }
+    }
+    m->on_delete([ r = std::move(foreign_ptr { r }) ] {});
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_slowlog_entries(lw_shared_ptr<std::vector<slowlog_entry>> r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    m->append(sstring(sprint("*%d\r\n", r->size())));
+    for (auto& e : *r) {
+        m->append(sstring(sprint("*7\r\n:%ld\r\n:%ld\r\n:%ld\r\n", e._id, e._timestamp / 1000000, e._duration.count())));
+        m->append(sstring(sprint("*%d\r\n", e._args.size())));
+        for (auto& arg : e._args) {
+            write_bytes(m, arg);
+        }
+        m->append(sstring(sprint("$%d\r\n%s\r\n$0\r\n\r\n", e._client.size(), e._client)));
+        m->append(sstring(sprint("*8\r\n$5\r\nshard\r\n:%d\r\n$7\r\nprepare\r\n:%ld\r\n$7\r\nexecute\r\n:%ld\r\n$7\r\nsession\r\n",
+            e._shard, e._prepare.count(), e._execute.count())));
+        if (e._session_id) {
+            auto session = e._session_id->to_sstring();
+            m->append(sstring(sprint("$%d\r\n%s\r\n", session.size(), session)));
+        } else {
+            m->append_static("$-1\r\n");
+        }
+    }
+    m->on_delete([ r = std::move(foreign_ptr { r }) ] {});
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_latency_latest(lw_shared_ptr<std::vector<std::tuple<sstring, int64_t, uint32_t, uint32_t>>> r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    m->append(sstring(sprint("*%d\r\n", r->size())));
+    for (auto& e : *r) {
+        auto& name = std::get<0>(e);
+        m->append(sstring(sprint("*4\r\n$%d\r\n%s\r\n:%ld\r\n:%d\r\n:%d\r\n", name.size(), name, std::get<1>(e), std::get<2>(e), std::get<3>(e))));
+    }
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_latency_history(lw_shared_ptr<std::vector<latency_monitor::sample>> r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    m->append(sstring(sprint("*%d\r\n", r->size())));
+    for (auto& e : *r) {
+        m->append(sstring(sprint("*2\r\n:%ld\r\n:%d\r\n", e._timestamp, e._latency)));
+    }
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_hot_keys(lw_shared_ptr<std::vector<hot_keys::entry>> r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    m->append(sstring(sprint("*%d\r\n", r->size() * 2)));
+    for (auto& e : *r) {
+        write_bytes(m, e._key);
+        m->append(sstring(sprint(":%ld\r\n", e._count)));
+    }
+    m->on_delete([ r = std::move(foreign_ptr { r }) ] {});
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_big_keys(lw_shared_ptr<std::vector<big_key>> r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    m->append(sstring(sprint("*%d\r\n", r->size())));
+    for (auto& k : *r) {
+        m->append(sstring(sprint("*4\r\n$%d\r\n%s\r\n:%d\r\n", k._type.size(), k._type, k._db)));
+        write_bytes(m, k._key);
+        m->append(sstring(sprint(":%d\r\n", k._bytes)));
+    }
+    m->on_delete([ r = std::move(foreign_ptr { r }) ] {});
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_slots(lw_shared_ptr<std::vector<slot_range>> r) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    m->append(sstring(sprint("*%d\r\n", r->size())));
+    for (auto& range : *r) {
+        m->append(sstring(sprint("*%d\r\n:%d\r\n:%d\r\n", 2 + range._replicas.size(), range._first, range._last)));
+        for (auto& node : range._replicas) {
+            m->append(sstring(sprint("*3\r\n$%d\r\n%s\r\n:%d\r\n$%d\r\n%s\r\n",
+                node._address.size(), node._address, node._port, node._id.size(), node._id)));
+        }
+    }
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_invalidation(lw_shared_ptr<std::vector<bytes>> keys) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    m->append_static(">2\r\n$10\r\ninvalidate\r\n");
+    if (keys->empty()) {
+        m->append_static("_\r\n");
+    } else {
+        m->append(sstring(sprint("*%d\r\n", keys->size())));
+        for (auto& k : *keys) {
+            write_bytes(m, k);
+        }
+    }
+    m->on_delete([ keys = std::move(foreign_ptr { keys }) ] {});
+    return make_ready_future<redis_message>(m);
+}
+
+future<redis_message> redis_message::make_hello(int protocol_version, uint64_t id, const sstring& version) {
+    auto m = make_lw_shared<scattered_message<char>> ();
+    auto field = [m] (const char* name) {
+        m->append(sstring(sprint("$%d\r\n%s\r\n", std::strlen(name), name)));
+    };
+    m->append(sstring(protocol_version == 3 ? "%7\r\n" : "*14\r\n"));
+    field("server");
+    field("redis");
+    field("version");
+    m->append(sstring(sprint("$%d\r\n%s\r\n", version.size(), version)));
+    field("proto");
+    m->append(sstring(sprint(":%d\r\n", protocol_version)));
+    field("id");
+    m->append(sstring(sprint(":%d\r\n", id)));
+    field("mode");
+    field("cluster");
+    field("role");
+    field("master");
+    field("modules");
+    m->append_static("*0\r\n");
+    return make_ready_future<redis_message>(m);
+}
 }
@@ -22,6 +22,8 @@
 #include <iomanip>
 #include <sstream>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 #include "bytes.hh"
@@ -31,6 +33,12 @@
 #include "seastar/core/shared_ptr.hh"
 #include "seastar/core/scattered_message.hh"
 #include "schema.hh"
+#include "redis/streams.hh"
+#include "redis/geo.hh"
+#include "redis/slowlog.hh"
+#include "redis/hot_keys.hh"
+#include "redis/key_footprint.hh"
+#include "redis/cluster.hh"
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/range/adaptor/filtered.hpp>
 
@@ -59,12 +67,35 @@ using prefetched_bytes = prefetched_struct<bytes>;
 using bytes_return_type = lw_shared_ptr<prefetched_bytes>;
 using prefetched_mbytes = prefetched_struct<std::vector<std::pair<bytes, bytes>>>;
 using mbytes_return_type = lw_shared_ptr<prefetched_mbytes>;
+// Entries of a stream, the ID and the fields & values.
+using prefetched_stream_type = prefetched_struct<std::vector<std::pair<redis::stream_id, std::vector<bytes>>>>;
+using stream_return_type = lw_shared_ptr<prefetched_stream_type>;
+// Rows of a consumer group, the ID and the consumer (or the last delivered ID for the metadata row).
+using prefetched_stream_group_type = prefetched_struct<std::vector<std::pair<redis::stream_id, bytes>>>;
+using stream_group_return_type = lw_shared_ptr<prefetched_stream_group_type>;
+// Chunks of a bitmap, the index and the bytes of the chunk.
+using prefetched_bitmap_type = prefetched_struct<std::vector<std::pair<int64_t, bytes>>>;
+using bitmap_return_type = lw_shared_ptr<prefetched_bitmap_type>;
+// Rows of the score index of a sorted set, the score and the member.
+using prefetched_zset_score_type = prefetched_struct<std::vector<std::pair<double, bytes>>>;
+using zset_score_return_type = lw_shared_ptr<prefetched_zset_score_type>;
 
 namespace redis {
-static const size_t redis_cluser_slots { 16384 };
+class redis_message;
+
+// The rest of a reply too large to be built at once, read and written page
+// by page by the connection. It lives on the shard which executed the command.
+class reply_stream {
+public:
+    virtual ~reply_stream() {}
+    // The next page of the reply, nothing once the reply is written.
+    virtual future<std::optional<redis_message>> next() = 0;
+};
+
 class redis_message final {
 private:
     seastar::lw_shared_ptr<scattered_message<char>> _message;
+    std::unique_ptr<reply_stream> _stream;
     /*
     redis_message(bytes_view b) noexcept : redis_message() {
         _message->write(b);
@@ -74,31 +105,24 @@ public:
     redis_message() = delete;
     redis_message(const redis_message&) = delete;
     redis_message& operator=(const redis_message&) = delete;
-    redis_message(redis_message&& o) noexcept : _message(std::move(o._message)) {}
+    redis_message(redis_message&& o) noexcept : _message(std::move(o._message)), _stream(std::move(o._stream)) {}
     redis_message(lw_shared_ptr<scattered_message<char>> m) noexcept : _message(m) {}
+    // The first page of a streamed reply.
+    redis_message(lw_shared_ptr<scattered_message<char>> m, std::unique_ptr<reply_stream> stream) noexcept
+        : _message(m)
+        , _stream(std::move(stream))
+    {
+    }
     redis_message& operator=(redis_message&& o) noexcept {
         if (this != &o) {
             _message = std::move(o._message);
+            _stream = std::move(o._stream);
         }
         return *this;
     }
-    static future<redis_message> make_slots(lw_shared_ptr<std::vector<std::tuple<size_t, size_t, bytes, uint16_t>>> peer_slots) {
-        auto m = make_lw_shared<scattered_message<char>> ();
-        m->append(sstring(sprint("*%d\r\n", peer_slots->size())));
-        if (peer_slots->size() > 0) {
-            for (auto& peer_slot : *peer_slots) {
-                m->append(sstring("*3\r\n"));
-                m->append(sstring(sprint(":%zd\r\n", std::get<0>(peer_slot))));
-                m->append(sstring(sprint(":%zd\r\n", std::get<1>(peer_slot))));
-                m->append(sstring(sprint("*2\r\n")));
-                auto& p = std::get<2>(peer_slot);
-                write_bytes(m, p);
-                m->append(sstring(sprint(":%d\r\n", std::get<3>(peer_slot))));
-            }
-        }
-        m->on_delete([ r = std::move(foreign_ptr { peer_slots }) ] {});
-        return make_ready_future<redis_message>(m);
-    }
+    // CLUSTER SLOTS, every range of slots is followed by its replicas, the
+    // primary first, each an address, a port and an id.
+    static future<redis_message> make_slots(lw_shared_ptr<std::vector<slot_range>> r);
     static future<redis_message> make_zset_bytes(lw_shared_ptr<std::vector<std::optional<bytes>>> r);
     static future<redis_message> make_exception(sstring data) {
         auto m = make_lw_shared<scattered_message<char>> ();
@@ -133,10 +157,54 @@ public:
     }
     static future<redis_message> make_map_key_bytes(map_return_type r);
     static future<redis_message> make_map_val_bytes(map_return_type r);
-    static future<redis_message> make_map_bytes(map_return_type r);
     static future<redis_message> make_set_bytes(map_return_type r, size_t index);
     static future<redis_message> make_set_bytes(map_return_type r, std::vector<size_t> index);
     static future<redis_message> make_mbytes(mbytes_return_type r);
+    static future<redis_message> make_stream_entries(stream_return_type r);
+    // XREAD reply, the entries of every stream prefixed by the stream key.
+    static future<redis_message> make_stream_read(lw_shared_ptr<std::vector<std::pair<bytes, stream_return_type>>> r);
+    // XPENDING summary: the number of pending entries, the smallest and the greatest
+    // pending IDs, and the number of pending entries of every consumer.
+    static future<redis_message> make_stream_pending_summary(stream_group_return_type r);
+    static future<redis_message> make_stream_id(const redis::stream_id& id) {
+        auto m = make_lw_shared<scattered_message<char>> ();
+        auto b = id.to_bytes();
+        write_bytes(m, b);
+        m->on_delete([ b = std::move(b) ] {});
+        return make_ready_future<redis_message>(m);
+    }
+    // An array of integers, a missing integer is replied as nil.
+    static future<redis_message> make_long_array(const std::vector<std::optional<long>>& r) {
+        auto m = make_lw_shared<scattered_message<char>> ();
+        m->append(sstring(sprint("*%d\r\n", r.size())));
+        for (auto& e : r) {
+            if (e) {
+                m->append(sstring(sprint(":%ld\r\n", *e)));
+            } else {
+                m->append_static("$-1\r\n");
+            }
+        }
+        return make_ready_future<redis_message>(m);
+    }
+    // GEOPOS, the longitude and the latitude of each member, or nil.
+    static future<redis_message> make_geo_positions(const std::vector<std::optional<std::pair<double, double>>>& r);
+    // GEORADIUS and GEOSEARCH, the distances are converted to `unit`.
+    static future<redis_message> make_geo_matches(lw_shared_ptr<std::vector<geo::match>> r, bool with_coord, bool with_dist, bool with_hash, double unit);
+    // Every entry is the id, the start (unix time), the duration in microseconds,
+    // the arguments, the client address, the client name, followed by the shard,
+    // the split of the duration and the tracing session, if any.
+    static future<redis_message> make_slowlog_entries(lw_shared_ptr<std::vector<slowlog_entry>> r);
+    // Every event is its name, the time of the latest spike, the latest and the all-time maximum latency.
+    static future<redis_message> make_latency_latest(lw_shared_ptr<std::vector<std::tuple<sstring, int64_t, uint32_t, uint32_t>>> r);
+    static future<redis_message> make_latency_history(lw_shared_ptr<std::vector<latency_monitor::sample>> r);
+    // Every key is followed by its estimated accesses.
+    static future<redis_message> make_hot_keys(lw_shared_ptr<std::vector<hot_keys::entry>> r);
+    // Every key is an array of its type, its database, its name and its bytes.
+    static future<redis_message> make_big_keys(lw_shared_ptr<std::vector<big_key>> r);
+    // The RESP3 push of CLIENT TRACKING, the keys written or null for all the keys.
+    static future<redis_message> make_invalidation(lw_shared_ptr<std::vector<bytes>> keys);
+    // The reply of HELLO, a map in RESP3.
+    static future<redis_message> make_hello(int protocol_version, uint64_t id, const sstring& version);
     static future<redis_message> one() {
         auto m = make_lw_shared<scattered_message<char>> ();
         m->append_static(":1\r\n");
@@ -152,22 +220,112 @@ public:
         m->append_static("+OK\r\n");
         return make_ready_future<redis_message>(m);
     }
+    static future<redis_message> wrong_type() {
+        auto m = make_lw_shared<scattered_message<char>> ();
+        m->append_static("-WRONGTYPE Operation against a key holding the wrong kind of value\r\n");
+        return make_ready_future<redis_message>(m);
+    }
     static future<redis_message> err() {
         auto m = make_lw_shared<scattered_message<char>> ();
         m->append_static(":0\r\n");
         return make_ready_future<redis_message>(m);
     }
-    static future<redis_message> null() {
+    // RESP3 has a single null, RESP2 the nil bulk string and the nil array.
+    static future<redis_message> null(int protocol_version) {
         auto m = make_lw_shared<scattered_message<char>> ();
-        m->append_static("$-1\r\n");
+        m->append_static(protocol_version == 3 ? "_\r\n" : "$-1\r\n");
         return make_ready_future<redis_message>(m);
     }
+    static future<redis_message> null_array(int protocol_version) {
+        auto m = make_lw_shared<scattered_message<char>> ();
+        m->append_static(protocol_version == 3 ? "_\r\n" : "*-1\r\n");
+        return make_ready_future<redis_message>(m);
+    }
+    // A double, a bulk string in RESP2.
+    static future<redis_message> make_double(double d, int protocol_version);
     inline lw_shared_ptr<scattered_message<char>> message() { return _message; }
+    bool streamed() const {
+        return bool(_stream);
+    }
+    // The next page of a streamed reply, null once the reply is written. To
+    // be called on the shard of the message.
+    future<foreign_ptr<std::unique_ptr<redis_message>>> next_page();
 private:
+    static void write_stream_entries(lw_shared_ptr<scattered_message<char>> m, std::vector<std::pair<redis::stream_id, std::vector<bytes>>>& entries);
     static void write_bytes(lw_shared_ptr<scattered_message<char>> m, bytes& b) {
         m->append(sstring(sprint("$%d\r\n", b.size())));
         m->append_static(reinterpret_cast<const char*>(b.data()), b.size());
         m->append_static("\r\n");
     }
 };
+
+// Writes a reply in the protocol of the connection, RESP2 or RESP3 (HELLO 3).
+// RESP3 has typed maps, sets, doubles, booleans and nulls, RESP2 replies the
+// maps flattened in arrays, the sets as arrays, the doubles as bulk strings and
+// the booleans as integers.
+//
+// The values are copied, so a reply can be written straight from a result view
+// without keeping the result. An aggregate whose size is not known before its
+// elements are written is streamed in RESP3, RESP2 needs the size first.
+class reply_writer {
+    lw_shared_ptr<scattered_message<char>> _m;
+    int _protocol_version;
+public:
+    explicit reply_writer(int protocol_version)
+        : _m(make_lw_shared<scattered_message<char>>())
+        , _protocol_version(protocol_version)
+    {
+    }
+    bool resp3() const {
+        return _protocol_version == 3;
+    }
+    void write_array_header(size_t size) {
+        _m->append(sstring(sprint("*%d\r\n", size)));
+    }
+    // The number of pairs, RESP2 counts the keys and the values.
+    void write_map_header(size_t size) {
+        _m->append(sstring(resp3() ? sprint("%%%d\r\n", size) : sprint("*%d\r\n", 2 * size)));
+    }
+    void write_set_header(size_t size) {
+        _m->append(sstring(sprint(resp3() ? "~%d\r\n" : "*%d\r\n", size)));
+    }
+    // RESP3 only, the elements are followed by write_streamed_end().
+    void write_streamed_array_header() {
+        assert(resp3());
+        _m->append_static("*?\r\n");
+    }
+    void write_streamed_map_header() {
+        assert(resp3());
+        _m->append_static("%?\r\n");
+    }
+    void write_streamed_set_header() {
+        assert(resp3());
+        _m->append_static("~?\r\n");
+    }
+    void write_streamed_end() {
+        _m->append_static(".\r\n");
+    }
+    void write_bytes(bytes_view b) {
+        _m->append(sstring(sprint("$%d\r\n", b.size())));
+        _m->append(sstring(reinterpret_cast<const char*>(b.data()), b.size()));
+        _m->append_static("\r\n");
+    }
+    void write_long(long l) {
+        _m->append(sstring(sprint(":%ld\r\n", l)));
+    }
+    void write_double(double d);
+    void write_boolean(bool b) {
+        _m->append_static(resp3() ? (b ? "#t\r\n" : "#f\r\n") : (b ? ":1\r\n" : ":0\r\n"));
+    }
+    void write_null() {
+        _m->append_static(resp3() ? "_\r\n" : "$-1\r\n");
+    }
+    future<redis_message> done() {
+        return make_ready_future<redis_message>(std::move(_m));
+    }
+    // The first page of a reply whose rest is written by the stream.
+    future<redis_message> done(std::unique_ptr<reply_stream> stream) {
+        return make_ready_future<redis_message>(redis_message(std::move(_m), std::move(stream)));
+    }
+};
 }
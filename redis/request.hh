@@ -8,5 +8,7 @@ struct request {
     bytes _command;
     uint32_t _args_count;
     std::vector<bytes> _args;
+    // The code of _command, looked up once by whoever makes the request.
+    command_code _code = command_code::unknown;
 };
 }
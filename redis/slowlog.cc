@@ -0,0 +1,88 @@
+#include "redis/slowlog.hh"
+#include "redis/request.hh"
+#include "seastar/core/print.hh"
+#include <algorithm>
+
+namespace redis {
+
+void slowlog::add(slowlog_entry&& e)
+{
+    e._id = _next_id++;
+    _entries.push_front(std::move(e));
+    while (_entries.size() > _max_len) {
+        _entries.pop_back();
+    }
+}
+
+std::vector<slowlog_entry> slowlog::get(size_t count) const
+{
+    std::vector<slowlog_entry> entries;
+    count = std::min(count, _entries.size());
+    entries.reserve(count);
+    std::copy_n(_entries.begin(), count, std::back_inserter(entries));
+    return entries;
+}
+
+static bytes truncate_arg(const bytes& arg)
+{
+    if (arg.size() <= slowlog::max_arg_size) {
+        return arg;
+    }
+    auto more = sprint("... (%d more bytes)", arg.size() - slowlog::max_arg_size);
+    bytes b(bytes::initialized_later(), slowlog::max_arg_size + more.size());
+    auto out = std::copy_n(arg.begin(), slowlog::max_arg_size, b.begin());
+    std::copy(more.begin(), more.end(), out);
+    return b;
+}
+
+std::vector<bytes> slowlog::truncate_args(const request& req)
+{
+    std::vector<bytes> args;
+    auto total = req._args.size() + 1;
+    auto kept = std::min(total, max_args);
+    args.reserve(kept);
+    args.emplace_back(truncate_arg(req._command));
+    for (size_t i = 0; i + 1 < kept; ++i) {
+        if (i + 2 == kept && kept < total) {
+            // the last slot tells how many arguments are missing.
+            args.emplace_back(to_bytes(sprint("... (%d more arguments)", total - kept + 1)));
+            break;
+        }
+        args.emplace_back(truncate_arg(req._args[i]));
+    }
+    return args;
+}
+
+void latency_monitor::add(const sstring& name, int64_t timestamp, uint32_t latency)
+{
+    auto& e = _events[name];
+    e._max = std::max(e._max, latency);
+    if (!e._samples.empty() && e._samples.back()._timestamp == timestamp) {
+        e._samples.back()._latency = std::max(e._samples.back()._latency, latency);
+        return;
+    }
+    e._samples.push_back(sample { timestamp, latency });
+    if (e._samples.size() > max_samples) {
+        e._samples.pop_front();
+    }
+}
+
+std::vector<sstring> latency_monitor::reset(const std::vector<sstring>& names)
+{
+    std::vector<sstring> reset;
+    if (names.empty()) {
+        for (auto& e : _events) {
+            reset.emplace_back(e.first);
+        }
+        _events.clear();
+        return reset;
+    }
+    for (auto& name : names) {
+        if (_events.erase(name)) {
+            reset.emplace_back(name);
+        }
+    }
+    return reset;
+}
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "bytes.hh"
+#include "utils/UUID.hh"
+#include "seastar/core/circular_buffer.hh"
+#include "seastar/core/sstring.hh"
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+using namespace seastar;
+
+namespace redis {
+
+struct request;
+
+// A command which took longer than the slowlog threshold. The time is split
+// between the parsing of the arguments (including the lookup of the schemas)
+// and the execution, i.e. the reads and writes through the storage proxy. When
+// the command was traced, the session in system_traces tells which replica
+// and which sstables made it slow.
+struct slowlog_entry {
+    uint64_t _id;
+    // The start of the command, in microseconds since the epoch.
+    int64_t _timestamp;
+    std::chrono::microseconds _duration;
+    std::chrono::microseconds _prepare;
+    std::chrono::microseconds _execute;
+    // The command and its arguments, truncated.
+    std::vector<bytes> _args;
+    sstring _client;
+    unsigned _shard;
+    std::optional<utils::UUID> _session_id;
+};
+
+// The last slow commands executed on this shard. Recording is a comparison
+// with the threshold unless the command is slow, so the log is always on.
+class slowlog {
+public:
+    // Same limits as redis.
+    static constexpr size_t max_args = 32;
+    static constexpr size_t max_arg_size = 128;
+private:
+    circular_buffer<slowlog_entry> _entries;
+    uint64_t _next_id = 0;
+    // Negative disables the log, zero logs every command.
+    int64_t _threshold_us;
+    size_t _max_len;
+public:
+    slowlog(int64_t threshold_us, size_t max_len) : _threshold_us(threshold_us), _max_len(max_len) {}
+
+    bool enabled() const {
+        return _threshold_us >= 0 && _max_len > 0;
+    }
+    bool is_slow(std::chrono::microseconds duration) const {
+        return enabled() && duration.count() >= _threshold_us;
+    }
+    void add(slowlog_entry&& e);
+    // The newest entries first.
+    std::vector<slowlog_entry> get(size_t count) const;
+    size_t size() const { return _entries.size(); }
+    void reset() { _entries.clear(); }
+
+    static std::vector<bytes> truncate_args(const request& req);
+};
+
+// The latency spikes (in milliseconds) of every command, the highest one per
+// second, like the redis latency monitor does for its events.
+class latency_monitor {
+public:
+    static constexpr size_t max_samples = 160;
+    struct sample {
+        // In seconds since the epoch.
+        int64_t _timestamp;
+        uint32_t _latency;
+    };
+    struct event {
+        circular_buffer<sample> _samples;
+        uint32_t _max = 0;
+    };
+private:
+    std::unordered_map<sstring, event> _events;
+    // In milliseconds, zero disables the monitor.
+    uint32_t _threshold_ms;
+public:
+    explicit latency_monitor(uint32_t threshold_ms) : _threshold_ms(threshold_ms) {}
+
+    bool is_spike(std::chrono::microseconds duration) const {
+        return _threshold_ms > 0 && std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() >= _threshold_ms;
+    }
+    void add(const sstring& event, int64_t timestamp, uint32_t latency);
+    const std::unordered_map<sstring, event>& events() const { return _events; }
+    // Resets the events given, or all of them if none is given. Returns the events reset.
+    std::vector<sstring> reset(const std::vector<sstring>& events);
+};
+
+}
@@ -0,0 +1,148 @@
+#include "redis/streams.hh"
+#include "types.hh"
+#include <seastar/net/byteorder.hh>
+#include <cctype>
+
+namespace redis {
+
+stream_id stream_id::next() const
+{
+    if (_seq == std::numeric_limits<uint64_t>::max()) {
+        return stream_id { _ms + 1, 0 };
+    }
+    return stream_id { _ms, _seq + 1 };
+}
+
+bytes stream_id::to_bytes() const
+{
+    return ::to_bytes(sprint("%lu-%lu", _ms, _seq));
+}
+
+static int64_t to_stored(uint64_t v)
+{
+    return static_cast<int64_t>(v ^ (uint64_t(1) << 63));
+}
+
+static uint64_t from_stored(int64_t v)
+{
+    return static_cast<uint64_t>(v) ^ (uint64_t(1) << 63);
+}
+
+clustering_key_prefix stream_id::to_clustering_key(const schema& s) const
+{
+    return clustering_key_prefix::from_exploded(s, std::vector<bytes> { long_type->decompose(to_stored(_ms)), long_type->decompose(to_stored(_seq)) });
+}
+
+clustering_key_prefix stream_id::to_group_clustering_key(const schema& s, const bytes& group) const
+{
+    return clustering_key_prefix::from_exploded(s, std::vector<bytes> { group, long_type->decompose(to_stored(_ms)), long_type->decompose(to_stored(_seq)) });
+}
+
+template<typename Iterator>
+static stream_id read_id(Iterator i)
+{
+    auto ms = from_stored(value_cast<int64_t>(long_type->deserialize_value(*i)));
+    ++i;
+    auto seq = from_stored(value_cast<int64_t>(long_type->deserialize_value(*i)));
+    return stream_id { ms, seq };
+}
+
+stream_id stream_id::from_clustering_key(const schema& s, const clustering_key& ckey)
+{
+    return read_id(ckey.begin(s));
+}
+
+stream_id stream_id::from_group_clustering_key(const schema& s, const clustering_key& ckey)
+{
+    // Skips the group.
+    return read_id(std::next(ckey.begin(s)));
+}
+
+static std::optional<uint64_t> parse_id_part(const char* begin, const char* end)
+{
+    if (begin == end) {
+        return std::nullopt;
+    }
+    uint64_t v = 0;
+    for (auto p = begin; p != end; ++p) {
+        if (!std::isdigit(*p)) {
+            return std::nullopt;
+        }
+        uint64_t digit = *p - '0';
+        if (v > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+            return std::nullopt;
+        }
+        v = v * 10 + digit;
+    }
+    return v;
+}
+
+std::optional<stream_id> parse_stream_id(const bytes& b, uint64_t missing_seq)
+{
+    auto begin = reinterpret_cast<const char*>(b.data());
+    auto end = begin + b.size();
+    auto dash = std::find(begin, end, '-');
+    auto ms = parse_id_part(begin, dash);
+    if (!ms) {
+        return std::nullopt;
+    }
+    if (dash == end) {
+        return stream_id { *ms, missing_seq };
+    }
+    auto seq = parse_id_part(dash + 1, end);
+    if (!seq) {
+        return std::nullopt;
+    }
+    return stream_id { *ms, *seq };
+}
+
+std::optional<stream_id> parse_stream_range_start(const bytes& b)
+{
+    if (b.size() == 1 && b[0] == '-') {
+        return stream_id::min();
+    }
+    return parse_stream_id(b, 0);
+}
+
+std::optional<stream_id> parse_stream_range_end(const bytes& b)
+{
+    if (b.size() == 1 && b[0] == '+') {
+        return stream_id::max();
+    }
+    return parse_stream_id(b, std::numeric_limits<uint64_t>::max());
+}
+
+bytes encode_stream_fields(const std::vector<bytes>& fields)
+{
+    size_t total = 0;
+    for (auto& f : fields) {
+        total += sizeof(uint32_t) + f.size();
+    }
+    bytes b(bytes::initialized_later(), total);
+    auto out = b.begin();
+    for (auto& f : fields) {
+        auto len = net::hton(static_cast<uint32_t>(f.size()));
+        out = std::copy_n(reinterpret_cast<const int8_t*>(&len), sizeof(len), out);
+        out = std::copy(f.begin(), f.end(), out);
+    }
+    return b;
+}
+
+std::vector<bytes> decode_stream_fields(bytes_view b)
+{
+    std::vector<bytes> fields;
+    while (b.size() >= sizeof(uint32_t)) {
+        uint32_t len;
+        std::copy_n(b.begin(), sizeof(len), reinterpret_cast<int8_t*>(&len));
+        len = net::ntoh(len);
+        b.remove_prefix(sizeof(len));
+        if (len > b.size()) {
+            throw std::runtime_error("corrupted stream entry");
+        }
+        fields.emplace_back(bytes(b.begin(), b.begin() + len));
+        b.remove_prefix(len);
+    }
+    return fields;
+}
+
+}
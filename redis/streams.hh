@@ -0,0 +1,52 @@
+#pragma once
+#include "bytes.hh"
+#include "keys.hh"
+#include "schema.hh"
+#include "range.hh"
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace redis {
+
+// The ID of a stream entry, <milliseconds>-<sequence>, both unsigned. Entries of a
+// stream are clustered by (ms, seq), so that ranges of IDs are served by clustering
+// range reads. The clustering columns are signed, the parts are stored with their
+// sign bit flipped to sort in the same order.
+struct stream_id {
+    uint64_t _ms = 0;
+    uint64_t _seq = 0;
+
+    static constexpr stream_id min() { return stream_id { 0, 0 }; }
+    static constexpr stream_id max() { return stream_id { std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max() }; }
+    // The ID of the row holding the metadata of a consumer group, sorting first.
+    // 0-0 is never the ID of an entry.
+    static constexpr stream_id group_metadata() { return min(); }
+
+    bool operator==(const stream_id& o) const { return _ms == o._ms && _seq == o._seq; }
+    bool operator!=(const stream_id& o) const { return !(*this == o); }
+    bool operator<(const stream_id& o) const { return _ms < o._ms || (_ms == o._ms && _seq < o._seq); }
+    bool operator<=(const stream_id& o) const { return !(o < *this); }
+
+    stream_id next() const;
+    bytes to_bytes() const;
+    clustering_key_prefix to_clustering_key(const schema& s) const;
+    // The clustering key of the consumer groups table, (group, ms, seq).
+    clustering_key_prefix to_group_clustering_key(const schema& s, const bytes& group) const;
+    static stream_id from_clustering_key(const schema& s, const clustering_key& ckey);
+    static stream_id from_group_clustering_key(const schema& s, const clustering_key& ckey);
+};
+
+// Parses "<ms>-<seq>" or "<ms>"; a missing sequence is replaced with `missing_seq`.
+std::optional<stream_id> parse_stream_id(const bytes& b, uint64_t missing_seq = 0);
+
+// Parses the boundaries of XRANGE, "-" and "+" stand for the minimum and the maximum ID.
+std::optional<stream_id> parse_stream_range_start(const bytes& b);
+std::optional<stream_id> parse_stream_range_end(const bytes& b);
+
+// The fields and values of an entry are kept in one cell, each of them prefixed
+// with its length (4 bytes, big endian), to preserve the order given by XADD.
+bytes encode_stream_fields(const std::vector<bytes>& fields);
+std::vector<bytes> decode_stream_fields(bytes_view b);
+
+}
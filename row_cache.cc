@@ -1100,6 +1100,23 @@ void row_cache::unlink_from_lru(const dht::decorated_key& dk) {
     });
 }
 
+size_t row_cache::partition_memory_usage(const dht::decorated_key& dk) {
+    return _read_section(_tracker.region(), [&] {
+        return with_linearized_managed_bytes([&] {
+            auto i = _partitions.find(dk, cache_entry::compare(_schema));
+            if (i == _partitions.end()) {
+                return size_t(0);
+            }
+            auto& allocator = _tracker.allocator();
+            size_t size = allocator.object_memory_size_in_allocator(&*i) + i->key().key().external_memory_usage();
+            for (partition_version& pv : i->partition().versions()) {
+                size += pv.size_in_allocator(*_schema, allocator);
+            }
+            return size;
+        });
+    });
+}
+
 void row_cache::invalidate_locked(const dht::decorated_key& dk) {
     auto pos = _partitions.lower_bound(dk, cache_entry::compare(_schema));
     if (pos == partitions_end() || !pos->key().equal(*_schema, dk)) {
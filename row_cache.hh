@@ -532,6 +532,10 @@ public:
     // that they are not evicted by memory reclaimer.
     void unlink_from_lru(const dht::decorated_key&);
 
+    // Returns the memory used by the given partition in the cache region,
+    // 0 if not present in cache.
+    size_t partition_memory_usage(const dht::decorated_key&);
+
     // Synchronizes cache with the underlying mutation source
     // by invalidating ranges which were modified. This will force
     // them to be re-read from the underlying mutation source
@@ -121,6 +121,9 @@ private:
     // Only set for "request copy"
     stdx::optional<api::timestamp_type> _request_ts;
 
+    // The RESP version of a redis connection, 2 or 3 (HELLO 3).
+    int _redis_protocol_version = 2;
+
 public:
     struct internal_tag {};
     struct external_tag {};
@@ -179,6 +182,14 @@ public:
             , _auth_service(&auth_service) {
     }
 
+    int get_redis_protocol_version() const noexcept {
+        return _redis_protocol_version;
+    }
+
+    void set_redis_protocol_version(int version) noexcept {
+        _redis_protocol_version = version;
+    }
+
     gms::inet_address get_client_address() const {
         return gms::inet_address(_remote_address);
     }
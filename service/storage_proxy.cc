@@ -3895,7 +3895,7 @@ db::hints::manager& storage_proxy::hints_manager_for(db::write_type type) {
     return type == db::write_type::VIEW ? _hints_for_views_manager : *_hints_manager;
 }
 
-future<> storage_proxy::truncate_blocking(sstring keyspace, sstring cfname) {
+future<> storage_proxy::truncate_blocking(sstring keyspace, sstring cfname, bool with_snapshot) {
     slogger.debug("Starting a blocking truncate operation on keyspace {}, CF {}", keyspace, cfname);
 
     auto& gossiper = gms::get_local_gossiper();
@@ -3918,8 +3918,8 @@ future<> storage_proxy::truncate_blocking(sstring keyspace, sstring cfname) {
 
     slogger.trace("Enqueuing truncate messages to hosts {}", all_endpoints);
 
-    return parallel_for_each(all_endpoints, [keyspace, cfname, &ms, timeout](auto ep) {
-        return ms.send_truncate(netw::messaging_service::msg_addr{ep, 0}, timeout, keyspace, cfname);
+    return parallel_for_each(all_endpoints, [keyspace, cfname, with_snapshot, &ms, timeout](auto ep) {
+        return ms.send_truncate(netw::messaging_service::msg_addr{ep, 0}, timeout, keyspace, cfname, with_snapshot);
     }).handle_exception([cfname](auto ep) {
        try {
            std::rethrow_exception(ep);
@@ -4327,11 +4327,13 @@ void storage_proxy::init_messaging_service() {
             });
         });
     });
-    ms.register_truncate([](sstring ksname, sstring cfname) {
+    ms.register_truncate([](sstring ksname, sstring cfname, rpc::optional<bool> with_snapshot_opt) {
+        // Older nodes don't send it, they always snapshot.
+        auto with_snapshot = with_snapshot_opt.value_or(true);
         return do_with(utils::make_joinpoint([] { return db_clock::now();}),
-                        [ksname, cfname](auto& tsf) {
-            return get_storage_proxy().invoke_on_all([ksname, cfname, &tsf](storage_proxy& sp) {
-                return sp._db.local().truncate(ksname, cfname, [&tsf] { return tsf.value(); });
+                        [ksname, cfname, with_snapshot](auto& tsf) {
+            return get_storage_proxy().invoke_on_all([ksname, cfname, with_snapshot, &tsf](storage_proxy& sp) {
+                return sp._db.local().truncate(ksname, cfname, [&tsf] { return tsf.value(); }, with_snapshot);
             });
         });
     });
@@ -358,8 +358,10 @@ public:
      * the column family cfname
      * @param keyspace
      * @param cfname
+     * @param with_snapshot whether the tables are snapshotted first, when
+     *        auto_snapshot is enabled
      */
-    future<> truncate_blocking(sstring keyspace, sstring cfname);
+    future<> truncate_blocking(sstring keyspace, sstring cfname, bool with_snapshot = true);
 
     /*
      * Executes data query on the whole cluster.
@@ -2186,6 +2186,7 @@ future<> storage_service::start_redis_transport() {
         redis_transport::redis_server_config redis_server_config;
         redis_server_config.timeout_config = make_timeout_config(cfg);
         redis_server_config.max_request_size = ss._db.local().get_available_memory() / 10;
+        redis_server_config.max_output_buffer_size = size_t(cfg.redis_client_output_buffer_limit_in_mb()) << 20;
         redis_transport::redis_load_balance lb = redis_transport::parse_load_balance(cfg.load_balance());
         return seastar::net::dns::resolve_name(addr).then([&ss, rserver, addr, &cfg, lb, keepalive, ceo = std::move(ceo), redis_server_config] (seastar::net::inet_address ip) {
                 return rserver->start(std::ref(service::get_storage_proxy()), std::ref(redis::get_query_processor()), lb, std::ref(ss._auth_service), redis_server_config).then([rserver, &cfg, addr, ip, ceo, keepalive]() {
@@ -2232,6 +2233,12 @@ future<> storage_service::start_redis_transport() {
                     }
                 }
 
+                // Every shard listens on the same ports, each one with the credentials
+                // of its own port. The posix network stack binds them with SO_REUSEPORT
+                // when the kernel has it, and the kernel spreads the connections over
+                // the shards. Otherwise shard 0 accepts them and hands them over. The
+                // network stack only listens on inet addresses, there are no unix
+                // domain socket listeners.
                 return f.then([rserver, configs = std::move(configs), keepalive] {
                     return parallel_for_each(configs, [rserver, keepalive](const listen_cfg & cfg) {
                         return rserver->invoke_on_all(&redis_transport::redis_server::listen, cfg.addr, cfg.cred, keepalive).then([cfg] {
@@ -2274,6 +2281,12 @@ future<bool> storage_service::is_redis_transport_running() {
     });
 }
 
+future<shared_ptr<distributed<redis_transport::redis_server>>> storage_service::get_redis_server() {
+    return run_with_no_api_lock([] (storage_service& ss) {
+        return ss._redis_server;
+    });
+}
+
 future<> storage_service::decommission() {
     return run_with_api_lock(sstring("decommission"), [] (storage_service& ss) {
         return seastar::async([&ss] {
@@ -360,6 +360,9 @@ public:
 
     future<bool> is_redis_transport_running();
 
+    // The redis server, null if the redis transport is not running.
+    future<shared_ptr<distributed<redis_transport::redis_server>>> get_redis_server();
+
 private:
     future<> do_stop_rpc_server();
     future<> do_stop_native_transport();
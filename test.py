@@ -43,6 +43,28 @@ boost_tests = [
     'mutation_reader_test',
     'serialized_action_test',
     'cql_query_test',
+    'redis/list_test',
+    'redis/stream_test',
+    'redis/hyperloglog_test',
+    'redis/geo_test',
+    'redis/hash_test',
+    'redis/bitmap_test',
+    'redis/transport_test',
+    'redis/stats_test',
+    'redis/slowlog_test',
+    'redis/info_test',
+    'redis/protocol_parser_test',
+    'redis/hotkeys_test',
+    'redis/near_cache_test',
+    'redis/resp3_test',
+    'redis/cluster_test',
+    'redis/schemas_test',
+    'redis/flushdb_test',
+    'redis/rdb_test',
+    'redis/replication_test',
+    'redis/dump_test',
+    'redis/rename_test',
+    'redis/object_test',
     'secondary_index_test',
     'filtering_test',
     'storage_proxy_test',
@@ -24,6 +24,7 @@
 #include <boost/range/adaptor/transformed.hpp>
 #include "cql_assertions.hh"
 #include "transport/messages/result_message.hh"
+#include "redis/reply.hh"
 #include "to_string.hh"
 #include "bytes.hh"
 
@@ -151,3 +152,163 @@ rows_assertions rows_assertions::with_serialized_columns_count(size_t columns_co
     }
     return {*this};
 }
+
+static bytes as_bytes(const sstring& s) {
+    return bytes(reinterpret_cast<const bytes::value_type*>(s.data()), s.size());
+}
+
+// Reads the elements of a RESP reply, nested aggregates aside.
+class resp_reader {
+    const sstring& _s;
+    size_t _pos = 0;
+public:
+    explicit resp_reader(const sstring& s) : _s(s) {}
+
+    sstring line() {
+        auto end = _s.find("\r\n", _pos);
+        if (end == sstring::npos) {
+            fail(sprint("Truncated reply: %s", _s));
+        }
+        auto l = _s.substr(_pos, end - _pos);
+        _pos = end + 2;
+        if (l.empty()) {
+            fail(sprint("Empty line in reply: %s", _s));
+        }
+        return l;
+    }
+
+    bytes_opt element() {
+        auto l = line();
+        switch (l[0]) {
+        case '$': {
+            auto size = std::stol(l.substr(1));
+            if (size < 0) {
+                return {};
+            }
+            auto value = _s.substr(_pos, size);
+            _pos += size + 2;
+            return as_bytes(value);
+        }
+        case '+':
+        case ':':
+        case ',':
+            return as_bytes(l.substr(1));
+        case '_':
+            return {};
+        default:
+            fail(sprint("Unexpected element %s in reply: %s", l, _s));
+            return {};
+        }
+    }
+
+    std::vector<bytes_opt> elements() {
+        auto l = line();
+        if (l[0] != '*' && l[0] != '%' && l[0] != '~') {
+            fail(sprint("Expected an aggregate, got reply: %s", _s));
+        }
+        std::vector<bytes_opt> elements;
+        if (l[1] == '?') {
+            while (_s.substr(_pos, 3) != ".\r\n") {
+                elements.emplace_back(element());
+            }
+            _pos += 3;
+            return elements;
+        }
+        auto count = std::stol(l.substr(1)) * (l[0] == '%' ? 2 : 1);
+        for (long i = 0; i < count; ++i) {
+            elements.emplace_back(element());
+        }
+        return elements;
+    }
+};
+
+static sstring elements_to_string(const std::vector<bytes_opt>& elements) {
+    std::vector<sstring> s;
+    for (auto& e : elements) {
+        s.emplace_back(e ? sstring(reinterpret_cast<const char*>(e->data()), e->size()) : sstring("(nil)"));
+    }
+    return ::join(", ", s);
+}
+
+redis_reply_assertions::redis_reply_assertions(sstring reply)
+    : _reply(std::move(reply))
+{ }
+
+redis_reply_assertions redis_reply_assertions::with_status(bytes status) {
+    auto expected = sprint("+%s\r\n", sstring(reinterpret_cast<const char*>(status.data()), status.size()));
+    if (_reply != expected) {
+        fail(sprint("Expected status %s, got reply: %s", expected, _reply));
+    }
+    return {*this};
+}
+
+redis_reply_assertions redis_reply_assertions::with_error(bytes error) {
+    auto text = sstring(reinterpret_cast<const char*>(error.data()), error.size());
+    if (_reply.empty() || _reply[0] != '-' || _reply.find(text) == sstring::npos) {
+        fail(sprint("Expected error %s, got reply: %s", text, _reply));
+    }
+    return {*this};
+}
+
+redis_reply_assertions redis_reply_assertions::with_bulk(bytes value) {
+    auto v = resp_reader(_reply).element();
+    if (_reply[0] != '$' || !v || *v != value) {
+        fail(sprint("Expected bulk %s, got reply: %s", value, _reply));
+    }
+    return {*this};
+}
+
+redis_reply_assertions redis_reply_assertions::with_integer(int64_t value) {
+    auto expected = sprint(":%d\r\n", value);
+    if (_reply != expected) {
+        fail(sprint("Expected integer %d, got reply: %s", value, _reply));
+    }
+    return {*this};
+}
+
+redis_reply_assertions redis_reply_assertions::is_empty() {
+    if (_reply != "$-1\r\n" && _reply != "*-1\r\n" && _reply != "_\r\n") {
+        fail(sprint("Expected a null reply, got: %s", _reply));
+    }
+    return {*this};
+}
+
+redis_reply_assertions redis_reply_assertions::with_elements(std::vector<bytes_opt> elements) {
+    auto actual = resp_reader(_reply).elements();
+    if (actual != elements) {
+        fail(sprint("Expected elements [%s], got [%s]", elements_to_string(elements), elements_to_string(actual)));
+    }
+    return {*this};
+}
+
+redis_reply_assertions redis_reply_assertions::with_elements_ignore_order(std::vector<bytes_opt> elements) {
+    auto actual = resp_reader(_reply).elements();
+    auto sorted = actual;
+    std::sort(sorted.begin(), sorted.end());
+    std::sort(elements.begin(), elements.end());
+    if (sorted != elements) {
+        fail(sprint("Expected elements [%s] in any order, got [%s]", elements_to_string(elements), elements_to_string(actual)));
+    }
+    return {*this};
+}
+
+redis_message_assertions::redis_message_assertions(sstring reply)
+    : _reply(std::move(reply))
+{ }
+
+redis_reply_assertions redis_message_assertions::is_redis_reply() {
+    return redis_reply_assertions(_reply);
+}
+
+sstring redis_reply_text(redis::redis_message&& msg) {
+    auto p = msg.message()->release();
+    sstring reply;
+    for (auto& f : p.fragments()) {
+        reply += sstring(f.base, f.size);
+    }
+    return reply;
+}
+
+redis_message_assertions assert_that(redis::redis_message&& msg) {
+    return redis_message_assertions(redis_reply_text(std::move(msg)));
+}
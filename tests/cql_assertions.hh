@@ -52,6 +52,40 @@ public:
 
 result_msg_assertions assert_that(shared_ptr<cql_transport::messages::result_message> msg);
 
+namespace redis {
+class redis_message;
+}
+
+// The reply of a redis request, as written to the connection.
+class redis_reply_assertions {
+    sstring _reply;
+public:
+    redis_reply_assertions(sstring reply);
+    redis_reply_assertions with_status(bytes status);
+    // The error contains the given text.
+    redis_reply_assertions with_error(bytes error);
+    redis_reply_assertions with_bulk(bytes value);
+    redis_reply_assertions with_integer(int64_t value);
+    // A null bulk string, a null array or the RESP3 null.
+    redis_reply_assertions is_empty();
+    // The elements of an array, a set, or the keys and values of a map, in
+    // order, sized or streamed. The integers and the status are given as text.
+    redis_reply_assertions with_elements(std::vector<bytes_opt> elements);
+    redis_reply_assertions with_elements_ignore_order(std::vector<bytes_opt> elements);
+};
+
+class redis_message_assertions {
+    sstring _reply;
+public:
+    redis_message_assertions(sstring reply);
+    redis_reply_assertions is_redis_reply();
+};
+
+redis_message_assertions assert_that(redis::redis_message&& msg);
+
+// The text of the reply, as written to the connection.
+sstring redis_reply_text(redis::redis_message&& msg);
+
 template<typename... T>
 void assert_that_failed(future<T...>& f)
 {
@@ -21,6 +21,7 @@
 
 #include <seastar/core/thread.hh>
 #include <seastar/util/defer.hh>
+#include <boost/algorithm/string.hpp>
 #include <sstables/sstables.hh>
 #include "core/do_with.hh"
 #include "cql_test_env.hh"
@@ -42,6 +43,12 @@
 #include "test_services.hh"
 #include "db/view/view_builder.hh"
 #include "db/view/node_view_update_backlog.hh"
+#include "redis/protocol_parser.hh"
+#include "redis/query_processor.hh"
+#include "redis/redis_keyspace.hh"
+#include "redis/request.hh"
+#include "transport/redis_server.hh"
+#include "timeout_config.hh"
 
 // TODO: remove (#293)
 #include "message/messaging_service.hh"
@@ -270,6 +277,10 @@ public:
         return _auth_service->local();
     }
 
+    sharded<auth::service>& auth_service() override {
+        return *_auth_service;
+    }
+
     virtual db::view::view_builder& local_view_builder() override {
         return _view_builder->local();
     }
@@ -477,6 +488,215 @@ future<> do_with_cql_env_thread(std::function<void(cql_test_env&)> func) {
     return do_with_cql_env_thread(std::move(func), db::config{});
 }
 
+static sstring make_redis_request(const std::vector<sstring>& args) {
+    auto data = sprint("*%d\r\n", args.size());
+    for (auto& a : args) {
+        data += sprint("$%d\r\n%s\r\n", a.size(), a);
+    }
+    return data;
+}
+
+static sstring make_redis_request(const sstring& text) {
+    std::vector<sstring> args;
+    boost::split(args, text, boost::is_any_of(" "), boost::token_compress_on);
+    return make_redis_request(args);
+}
+
+// The end of the RESP value starting at `pos`, npos if it isn't whole yet.
+static size_t resp_value_end(const sstring& s, size_t pos) {
+    auto eol = s.find("\r\n", pos);
+    if (eol == sstring::npos) {
+        return sstring::npos;
+    }
+    auto next = eol + 2;
+    auto type = s[pos];
+    switch (type) {
+    case '$':
+    case '=':
+    case '!': {
+        auto size = std::stol(s.substr(pos + 1, eol - pos - 1));
+        if (size < 0) {
+            return next;
+        }
+        return s.size() < next + size + 2 ? sstring::npos : next + size + 2;
+    }
+    case '*':
+    case '~':
+    case '>':
+    case '%': {
+        if (s[pos + 1] == '?') {
+            while (next != sstring::npos && s.size() >= next + 3 && s.substr(next, 3) != ".\r\n") {
+                next = resp_value_end(s, next);
+            }
+            return next == sstring::npos || s.size() < next + 3 ? sstring::npos : next + 3;
+        }
+        auto count = std::stol(s.substr(pos + 1, eol - pos - 1)) * (type == '%' ? 2 : 1);
+        for (long i = 0; i < count && next != sstring::npos; ++i) {
+            next = resp_value_end(s, next);
+        }
+        return next;
+    }
+    default:
+        return next;
+    }
+}
+
+redis_test_connection::redis_test_connection(connected_socket socket)
+    : _socket(std::move(socket))
+    , _in(_socket.input())
+    , _out(_socket.output())
+{ }
+
+future<> redis_test_connection::send(const sstring& text) {
+    return _out.write(make_redis_request(text)).then([this] {
+        return _out.flush();
+    });
+}
+
+future<sstring> redis_test_connection::read_reply() {
+    return repeat([this] {
+        if (!_buffer.empty() && resp_value_end(_buffer, 0) != sstring::npos) {
+            return make_ready_future<stop_iteration>(stop_iteration::yes);
+        }
+        return _in.read().then([this] (temporary_buffer<char> buf) {
+            if (buf.empty()) {
+                _buffer = {};
+                return stop_iteration::yes;
+            }
+            _buffer += sstring(buf.get(), buf.size());
+            return stop_iteration::no;
+        });
+    }).then([this] {
+        if (_buffer.empty()) {
+            return sstring();
+        }
+        auto end = resp_value_end(_buffer, 0);
+        auto reply = _buffer.substr(0, end);
+        _buffer = _buffer.substr(end);
+        return reply;
+    });
+}
+
+future<sstring> redis_test_connection::execute(const sstring& text) {
+    return send(text).then([this] {
+        return read_reply();
+    });
+}
+
+future<> redis_test_connection::close() {
+    return _out.close().finally([this] {
+        return _in.close();
+    });
+}
+
+redis_test_env::redis_test_env(cql_test_env& env)
+    : _env(env)
+    , _client_state(service::client_state::internal_tag{})
+{
+    _client_state.set_raw_keyspace(redis::DEFAULT_DATABASE_NAME);
+}
+
+redis_test_env::~redis_test_env() {
+}
+
+future<> redis_test_env::start_transport(uint16_t port, const redis_transport::redis_server_config& cfg) {
+    _server = std::make_unique<distributed<redis_transport::redis_server>>();
+    _port = port;
+    return _server->start(std::ref(service::get_storage_proxy()), std::ref(redis::get_query_processor()),
+            redis_transport::redis_load_balance::none, std::ref(_env.auth_service()), cfg).then([this] {
+        return _server->invoke_on_all(&redis_transport::redis_server::listen, ipv4_addr("127.0.0.1", _port),
+            std::shared_ptr<seastar::tls::credentials_builder>(), false);
+    });
+}
+
+future<> redis_test_env::listen(uint16_t port) {
+    return _server->invoke_on_all(&redis_transport::redis_server::listen, ipv4_addr("127.0.0.1", port),
+        std::shared_ptr<seastar::tls::credentials_builder>(), false);
+}
+
+future<redis_test_connection> redis_test_env::connect() {
+    return connect(_port);
+}
+
+future<redis_test_connection> redis_test_env::connect(uint16_t port) {
+    return engine().net().connect(make_ipv4_address(ipv4_addr("127.0.0.1", port))).then([] (connected_socket socket) {
+        return redis_test_connection(std::move(socket));
+    });
+}
+
+future<> redis_test_env::stop_transport() {
+    if (!_server) {
+        return make_ready_future<>();
+    }
+    return _server->stop().then([this] {
+        _server = {};
+    });
+}
+
+void redis_test_env::set_protocol_version(int version) {
+    _client_state.set_redis_protocol_version(version);
+}
+
+future<redis::redis_message> redis_test_env::execute_redis(const sstring& text) {
+    return execute_redis_request(make_redis_request(text));
+}
+
+future<redis::redis_message> redis_test_env::execute_redis(const std::vector<sstring>& args) {
+    return execute_redis_request(make_redis_request(args));
+}
+
+future<redis::redis_message> redis_test_env::execute_redis_request(sstring data) {
+    auto parser = make_lw_shared<redis::protocol_parser>(redis::make_ragel_protocol_parser());
+    parser->init();
+    return (*parser)(temporary_buffer<char>(data.data(), data.size())).then([this, parser] (auto remainder) {
+        if (!remainder) {
+            throw std::runtime_error("incomplete redis request");
+        }
+        auto cs = make_lw_shared<service::client_state>(service::client_state::request_copy_tag{}, _client_state, _client_state.get_timestamp());
+        return redis::get_local_query_processor().process(std::move(parser->get_request()), *cs, infinite_timeout_config).finally([cs] {});
+    }).then([] (redis::redis_message reply) {
+        if (!reply.streamed()) {
+            return make_ready_future<redis::redis_message>(std::move(reply));
+        }
+        auto m = reply.message();
+        return do_with(std::move(reply), [m] (auto& reply) {
+            return repeat([&reply, m] {
+                return reply.next_page().then([m] (foreign_ptr<std::unique_ptr<redis::redis_message>> page) {
+                    if (!page) {
+                        return stop_iteration::yes;
+                    }
+                    auto p = page->message()->release();
+                    for (auto& f : p.fragments()) {
+                        m->append(sstring(f.base, f.size));
+                    }
+                    return stop_iteration::no;
+                });
+            }).then([m] {
+                return redis::redis_message(m);
+            });
+        });
+    });
+}
+
+future<> do_with_redis_env_thread(std::function<void(redis_test_env&)> func, const db::config& cfg_in) {
+    return do_with_cql_env_thread([func = std::move(func)] (cql_test_env& e) {
+        redis::get_query_processor().start(std::ref(service::get_storage_proxy()), std::ref(e.db())).get();
+        auto stop_redis_qp = defer([] {
+            redis::get_query_processor().stop().get();
+        });
+        redis::redis_keyspace_helper::create_if_not_exists(make_lw_shared<db::config>()).get();
+        redis_test_env env(e);
+        auto stop_transport = defer([&env] {
+            env.stop_transport().get();
+        });
+        func(env);
+    }, cfg_in);
+}
+
+future<> do_with_redis_env_thread(std::function<void(redis_test_env&)> func) {
+    return do_with_redis_env_thread(std::move(func), db::config{});
+}
+
 class storage_service_for_tests::impl {
     distributed<database> _db;
     sharded<auth::service> _auth_service;
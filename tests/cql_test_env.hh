@@ -37,6 +37,8 @@
 #include "schema.hh"
 #include "tests/eventually.hh"
 #include "db/view/view_update_from_staging_generator.hh"
+#include "redis/reply.hh"
+#include "service/client_state.hh"
 
 class database;
 
@@ -102,6 +104,8 @@ public:
 
     virtual auth::service& local_auth_service() = 0;
 
+    virtual sharded<auth::service>& auth_service() = 0;
+
     virtual db::view::view_builder& local_view_builder() = 0;
 
     virtual db::view::view_update_from_staging_generator& local_view_update_generator() = 0;
@@ -111,3 +115,73 @@ future<> do_with_cql_env(std::function<future<>(cql_test_env&)> func);
 future<> do_with_cql_env(std::function<future<>(cql_test_env&)> func, const db::config&);
 future<> do_with_cql_env_thread(std::function<void(cql_test_env&)> func);
 future<> do_with_cql_env_thread(std::function<void(cql_test_env&)> func, const db::config&);
+
+namespace redis_transport {
+class redis_server;
+struct redis_server_config;
+}
+
+// A client connection to the redis transport started by redis_test_env.
+class redis_test_connection {
+    connected_socket _socket;
+    input_stream<char> _in;
+    output_stream<char> _out;
+    // Read and not returned yet.
+    sstring _buffer;
+public:
+    explicit redis_test_connection(connected_socket socket);
+
+    // The arguments are separated by spaces.
+    future<> send(const sstring& text);
+    // The next reply or push, whole, as written by the server. Empty once the
+    // server closed the connection.
+    future<sstring> read_reply();
+    future<sstring> execute(const sstring& text);
+    future<> close();
+};
+
+// The redis frontend of the node of a cql_test_env: the redis query processor
+// is started with the keyspaces of the redis databases, and the requests are
+// parsed and executed on the shard as a connection does.
+class redis_test_env {
+    cql_test_env& _env;
+    service::client_state _client_state;
+    std::unique_ptr<distributed<redis_transport::redis_server>> _server;
+    uint16_t _port = 0;
+
+    future<redis::redis_message> execute_redis_request(sstring data);
+public:
+    explicit redis_test_env(cql_test_env& env);
+    ~redis_test_env();
+
+    // The arguments are separated by spaces. The pages of a streamed reply are
+    // read to the end, they are all in the returned message. Concurrent
+    // requests are executed with copies of the client state.
+    future<redis::redis_message> execute_redis(const sstring& text);
+    // The arguments as they are, they may hold spaces or any byte.
+    future<redis::redis_message> execute_redis(const std::vector<sstring>& args);
+
+    future<::shared_ptr<cql_transport::messages::result_message>> execute_cql(const sstring& text) {
+        return _env.execute_cql(text);
+    }
+
+    // The RESP version of the following requests, as HELLO sets it.
+    void set_protocol_version(int version);
+
+    cql_test_env& cql_env() {
+        return _env;
+    }
+
+    // Starts the redis transport on every shard, listening on 127.0.0.1 and the
+    // given port. It is stopped with the environment.
+    future<> start_transport(uint16_t port, const redis_transport::redis_server_config& cfg);
+    // Another listener of the started transport, on 127.0.0.1 and the port.
+    future<> listen(uint16_t port);
+    future<redis_test_connection> connect();
+    future<redis_test_connection> connect(uint16_t port);
+    future<> stop_transport();
+};
+
+// The database of the requests is redis::DEFAULT_DATABASE_NAME.
+future<> do_with_redis_env_thread(std::function<void(redis_test_env&)> func);
+future<> do_with_redis_env_thread(std::function<void(redis_test_env&)> func, const db::config&);
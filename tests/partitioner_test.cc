@@ -23,11 +23,14 @@
 
 #include <boost/test/unit_test.hpp>
 #include <boost/algorithm/cxx11/all_of.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include "dht/i_partitioner.hh"
 #include "dht/murmur3_partitioner.hh"
 #include "dht/byte_ordered_partitioner.hh"
 #include "dht/random_partitioner.hh"
+#include "dht/redis_hash_slot_partitioner.hh"
+#include "redis/cluster.hh"
 #include "schema.hh"
 #include "types.hh"
 #include "schema_builder.hh"
@@ -550,6 +553,35 @@ BOOST_AUTO_TEST_CASE(test_rp_describe_ownership) {
     dht::set_global_partitioner(to_sstring("org.apache.cassandra.dht.Murmur3Partitioner"));
 }
 
+BOOST_AUTO_TEST_CASE(test_redis_hash_slot_partitioner) {
+    BOOST_REQUIRE_EQUAL(redis::hash_slot(to_bytes("123456789")), 12739);
+    BOOST_REQUIRE_EQUAL(redis::hash_slot(to_bytes("{user1000}.following")), redis::hash_slot(to_bytes("user1000")));
+    // An empty hashtag is not a hashtag.
+    BOOST_REQUIRE_EQUAL(redis::hash_slot(to_bytes("foo{}{bar}")), redis::crc16(to_bytes("foo{}{bar}")) & 16383);
+
+    dht::redis_hash_slot_partitioner partitioner(8);
+    auto s = schema_builder("ks", "cf")
+        .with_column("pkey", bytes_type, column_kind::partition_key)
+        .with_column("data", bytes_type)
+        .build();
+    auto token_of = [&] (const char* key) {
+        return partitioner.get_token(*s, partition_key::from_single_value(*s, to_bytes(key)));
+    };
+    for (auto key : { "{user1000}.following", "{user1000}.followers", "a", "b", "c" }) {
+        auto slot = redis::hash_slot(to_bytes(key));
+        auto t = token_of(key);
+        BOOST_REQUIRE(redis::slot_token_range(slot).contains(t, dht::token_comparator()));
+        BOOST_REQUIRE_EQUAL(partitioner.shard_of(t), partitioner.shard_of(redis::slot_first_token(slot)));
+    }
+    BOOST_REQUIRE(token_of("{user1000}.following") != token_of("{user1000}.followers"));
+    BOOST_REQUIRE_EQUAL(partitioner.shard_of(token_of("{user1000}.following")), partitioner.shard_of(token_of("{user1000}.followers")));
+    for (int i = 0; i < 100; ++i) {
+        auto t = partitioner.get_random_token();
+        auto value = boost::lexical_cast<int64_t>(partitioner.to_sstring(t));
+        BOOST_REQUIRE_EQUAL((uint64_t(value) - uint64_t(std::numeric_limits<int64_t>::min())) & ((uint64_t(1) << 50) - 1), 0u);
+    }
+}
+
 void test_partitioner_sharding(const dht::i_partitioner& part, unsigned shards, std::vector<dht::token> shard_limits,
         std::function<dht::token (const dht::i_partitioner&, dht::token)> prev_token, unsigned ignorebits = 0) {
     auto s = schema_builder("ks", "cf")
@@ -0,0 +1,353 @@
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Drives the redis frontend in process: the requests are encoded in RESP,
+// parsed by the ragel or the native parser and executed by the redis query
+// processor, down to the storage. The network is left out.
+
+#include <boost/range/irange.hpp>
+#include <boost/range/algorithm/find_if.hpp>
+#include <boost/algorithm/string.hpp>
+#include <random>
+#include "tests/cql_test_env.hh"
+#include "tests/perf/perf.hh"
+#include "core/app-template.hh"
+#include "core/memory.hh"
+#include "db/config.hh"
+#include "redis/protocol_parser.hh"
+#include "redis/query_processor.hh"
+#include "redis/redis_keyspace.hh"
+#include "redis/request.hh"
+#include "redis/reply.hh"
+#include "service/client_state.hh"
+#include "service/storage_proxy.hh"
+#include "timeout_config.hh"
+#include "utils/estimated_histogram.hh"
+
+enum class command_kind { get, set, hset, zadd, lrange };
+
+static const std::vector<std::pair<sstring, command_kind>> command_names {
+    { "get", command_kind::get },
+    { "set", command_kind::set },
+    { "hset", command_kind::hset },
+    { "zadd", command_kind::zadd },
+    { "lrange", command_kind::lrange },
+};
+
+struct test_config {
+    enum class distribution { uniform, zipfian };
+    enum class parser { ragel, native };
+
+    // The weights of the commands, e.g. get:80,set:20.
+    std::vector<std::pair<command_kind, unsigned>> mix;
+    unsigned keys;
+    distribution key_distribution;
+    double zipf_exponent;
+    unsigned value_size;
+    // The number of requests sent at once by a client, as a pipelining client does.
+    unsigned pipeline;
+    parser parser_kind;
+    unsigned concurrency;
+    unsigned duration_in_seconds;
+    unsigned operations_per_shard = 0;
+    bool populate;
+};
+
+std::ostream& operator<<(std::ostream& os, const test_config& cfg) {
+    os << "{keys=" << cfg.keys
+       << ", mix=";
+    for (auto& m : cfg.mix) {
+        auto it = boost::find_if(command_names, [&m] (auto& n) { return n.second == m.first; });
+        os << it->first << ":" << m.second << (&m == &cfg.mix.back() ? "" : ",");
+    }
+    return os << ", distribution=" << (cfg.key_distribution == test_config::distribution::uniform ? "uniform" : sprint("zipfian(%.2f)", cfg.zipf_exponent))
+       << ", value_size=" << cfg.value_size
+       << ", pipeline=" << cfg.pipeline
+       << ", parser=" << (cfg.parser_kind == test_config::parser::ragel ? "ragel" : "native")
+       << ", concurrency=" << cfg.concurrency
+       << "}";
+}
+
+static std::vector<std::pair<command_kind, unsigned>> parse_mix(const sstring& s) {
+    std::vector<std::pair<command_kind, unsigned>> mix;
+    std::vector<std::string> parts;
+    boost::split(parts, s, boost::is_any_of(","));
+    for (auto& part : parts) {
+        std::vector<std::string> kv;
+        boost::split(kv, part, boost::is_any_of(":"));
+        auto it = boost::find_if(command_names, [&kv] (auto& n) { return n.first == kv[0]; });
+        if (it == command_names.end() || kv.size() > 2) {
+            throw std::invalid_argument(sprint("invalid command mix: %s", s));
+        }
+        mix.emplace_back(it->second, kv.size() == 2 ? std::stoul(kv[1]) : 1);
+    }
+    return mix;
+}
+
+// Appends a request, as sent by the clients, to `out`.
+static void append_request(std::string& out, std::initializer_list<sstring> args) {
+    out += sprint("*%d\r\n", args.size());
+    for (auto& a : args) {
+        out += sprint("$%d\r\n", a.size());
+        out.append(a.begin(), a.end());
+        out += "\r\n";
+    }
+}
+
+struct client_stats {
+    uint64_t ops = 0;
+    uint64_t errors = 0;
+    uint64_t mallocs = 0;
+    utils::estimated_histogram latency;
+
+    client_stats& operator+=(const client_stats& o) {
+        ops += o.ops;
+        errors += o.errors;
+        mallocs += o.mallocs;
+        latency.merge(o.latency);
+        return *this;
+    }
+};
+
+// The clients of a shard, they execute their requests on the shard.
+class redis_clients {
+    using clock = std::chrono::steady_clock;
+    const test_config& _cfg;
+    redis::protocol_parser _parser;
+    service::client_state _client_state;
+    // Every command is repeated according to its weight, a random pick follows the mix.
+    std::vector<command_kind> _commands;
+    // The cumulative distribution of the keys, for zipfian.
+    std::vector<double> _cdf;
+    std::default_random_engine _rng;
+    sstring _value;
+    client_stats _stats;
+    uint64_t _mallocs_at_start = 0;
+private:
+    unsigned next_key() {
+        if (_cfg.key_distribution == test_config::distribution::uniform) {
+            return std::uniform_int_distribution<unsigned>(0, _cfg.keys - 1)(_rng);
+        }
+        auto p = std::uniform_real_distribution<double>(0, _cdf.back())(_rng);
+        return std::lower_bound(_cdf.begin(), _cdf.end(), p) - _cdf.begin();
+    }
+    void append_command(std::string& out, command_kind kind, unsigned key) {
+        auto k = sprint("key:%d", key);
+        switch (kind) {
+        case command_kind::get:
+            append_request(out, { "GET", k });
+            break;
+        case command_kind::set:
+            append_request(out, { "SET", k, _value });
+            break;
+        case command_kind::hset:
+            append_request(out, { "HSET", k, sprint("field:%d", std::uniform_int_distribution<unsigned>(0, 9)(_rng)), _value });
+            break;
+        case command_kind::zadd:
+            append_request(out, { "ZADD", k, sprint("%d", std::uniform_int_distribution<unsigned>(0, 1000)(_rng)), sprint("member:%d", std::uniform_int_distribution<unsigned>(0, 9)(_rng)) });
+            break;
+        case command_kind::lrange:
+            append_request(out, { "LRANGE", k, "0", "9" });
+            break;
+        }
+    }
+    // Parses the requests as the connections do, one request at a time from the buffer.
+    std::vector<redis::request> parse(std::string&& data) {
+        std::vector<redis::request> requests;
+        temporary_buffer<char> buf(data.data(), data.size());
+        while (!buf.empty()) {
+            _parser.init();
+            auto remainder = _parser(std::move(buf)).get0();
+            if (!remainder) {
+                throw std::runtime_error("incomplete request");
+            }
+            requests.emplace_back(std::move(_parser.get_request()));
+            buf = std::move(*remainder);
+        }
+        return requests;
+    }
+    future<> execute(std::vector<redis::request> requests, clock::time_point start) {
+        return parallel_for_each(std::move(requests), [this, start] (redis::request& req) {
+            auto cs = make_lw_shared<service::client_state>(service::client_state::request_copy_tag{}, _client_state, _client_state.get_timestamp());
+            return redis::get_local_query_processor().process(std::move(req), *cs, infinite_timeout_config).then_wrapped([this, cs, start] (auto f) {
+                if (f.failed()) {
+                    f.ignore_ready_future();
+                    ++_stats.errors;
+                }
+                ++_stats.ops;
+                _stats.latency.add(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count());
+            });
+        });
+    }
+public:
+    explicit redis_clients(const test_config& cfg)
+        : _cfg(cfg)
+        , _parser(cfg.parser_kind == test_config::parser::ragel ? redis::make_ragel_protocol_parser() : redis::make_native_protocol_parser())
+        , _client_state(service::client_state::internal_tag{})
+        , _rng(engine().cpu_id())
+        , _value(sstring(cfg.value_size, 'v'))
+    {
+        _client_state.set_raw_keyspace(redis::DEFAULT_DATABASE_NAME);
+        for (auto& m : cfg.mix) {
+            _commands.insert(_commands.end(), m.second, m.first);
+        }
+        if (cfg.key_distribution == test_config::distribution::zipfian) {
+            _cdf.reserve(cfg.keys);
+            double sum = 0;
+            for (unsigned i = 0; i < cfg.keys; ++i) {
+                sum += 1.0 / std::pow(i + 1, cfg.zipf_exponent);
+                _cdf.push_back(sum);
+            }
+        }
+    }
+
+    // Writes the keys of this shard's share, so that the reads find something.
+    future<> populate() {
+        auto keys = boost::irange<unsigned>(engine().cpu_id(), _cfg.keys, smp::count);
+        return do_for_each(keys.begin(), keys.end(), [this] (unsigned key) {
+            std::string data;
+            auto k = sprint("key:%d", key);
+            append_request(data, { "SET", k, _value });
+            append_request(data, { "LPUSH", k, "a", "b", "c", "d", "e", "f", "g", "h", "i", "j" });
+            for (auto kind : { command_kind::hset, command_kind::zadd }) {
+                append_command(data, kind, key);
+            }
+            return execute(parse(std::move(data)), clock::now());
+        });
+    }
+
+    // Sends `pipeline` random requests at once and waits for all the replies.
+    future<> run_pipeline() {
+        std::string data;
+        for (unsigned i = 0; i < _cfg.pipeline; ++i) {
+            auto kind = _commands[std::uniform_int_distribution<size_t>(0, _commands.size() - 1)(_rng)];
+            append_command(data, kind, next_key());
+        }
+        auto start = clock::now();
+        return execute(parse(std::move(data)), start);
+    }
+
+    void start_counting() {
+        _stats = client_stats();
+        _mallocs_at_start = memory::stats().mallocs();
+    }
+
+    client_stats get_stats() const {
+        auto s = _stats;
+        s.mallocs = memory::stats().mallocs() - _mallocs_at_start;
+        return s;
+    }
+
+    future<> stop() {
+        return make_ready_future<>();
+    }
+};
+
+future<> do_test(cql_test_env& env, test_config& cfg) {
+    std::cout << "Running test with config: " << cfg << std::endl;
+    auto clients = ::make_shared<distributed<redis_clients>>();
+    auto db_cfg = make_lw_shared<db::config>();
+    return redis::get_query_processor().start(std::ref(service::get_storage_proxy()), std::ref(env.db())).then([db_cfg] {
+        return redis::redis_keyspace_helper::create_if_not_exists(db_cfg);
+    }).then([&cfg, clients] {
+        return clients->start(std::cref(cfg));
+    }).then([&cfg, clients] {
+        if (!cfg.populate) {
+            return make_ready_future<>();
+        }
+        std::cout << "Populating " << cfg.keys << " keys..." << std::endl;
+        return clients->invoke_on_all(&redis_clients::populate);
+    }).then([clients] {
+        return clients->invoke_on_all(&redis_clients::start_counting);
+    }).then([&cfg, clients] {
+        // time_parallel counts the pipelines, which are of cfg.pipeline requests.
+        std::cout << "Pipelines per second:" << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        return time_parallel([clients] {
+            return clients->local().run_pipeline();
+        }, cfg.concurrency, cfg.duration_in_seconds, cfg.operations_per_shard).then([clients, start] {
+            auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return clients->map_reduce0([] (auto& c) {
+                return c.get_stats();
+            }, client_stats(), [] (client_stats all, const client_stats& s) {
+                all += s;
+                return all;
+            }).then([duration] (client_stats s) {
+                std::cout << sprint("throughput: %.2f ops/s, errors: %d\n", s.ops / duration, s.errors);
+                std::cout << sprint("latency (us): p50 %d, p99 %d, p999 %d, max %d\n",
+                    s.latency.percentile(0.5), s.latency.percentile(0.99), s.latency.percentile(0.999), s.latency.max());
+                std::cout << sprint("allocations per op (including the load generator): %.2f\n", s.ops ? double(s.mallocs) / s.ops : 0.0);
+            });
+        });
+    }).finally([clients] {
+        return clients->stop().then([] {
+            return redis::get_query_processor().stop();
+        }).finally([clients] {});
+    });
+}
+
+int main(int argc, char** argv) {
+    namespace bpo = boost::program_options;
+    app_template app;
+    app.add_options()
+        ("keys", bpo::value<unsigned>()->default_value(10000), "number of keys")
+        ("mix", bpo::value<sstring>()->default_value("get:80,set:20"), "weights of the commands, among get, set, hset, zadd and lrange")
+        ("distribution", bpo::value<sstring>()->default_value("uniform"), "distribution of the keys, uniform or zipfian")
+        ("zipf-exponent", bpo::value<double>()->default_value(0.99), "exponent of the zipfian distribution")
+        ("value-size", bpo::value<unsigned>()->default_value(100), "size of the values written, in bytes")
+        ("pipeline", bpo::value<unsigned>()->default_value(1), "requests sent at once by a client")
+        ("parser", bpo::value<sstring>()->default_value("ragel"), "protocol parser, ragel or native")
+        ("duration", bpo::value<unsigned>()->default_value(5), "test duration in seconds")
+        ("concurrency", bpo::value<unsigned>()->default_value(100), "clients per core")
+        ("operations-per-shard", bpo::value<unsigned>(), "run this many pipelines per shard (overrides duration)")
+        ("no-populate", "do not write the keys before the test");
+
+    return app.run(argc, argv, [&app] {
+        return do_with_cql_env([&app] (auto&& env) {
+            auto cfg = make_lw_shared<test_config>();
+            auto& opts = app.configuration();
+            cfg->mix = parse_mix(opts["mix"].as<sstring>());
+            cfg->keys = std::max(1u, opts["keys"].as<unsigned>());
+            auto distribution = opts["distribution"].as<sstring>();
+            if (distribution == "uniform") {
+                cfg->key_distribution = test_config::distribution::uniform;
+            } else if (distribution == "zipfian") {
+                cfg->key_distribution = test_config::distribution::zipfian;
+            } else {
+                throw std::invalid_argument(sprint("unknown distribution: %s", distribution));
+            }
+            cfg->zipf_exponent = opts["zipf-exponent"].as<double>();
+            cfg->value_size = opts["value-size"].as<unsigned>();
+            cfg->pipeline = std::max(1u, opts["pipeline"].as<unsigned>());
+            auto parser = opts["parser"].as<sstring>();
+            if (parser == "ragel") {
+                cfg->parser_kind = test_config::parser::ragel;
+            } else if (parser == "native") {
+                cfg->parser_kind = test_config::parser::native;
+            } else {
+                throw std::invalid_argument(sprint("unknown parser: %s", parser));
+            }
+            cfg->duration_in_seconds = opts["duration"].as<unsigned>();
+            cfg->concurrency = opts["concurrency"].as<unsigned>();
+            if (opts.count("operations-per-shard")) {
+                cfg->operations_per_shard = opts["operations-per-shard"].as<unsigned>();
+            }
+            cfg->populate = !opts.count("no-populate");
+            return do_test(env, *cfg).finally([cfg] {});
+        });
+    });
+}
@@ -0,0 +1,131 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "redis/redis_keyspace.hh"
+
+SEASTAR_TEST_CASE(test_redis_setbit_getbit) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("setbit b 7 1").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("setbit b 7 1").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("getbit b 7").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("getbit b 6").get0()).is_redis_reply()
+            .with_integer(0);
+        // An offset in another chunk.
+        assert_that(e.execute_redis("setbit b 100000 1").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("getbit b 100000").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("getbit missing 100").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("setbit b -1 1").get0()).is_redis_reply()
+            .with_error(bytes("bit offset is not an integer or out of range"));
+        assert_that(e.execute_redis("setbit b 1 2").get0()).is_redis_reply()
+            .with_error(bytes("bit is not an integer or out of range"));
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_bitcount_bitpos) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("setbit b 3 1").get();
+        e.execute_redis("setbit b 9 1").get();
+        e.execute_redis("setbit b 40000 1").get();
+        assert_that(e.execute_redis("bitcount b").get0()).is_redis_reply()
+            .with_integer(3);
+        assert_that(e.execute_redis("bitcount b 1 1").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("bitcount missing").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("bitpos b 1").get0()).is_redis_reply()
+            .with_integer(3);
+        assert_that(e.execute_redis("bitpos b 1 2").get0()).is_redis_reply()
+            .with_integer(40000);
+        assert_that(e.execute_redis("bitpos b 0").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("bitpos missing 1").get0()).is_redis_reply()
+            .with_integer(-1);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_bitop) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("setbit a 0 1").get();
+        e.execute_redis("setbit a 1 1").get();
+        e.execute_redis("setbit b 1 1").get();
+        e.execute_redis("setbit b 50000 1").get();
+        assert_that(e.execute_redis("bitop and dst a b").get0()).is_redis_reply()
+            .with_integer(6251);
+        assert_that(e.execute_redis("bitcount dst").get0()).is_redis_reply()
+            .with_integer(1);
+        e.execute_redis("bitop or dst a b").get();
+        assert_that(e.execute_redis("bitcount dst").get0()).is_redis_reply()
+            .with_integer(3);
+        e.execute_redis("bitop xor dst a b").get();
+        assert_that(e.execute_redis("bitcount dst").get0()).is_redis_reply()
+            .with_integer(2);
+        assert_that(e.execute_redis("bitop not dst a b").get0()).is_redis_reply()
+            .with_error(bytes("BITOP NOT must be called with a single source key"));
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_bitfield) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("bitfield b set u8 0 200 get u8 0").get0()).is_redis_reply()
+            .with_elements({ bytes("0"), bytes("200") });
+        assert_that(e.execute_redis("bitfield b incrby u8 0 100").get0()).is_redis_reply()
+            .with_elements({ bytes("44") });
+        assert_that(e.execute_redis("bitfield b overflow fail incrby u8 0 250").get0()).is_redis_reply()
+            .with_elements({ std::nullopt });
+        assert_that(e.execute_redis("bitfield b get i8 0").get0()).is_redis_reply()
+            .with_elements({ bytes("44") });
+    });
+}
+
+// The strings and the bitmaps are kept apart, see bitmaps.hh.
+SEASTAR_TEST_CASE(test_redis_bitmap_wrong_type) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set s v").get();
+        assert_that(e.execute_redis("setbit s 0 1").get0()).is_redis_reply()
+            .with_error(bytes("WRONGTYPE"));
+        assert_that(e.execute_redis("getbit s 0").get0()).is_redis_reply()
+            .with_error(bytes("WRONGTYPE"));
+        assert_that(e.execute_redis("bitcount s").get0()).is_redis_reply()
+            .with_error(bytes("WRONGTYPE"));
+    });
+}
+
+// The concurrent SETBITs of different bits of one chunk are all kept.
+SEASTAR_TEST_CASE(test_redis_concurrent_setbit) {
+    return do_with_redis_env_thread([] (auto& e) {
+        std::vector<future<redis::redis_message>> sets;
+        for (int i = 0; i < 64; ++i) {
+            sets.emplace_back(e.execute_redis(sprint("setbit users %d 1", i * 3)));
+        }
+        for (auto& f : sets) {
+            assert_that(f.get0()).is_redis_reply()
+                .with_integer(0);
+        }
+        assert_that(e.execute_redis("bitcount users").get0()).is_redis_reply()
+            .with_integer(64);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_concurrent_bitfield_incrby) {
+    return do_with_redis_env_thread([] (auto& e) {
+        std::vector<future<redis::redis_message>> increments;
+        for (int i = 0; i < 50; ++i) {
+            increments.emplace_back(e.execute_redis("bitfield counter incrby u32 0 1"));
+        }
+        for (auto& f : increments) {
+            f.get();
+        }
+        assert_that(e.execute_redis("bitfield counter get u32 0").get0()).is_redis_reply()
+            .with_elements({ bytes("50") });
+    });
+}
@@ -0,0 +1,48 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "redis/cluster.hh"
+
+// The slots given by the Redis Cluster specification.
+SEASTAR_TEST_CASE(test_redis_cluster_keyslot) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("cluster keyslot somekey").get0()).is_redis_reply()
+            .with_integer(11058);
+        assert_that(e.execute_redis("cluster keyslot foo{hash_tag}").get0()).is_redis_reply()
+            .with_integer(2515);
+        // The keys of a hashtag share its slot, an empty hashtag is no hashtag.
+        BOOST_REQUIRE_EQUAL(redis::hash_slot(bytes("{user1000}.following")), redis::hash_slot(bytes("{user1000}.followers")));
+        BOOST_REQUIRE_EQUAL(redis::hash_slot(bytes("{user1000}.following")), redis::hash_slot(bytes("user1000")));
+        BOOST_REQUIRE(redis::hash_slot(bytes("foo{}{bar}")) != redis::hash_slot(bytes("bar")));
+    });
+}
+
+// A single node owns every slot.
+SEASTAR_TEST_CASE(test_redis_cluster_slots) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto slots = redis_reply_text(e.execute_redis("cluster slots").get0());
+        BOOST_REQUIRE(slots.find("*1\r\n*3\r\n:0\r\n:16383\r\n*3\r\n") == 0);
+        auto nodes = redis_reply_text(e.execute_redis("cluster nodes").get0());
+        BOOST_REQUIRE(nodes.find("myself,master") != sstring::npos);
+        BOOST_REQUIRE(nodes.find(" connected 0-16383\n") != sstring::npos);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_cluster_countkeysinslot) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("cluster countkeysinslot 11058").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("cluster countkeysinslot 16384").get0()).is_redis_reply()
+            .with_error(bytes("Invalid slot"));
+        assert_that(e.execute_redis("cluster countkeysinslot -1").get0()).is_redis_reply()
+            .with_error(bytes("Invalid slot"));
+        assert_that(e.execute_redis("cluster nosuch").get0()).is_redis_reply()
+            .with_error(bytes("unknown cluster command"));
+        assert_that(e.execute_redis("cluster keyslot").get0()).is_redis_reply()
+            .with_error(bytes("wrong number of arguments"));
+    });
+}
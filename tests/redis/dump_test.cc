@@ -0,0 +1,127 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+
+using namespace std::chrono_literals;
+
+// The payload of the DUMP reply of the key.
+static sstring dump(redis_test_env& e, const sstring& key) {
+    auto text = redis_reply_text(e.execute_redis("dump " + key).get0());
+    BOOST_REQUIRE(text[0] == '$');
+    auto begin = text.find("\r\n") + 2;
+    auto size = std::stoul(text.substr(1, begin - 3));
+    BOOST_REQUIRE_EQUAL(text.size(), begin + size + 2);
+    return text.substr(begin, size);
+}
+
+static redis::redis_message restore(redis_test_env& e, std::vector<sstring> args) {
+    return e.execute_redis(args).get0();
+}
+
+// Every type is restored as it was dumped.
+SEASTAR_TEST_CASE(test_redis_dump_restore) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set s value").get();
+        e.execute_redis("rpush l a b c").get();
+        e.execute_redis("hset h f1 v1").get();
+        e.execute_redis("hset h f2 v2").get();
+        e.execute_redis("sadd st m1 m2").get();
+        e.execute_redis("zadd z 1 one 2 two").get();
+        for (auto key : { "s", "l", "h", "st", "z" }) {
+            auto payload = dump(e, key);
+            assert_that(restore(e, { "restore", sstring(key) + "_copy", "0", payload })).is_redis_reply()
+                .with_status(bytes("OK"));
+        }
+        assert_that(e.execute_redis("get s_copy").get0()).is_redis_reply()
+            .with_bulk(bytes("value"));
+        assert_that(e.execute_redis("lrange l_copy 0 -1").get0()).is_redis_reply()
+            .with_elements({ bytes("a"), bytes("b"), bytes("c") });
+        assert_that(e.execute_redis("hgetall h_copy").get0()).is_redis_reply()
+            .with_elements_ignore_order({ bytes("f1"), bytes("v1"), bytes("f2"), bytes("v2") });
+        assert_that(e.execute_redis("smembers st_copy").get0()).is_redis_reply()
+            .with_elements_ignore_order({ bytes("m1"), bytes("m2") });
+        assert_that(e.execute_redis("zrange z_copy 0 -1 withscores").get0()).is_redis_reply()
+            .with_elements({ bytes("one"), bytes("1"), bytes("two"), bytes("2") });
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_dump_missing_key) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("dump missing").get0()).is_redis_reply()
+            .is_empty();
+    });
+}
+
+// An existing key is only replaced with REPLACE.
+SEASTAR_TEST_CASE(test_redis_restore_busy_key) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set src new").get();
+        e.execute_redis("rpush dst a b").get();
+        auto payload = dump(e, "src");
+        assert_that(restore(e, { "restore", "dst", "0", payload })).is_redis_reply()
+            .with_error(bytes("BUSYKEY"));
+        assert_that(e.execute_redis("llen dst").get0()).is_redis_reply()
+            .with_integer(2);
+        assert_that(restore(e, { "restore", "dst", "0", payload, "replace" })).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(e.execute_redis("get dst").get0()).is_redis_reply()
+            .with_bulk(bytes("new"));
+        assert_that(e.execute_redis("llen dst").get0()).is_redis_reply()
+            .with_integer(0);
+    });
+}
+
+// A payload altered or cut is rejected, nothing is written.
+SEASTAR_TEST_CASE(test_redis_restore_bad_payload) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set src value").get();
+        auto payload = dump(e, "src");
+        auto altered = payload;
+        altered[1] ^= 1;
+        assert_that(restore(e, { "restore", "k", "0", altered })).is_redis_reply()
+            .with_error(bytes("DUMP payload version or checksum are wrong"));
+        assert_that(restore(e, { "restore", "k", "0", payload.substr(0, payload.size() - 1) })).is_redis_reply()
+            .with_error(bytes("DUMP payload version or checksum are wrong"));
+        assert_that(restore(e, { "restore", "k", "0", "short" })).is_redis_reply()
+            .with_error(bytes("DUMP payload version or checksum are wrong"));
+        assert_that(e.execute_redis("exists k").get0()).is_redis_reply()
+            .with_integer(0);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_restore_wrong_arguments) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set src value").get();
+        auto payload = dump(e, "src");
+        assert_that(restore(e, { "restore", "k", "x", payload })).is_redis_reply()
+            .with_error(bytes("value is not an integer"));
+        assert_that(restore(e, { "restore", "k", "-1", payload })).is_redis_reply()
+            .with_error(bytes("Invalid TTL value"));
+        assert_that(restore(e, { "restore", "k", "0", payload, "nope" })).is_redis_reply()
+            .with_error(bytes("syntax error"));
+    });
+}
+
+// The key restored with a TTL expires.
+SEASTAR_TEST_CASE(test_redis_restore_ttl) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set src value").get();
+        auto payload = dump(e, "src");
+        assert_that(restore(e, { "restore", "k", "1000", payload })).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(restore(e, { "restore", "forever", "0", payload })).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(e.execute_redis("get k").get0()).is_redis_reply()
+            .with_bulk(bytes("value"));
+        seastar::sleep(2500ms).get();
+        assert_that(e.execute_redis("get k").get0()).is_redis_reply()
+            .is_empty();
+        assert_that(e.execute_redis("get forever").get0()).is_redis_reply()
+            .with_bulk(bytes("value"));
+    });
+}
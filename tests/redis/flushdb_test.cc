@@ -0,0 +1,93 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "transport/redis_server.hh"
+#include "redis/redis_keyspace.hh"
+#include "database.hh"
+#include "db/config.hh"
+
+static void write_every_type(redis_test_env& e) {
+    e.execute_redis("set s v").get();
+    e.execute_redis("rpush l a b").get();
+    e.execute_redis("hset h f v").get();
+    e.execute_redis("sadd set m").get();
+    e.execute_redis("zadd z 1 m").get();
+    e.execute_redis("setbit b 7 1").get();
+}
+
+static size_t snapshots_of(redis_test_env& e, const sstring& table) {
+    auto& cf = e.cql_env().local_db().find_column_family(redis::DEFAULT_DATABASE_NAME, table);
+    return cf.get_snapshot_details().get0().size();
+}
+
+SEASTAR_TEST_CASE(test_redis_flushdb) {
+    return do_with_redis_env_thread([] (auto& e) {
+        write_every_type(e);
+        assert_that(e.execute_redis("flushdb").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(e.execute_redis("exists s l h set z b").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("get s").get0()).is_redis_reply()
+            .is_empty();
+        // The keyspace is usable again.
+        e.execute_redis("set s v2").get();
+        assert_that(e.execute_redis("get s").get0()).is_redis_reply()
+            .with_bulk(bytes("v2"));
+        assert_that(e.execute_redis("flushdb async").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(e.execute_redis("flushdb now").get0()).is_redis_reply()
+            .with_error(bytes("syntax error"));
+    });
+}
+
+// FLUSHDB flushes the database of the connection, FLUSHALL all of them.
+SEASTAR_TEST_CASE(test_redis_flushdb_databases) {
+    return do_with_redis_env_thread([] (auto& e) {
+        redis_transport::redis_server_config cfg;
+        cfg.timeout_config = infinite_timeout_config;
+        cfg.max_request_size = 1 << 20;
+        e.start_transport(16379, cfg).get();
+        auto c = e.connect().get0();
+        BOOST_REQUIRE_EQUAL(c.execute("set k zero").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("select 1").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("set k one").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("flushdb").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("get k").get0(), "$-1\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("set k one").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("select 0").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("get k").get0(), "$4\r\nzero\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("flushall").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("get k").get0(), "$-1\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("select 1").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("get k").get0(), "$-1\r\n");
+        c.close().get();
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_flushdb_snapshot) {
+    return do_with_redis_env_thread([] (auto& e) {
+        write_every_type(e);
+        BOOST_REQUIRE_EQUAL(snapshots_of(e, redis::STRINGS), 0);
+        e.execute_redis("flushdb").get();
+        BOOST_REQUIRE_EQUAL(snapshots_of(e, redis::STRINGS), 1);
+        BOOST_REQUIRE_EQUAL(snapshots_of(e, redis::LISTS), 1);
+    });
+}
+
+// With redis_flush_auto_snapshot off, the data is dropped without a snapshot.
+SEASTAR_TEST_CASE(test_redis_flushdb_no_snapshot) {
+    db::config cfg;
+    cfg.redis_flush_auto_snapshot(false);
+    return do_with_redis_env_thread([] (auto& e) {
+        write_every_type(e);
+        e.execute_redis("flushdb").get();
+        BOOST_REQUIRE_EQUAL(snapshots_of(e, redis::STRINGS), 0);
+        BOOST_REQUIRE_EQUAL(snapshots_of(e, redis::LISTS), 0);
+        assert_that(e.execute_redis("exists s l").get0()).is_redis_reply()
+            .with_integer(0);
+    }, cfg);
+}
@@ -0,0 +1,68 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "redis/redis_keyspace.hh"
+
+// The value of a bulk string reply.
+static sstring bulk_value(redis::redis_message&& reply) {
+    auto text = redis_reply_text(std::move(reply));
+    BOOST_REQUIRE(text[0] == '$');
+    auto begin = text.find("\r\n") + 2;
+    return text.substr(begin, text.size() - begin - 2);
+}
+
+// A sorted set written by ZADD with the scores of GEOADD.
+static void zadd_palermo(redis_test_env& e) {
+    e.execute_redis("geoadd g1 13.361389 38.115556 Palermo").get();
+    auto score = bulk_value(e.execute_redis("zscore g1 Palermo").get0());
+    assert_that(e.execute_redis("zadd g2 " + score + " Palermo").get0()).is_redis_reply()
+        .with_integer(1);
+}
+
+SEASTAR_TEST_CASE(test_redis_geoadd_georadius) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("geoadd g 13.361389 38.115556 Palermo 15.087269 37.502669 Catania").get0()).is_redis_reply()
+            .with_integer(2);
+        assert_that(e.execute_redis("georadius g 15 37 100 km").get0()).is_redis_reply()
+            .with_elements({ bytes("Catania") });
+        assert_that(e.execute_redis("georadius g 15 37 200 km").get0()).is_redis_reply()
+            .with_elements_ignore_order({ bytes("Palermo"), bytes("Catania") });
+    });
+}
+
+// The index of the scores is written by ZADD, not only by GEOADD.
+SEASTAR_TEST_CASE(test_redis_georadius_after_zadd) {
+    return do_with_redis_env_thread([] (auto& e) {
+        zadd_palermo(e);
+        assert_that(e.execute_redis("georadius g2 15 37 200 km").get0()).is_redis_reply()
+            .with_elements({ bytes("Palermo") });
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_georadius_after_zrem) {
+    return do_with_redis_env_thread([] (auto& e) {
+        zadd_palermo(e);
+        assert_that(e.execute_redis("zrem g2 Palermo").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("georadius g2 15 37 200 km").get0()).is_redis_reply()
+            .with_elements({});
+        assert_that(e.execute_cql(sprint("select * from %s.%s where pkey = 'g2';", redis::DEFAULT_DATABASE_NAME, redis::ZSET_SCORES)).get0())
+            .is_rows().with_size(0);
+    });
+}
+
+// A member moved by ZADD is found at its new position only.
+SEASTAR_TEST_CASE(test_redis_georadius_after_zadd_move) {
+    return do_with_redis_env_thread([] (auto& e) {
+        zadd_palermo(e);
+        e.execute_redis("zadd g2 0 Palermo").get();
+        assert_that(e.execute_redis("georadius g2 15 37 200 km").get0()).is_redis_reply()
+            .with_elements({});
+        assert_that(e.execute_cql(sprint("select * from %s.%s where pkey = 'g2';", redis::DEFAULT_DATABASE_NAME, redis::ZSET_SCORES)).get0())
+            .is_rows().with_size(1);
+    });
+}
@@ -0,0 +1,102 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "redis/redis_keyspace.hh"
+#include "db/config.hh"
+
+// Collections larger than a page, read page by page.
+static db::config small_pages_config() {
+    db::config cfg;
+    cfg.redis_reply_page_rows(2);
+    return cfg;
+}
+
+static void hset_five_fields(redis_test_env& e) {
+    assert_that(e.execute_redis("hmset h f1 v1 f2 v2 f3 v3 f4 v4 f5 v5").get0()).is_redis_reply()
+        .with_status(bytes("OK"));
+}
+
+SEASTAR_TEST_CASE(test_redis_hset_hget) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("hset h f v").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("hget h f").get0()).is_redis_reply()
+            .with_bulk(bytes("v"));
+        assert_that(e.execute_redis("hget h g").get0()).is_redis_reply()
+            .is_empty();
+        assert_that(e.execute_redis("hgetall missing").get0()).is_redis_reply()
+            .is_empty();
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_resp2_hgetall) {
+    return do_with_redis_env_thread([] (auto& e) {
+        hset_five_fields(e);
+        assert_that(e.execute_redis("hgetall h").get0()).is_redis_reply()
+            .with_elements({ bytes("f1"), bytes("v1"), bytes("f2"), bytes("v2"), bytes("f3"), bytes("v3"),
+                bytes("f4"), bytes("v4"), bytes("f5"), bytes("v5") });
+        assert_that(e.execute_redis("hkeys h").get0()).is_redis_reply()
+            .with_elements({ bytes("f1"), bytes("f2"), bytes("f3"), bytes("f4"), bytes("f5") });
+        assert_that(e.execute_redis("hvals h").get0()).is_redis_reply()
+            .with_elements({ bytes("v1"), bytes("v2"), bytes("v3"), bytes("v4"), bytes("v5") });
+    }, small_pages_config());
+}
+
+// The deleted fields are not in the reply, the count of the array is the
+// count of the fields left.
+SEASTAR_TEST_CASE(test_redis_resp2_hgetall_after_hdel) {
+    return do_with_redis_env_thread([] (auto& e) {
+        hset_five_fields(e);
+        e.execute_redis("hdel h f2 f4").get();
+        assert_that(e.execute_redis("hgetall h").get0()).is_redis_reply()
+            .with_elements({ bytes("f1"), bytes("v1"), bytes("f3"), bytes("v3"), bytes("f5"), bytes("v5") });
+        auto text = redis_reply_text(e.execute_redis("hkeys h").get0());
+        BOOST_REQUIRE(text.find("*3\r\n") == 0);
+        BOOST_REQUIRE(text.find("$-1") == sstring::npos);
+    }, small_pages_config());
+}
+
+SEASTAR_TEST_CASE(test_redis_resp3_hgetall) {
+    return do_with_redis_env_thread([] (auto& e) {
+        hset_five_fields(e);
+        e.set_protocol_version(3);
+        assert_that(e.execute_redis("hgetall h").get0()).is_redis_reply()
+            .with_elements({ bytes("f1"), bytes("v1"), bytes("f2"), bytes("v2"), bytes("f3"), bytes("v3"),
+                bytes("f4"), bytes("v4"), bytes("f5"), bytes("v5") });
+        assert_that(e.execute_redis("hkeys h").get0()).is_redis_reply()
+            .with_elements({ bytes("f1"), bytes("f2"), bytes("f3"), bytes("f4"), bytes("f5") });
+    }, small_pages_config());
+}
+
+SEASTAR_TEST_CASE(test_redis_smembers_pages) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("sadd s a b c d e").get();
+        assert_that(e.execute_redis("smembers s").get0()).is_redis_reply()
+            .with_elements_ignore_order({ bytes("a"), bytes("b"), bytes("c"), bytes("d"), bytes("e") });
+        e.set_protocol_version(3);
+        assert_that(e.execute_redis("smembers s").get0()).is_redis_reply()
+            .with_elements_ignore_order({ bytes("a"), bytes("b"), bytes("c"), bytes("d"), bytes("e") });
+    }, small_pages_config());
+}
+
+// RESP2 counts a collection of many pages before writing it page by page.
+SEASTAR_TEST_CASE(test_redis_resp2_many_pages) {
+    return do_with_redis_env_thread([] (auto& e) {
+        std::vector<bytes_opt> members;
+        sstring sadd = "sadd s";
+        for (int i = 0; i < 25; ++i) {
+            auto m = sprint("m%02d", i);
+            sadd += " " + m;
+            members.emplace_back(to_bytes(m));
+        }
+        e.execute_redis(sadd).get();
+        assert_that(e.execute_redis("smembers s").get0()).is_redis_reply()
+            .with_elements_ignore_order(members);
+        auto text = redis_reply_text(e.execute_redis("smembers s").get0());
+        BOOST_REQUIRE(text.find("*25\r\n") == 0);
+    }, small_pages_config());
+}
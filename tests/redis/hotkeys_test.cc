@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "db/config.hh"
+
+// The position of a key in a HOTKEYS reply, npos if it is not there.
+static size_t position_of(const sstring& reply, const sstring& key) {
+    return reply.find(sprint("$%d\r\n%s\r\n", key.size(), key));
+}
+
+SEASTAR_TEST_CASE(test_redis_hotkeys) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set hot v").get();
+        for (int i = 0; i < 20; ++i) {
+            e.execute_redis("get hot").get();
+        }
+        for (int i = 0; i < 5; ++i) {
+            e.execute_redis("rpush warm x").get();
+        }
+        e.execute_redis("get cold").get();
+        auto all = redis_reply_text(e.execute_redis("hotkeys").get0());
+        BOOST_REQUIRE(all.find("*6\r\n") == 0);
+        BOOST_REQUIRE(position_of(all, "hot") < position_of(all, "warm"));
+        BOOST_REQUIRE(position_of(all, "warm") < position_of(all, "cold"));
+        BOOST_REQUIRE(all.find("$3\r\nhot\r\n:21\r\n") != sstring::npos);
+        auto hottest = redis_reply_text(e.execute_redis("hotkeys 1").get0());
+        BOOST_REQUIRE(hottest.find("*2\r\n$3\r\nhot\r\n") == 0);
+    });
+}
+
+// The arguments of the commands without keys are not counted.
+SEASTAR_TEST_CASE(test_redis_hotkeys_not_keys) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("info server").get();
+        e.execute_redis("slowlog len").get();
+        e.execute_redis("select 0").get();
+        assert_that(e.execute_redis("hotkeys").get0()).is_redis_reply()
+            .with_elements({});
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_hotkeys_reset) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("get k").get();
+        assert_that(e.execute_redis("hotkeys reset").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(e.execute_redis("hotkeys").get0()).is_redis_reply()
+            .with_elements({});
+        assert_that(e.execute_redis("hotkeys 0").get0()).is_redis_reply()
+            .with_error(bytes("count should be greater than 0"));
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_hotkeys_disabled) {
+    db::config cfg;
+    cfg.redis_hotkeys_capacity(0);
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("get k").get();
+        assert_that(e.execute_redis("hotkeys").get0()).is_redis_reply()
+            .with_elements({});
+    }, cfg);
+}
@@ -0,0 +1,99 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "redis/redis_keyspace.hh"
+#include "db/config.hh"
+
+static db::config near_cache_config() {
+    db::config cfg;
+    cfg.redis_near_cache_size_in_kb(1024);
+    return cfg;
+}
+
+SEASTAR_TEST_CASE(test_redis_pfadd_pfcount) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("pfadd h a b c").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("pfadd h a b").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("pfcount h").get0()).is_redis_reply()
+            .with_integer(3);
+    });
+}
+
+// The HyperLogLog read by GET is cached, a PFADD changing it invalidates the
+// cached value.
+SEASTAR_TEST_CASE(test_redis_get_after_pfadd_with_near_cache) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("pfadd h a b c").get();
+        auto before = redis_reply_text(e.execute_redis("get h").get0());
+        BOOST_REQUIRE(before[0] == '$');
+        assert_that(e.execute_redis("pfadd h d e f").get0()).is_redis_reply()
+            .with_integer(1);
+        auto after = redis_reply_text(e.execute_redis("get h").get0());
+        BOOST_REQUIRE(before != after);
+        assert_that(e.execute_redis("pfcount h").get0()).is_redis_reply()
+            .with_integer(6);
+    }, near_cache_config());
+}
+
+SEASTAR_TEST_CASE(test_redis_get_after_pfmerge_with_near_cache) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("pfadd h1 a b c").get();
+        e.execute_redis("pfadd h2 d e f").get();
+        e.execute_redis("pfmerge dst h1").get();
+        auto before = redis_reply_text(e.execute_redis("get dst").get0());
+        BOOST_REQUIRE(before[0] == '$');
+        assert_that(e.execute_redis("pfmerge dst h2").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        auto after = redis_reply_text(e.execute_redis("get dst").get0());
+        BOOST_REQUIRE(before != after);
+        assert_that(e.execute_redis("pfcount dst").get0()).is_redis_reply()
+            .with_integer(6);
+    }, near_cache_config());
+}
+
+// The registers set by concurrent PFADDs of a key are all kept, the key ends
+// up as if the elements were added at once.
+SEASTAR_TEST_CASE(test_redis_concurrent_pfadd) {
+    return do_with_redis_env_thread([] (auto& e) {
+        std::vector<future<redis::redis_message>> adds;
+        sstring all = "pfadd reference";
+        for (int i = 0; i < 50; ++i) {
+            adds.emplace_back(e.execute_redis(sprint("pfadd h e%d", i)));
+            all += sprint(" e%d", i);
+        }
+        for (auto& f : adds) {
+            assert_that(f.get0()).is_redis_reply()
+                .with_integer(1);
+        }
+        e.execute_redis(all).get();
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("get h").get0()),
+            redis_reply_text(e.execute_redis("get reference").get0()));
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_concurrent_pfmerge) {
+    return do_with_redis_env_thread([] (auto& e) {
+        std::vector<future<redis::redis_message>> merges;
+        sstring all = "pfadd reference";
+        for (int i = 0; i < 20; ++i) {
+            e.execute_redis(sprint("pfadd source%d e%d", i, i)).get();
+            all += sprint(" e%d", i);
+        }
+        for (int i = 0; i < 20; ++i) {
+            merges.emplace_back(e.execute_redis(sprint("pfmerge dst source%d", i)));
+        }
+        for (auto& f : merges) {
+            assert_that(f.get0()).is_redis_reply()
+                .with_status(bytes("OK"));
+        }
+        e.execute_redis(all).get();
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("get dst").get0()),
+            redis_reply_text(e.execute_redis("get reference").get0()));
+    });
+}
@@ -0,0 +1,61 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+
+static bool contains(const sstring& text, const sstring& s) {
+    return text.find(s) != sstring::npos;
+}
+
+SEASTAR_TEST_CASE(test_redis_info_default_sections) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto info = redis_reply_text(e.execute_redis("info").get0());
+        BOOST_REQUIRE(info[0] == '$');
+        for (auto section : { "# Server\r\n", "# Clients\r\n", "# Memory\r\n", "# Stats\r\n", "# Replication\r\n", "# Keyspace\r\n" }) {
+            BOOST_REQUIRE(contains(info, section));
+        }
+        BOOST_REQUIRE(!contains(info, "# Commandstats"));
+        BOOST_REQUIRE(contains(info, "redis_version:5.0.0\r\n"));
+        BOOST_REQUIRE(contains(info, sprint("shards:%d\r\n", smp::count)));
+        BOOST_REQUIRE(contains(info, "role:master\r\n"));
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_info_one_section) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto info = redis_reply_text(e.execute_redis("info MEMORY").get0());
+        BOOST_REQUIRE(contains(info, "# Memory\r\n"));
+        BOOST_REQUIRE(contains(info, "used_memory:"));
+        BOOST_REQUIRE(!contains(info, "# Server"));
+        auto none = redis_reply_text(e.execute_redis("info nosuchsection").get0());
+        BOOST_REQUIRE_EQUAL(none, "$0\r\n\r\n");
+    });
+}
+
+// The calls of every shard are summed.
+SEASTAR_TEST_CASE(test_redis_info_commandstats) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set a 1").get();
+        e.execute_redis("set b 2").get();
+        e.execute_redis("get a").get();
+        auto info = redis_reply_text(e.execute_redis("info commandstats").get0());
+        BOOST_REQUIRE(contains(info, "# Commandstats\r\n"));
+        BOOST_REQUIRE(contains(info, "cmdstat_set:calls=2,"));
+        BOOST_REQUIRE(contains(info, "cmdstat_get:calls=1,"));
+        BOOST_REQUIRE(!contains(info, "cmdstat_del:"));
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_info_keyspace) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto empty = redis_reply_text(e.execute_redis("info keyspace").get0());
+        BOOST_REQUIRE(!contains(empty, "db0:"));
+        e.execute_redis("set a 1").get();
+        e.execute_redis("rpush l x").get();
+        auto info = redis_reply_text(e.execute_redis("info keyspace").get0());
+        BOOST_REQUIRE(contains(info, "db0:keys=2,"));
+    });
+}
@@ -0,0 +1,114 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "redis/redis_keyspace.hh"
+
+#include <set>
+
+using namespace std::chrono_literals;
+
+// The value of a BLPOP reply, [key, value].
+static sstring popped_value(redis::redis_message&& reply) {
+    auto text = redis_reply_text(std::move(reply));
+    BOOST_REQUIRE(text.find("*2\r\n") == 0);
+    auto end = text.rfind("\r\n");
+    auto begin = text.rfind("\r\n", end - 1) + 2;
+    return text.substr(begin, end - begin);
+}
+
+SEASTAR_TEST_CASE(test_redis_lpush_lpop) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("lpush l a b c").get0()).is_redis_reply()
+            .with_integer(3);
+        assert_that(e.execute_redis("lpop l").get0()).is_redis_reply()
+            .with_bulk(bytes("c"));
+        assert_that(e.execute_redis("rpop l").get0()).is_redis_reply()
+            .with_bulk(bytes("a"));
+        assert_that(e.execute_redis("lrange l 0 -1").get0()).is_redis_reply()
+            .with_elements({ bytes("b") });
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_blpop_timeout) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("blpop empty 1").get0()).is_redis_reply()
+            .is_empty();
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_blpop_not_empty) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("rpush l a b").get();
+        assert_that(e.execute_redis("blpop empty l 1").get0()).is_redis_reply()
+            .with_elements({ bytes("l"), bytes("a") });
+    });
+}
+
+// Every element pushed goes to one blocked client, each client gets one.
+SEASTAR_TEST_CASE(test_redis_concurrent_blpop) {
+    return do_with_redis_env_thread([] (auto& e) {
+        std::vector<future<redis::redis_message>> pops;
+        for (int i = 0; i < 5; ++i) {
+            pops.emplace_back(e.execute_redis("blpop q 10"));
+        }
+        seastar::sleep(100ms).get();
+        assert_that(e.execute_redis("lpush q e1 e2 e3 e4 e5").get0()).is_redis_reply()
+            .with_integer(5);
+        std::set<sstring> popped;
+        for (auto& f : pops) {
+            popped.insert(popped_value(f.get0()));
+        }
+        BOOST_REQUIRE(popped == std::set<sstring>({ "e1", "e2", "e3", "e4", "e5" }));
+        assert_that(e.execute_redis("llen q").get0()).is_redis_reply()
+            .with_integer(0);
+    });
+}
+
+// More clients than elements: the others time out, no element is lost or
+// given twice.
+SEASTAR_TEST_CASE(test_redis_blpop_more_clients_than_elements) {
+    return do_with_redis_env_thread([] (auto& e) {
+        std::vector<future<redis::redis_message>> pops;
+        for (int i = 0; i < 3; ++i) {
+            pops.emplace_back(e.execute_redis("blpop q 2"));
+        }
+        seastar::sleep(100ms).get();
+        e.execute_redis("rpush q e1").get();
+        e.execute_redis("rpush q e2").get();
+        std::multiset<sstring> popped;
+        size_t timed_out = 0;
+        for (auto& f : pops) {
+            auto text = redis_reply_text(f.get0());
+            if (text == "*-1\r\n") {
+                ++timed_out;
+                continue;
+            }
+            auto end = text.rfind("\r\n");
+            auto begin = text.rfind("\r\n", end - 1) + 2;
+            popped.insert(text.substr(begin, end - begin));
+        }
+        BOOST_REQUIRE_EQUAL(timed_out, 1);
+        BOOST_REQUIRE(popped == std::multiset<sstring>({ "e1", "e2" }));
+        assert_that(e.execute_redis("llen q").get0()).is_redis_reply()
+            .with_integer(0);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_brpoplpush) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto pop = e.execute_redis("brpoplpush src dst 10");
+        seastar::sleep(100ms).get();
+        e.execute_redis("lpush src x").get();
+        assert_that(pop.get0()).is_redis_reply()
+            .with_bulk(bytes("x"));
+        assert_that(e.execute_redis("llen src").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("lrange dst 0 -1").get0()).is_redis_reply()
+            .with_elements({ bytes("x") });
+    });
+}
@@ -0,0 +1,97 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "redis/query_processor.hh"
+#include "db/config.hh"
+
+static db::config near_cache_config() {
+    db::config cfg;
+    cfg.redis_near_cache_size_in_kb(1024);
+    // Longer than the tests, the values are only dropped by the invalidations.
+    cfg.redis_near_cache_staleness_in_ms(60000);
+    return cfg;
+}
+
+static const redis::near_cache::stats& near_cache_stats() {
+    return redis::get_local_query_processor().get_near_cache().get_stats();
+}
+
+SEASTAR_TEST_CASE(test_redis_near_cache_hit) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set k v").get();
+        auto hits = near_cache_stats()._hits;
+        assert_that(e.execute_redis("get k").get0()).is_redis_reply()
+            .with_bulk(bytes("v"));
+        assert_that(e.execute_redis("get k").get0()).is_redis_reply()
+            .with_bulk(bytes("v"));
+        BOOST_REQUIRE_EQUAL(near_cache_stats()._hits, hits + 1);
+        // The absence of a value is cached too.
+        e.execute_redis("get missing").get();
+        assert_that(e.execute_redis("get missing").get0()).is_redis_reply()
+            .is_empty();
+        BOOST_REQUIRE_EQUAL(near_cache_stats()._hits, hits + 2);
+    }, near_cache_config());
+}
+
+// Every write of a string read before is seen by the next GET.
+SEASTAR_TEST_CASE(test_redis_near_cache_string_invalidation) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto check = [&e] (const char* write, const char* value) {
+            e.execute_redis("get k").get();
+            e.execute_redis(write).get();
+            auto reply = assert_that(e.execute_redis("get k").get0()).is_redis_reply();
+            if (value) {
+                reply.with_bulk(bytes(value));
+            } else {
+                reply.is_empty();
+            }
+        };
+        check("set k 1", "1");
+        check("incr k", "2");
+        check("incrby k 3", "5");
+        check("decr k", "4");
+        check("append k 0", "40");
+        check("mset a x k y", "y");
+        check("setex k 100 z", "z");
+        check("del k", nullptr);
+        check("set k v", "v");
+        check("rename k r", nullptr);
+        check("copy r k", "v");
+        BOOST_REQUIRE(near_cache_stats()._invalidations > 0);
+    }, near_cache_config());
+}
+
+SEASTAR_TEST_CASE(test_redis_near_cache_hash_invalidation) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto check = [&e] (const char* write, const char* value) {
+            e.execute_redis("hget h f").get();
+            e.execute_redis(write).get();
+            auto reply = assert_that(e.execute_redis("hget h f").get0()).is_redis_reply();
+            if (value) {
+                reply.with_bulk(bytes(value));
+            } else {
+                reply.is_empty();
+            }
+        };
+        check("hset h f 1", "1");
+        check("hincrby h f 2", "3");
+        check("hmset h f a g b", "a");
+        check("hdel h f", nullptr);
+        check("hset h f 1", "1");
+        check("del h", nullptr);
+    }, near_cache_config());
+}
+
+SEASTAR_TEST_CASE(test_redis_near_cache_disabled) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set k v").get();
+        e.execute_redis("get k").get();
+        e.execute_redis("get k").get();
+        BOOST_REQUIRE_EQUAL(near_cache_stats()._hits, 0);
+        BOOST_REQUIRE_EQUAL(near_cache_stats()._insertions, 0);
+    });
+}
@@ -0,0 +1,98 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+
+// The integer of a reply.
+static int64_t integer_of(redis::redis_message&& reply) {
+    auto text = redis_reply_text(std::move(reply));
+    BOOST_REQUIRE(text[0] == ':');
+    return std::stoll(text.substr(1));
+}
+
+SEASTAR_TEST_CASE(test_redis_object_encoding) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set s v").get();
+        e.execute_redis("rpush l a").get();
+        e.execute_redis("hset h f v").get();
+        e.execute_redis("sadd st m").get();
+        e.execute_redis("zadd z 1 m").get();
+        assert_that(e.execute_redis("object encoding s").get0()).is_redis_reply()
+            .with_bulk(bytes("raw"));
+        assert_that(e.execute_redis("object encoding l").get0()).is_redis_reply()
+            .with_bulk(bytes("quicklist"));
+        assert_that(e.execute_redis("object encoding h").get0()).is_redis_reply()
+            .with_bulk(bytes("hashtable"));
+        assert_that(e.execute_redis("object encoding st").get0()).is_redis_reply()
+            .with_bulk(bytes("hashtable"));
+        assert_that(e.execute_redis("object encoding z").get0()).is_redis_reply()
+            .with_bulk(bytes("skiplist"));
+        assert_that(e.execute_redis("object encoding missing").get0()).is_redis_reply()
+            .is_empty();
+    });
+}
+
+// The accesses of the key counted by the hot keys, the OBJECT request included.
+SEASTAR_TEST_CASE(test_redis_object_freq) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set k v").get();
+        for (int i = 0; i < 3; ++i) {
+            e.execute_redis("get k").get();
+        }
+        assert_that(e.execute_redis("object freq k").get0()).is_redis_reply()
+            .with_integer(5);
+        assert_that(e.execute_redis("object refcount k").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("object idletime k").get0()).is_redis_reply()
+            .with_integer(0);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_object_wrong_arguments) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("object nope k").get0()).is_redis_reply()
+            .with_error(bytes("Unknown subcommand"));
+        assert_that(e.execute_redis("object encoding").get0()).is_redis_reply()
+            .with_error(bytes("wrong number of arguments"));
+    });
+}
+
+// The footprint of the key in the memtables, larger for the larger values.
+SEASTAR_TEST_CASE(test_redis_memory_usage) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set small v").get();
+        e.execute_redis(sprint("set large %s", sstring(10000, 'x'))).get();
+        auto small = integer_of(e.execute_redis("memory usage small").get0());
+        auto large = integer_of(e.execute_redis("memory usage large").get0());
+        BOOST_REQUIRE_GT(small, 0);
+        BOOST_REQUIRE_GT(large, small + 10000);
+        BOOST_REQUIRE_EQUAL(integer_of(e.execute_redis("memory usage small samples 5").get0()), small);
+        assert_that(e.execute_redis("memory usage missing").get0()).is_redis_reply()
+            .is_empty();
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_memory_wrong_arguments) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("memory doctor").get0()).is_redis_reply()
+            .with_error(bytes("Unknown subcommand"));
+        assert_that(e.execute_redis("memory usage k samples").get0()).is_redis_reply()
+            .with_error(bytes("syntax error"));
+        assert_that(e.execute_redis("memory usage k count 5").get0()).is_redis_reply()
+            .with_error(bytes("syntax error"));
+        assert_that(e.execute_redis("memory usage k samples -1").get0()).is_redis_reply()
+            .with_error(bytes("value is not an integer"));
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_bigkeys_wrong_arguments) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("bigkeys 0").get0()).is_redis_reply()
+            .with_error(bytes("count should be greater than 0"));
+        assert_that(e.execute_redis("bigkeys 1 2").get0()).is_redis_reply()
+            .with_error(bytes("syntax error"));
+    });
+}
@@ -0,0 +1,75 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/core/thread.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "redis/protocol_parser.hh"
+#include "types.hh"
+
+// The requests of perf_redis, which compares the parsers.
+static const std::vector<std::vector<sstring>> requests {
+    { "GET", "key:1" },
+    { "SET", "key:1", sstring(100, 'x') },
+    { "HSET", "key:1", "field:3", "value" },
+    { "ZADD", "key:1", "42", "member:3" },
+    { "LRANGE", "key:1", "0", "9" },
+    { "NOSUCHCOMMAND" },
+};
+
+static std::string encode(const std::vector<sstring>& args) {
+    auto out = sprint("*%d\r\n", args.size());
+    for (auto& a : args) {
+        out += sprint("$%d\r\n%s\r\n", a.size(), a);
+    }
+    return out;
+}
+
+// Parses every request of `data`.
+static std::vector<redis::request> parse(redis::protocol_parser parser, const std::string& data) {
+    std::vector<redis::request> parsed;
+    temporary_buffer<char> buf(data.data(), data.size());
+    while (!buf.empty()) {
+        parser.init();
+        auto remainder = parser(std::move(buf)).get0();
+        BOOST_REQUIRE(remainder);
+        parsed.emplace_back(std::move(parser.get_request()));
+        buf = std::move(*remainder);
+    }
+    return parsed;
+}
+
+static void check_requests(redis::protocol_parser parser) {
+    std::string data;
+    for (auto& r : requests) {
+        data += encode(r);
+    }
+    auto parsed = parse(std::move(parser), data);
+    BOOST_REQUIRE_EQUAL(parsed.size(), requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        auto& req = parsed[i];
+        auto& expected = requests[i];
+        auto name = expected[0];
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        BOOST_REQUIRE(req._command == to_bytes(name));
+        BOOST_REQUIRE_EQUAL(req._args_count, expected.size() - 1);
+        BOOST_REQUIRE_EQUAL(req._args.size(), expected.size() - 1);
+        for (size_t a = 1; a < expected.size(); ++a) {
+            BOOST_REQUIRE(req._args[a - 1] == to_bytes(expected[a]));
+        }
+    }
+    BOOST_REQUIRE(parsed[0]._code == redis::command_code::get);
+    BOOST_REQUIRE(parsed[1]._code == redis::command_code::set);
+    BOOST_REQUIRE(parsed[2]._code == redis::command_code::hset);
+    BOOST_REQUIRE(parsed[3]._code == redis::command_code::zadd);
+    BOOST_REQUIRE(parsed[4]._code == redis::command_code::lrange);
+    BOOST_REQUIRE(parsed[5]._code == redis::command_code::unknown);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_redis_ragel_parser) {
+    check_requests(redis::make_ragel_protocol_parser());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_redis_native_parser) {
+    check_requests(redis::make_native_protocol_parser());
+}
@@ -0,0 +1,84 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "tests/tmpdir.hh"
+#include "redis/rdb.hh"
+
+#include <fstream>
+
+static void write_file(const sstring& path, const std::string& content) {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    out.write(content.data(), content.size());
+}
+
+// The keys exported are imported back, of every type.
+SEASTAR_TEST_CASE(test_redis_rdb_round_trip) {
+    return do_with_redis_env_thread([] (auto& e) {
+        tmpdir dir;
+        auto path = dir.path + "/dump.rdb";
+        e.execute_redis("set s v").get();
+        e.execute_redis("setex temporary 1000 t").get();
+        e.execute_redis("rpush l a b c").get();
+        e.execute_redis("hmset h f1 v1 f2 v2").get();
+        e.execute_redis("sadd set m1 m2").get();
+        e.execute_redis("zadd z 1 a 2.5 b").get();
+        BOOST_REQUIRE_EQUAL(redis::export_rdb(path).get0(), 6);
+        e.execute_redis("flushall").get();
+        assert_that(e.execute_redis("exists s temporary l h set z").get0()).is_redis_reply()
+            .with_integer(0);
+        BOOST_REQUIRE_EQUAL(redis::import_rdb(path).get0(), 6);
+        assert_that(e.execute_redis("get s").get0()).is_redis_reply()
+            .with_bulk(bytes("v"));
+        assert_that(e.execute_redis("get temporary").get0()).is_redis_reply()
+            .with_bulk(bytes("t"));
+        assert_that(e.execute_redis("lrange l 0 -1").get0()).is_redis_reply()
+            .with_elements({ bytes("a"), bytes("b"), bytes("c") });
+        assert_that(e.execute_redis("hgetall h").get0()).is_redis_reply()
+            .with_elements({ bytes("f1"), bytes("v1"), bytes("f2"), bytes("v2") });
+        assert_that(e.execute_redis("smembers set").get0()).is_redis_reply()
+            .with_elements_ignore_order({ bytes("m1"), bytes("m2") });
+        assert_that(e.execute_redis("zscore z b").get0()).is_redis_reply()
+            .with_bulk(bytes("2.500000"));
+    });
+}
+
+// A file written by Redis, with an intset, an expired key and two databases.
+SEASTAR_TEST_CASE(test_redis_rdb_import) {
+    return do_with_redis_env_thread([] (auto& e) {
+        tmpdir dir;
+        auto path = dir.path + "/redis.rdb";
+        std::string rdb("REDIS0009", 9);
+        rdb += std::string("\xfe\x00", 2);
+        rdb += std::string("\x00\x03str\x05hello", 11);
+        rdb += std::string("\x0b\x04ints\x0c\x02\x00\x00\x00\x02\x00\x00\x00\x01\x00\x02\x00", 19);
+        rdb += std::string("\xfc\x01\x00\x00\x00\x00\x00\x00\x00\x00\x03old\x01x", 16);
+        rdb += std::string("\xfe\x01", 2);
+        rdb += std::string("\x00\x01k\x01v", 5);
+        rdb += std::string("\xff\x00\x00\x00\x00\x00\x00\x00\x00", 9);
+        write_file(path, rdb);
+        BOOST_REQUIRE_EQUAL(redis::import_rdb(path).get0(), 3);
+        assert_that(e.execute_redis("get str").get0()).is_redis_reply()
+            .with_bulk(bytes("hello"));
+        assert_that(e.execute_redis("smembers ints").get0()).is_redis_reply()
+            .with_elements_ignore_order({ bytes("1"), bytes("2") });
+        assert_that(e.execute_redis("exists old").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_cql("select pkey from redis_1.strings").get0())
+            .is_rows().with_size(1);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_rdb_import_invalid) {
+    return do_with_redis_env_thread([] (auto& e) {
+        tmpdir dir;
+        auto path = dir.path + "/invalid.rdb";
+        write_file(path, "NOTREDIS0009");
+        BOOST_REQUIRE_THROW(redis::import_rdb(path).get(), std::exception);
+        write_file(path, "REDIS0099");
+        BOOST_REQUIRE_THROW(redis::import_rdb(path).get(), std::exception);
+    });
+}
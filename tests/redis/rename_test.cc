@@ -0,0 +1,129 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+
+// The value of every type is renamed, the key replaced is removed first.
+SEASTAR_TEST_CASE(test_redis_rename) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("rpush l a b").get();
+        e.execute_redis("set dst old").get();
+        assert_that(e.execute_redis("rename l dst").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(e.execute_redis("exists l").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("lrange dst 0 -1").get0()).is_redis_reply()
+            .with_elements({ bytes("a"), bytes("b") });
+        assert_that(e.execute_redis("get dst").get0()).is_redis_reply()
+            .is_empty();
+        e.execute_redis("hset h f v").get();
+        assert_that(e.execute_redis("rename h h2").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(e.execute_redis("hget h2 f").get0()).is_redis_reply()
+            .with_bulk(bytes("v"));
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_rename_missing_key) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("rename missing k").get0()).is_redis_reply()
+            .with_error(bytes("no such key"));
+        assert_that(e.execute_redis("rename missing missing").get0()).is_redis_reply()
+            .with_error(bytes("no such key"));
+        e.execute_redis("set k v").get();
+        assert_that(e.execute_redis("rename k k").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(e.execute_redis("get k").get0()).is_redis_reply()
+            .with_bulk(bytes("v"));
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_renamenx) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set a 1").get();
+        e.execute_redis("set b 2").get();
+        assert_that(e.execute_redis("renamenx a b").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("get a").get0()).is_redis_reply()
+            .with_bulk(bytes("1"));
+        assert_that(e.execute_redis("renamenx a c").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("get c").get0()).is_redis_reply()
+            .with_bulk(bytes("1"));
+        assert_that(e.execute_redis("exists a").get0()).is_redis_reply()
+            .with_integer(0);
+    });
+}
+
+// The source is kept, the destination is only replaced with REPLACE.
+SEASTAR_TEST_CASE(test_redis_copy) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("sadd s m1 m2").get();
+        assert_that(e.execute_redis("copy s s2").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("smembers s2").get0()).is_redis_reply()
+            .with_elements_ignore_order({ bytes("m1"), bytes("m2") });
+        assert_that(e.execute_redis("scard s").get0()).is_redis_reply()
+            .with_integer(2);
+        e.execute_redis("set dst old").get();
+        assert_that(e.execute_redis("copy s dst").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("get dst").get0()).is_redis_reply()
+            .with_bulk(bytes("old"));
+        assert_that(e.execute_redis("copy s dst replace").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("get dst").get0()).is_redis_reply()
+            .is_empty();
+        assert_that(e.execute_redis("scard dst").get0()).is_redis_reply()
+            .with_integer(2);
+        assert_that(e.execute_redis("copy missing k").get0()).is_redis_reply()
+            .with_integer(0);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_copy_db) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set k v").get();
+        assert_that(e.execute_redis("copy k k db 1").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_cql("select pkey from redis_1.strings").get0())
+            .is_rows().with_size(1);
+        assert_that(e.execute_redis("get k").get0()).is_redis_reply()
+            .with_bulk(bytes("v"));
+        assert_that(e.execute_redis("copy k k").get0()).is_redis_reply()
+            .with_error(bytes("source and destination objects are the same"));
+        assert_that(e.execute_redis("copy k k db 1000").get0()).is_redis_reply()
+            .with_error(bytes("DB index is out of range"));
+        assert_that(e.execute_redis("copy k k db x").get0()).is_redis_reply()
+            .with_error(bytes("value is not an integer"));
+        assert_that(e.execute_redis("copy k k2 nope").get0()).is_redis_reply()
+            .with_error(bytes("syntax error"));
+    });
+}
+
+// The key is moved unless the other database has it.
+SEASTAR_TEST_CASE(test_redis_move) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set k v").get();
+        assert_that(e.execute_redis("move k 1").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("exists k").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_cql("select pkey from redis_1.strings").get0())
+            .is_rows().with_size(1);
+        e.execute_redis("set k other").get();
+        assert_that(e.execute_redis("move k 1").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("get k").get0()).is_redis_reply()
+            .with_bulk(bytes("other"));
+        assert_that(e.execute_redis("move missing 1").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("move k 0").get0()).is_redis_reply()
+            .with_error(bytes("source and destination objects are the same"));
+        assert_that(e.execute_redis("move k 1000").get0()).is_redis_reply()
+            .with_error(bytes("DB index is out of range"));
+    });
+}
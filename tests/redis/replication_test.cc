@@ -0,0 +1,147 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+
+using namespace std::chrono_literals;
+
+static constexpr uint16_t master_port = 16380;
+
+// A master talking to the replica of the node, in the test thread.
+class fake_master {
+    connected_socket _socket;
+    input_stream<char> _in;
+    output_stream<char> _out;
+    sstring _buffer;
+
+    sstring read_line() {
+        size_t eol;
+        while ((eol = _buffer.find("\r\n")) == sstring::npos) {
+            auto buf = _in.read().get0();
+            BOOST_REQUIRE(!buf.empty());
+            _buffer += sstring(buf.get(), buf.size());
+        }
+        auto line = _buffer.substr(0, eol);
+        _buffer = _buffer.substr(eol + 2);
+        return line;
+    }
+public:
+    explicit fake_master(connected_socket socket)
+        : _socket(std::move(socket))
+        , _in(_socket.input())
+        , _out(_socket.output())
+    { }
+    // The arguments of the next command of the replica.
+    std::vector<sstring> read_command() {
+        auto header = read_line();
+        BOOST_REQUIRE(header[0] == '*');
+        std::vector<sstring> args;
+        for (auto n = std::stoi(header.substr(1)); n > 0; --n) {
+            read_line();
+            args.push_back(read_line());
+        }
+        return args;
+    }
+    void write(const sstring& data) {
+        _out.write(data).get();
+        _out.flush().get();
+    }
+    void close() {
+        _out.close().get();
+        _in.close().get();
+    }
+};
+
+static sstring make_command(std::vector<sstring> args) {
+    auto cmd = sprint("*%d\r\n", args.size());
+    for (auto& a : args) {
+        cmd += sprint("$%d\r\n%s\r\n", a.size(), a);
+    }
+    return cmd;
+}
+
+// Retries the request until its reply is the one expected, the replica
+// applies the commands asynchronously.
+static void wait_for_reply(redis_test_env& e, const sstring& request, const sstring& expected) {
+    for (int i = 0; i < 500; ++i) {
+        if (redis_reply_text(e.execute_redis(request).get0()) == expected) {
+            return;
+        }
+        seastar::sleep(20ms).get();
+    }
+    BOOST_FAIL(sprint("%s was not replied %s", request, expected));
+}
+
+// The snapshot of the full synchronization, then the stream of commands.
+SEASTAR_TEST_CASE(test_redis_replicaof) {
+    return do_with_redis_env_thread([] (auto& e) {
+        listen_options lo;
+        lo.reuse_address = true;
+        auto listener = engine().listen(make_ipv4_address({"127.0.0.1", master_port}), lo);
+        assert_that(e.execute_redis(sprint("replicaof 127.0.0.1 %d", master_port)).get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        fake_master master(listener.accept().get0());
+        BOOST_REQUIRE(master.read_command() == std::vector<sstring>({ "PING" }));
+        master.write("+PONG\r\n");
+        BOOST_REQUIRE_EQUAL(master.read_command()[0], "REPLCONF");
+        master.write("+OK\r\n");
+        BOOST_REQUIRE_EQUAL(master.read_command()[0], "REPLCONF");
+        master.write("+OK\r\n");
+        BOOST_REQUIRE(master.read_command() == std::vector<sstring>({ "PSYNC", "?", "-1" }));
+        master.write(sprint("+FULLRESYNC %s 100\r\n", sstring(40, 'a')));
+        auto rdb = sstring("REDIS0009") + sstring("\xfe\x00", 2) + sstring("\x00\x03key\x05value", 11)
+            + sstring("\xff\x00\x00\x00\x00\x00\x00\x00\x00", 9);
+        master.write(sprint("$%d\r\n", rdb.size()) + rdb);
+        master.write(make_command({ "SET", "a", "1" }) + make_command({ "INCR", "a" }) + make_command({ "RPUSH", "l", "x", "y" }));
+        wait_for_reply(e, "lrange l 0 -1", "*2\r\n$1\r\nx\r\n$1\r\ny\r\n");
+        assert_that(e.execute_redis("get key").get0()).is_redis_reply()
+            .with_bulk(bytes("value"));
+        assert_that(e.execute_redis("get a").get0()).is_redis_reply()
+            .with_bulk(bytes("2"));
+        auto info = redis_reply_text(e.execute_redis("info replication").get0());
+        BOOST_REQUIRE(info.find("role:slave\r\n") != sstring::npos);
+        BOOST_REQUIRE(info.find("master_link_status:up\r\n") != sstring::npos);
+        BOOST_REQUIRE(info.find(sprint("master_replid:%s\r\n", sstring(40, 'a'))) != sstring::npos);
+        // The keys replicated are kept.
+        assert_that(e.execute_redis("replicaof no one").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        info = redis_reply_text(e.execute_redis("info replication").get0());
+        BOOST_REQUIRE(info.find("role:master\r\n") != sstring::npos);
+        assert_that(e.execute_redis("get a").get0()).is_redis_reply()
+            .with_bulk(bytes("2"));
+        master.close();
+        listener.abort_accept();
+    });
+}
+
+// SELECT switches the keyspace of the commands that follow.
+SEASTAR_TEST_CASE(test_redis_replicaof_select) {
+    return do_with_redis_env_thread([] (auto& e) {
+        listen_options lo;
+        lo.reuse_address = true;
+        auto listener = engine().listen(make_ipv4_address({"127.0.0.1", master_port}), lo);
+        e.execute_redis(sprint("replicaof 127.0.0.1 %d", master_port)).get();
+        fake_master master(listener.accept().get0());
+        for (auto reply : { "+PONG\r\n", "+OK\r\n", "+OK\r\n" }) {
+            master.read_command();
+            master.write(reply);
+        }
+        master.read_command();
+        master.write(sprint("+FULLRESYNC %s 0\r\n", sstring(40, 'b')));
+        auto rdb = sstring("REDIS0009") + sstring("\xff\x00\x00\x00\x00\x00\x00\x00\x00", 9);
+        master.write(sprint("$%d\r\n", rdb.size()) + rdb);
+        master.write(make_command({ "SELECT", "1" }) + make_command({ "SET", "k", "one" })
+            + make_command({ "SELECT", "0" }) + make_command({ "SET", "k", "zero" }));
+        wait_for_reply(e, "get k", "$4\r\nzero\r\n");
+        assert_that(e.execute_cql("select pkey from redis_1.strings").get0())
+            .is_rows().with_size(1);
+        e.execute_redis("replicaof no one").get();
+        master.close();
+        listener.abort_accept();
+    });
+}
@@ -0,0 +1,45 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+
+SEASTAR_TEST_CASE(test_redis_resp3_null) {
+    return do_with_redis_env_thread([] (auto& e) {
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("get missing").get0()), "$-1\r\n");
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("blpop missing 1").get0()), "*-1\r\n");
+        e.set_protocol_version(3);
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("get missing").get0()), "_\r\n");
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("hget missing f").get0()), "_\r\n");
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("lindex missing 0").get0()), "_\r\n");
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("blpop missing 1").get0()), "_\r\n");
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_resp3_double) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("zadd z 1.5 a 2 b").get();
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("zscore z a").get0()), "$8\r\n1.500000\r\n");
+        e.set_protocol_version(3);
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("zscore z a").get0()), ",1.500000\r\n");
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("zincrby z 1 b").get0()), ",3.000000\r\n");
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("zrange z 0 -1 withscores").get0()),
+            "*4\r\n$1\r\na\r\n,1.500000\r\n$1\r\nb\r\n,3.000000\r\n");
+    });
+}
+
+// The maps count their pairs, the sets are typed.
+SEASTAR_TEST_CASE(test_redis_resp3_map_and_set) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("hset h f v").get();
+        e.execute_redis("sadd s m").get();
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("hgetall h").get0()), "*2\r\n$1\r\nf\r\n$1\r\nv\r\n");
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("smembers s").get0()), "*1\r\n$1\r\nm\r\n");
+        e.set_protocol_version(3);
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("hgetall h").get0()), "%1\r\n$1\r\nf\r\n$1\r\nv\r\n");
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("smembers s").get0()), "~1\r\n$1\r\nm\r\n");
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("hkeys h").get0()), "*1\r\n$1\r\nf\r\n");
+    });
+}
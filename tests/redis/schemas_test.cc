@@ -0,0 +1,59 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "transport/redis_server.hh"
+#include "redis/query_processor.hh"
+#include "redis/redis_keyspace.hh"
+
+// The schemas are resolved once per keyspace.
+SEASTAR_TEST_CASE(test_redis_schemas_cached) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto& qp = redis::get_local_query_processor();
+        auto& schemas = qp.schemas_of(redis::DEFAULT_DATABASE_NAME);
+        BOOST_REQUIRE(schemas._strings->cf_name() == redis::STRINGS);
+        BOOST_REQUIRE(schemas._zset_scores->cf_name() == redis::ZSET_SCORES);
+        BOOST_REQUIRE_EQUAL(&qp.schemas_of(redis::DEFAULT_DATABASE_NAME), &schemas);
+        auto& other = qp.schemas_of("redis_1");
+        BOOST_REQUIRE(other._strings->ks_name() == "redis_1");
+        BOOST_REQUIRE_EQUAL(&qp.schemas_of(redis::DEFAULT_DATABASE_NAME), &schemas);
+    });
+}
+
+// A schema change of a redis keyspace drops the schemas resolved, the next
+// commands use the new ones.
+SEASTAR_TEST_CASE(test_redis_schemas_changed) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set k v").get();
+        auto& qp = redis::get_local_query_processor();
+        auto version = qp.schemas_of(redis::DEFAULT_DATABASE_NAME)._strings->version();
+        e.execute_cql(sprint("alter table %s.%s with comment = 'changed'", redis::DEFAULT_DATABASE_NAME, redis::STRINGS)).get();
+        BOOST_REQUIRE(qp.schemas_of(redis::DEFAULT_DATABASE_NAME)._strings->version() != version);
+        assert_that(e.execute_redis("get k").get0()).is_redis_reply()
+            .with_bulk(bytes("v"));
+        assert_that(e.execute_redis("set k v2").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+    });
+}
+
+// The connections switching databases use the schemas of each.
+SEASTAR_TEST_CASE(test_redis_select_schemas) {
+    return do_with_redis_env_thread([] (auto& e) {
+        redis_transport::redis_server_config cfg;
+        cfg.timeout_config = infinite_timeout_config;
+        cfg.max_request_size = 1 << 20;
+        e.start_transport(16379, cfg).get();
+        auto c = e.connect().get0();
+        BOOST_REQUIRE_EQUAL(c.execute("set k zero").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("select 1").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("get k").get0(), "$-1\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("set k one").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("select 0").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("get k").get0(), "$4\r\nzero\r\n");
+        BOOST_REQUIRE(c.execute("select 16").get0().find("-invalid DB index") == 0);
+        c.close().get();
+    });
+}
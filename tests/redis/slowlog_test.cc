@@ -0,0 +1,84 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "db/config.hh"
+
+// Every command is slow.
+static db::config log_all_config() {
+    db::config cfg;
+    cfg.redis_slowlog_log_slower_than(0);
+    cfg.redis_slowlog_max_len(4);
+    return cfg;
+}
+
+SEASTAR_TEST_CASE(test_redis_slowlog) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("slowlog reset").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        e.execute_redis("set slow v").get();
+        // The reset, then the set.
+        assert_that(e.execute_redis("slowlog len").get0()).is_redis_reply()
+            .with_integer(2);
+        auto entries = redis_reply_text(e.execute_redis("slowlog get -1").get0());
+        BOOST_REQUIRE(entries.find("*3\r\n") == 0);
+        BOOST_REQUIRE(entries.find("*3\r\n$3\r\nset\r\n$4\r\nslow\r\n$1\r\nv\r\n") != sstring::npos);
+        BOOST_REQUIRE(entries.find("$5\r\nshard\r\n") != sstring::npos);
+        auto latest = redis_reply_text(e.execute_redis("slowlog get 1").get0());
+        BOOST_REQUIRE(latest.find("*1\r\n*7\r\n") == 0);
+    }, log_all_config());
+}
+
+// The oldest entries are dropped past redis_slowlog_max_len.
+SEASTAR_TEST_CASE(test_redis_slowlog_max_len) {
+    return do_with_redis_env_thread([] (auto& e) {
+        for (int i = 0; i < 10; ++i) {
+            e.execute_redis("get k").get();
+        }
+        assert_that(e.execute_redis("slowlog len").get0()).is_redis_reply()
+            .with_integer(4);
+    }, log_all_config());
+}
+
+SEASTAR_TEST_CASE(test_redis_slowlog_disabled) {
+    db::config cfg;
+    cfg.redis_slowlog_log_slower_than(-1);
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("set k v").get();
+        assert_that(e.execute_redis("slowlog len").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("slowlog get").get0()).is_redis_reply()
+            .with_elements({});
+    }, cfg);
+}
+
+SEASTAR_TEST_CASE(test_redis_slowlog_wrong_arguments) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("slowlog get -2").get0()).is_redis_reply()
+            .with_error(bytes("count should be greater than or equal to -1"));
+        assert_that(e.execute_redis("slowlog nosuch").get0()).is_redis_reply()
+            .with_error(bytes("unknown subcommand"));
+    });
+}
+
+// A BLPOP timing out after a second is a spike of the default threshold,
+// 100ms.
+SEASTAR_TEST_CASE(test_redis_latency_monitor) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("blpop empty 1").get0()).is_redis_reply()
+            .is_empty();
+        auto latest = redis_reply_text(e.execute_redis("latency latest").get0());
+        BOOST_REQUIRE(latest.find("*1\r\n*4\r\n$5\r\nblpop\r\n") == 0);
+        auto history = redis_reply_text(e.execute_redis("latency history blpop").get0());
+        BOOST_REQUIRE(history.find("*1\r\n*2\r\n") == 0);
+        assert_that(e.execute_redis("latency history get").get0()).is_redis_reply()
+            .with_elements({});
+        assert_that(e.execute_redis("latency reset blpop").get0()).is_redis_reply()
+            .with_integer(1);
+        assert_that(e.execute_redis("latency latest").get0()).is_redis_reply()
+            .with_elements({});
+    });
+}
@@ -0,0 +1,43 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "redis/query_processor.hh"
+
+static const redis::command_stats& stats_of(redis::command_code code) {
+    return redis::get_local_query_processor().get_command_stats()[size_t(code)];
+}
+
+SEASTAR_TEST_CASE(test_redis_command_stats) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto& set = stats_of(redis::command_code::set);
+        auto& get = stats_of(redis::command_code::get);
+        BOOST_REQUIRE(set._name == bytes("set"));
+        auto sets = set._calls;
+        auto gets = get._calls;
+        auto latencies = set._latency._count;
+        e.execute_redis("set k v").get();
+        e.execute_redis("set k v2").get();
+        e.execute_redis("get k").get();
+        BOOST_REQUIRE_EQUAL(set._calls, sets + 2);
+        BOOST_REQUIRE_EQUAL(get._calls, gets + 1);
+        BOOST_REQUIRE_EQUAL(set._latency._count, latencies + 2);
+        BOOST_REQUIRE_EQUAL(set._failures, 0);
+    });
+}
+
+// The commands not supported are accounted together.
+SEASTAR_TEST_CASE(test_redis_unknown_command_stats) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto& unknown = stats_of(redis::command_code::unknown);
+        BOOST_REQUIRE(unknown._name == bytes("unknown"));
+        auto calls = unknown._calls;
+        assert_that(e.execute_redis("nosuchcommand k").get0()).is_redis_reply()
+            .with_error(bytes("Unknown or disabled command"));
+        e.execute_redis("othercommand").get();
+        BOOST_REQUIRE_EQUAL(unknown._calls, calls + 2);
+    });
+}
@@ -0,0 +1,95 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "redis/redis_keyspace.hh"
+
+#include <set>
+
+SEASTAR_TEST_CASE(test_redis_xadd_xlen) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("xadd s 1-1 f v").get0()).is_redis_reply()
+            .with_bulk(bytes("1-1"));
+        assert_that(e.execute_redis("xadd s 1-1 f v").get0()).is_redis_reply()
+            .with_error(bytes("equal or smaller"));
+        assert_that(e.execute_redis("xadd s 2-1 f v").get0()).is_redis_reply()
+            .with_bulk(bytes("2-1"));
+        assert_that(e.execute_redis("xlen s").get0()).is_redis_reply()
+            .with_integer(2);
+    });
+}
+
+// The IDs generated for the concurrent XADD * of a stream are all distinct,
+// none of the entries overwrites another.
+SEASTAR_TEST_CASE(test_redis_concurrent_xadd) {
+    return do_with_redis_env_thread([] (auto& e) {
+        std::vector<future<redis::redis_message>> adds;
+        for (int i = 0; i < 100; ++i) {
+            adds.emplace_back(e.execute_redis("xadd s * f v"));
+        }
+        std::set<sstring> ids;
+        for (auto& f : adds) {
+            auto text = redis_reply_text(f.get0());
+            BOOST_REQUIRE(text[0] == '$');
+            ids.insert(text);
+        }
+        BOOST_REQUIRE_EQUAL(ids.size(), 100);
+        assert_that(e.execute_redis("xlen s").get0()).is_redis_reply()
+            .with_integer(100);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_xadd_nomkstream) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("xadd missing NOMKSTREAM * f v").get0()).is_redis_reply()
+            .is_empty();
+        assert_that(e.execute_redis("exists missing").get0()).is_redis_reply()
+            .with_integer(0);
+        assert_that(e.execute_redis("xlen missing").get0()).is_redis_reply()
+            .with_integer(0);
+
+        e.execute_redis("xadd s 1-1 f v").get();
+        assert_that(e.execute_redis("xadd s NOMKSTREAM 2-1 f v").get0()).is_redis_reply()
+            .with_bulk(bytes("2-1"));
+        assert_that(e.execute_redis("xlen s").get0()).is_redis_reply()
+            .with_integer(2);
+    });
+}
+
+// The parts of the IDs are unsigned 64 bits.
+SEASTAR_TEST_CASE(test_redis_xadd_large_ids) {
+    return do_with_redis_env_thread([] (auto& e) {
+        assert_that(e.execute_redis("xadd s 9223372036854775807-1 f v").get0()).is_redis_reply()
+            .with_bulk(bytes("9223372036854775807-1"));
+        assert_that(e.execute_redis("xadd s 9223372036854775808-0 f v").get0()).is_redis_reply()
+            .with_bulk(bytes("9223372036854775808-0"));
+        assert_that(e.execute_redis("xadd s 18446744073709551615-18446744073709551615 f v").get0()).is_redis_reply()
+            .with_bulk(bytes("18446744073709551615-18446744073709551615"));
+        assert_that(e.execute_redis("xadd s 18446744073709551616-0 f v").get0()).is_redis_reply()
+            .with_error(bytes("Invalid stream ID"));
+        assert_that(e.execute_redis("xadd s 5-0 f v").get0()).is_redis_reply()
+            .with_error(bytes("equal or smaller"));
+        assert_that(e.execute_redis("xlen s").get0()).is_redis_reply()
+            .with_integer(3);
+        auto range = redis_reply_text(e.execute_redis("xrange s 9223372036854775808 +").get0());
+        BOOST_REQUIRE(range.find("*2\r\n") == 0);
+        BOOST_REQUIRE(range.find("9223372036854775808-0") != sstring::npos);
+        BOOST_REQUIRE(range.find("18446744073709551615-18446744073709551615") != sstring::npos);
+        BOOST_REQUIRE(range.find("9223372036854775807-1") == sstring::npos);
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_xack_metadata_id) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.execute_redis("xadd s 1-1 f v").get();
+        assert_that(e.execute_redis("xgroup create s g 0").get0()).is_redis_reply()
+            .with_status(bytes("OK"));
+        assert_that(e.execute_redis("xack s g 0-0").get0()).is_redis_reply()
+            .with_integer(0);
+        // The group is still there, with nothing pending.
+        BOOST_REQUIRE_EQUAL(redis_reply_text(e.execute_redis("xpending s g").get0()), "*4\r\n:0\r\n$-1\r\n$-1\r\n*-1\r\n");
+    });
+}
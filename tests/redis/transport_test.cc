@@ -0,0 +1,176 @@
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/future.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/tests/test-utils.hh>
+
+#include "seastarx.hh"
+#include "tests/cql_test_env.hh"
+#include "tests/cql_assertions.hh"
+#include "transport/redis_server.hh"
+#include "redis/redis_keyspace.hh"
+
+static constexpr uint16_t test_port = 16379;
+
+static redis_transport::redis_server_config make_server_config() {
+    redis_transport::redis_server_config cfg;
+    cfg.timeout_config = infinite_timeout_config;
+    cfg.max_request_size = 1 << 20;
+    return cfg;
+}
+
+SEASTAR_TEST_CASE(test_redis_transport_requests) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.start_transport(test_port, make_server_config()).get();
+        auto c = e.connect().get0();
+        BOOST_REQUIRE_EQUAL(c.execute("set k v").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("get k").get0(), "$1\r\nv\r\n");
+        // Pipelined requests are replied in order.
+        c.send("set k v2").get();
+        c.send("get k").get();
+        c.send("del k").get();
+        BOOST_REQUIRE_EQUAL(c.read_reply().get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.read_reply().get0(), "$2\r\nv2\r\n");
+        BOOST_REQUIRE_EQUAL(c.read_reply().get0(), ":1\r\n");
+        c.close().get();
+    });
+}
+
+// A request larger than the memory of the transport is refused, the
+// connection goes on.
+SEASTAR_TEST_CASE(test_redis_transport_request_too_large) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto cfg = make_server_config();
+        cfg.max_request_size = 20000;
+        e.start_transport(test_port, cfg).get();
+        auto c = e.connect().get0();
+        auto reply = c.execute("set k " + sstring(30000, 'x')).get0();
+        BOOST_REQUIRE(reply.find("-ERR request size too large") == 0);
+        BOOST_REQUIRE_EQUAL(c.execute("exists k").get0(), ":0\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("set k " + sstring(1000, 'x')).get0(), "+OK\r\n");
+        c.close().get();
+    });
+}
+
+// A connection with more replies pending than its output buffer limit is
+// closed, the others go on.
+SEASTAR_TEST_CASE(test_redis_transport_output_buffer_limit) {
+    return do_with_redis_env_thread([] (auto& e) {
+        auto cfg = make_server_config();
+        cfg.max_output_buffer_size = 1000;
+        e.start_transport(test_port, cfg).get();
+        e.execute_redis("set small v").get();
+        e.execute_redis("set large " + sstring(5000, 'x')).get();
+        auto c = e.connect().get0();
+        BOOST_REQUIRE_EQUAL(c.execute("get small").get0(), "$1\r\nv\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("get large").get0(), "");
+        c.close().get();
+        auto other = e.connect().get0();
+        BOOST_REQUIRE_EQUAL(other.execute("get small").get0(), "$1\r\nv\r\n");
+        other.close().get();
+    });
+}
+
+// A key read by a client with CLIENT TRACKING is invalidated once, by the
+// first write of another client.
+SEASTAR_TEST_CASE(test_redis_tracking_invalidation) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.start_transport(test_port, make_server_config()).get();
+        auto reader = e.connect().get0();
+        auto writer = e.connect().get0();
+        BOOST_REQUIRE(reader.execute("hello 3").get0().find("%7\r\n") == 0);
+        BOOST_REQUIRE_EQUAL(reader.execute("client tracking on").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(reader.execute("get k").get0(), "_\r\n");
+        BOOST_REQUIRE_EQUAL(writer.execute("set k v").get0(), "+OK\r\n");
+        // Pushed before the write is replied.
+        BOOST_REQUIRE_EQUAL(reader.read_reply().get0(), ">2\r\n$10\r\ninvalidate\r\n*1\r\n$1\r\nk\r\n");
+        // Not read again, not invalidated again.
+        BOOST_REQUIRE_EQUAL(writer.execute("set k v2").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(reader.execute("get k").get0(), "$2\r\nv2\r\n");
+        BOOST_REQUIRE_EQUAL(writer.execute("del k").get0(), ":1\r\n");
+        BOOST_REQUIRE_EQUAL(reader.read_reply().get0(), ">2\r\n$10\r\ninvalidate\r\n*1\r\n$1\r\nk\r\n");
+        BOOST_REQUIRE_EQUAL(reader.execute("client tracking off").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(reader.execute("get k").get0(), "_\r\n");
+        BOOST_REQUIRE_EQUAL(writer.execute("set k v3").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(reader.execute("exists k").get0(), ":1\r\n");
+        reader.close().get();
+        writer.close().get();
+    });
+}
+
+// In the broadcasting mode, every write of a key of the prefixes is pushed.
+SEASTAR_TEST_CASE(test_redis_tracking_bcast) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.start_transport(test_port, make_server_config()).get();
+        auto reader = e.connect().get0();
+        auto writer = e.connect().get0();
+        reader.execute("hello 3").get();
+        BOOST_REQUIRE_EQUAL(reader.execute("client tracking on bcast prefix user:").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(writer.execute("set other v").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(writer.execute("set user:1 v").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(reader.read_reply().get0(), ">2\r\n$10\r\ninvalidate\r\n*1\r\n$6\r\nuser:1\r\n");
+        BOOST_REQUIRE_EQUAL(writer.execute("set user:1 v2").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(reader.read_reply().get0(), ">2\r\n$10\r\ninvalidate\r\n*1\r\n$6\r\nuser:1\r\n");
+        reader.close().get();
+        writer.close().get();
+    });
+}
+
+SEASTAR_TEST_CASE(test_redis_tracking_needs_resp3) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.start_transport(test_port, make_server_config()).get();
+        auto c = e.connect().get0();
+        BOOST_REQUIRE(c.execute("client tracking on").get0().find("-ERR CLIENT TRACKING needs RESP3") == 0);
+        BOOST_REQUIRE(c.execute("hello 3").get0().find("%7\r\n") == 0);
+        BOOST_REQUIRE(c.execute("client tracking on prefix a").get0().find("-ERR PREFIX option requires BCAST") == 0);
+        BOOST_REQUIRE(c.execute("client tracking on optin").get0().find("-ERR optin is not supported") == 0);
+        BOOST_REQUIRE_EQUAL(c.execute("client getredir").get0(), ":-1\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("client tracking on").get0(), "+OK\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("client getredir").get0(), ":0\r\n");
+        BOOST_REQUIRE(c.execute("hello 2").get0().find("-ERR the invalidations of CLIENT TRACKING need RESP3") == 0);
+        c.close().get();
+    });
+}
+
+// HELLO switches the protocol of the connection.
+SEASTAR_TEST_CASE(test_redis_transport_hello) {
+    return do_with_redis_env_thread([] (auto& e) {
+        e.start_transport(test_port, make_server_config()).get();
+        auto c = e.connect().get0();
+        BOOST_REQUIRE_EQUAL(c.execute("get missing").get0(), "$-1\r\n");
+        auto hello = c.execute("hello 3 setname app").get0();
+        BOOST_REQUIRE(hello.find("%7\r\n$6\r\nserver\r\n$5\r\nredis\r\n") == 0);
+        BOOST_REQUIRE(hello.find("$5\r\nproto\r\n:3\r\n") != sstring::npos);
+        BOOST_REQUIRE_EQUAL(c.execute("get missing").get0(), "_\r\n");
+        BOOST_REQUIRE_EQUAL(c.execute("client getname").get0(), "$3\r\napp\r\n");
+        BOOST_REQUIRE(c.execute("hello 4").get0().find("-NOPROTO") == 0);
+        BOOST_REQUIRE(c.execute("hello x").get0().find("-ERR Protocol version is not an integer") == 0);
+        BOOST_REQUIRE(c.execute("hello 2").get0().find("*14\r\n") == 0);
+        BOOST_REQUIRE_EQUAL(c.execute("get missing").get0(), "$-1\r\n");
+        c.close().get();
+    });
+}
+
+// Every shard listens on every port, the connections of each port are served
+// whichever shard accepts them.
+SEASTAR_TEST_CASE(test_redis_transport_listeners) {
+    return do_with_redis_env_thread([] (auto& e) {
+        static constexpr uint16_t other_port = test_port + 10;
+        e.start_transport(test_port, make_server_config()).get();
+        e.listen(other_port).get();
+        std::vector<redis_test_connection> connections;
+        for (unsigned i = 0; i < 2 * smp::count; ++i) {
+            connections.push_back(e.connect(i % 2 ? other_port : test_port).get0());
+        }
+        for (unsigned i = 0; i < connections.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(connections[i].execute(sprint("set k%d v%d", i, i)).get0(), "+OK\r\n");
+        }
+        for (unsigned i = 0; i < connections.size(); ++i) {
+            auto value = sprint("v%d", (i + 1) % connections.size());
+            BOOST_REQUIRE_EQUAL(connections[i].execute(sprint("get k%d", (i + 1) % connections.size())).get0(),
+                sprint("$%d\r\n%s\r\n", value.size(), value));
+        }
+        for (auto& c : connections) {
+            c.close().get();
+        }
+    });
+}
@@ -24,6 +24,10 @@
 
 #include "db/timeout_clock.hh"
 
+namespace db {
+class config;
+}
+
 struct timeout_config {
     db::timeout_clock::duration read_timeout;
     db::timeout_clock::duration write_timeout;
@@ -37,3 +41,6 @@ struct timeout_config {
 using timeout_config_selector = db::timeout_clock::duration (timeout_config::*);
 
 extern const timeout_config infinite_timeout_config;
+
+// The timeouts of the requests of the clients, from the configuration.
+timeout_config make_timeout_config(const db::config& cfg);
@@ -26,6 +26,8 @@
 #include <boost/bimap.hpp>
 #include <boost/assign.hpp>
 #include <boost/range/adaptor/sliced.hpp>
+#include <boost/range/adaptor/transformed.hpp>
+#include <boost/range/numeric.hpp>
 
 #include "cql3/statements/batch_statement.hh"
 #include "service/migration_manager.hh"
@@ -56,6 +58,10 @@
 #include "response.hh"
 #include "request.hh"
 #include "redis/reply.hh"
+#include "redis/abstract_command.hh"
+#include "redis/client_tracking.hh"
+#include "redis/command_keys.hh"
+#include "version.hh"
 namespace redis_transport {
 
 static logging::logger logging("redis_server");
@@ -87,6 +93,46 @@ redis_server::redis_server(distributed<service::storage_proxy>& proxy, distribut
     , _auth_service(auth_service)
 {
     namespace sm = seastar::metrics;
+
+    _metrics.add_group("redis_transport", {
+        sm::make_derive("connections", _connects,
+                        sm::description("Counts a number of client connections.")),
+
+        sm::make_gauge("current_connections", _connections,
+                        sm::description("Holds a current number of client connections.")),
+
+        sm::make_derive("requests_served", _requests_served,
+                        sm::description("Counts a number of served requests.")),
+
+        sm::make_gauge("requests_serving", _requests_serving,
+                        sm::description("Holds a number of requests that are being processed right now.")),
+
+        sm::make_gauge("requests_blocked_memory_current", [this] { return _memory_available.waiters(); },
+                        sm::description(
+                            seastar::format("Holds the number of requests that are currently blocked due to reaching the memory quota limit ({}B).", _max_request_size))),
+
+        sm::make_derive("requests_blocked_memory", _requests_blocked_memory,
+                        sm::description(
+                            seastar::format("Holds an incrementing counter with the requests that ever blocked due to reaching the memory quota limit ({}B).", _max_request_size))),
+
+        sm::make_derive("output_buffer_overflows", _output_buffer_overflows,
+                        sm::description("Counts the connections closed for going over the output buffer limit.")),
+
+        sm::make_derive("bytes_received", _bytes_received,
+                        sm::description("Counts the bytes of the arguments of the requests received.")),
+
+        sm::make_derive("bytes_sent", _bytes_sent,
+                        sm::description("Counts the bytes of the replies sent.")),
+
+        sm::make_derive("parse_errors", _parse_errors,
+                        sm::description("Counts the requests which could not be parsed.")),
+
+        sm::make_derive("requests_forwarded", _requests_forwarded,
+                        sm::description("Counts the requests processed on another shard than the one of their connection.")),
+
+        sm::make_histogram("pipeline_depth", sm::description("The histogram of the number of requests of a connection in flight when a request is admitted."),
+                        [this] { return _pipeline_depth.get_histogram(1, 8); }),
+    });
 }
 
 future<> redis_server::stop() {
@@ -162,11 +208,49 @@ redis_server::do_accepts(int which, bool keepalive, ipv4_addr server_addr) {
     });
 }
 
+redis_server::stats& redis_server::stats::operator+=(const stats& o) {
+    _total_connections += o._total_connections;
+    _connections += o._connections;
+    _requests_served += o._requests_served;
+    _requests_blocked_memory += o._requests_blocked_memory;
+    _output_buffer_overflows += o._output_buffer_overflows;
+    _bytes_received += o._bytes_received;
+    _bytes_sent += o._bytes_sent;
+    _parse_errors += o._parse_errors;
+    return *this;
+}
+
+redis_server::stats redis_server::get_stats() const {
+    stats s;
+    s._total_connections = _connects;
+    s._connections = _connections;
+    s._requests_served = _requests_served;
+    s._requests_blocked_memory = _requests_blocked_memory;
+    s._output_buffer_overflows = _output_buffer_overflows;
+    s._bytes_received = _bytes_received;
+    s._bytes_sent = _bytes_sent;
+    s._parse_errors = _parse_errors;
+    return s;
+}
+
 future<redis_server::connection::result> redis_server::connection::process_request_one(redis::request&& request,  service::client_state cs, tracing_request_type rt) {
-    return futurize_apply([this, request = std::move(request), cs = std::move(cs)] () mutable {
-        auto& config = _server._config.timeout_config;
-        return _server._query_processor.local().process(std::move(request), cs, config).then([] (auto&& message) {
-            return make_ready_future<redis_server::connection::result> (std::move(message));
+    tracing::trace_state_props_set trace_props;
+    trace_props.set_if<tracing::trace_state_props::log_slow_query>(tracing::tracing::get_local_tracing_instance().slow_query_tracing_enabled());
+    trace_props.set_if<tracing::trace_state_props::full_tracing>(rt != tracing_request_type::not_requested);
+    if (trace_props) {
+        cs.create_tracing_session(tracing::trace_type::QUERY, trace_props);
+        tracing::begin(cs.get_trace_state(), seastar::value_of([&request] {
+            return seastar::format("Execute redis command {}", sstring(reinterpret_cast<const char*>(request._command.data()), request._command.size()));
+        }), cs.get_client_address());
+    }
+    return do_with(std::move(cs), [this, request = std::move(request)] (service::client_state& cs) mutable {
+        return futurize_apply([this, &cs, request = std::move(request)] () mutable {
+            auto& config = _server._config.timeout_config;
+            return _server._query_processor.local().process(std::move(request), cs, config).then([] (auto&& message) {
+                return make_ready_future<redis_server::connection::result> (std::move(message));
+            });
+        }).finally([&cs] {
+            tracing::stop_foreground(cs.get_trace_state());
         });
     });
 }
@@ -196,6 +280,143 @@ int redis_server::connection::maybe_change_keyspace(const redis::request& req, t
     return 1;
 }
 
+static future<redis_server::result> make_result(future<redis::redis_message>&& message)
+{
+    return message.then([] (auto&& message) {
+        return make_ready_future<redis_server::result>(std::move(message));
+    });
+}
+
+static sstring bytes_to_sstring(const bytes& b)
+{
+    return sstring(reinterpret_cast<const char*>(b.data()), b.size());
+}
+
+// HELLO [protover [AUTH username password] [SETNAME clientname]]
+future<redis_server::connection::result> redis_server::connection::process_hello(const redis::request& req) {
+    auto& args = req._args;
+    auto version = _client_state.get_redis_protocol_version();
+    if (!args.empty()) {
+        auto v = redis::try_bytes2long(args[0]);
+        if (!v) {
+            return make_result(redis::redis_message::make_exception("-ERR Protocol version is not an integer or out of range\r\n"));
+        }
+        if (*v != 2 && *v != 3) {
+            return make_result(redis::redis_message::make_exception("-NOPROTO unsupported protocol version\r\n"));
+        }
+        version = *v;
+    }
+    std::optional<sstring> name;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (redis::option_equals(args[i], "setname") && i + 1 < args.size()) {
+            name = bytes_to_sstring(args[++i]);
+        } else if (redis::option_equals(args[i], "auth")) {
+            return make_result(redis::redis_message::make_exception("-ERR AUTH is not supported by HELLO\r\n"));
+        } else {
+            return make_result(redis::redis_message::make_exception(sprint("-ERR Syntax error in HELLO option '%s'\r\n", bytes_to_sstring(args[i]))));
+        }
+    }
+    if (_tracking && version == 2) {
+        return make_result(redis::redis_message::make_exception("-ERR the invalidations of CLIENT TRACKING need RESP3, turn it off first\r\n"));
+    }
+    _client_state.set_redis_protocol_version(version);
+    if (name) {
+        _name = std::move(*name);
+    }
+    return make_result(redis::redis_message::make_hello(version, _id, version::release()));
+}
+
+// CLIENT ID | GETNAME | SETNAME name | GETREDIR | TRACKING ...
+future<redis_server::connection::result> redis_server::connection::process_client(const redis::request& req) {
+    auto& args = req._args;
+    if (args.empty()) {
+        return make_result(redis::redis_message::make_exception("-ERR wrong number of arguments for 'client' command\r\n"));
+    }
+    auto& op = args[0];
+    if (redis::option_equals(op, "id") && args.size() == 1) {
+        return make_result(redis::redis_message::make_long(static_cast<long>(_id)));
+    } else if (redis::option_equals(op, "getname") && args.size() == 1) {
+        if (_name.empty()) {
+            return make_result(redis::redis_message::null(_client_state.get_redis_protocol_version()));
+        }
+        return make_result(redis::redis_message::make_bytes(to_bytes(_name)));
+    } else if (redis::option_equals(op, "setname") && args.size() == 2) {
+        _name = bytes_to_sstring(args[1]);
+        return make_result(redis::redis_message::ok());
+    } else if (redis::option_equals(op, "getredir") && args.size() == 1) {
+        // The invalidations are pushed to the connection itself, never redirected.
+        return make_result(redis::redis_message::make_long(_tracking ? 0 : -1));
+    } else if (redis::option_equals(op, "tracking") && args.size() >= 2) {
+        return enable_tracking(req);
+    }
+    return make_result(redis::redis_message::make_exception(sprint("-ERR Unknown subcommand or wrong number of arguments for '%s'\r\n", bytes_to_sstring(op))));
+}
+
+// CLIENT TRACKING ON|OFF [BCAST] [PREFIX prefix ...] [NOLOOP]
+future<redis_server::connection::result> redis_server::connection::enable_tracking(const redis::request& req) {
+    auto& args = req._args;
+    auto& state = args[1];
+    if (redis::option_equals(state, "off")) {
+        return disable_tracking().then([] {
+            return make_result(redis::redis_message::ok());
+        });
+    } else if (!redis::option_equals(state, "on")) {
+        return make_result(redis::redis_message::make_exception("-ERR syntax error\r\n"));
+    }
+    tracking t;
+    std::vector<bytes> prefixes;
+    for (size_t i = 2; i < args.size(); ++i) {
+        if (redis::option_equals(args[i], "bcast")) {
+            t._bcast = true;
+        } else if (redis::option_equals(args[i], "noloop")) {
+            t._noloop = true;
+        } else if (redis::option_equals(args[i], "prefix") && i + 1 < args.size()) {
+            prefixes.emplace_back(args[++i]);
+        } else if (redis::option_equals(args[i], "redirect") || redis::option_equals(args[i], "optin") || redis::option_equals(args[i], "optout")) {
+            return make_result(redis::redis_message::make_exception(sprint("-ERR %s is not supported, the invalidations are pushed with RESP3\r\n", bytes_to_sstring(args[i]))));
+        } else {
+            return make_result(redis::redis_message::make_exception("-ERR syntax error\r\n"));
+        }
+    }
+    if (!prefixes.empty() && !t._bcast) {
+        return make_result(redis::redis_message::make_exception("-ERR PREFIX option requires BCAST mode to be enabled\r\n"));
+    }
+    if (_client_state.get_redis_protocol_version() < 3) {
+        return make_result(redis::redis_message::make_exception("-ERR CLIENT TRACKING needs RESP3 to push the invalidations, send HELLO 3 first\r\n"));
+    }
+    // Turning it on again replaces the options.
+    return disable_tracking().then([this, t, prefixes = std::move(prefixes)] () mutable {
+        _tracking = t;
+        _server._query_processor.local().get_client_tracking().register_connection(_id, [this] (std::vector<bytes> keys) {
+            push_invalidation(std::move(keys));
+        });
+        return redis::enable_client_tracking(tracking_client(), t._bcast, std::move(prefixes));
+    }).then([] {
+        return make_result(redis::redis_message::ok());
+    });
+}
+
+future<> redis_server::connection::disable_tracking() {
+    if (!_tracking) {
+        return make_ready_future<>();
+    }
+    auto bcast = _tracking->_bcast;
+    auto c = tracking_client();
+    _tracking = std::nullopt;
+    _server._query_processor.local().get_client_tracking().unregister_connection(_id);
+    // The keys read stay in the tables, their invalidations are dropped.
+    return redis::disable_client_tracking(c, bcast);
+}
+
+redis::client_tracking::client redis_server::connection::tracking_client() const {
+    return redis::client_tracking::client { engine().cpu_id(), _id, _tracking && _tracking->_noloop };
+}
+
+void redis_server::connection::push_invalidation(std::vector<bytes> keys) {
+    auto message = redis::redis_message::make_invalidation(make_lw_shared<std::vector<bytes>>(std::move(keys)));
+    write_response(make_result(std::move(message)), semaphore_units<>(_server._memory_available, 0));
+}
+
 redis_server::connection::connection(redis_server& server, ipv4_addr server_addr, connected_socket&& fd, socket_address addr)
     : _server(server)
     , _server_addr(server_addr)
@@ -204,6 +425,7 @@ redis_server::connection::connection(redis_server& server, ipv4_addr server_addr
     , _write_buf(_fd.output())
     , _parser(redis::make_ragel_protocol_parser())
     , _client_state(service::client_state::external_redis_tag{}, server._auth_service, addr, "redis_0")
+    , _id(server._next_connection_id++ * smp::count + engine().cpu_id())
 {
     ++_server._total_connections;
     ++_server._current_connections;
@@ -234,6 +456,8 @@ future<> redis_server::connection::process()
         } */ catch (...) {
             //write_response(make_error(0, exceptions::exception_code::SERVER_ERROR, "unknown error", tracing::trace_state_ptr()));
         }
+    }).finally([this] {
+        return disable_tracking();
     }).finally([this] {
         return _pending_requests_gate.close().then([this] {
             //_server._notifier->unregister_connection(this);
@@ -256,55 +480,213 @@ future<> redis_server::connection::shutdown()
 
 thread_local redis_server::connection::execution_stage_type redis_server::connection::_process_request_stage{"redis_transport", &connection::process_request_one};
 
+// The part of the memory estimate of a request set aside for its reply. A larger
+// reply is charged to the memory semaphore until it is written.
+static constexpr size_t reply_allowance = 8000;
+
+// The memory held by a request while it is processed, allowing for the copies
+// made by the commands and for the reply.
+static size_t estimate_request_memory(const redis::request& req)
+{
+    size_t size = req._command.size();
+    for (auto& arg : req._args) {
+        size += arg.size() + sizeof(bytes);
+    }
+    return size * 2 + reply_allowance;
+}
+
+static size_t reply_overcharge(size_t size)
+{
+    return size > reply_allowance ? size - reply_allowance : 0;
+}
+
+future<redis_server::connection::result> redis_server::connection::dispatch_request(tracing_request_type tracing_requested) {
+    auto& req = _parser.get_request();
+    if (req._command == "hello") {
+        return process_hello(req);
+    } else if (req._command == "client") {
+        return process_client(req);
+    }
+    if (!_server._query_processor.local().get_client_tracking().active()) {
+        return forward_request(std::move(req), _client_state, tracing_requested);
+    }
+    // The keys are recorded before they are read, a write processed meanwhile
+    // is invalidated, and the written keys are invalidated before the write is
+    // replied.
+    auto read = _tracking && !_tracking->_bcast ? redis::command_keys::read_keys(req) : std::vector<bytes>();
+    auto written = redis::command_keys::written_keys(req);
+    auto response = read.empty()
+        ? forward_request(std::move(req), _client_state, tracing_requested)
+        // The state of the connection is the one of the request, not the one
+        // of the requests following it.
+        : redis::track_keys(tracking_client(), std::move(read)).then([this, req = std::move(req), cs = _client_state, tracing_requested] () mutable {
+            return forward_request(std::move(req), cs, tracing_requested);
+        });
+    return response.then([this, written = std::move(written)] (result r) mutable {
+        if (written.empty()) {
+            return make_ready_future<result>(std::move(r));
+        }
+        return redis::invalidate_tracked_keys(std::move(written), _id).then([r = std::move(r)] () mutable {
+            return std::move(r);
+        });
+    });
+}
+
+future<redis_server::connection::result> redis_server::connection::forward_request(redis::request&& req, const service::client_state& cs, tracing_request_type tracing_requested) {
+    auto cpu = pick_request_cpu();
+    // If the SELECT command coming,  Maybe we should change the
+    // keyspace of current connection.
+    // So do not submit the SELECT command to other shard.
+    auto changed = maybe_change_keyspace(req, tracing_requested);
+    if (changed < 0) {
+        if (cpu != engine().cpu_id()) {
+            ++_server._requests_forwarded;
+        }
+        if (cpu == engine().cpu_id()) {
+            return _process_request_stage(this, std::move(req), service::client_state(service::client_state::request_copy_tag{}, cs, cs.get_timestamp()), tracing_requested);
+        } else {
+            return smp::submit_to(cpu, [this, request = std::move(req), client_state = cs, tracing_requested, ts = cs.get_timestamp()] () mutable {
+                return _process_request_stage(this, request, service::client_state(service::client_state::request_copy_tag{}, client_state, ts), tracing_requested);
+            });
+        }
+    } else if (changed == 0) {
+        // Move these codes to query processor.
+        return redis::redis_message::ok().then([] (auto&& message) {
+            return make_ready_future<redis_server::connection::result>(std::move(message));
+        });
+    } else if (changed == 1) {
+        return redis::redis_message::make_exception("-invalid DB index\r\n").then([] (auto&& message) {
+            return make_ready_future<redis_server::connection::result>(std::move(message));
+        });
+    } else {
+        return redis::redis_message::make_exception("-wrong number of arguments for 'select' command\r\n").then([] (auto&& message) {
+            return make_ready_future<redis_server::connection::result>(std::move(message));
+        });
+    }
+}
+
 future<> redis_server::connection::process_request() {
     _parser.init();
     return _read_buf.consume(_parser).then([this] {
-        ++_server._requests_served;
-        ++_server._requests_serving;
-        _pending_requests_gate.enter();
-        auto leave = defer([this] { _pending_requests_gate.leave(); });
-        tracing_request_type tracing_requested = tracing_request_type::not_requested;
-        [&] {
-            auto cpu = pick_request_cpu();
-            // If the SELECT command coming,  Maybe we should change the
-            // keyspace of current connection.
-            // So do not submit the SELECT command to other shard.
-            auto changed = maybe_change_keyspace(_parser.get_request(), tracing_requested);
-            if (changed < 0) {
-                if (cpu == engine().cpu_id()) {
-                    return _process_request_stage(this, std::move(_parser.get_request()), service::client_state(service::client_state::request_copy_tag{}, _client_state, _client_state.get_timestamp()), tracing_requested);
-                } else {
-                    return smp::submit_to(cpu, [this, request = std::move(_parser.get_request()), client_state = _client_state, tracing_requested, ts = _client_state.get_timestamp()] () mutable {
-                        return _process_request_stage(this, request, service::client_state(service::client_state::request_copy_tag{}, client_state, ts), tracing_requested);
-                    });
-                }
-            } else if (changed == 0) {
-                // Move these codes to query processor.
-                return redis::redis_message::ok().then([] (auto&& message) {
-                    return make_ready_future<redis_server::connection::result>(std::move(message));
-                });
-            } else if (changed == 1) {
-                return redis::redis_message::make_exception("-invalid DB index\r\n").then([] (auto&& message) {
-                    return make_ready_future<redis_server::connection::result>(std::move(message));
-                });
-            } else {
-                return redis::redis_message::make_exception("-wrong number of arguments for 'select' command\r\n").then([] (auto&& message) {
-                    return make_ready_future<redis_server::connection::result>(std::move(message));
+        auto& req = _parser.get_request();
+        if (req._state == redis::protocol_state::error) {
+            ++_server._parse_errors;
+        }
+        auto mem_estimate = estimate_request_memory(req);
+        auto request_size = boost::accumulate(req._args | boost::adaptors::transformed([] (auto& arg) { return arg.size(); }), req._command.size());
+        if (mem_estimate > _server._max_request_size) {
+            // Waiting for more units than the semaphore has would never complete.
+            auto response = redis::redis_message::make_exception(sprint("-ERR request size too large (estimate %d; allowed %d)\r\n", mem_estimate, _server._max_request_size)).then([] (auto&& message) {
+                return make_ready_future<redis_server::connection::result>(std::move(message));
+            });
+            write_response(std::move(response), semaphore_units<>(_server._memory_available, 0));
+            return make_ready_future<>();
+        }
+        // The next request is not read until this one is admitted, so a client
+        // over the budget is held back by TCP flow control.
+        auto fut = get_units(_server._memory_available, mem_estimate);
+        if (_server._memory_available.waiters()) {
+            ++_server._requests_blocked_memory;
+        }
+        return fut.then([this, request_size] (semaphore_units<> mem_permit) {
+            ++_server._requests_served;
+            ++_server._requests_serving;
+            _server._bytes_received += request_size;
+            _server._pipeline_depth.add(_pending_requests);
+            // Sampled by the trace probability (nodetool settraceprobability), the
+            // sessions of the slow commands are linked from their slowlog entries.
+            tracing_request_type tracing_requested = tracing_request_type::not_requested;
+            if (tracing::tracing::get_local_tracing_instance().trace_next_query()) {
+                tracing_requested = tracing_request_type::no_write_on_close;
+            }
+            auto response = dispatch_request(tracing_requested).finally([this] {
+                --_server._requests_serving;
+            }).then([this] (result r) {
+                auto size = r._data->message()->size();
+                return account_output(size).then([r = std::move(r)] () mutable {
+                    return std::move(r);
                 });
-            } 
-        } ().then_wrapped([this, leave = std::move(leave)] (future<result> result_future) {
+            });
+            write_response(std::move(response), std::move(mem_permit));
+        });
+    });
+}
+
+future<> redis_server::connection::account_output(size_t size) {
+    // The reply is already built, it can't wait for memory, the following requests will.
+    _server._memory_available.consume(reply_overcharge(size));
+    _pending_output += size;
+    auto limit = _server._config.max_output_buffer_size;
+    if (limit && _pending_output > limit) {
+        ++_server._output_buffer_overflows;
+        logging.warn("closing connection: {} bytes of replies are pending, over the output buffer limit of {} bytes", _pending_output, limit);
+        // The reply is still handed to write_response(), its write fails on
+        // the closed socket and the pending replies are released in order.
+        return shutdown().handle_exception([] (auto ep) {
+            logging.warn("closing connection failed: {}", ep);
+        });
+    }
+    return make_ready_future<>();
+}
+
+void redis_server::connection::write_response(future<result>&& response, semaphore_units<>&& mem_permit) {
+    _pending_requests_gate.enter();
+    ++_pending_requests;
+    _ready_to_respond = _ready_to_respond.then_wrapped([this, response = std::move(response), mem_permit = std::move(mem_permit)] (future<> previous) mutable {
+        // A failed write already broke the connection, the replies are still consumed.
+        previous.ignore_ready_future();
+        return std::move(response).then_wrapped([this] (future<result> f) {
             try {
-                auto result = result_future.get0();
-                --_server._requests_serving;
-                auto message = result.make_message();
-                _write_buf.write(std::move(*message)).then([this] {
-                    _write_buf.flush();
+                auto r = f.get0();
+                auto message = r.make_message();
+                auto size = message->size();
+                return _write_buf.write(std::move(*message)).then([this] {
+                    return _write_buf.flush();
+                }).finally([this, size] {
+                    _server._bytes_sent += size;
+                    _pending_output -= size;
+                    _server._memory_available.signal(reply_overcharge(size));
+                }).then([this, reply = std::move(r._data)] () mutable {
+                    return write_pages(std::move(reply));
                 });
             } catch (...) {
                 logging.error("request processing failed: {}", std::current_exception());
             }
+            return make_ready_future<>();
         });
+    }).finally([this] {
+        --_pending_requests;
+        _pending_requests_gate.leave();
+    });
+}
+
+future<> redis_server::connection::write_pages(foreign_ptr<std::unique_ptr<redis::redis_message>> reply) {
+    if (!reply->streamed()) {
         return make_ready_future<>();
+    }
+    return do_with(std::move(reply), [this] (auto& reply) {
+        return repeat([this, &reply] {
+            return smp::submit_to(reply.get_owner_shard(), [m = reply.get()] {
+                return m->next_page();
+            }).then([this] (foreign_ptr<std::unique_ptr<redis::redis_message>> page) {
+                if (!page) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
+                auto message = page->message();
+                _server._bytes_sent += message->size();
+                return _write_buf.write(std::move(*message)).then([this] {
+                    return _write_buf.flush();
+                }).then([page = std::move(page)] {
+                    return stop_iteration::no;
+                });
+            });
+        });
+    }).handle_exception([this] (auto ep) {
+        // Half of the reply is written, the connection can't go on.
+        logging.error("streaming a reply failed: {}", ep);
+        return shutdown().handle_exception([] (auto ep) {
+            logging.warn("closing connection failed: {}", ep);
+        });
     });
 }
 
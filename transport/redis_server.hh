@@ -38,6 +38,7 @@
 #include <seastar/net/tls.hh>
 #include <seastar/core/metrics_registration.hh>
 #include "utils/fragmented_temporary_buffer.hh"
+#include "utils/estimated_histogram.hh"
 #include "redis/request.hh"
 #include "redis/reply.hh"
 #include "redis/protocol_parser.hh"
@@ -55,6 +56,8 @@ redis_load_balance parse_load_balance(sstring value);
 struct redis_server_config {
     ::timeout_config timeout_config;
     size_t max_request_size;
+    // The limit of the replies pending on a connection, 0 for no limit.
+    size_t max_output_buffer_size = 0;
 };
 
 class redis_server {
@@ -71,6 +74,16 @@ private:
     uint64_t _requests_served = 0;
     uint64_t _requests_serving = 0;
     uint64_t _requests_blocked_memory = 0;
+    uint64_t _output_buffer_overflows = 0;
+    uint64_t _bytes_received = 0;
+    uint64_t _bytes_sent = 0;
+    uint64_t _parse_errors = 0;
+    uint64_t _requests_forwarded = 0;
+    // The number of requests of a connection pending when a request is admitted.
+    utils::estimated_histogram _pipeline_depth;
+    // The ids of the connections are unique on the node, the shard is the
+    // remainder by the number of shards.
+    uint64_t _next_connection_id = 0;
     redis_load_balance _lb;
     auth::service& _auth_service;
 public:
@@ -78,6 +91,20 @@ public:
     future<> listen(ipv4_addr addr, std::shared_ptr<seastar::tls::credentials_builder> = {}, bool keepalive = false);
     future<> do_accepts(int which, bool keepalive, ipv4_addr server_addr);
     future<> stop();
+
+    // The counters of a shard, summed up over the shards by INFO.
+    struct stats {
+        uint64_t _total_connections = 0;
+        uint64_t _connections = 0;
+        uint64_t _requests_served = 0;
+        uint64_t _requests_blocked_memory = 0;
+        uint64_t _output_buffer_overflows = 0;
+        uint64_t _bytes_received = 0;
+        uint64_t _bytes_sent = 0;
+        uint64_t _parse_errors = 0;
+        stats& operator+=(const stats& o);
+    };
+    stats get_stats() const;
 public:
     struct result {
         result(redis::redis_message&& m) : _data(make_foreign(std::make_unique<redis::redis_message>(std::move(m)))) {}
@@ -102,6 +129,18 @@ private:
         service::client_state _client_state;
         future<> _ready_to_respond = make_ready_future<>();
         unsigned _request_cpu = 0;
+        // The size of the replies ready but not written yet.
+        size_t _pending_output = 0;
+        // The requests admitted but not replied yet.
+        size_t _pending_requests = 0;
+        uint64_t _id;
+        sstring _name;
+        // CLIENT TRACKING on.
+        struct tracking {
+            bool _bcast = false;
+            bool _noloop = false;
+        };
+        std::optional<tracking> _tracking;
     private:
         enum class tracing_request_type : uint8_t {
             not_requested,
@@ -128,6 +167,26 @@ private:
         friend class process_request_executor;
         future<result> process_request_one(redis::request&& request,  service::client_state cs, tracing_request_type rt);
         int maybe_change_keyspace(const redis::request& request, tracing_request_type rt);
+        future<result> dispatch_request(tracing_request_type rt);
+        future<result> forward_request(redis::request&& request, const service::client_state& cs, tracing_request_type rt);
+        // HELLO and CLIENT change the state of the connection, they are
+        // processed by the connection like SELECT.
+        future<result> process_hello(const redis::request& request);
+        future<result> process_client(const redis::request& request);
+        future<result> enable_tracking(const redis::request& request);
+        future<> disable_tracking();
+        redis::client_tracking::client tracking_client() const;
+        // Sends the invalidations of CLIENT TRACKING.
+        void push_invalidation(std::vector<bytes> keys);
+        // Writes the reply once the previous ones are written, so that the replies of
+        // pipelined requests are in order; the memory permit is released afterwards.
+        void write_response(future<result>&& response, semaphore_units<>&& mem_permit);
+        // Charges the reply to the memory of the server and to the output buffer of
+        // the connection, which is shut down over its limit.
+        future<> account_output(size_t size);
+        // Writes the pages following the first one of a streamed reply, each
+        // one read once the previous one is written.
+        future<> write_pages(foreign_ptr<std::unique_ptr<redis::redis_message>> reply);
         unsigned pick_request_cpu();
     };
 